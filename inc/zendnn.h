@@ -3325,9 +3325,13 @@ zendnn_status_t ZENDNN_API zendnn_reduction_desc_init(zendnn_reduction_desc_t *d
 ///     #zendnn_embedding_bag_mean,
 /// @param num_threads Parallel threads for the primitive (zero for default
 ///              omp threads)
-/// @param input_desc Input (embedding table) memory descriptor.
-/// @param indices_desc Indices memory descriptor.
-/// @param offsets_desc Offsets memory descriptor.
+/// @param input_desc Input (embedding table) memory descriptor. Row-wise
+///     quantized (#zendnn_u8) tables need
+///     zendnn_embedding_bag_quant_desc_init().
+/// @param indices_desc Indices memory descriptor, #zendnn_s32 or
+///     #zendnn_s64.
+/// @param offsets_desc Offsets memory descriptor, same data type as
+///     indices.
 /// @param weights_desc Weights memory descriptor. This can be nullptr if
 ///     no weights vector is present.
 /// @param dst_desc Destination memory descriptor.
@@ -3347,6 +3351,53 @@ zendnn_embedding_bag_desc_init(zendnn_embedding_bag_desc_t *desc,
                                const zendnn_memory_desc_t *weights_desc,
                                const zendnn_memory_desc_t *dst_desc,
                                int32_t padding_idx);
+
+/// Initializes a descriptor for an embedding_bag primitive over a row-wise
+/// quantized table.
+///
+/// Table is #zendnn_u8 of dims {rows, bytes of quantized values}, row holds
+/// dst_desc->dims[1] values of @p quant_bits bits (4 bit values are packed
+/// two per byte, even column in low nibble) followed by scale and bias of
+/// @p scale_data_type. Row stride must be the quantized bytes plus scale and
+/// bias.
+///
+/// @param desc Output descriptor for an embeding_bag primitive
+/// @param prop_kind Propagation kind. currently only forward_inference is
+///     supported.
+/// @param alg_kind embedding_bag algorithm kind. Possible values:
+///     #zendnn_embedding_bag_max, #zendnn_embedding_bag_sum,
+///     #zendnn_embedding_bag_mean,
+/// @param num_threads Parallel threads for the primitive (zero for default
+///              omp threads)
+/// @param input_desc Input (quantized embedding table) memory descriptor.
+/// @param indices_desc Indices memory descriptor, #zendnn_s32 or
+///     #zendnn_s64.
+/// @param offsets_desc Offsets memory descriptor, same data type as
+///     indices.
+/// @param weights_desc Weights memory descriptor. This can be nullptr if
+///     no weights vector is present.
+/// @param dst_desc Destination memory descriptor.
+/// @param padding_idx Padding Index. If no padding index is present then
+///     this should be -1.
+/// @param quant_bits Bits per quantized value, 8 or 4.
+/// @param scale_data_type Data type of scale and bias, #zendnn_f32 or
+///     #zendnn_f16.
+/// @returns #zendnn_success on success and a status describing the error
+///     otherwise.
+///
+zendnn_status_t ZENDNN_API
+zendnn_embedding_bag_quant_desc_init(zendnn_embedding_bag_desc_t *desc,
+                                     zendnn_prop_kind_t prop_kind,
+                                     zendnn_alg_kind_t alg_kind,
+                                     uint32_t num_threads,
+                                     const zendnn_memory_desc_t *input_desc,
+                                     const zendnn_memory_desc_t *indices_desc,
+                                     const zendnn_memory_desc_t *offsets_desc,
+                                     const zendnn_memory_desc_t *weights_desc,
+                                     const zendnn_memory_desc_t *dst_desc,
+                                     int32_t padding_idx,
+                                     int32_t quant_bits,
+                                     zendnn_data_type_t scale_data_type);
 /// @} zendnn_api_embedding_bag
 
 /// @} zendnn_api_primitives
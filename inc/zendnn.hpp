@@ -491,6 +491,11 @@ enum class algorithm {
     convolution_direct = zendnn_convolution_direct,
     /// Winograd convolution
     convolution_winograd = zendnn_convolution_winograd,
+    /// FFT convolution, stride 1 2D convolution only. The filter is
+    /// transformed once per primitive and reused while the same weights
+    /// buffer is passed, call zenWeightsUpdated() after updating weights in
+    /// place.
+    convolution_fft = zendnn_convolution_fft,
     /// Direct deconvolution
     deconvolution_direct = zendnn_deconvolution_direct,
     /// Winograd deconvolution
@@ -1180,6 +1185,8 @@ struct memory : public handle<zendnn_memory_t> {
         s8 = zendnn_s8,
         /// 8-bit unsigned integer.
         u8 = zendnn_u8,
+        /// 64-bit signed integer(embedding bag indices and offsets only).
+        s64 = zendnn_s64,
     };
 
     /// Returns size of data type in bytes.
@@ -10975,6 +10982,54 @@ struct embedding_bag : public primitive {
                     "could not create an embedding_bag descriptor");
         }
 
+        /// Constructs a descriptor for an embedding_bag primitive over a
+        /// row-wise quantized (u8) table.
+        ///
+        /// Table row holds dst_desc.dims[1] values of @p quant_bits bits
+        /// (4 bit values are packed two per byte) followed by scale and bias
+        /// of @p scale_data_type, see
+        /// zendnn_embedding_bag_quant_desc_init().
+        ///
+        /// @param aprop_kind possible value forward_inference
+        /// @param aalgorithm embedding_mag algorithm kind. Possible values:
+        ///     embedding_bag_max, embedding_bag_sum or embedding_bag_mean,
+        /// @param num_threads Parallel threads for the primitive
+        /// (zero for default omp threads)
+        /// @param input_desc Input (quantized embedding table) memory
+        ///     descriptor.
+        /// @param indices_desc Indices memory descriptor.
+        /// @param offsets_desc Offsets memory descriptor.
+        /// @param weights_desc Weights memory descriptor, zero memory
+        ///     descriptor if there are no weights.
+        /// @param padding_idx Padding Index, -1 if there is no padding index.
+        /// @param quant_bits Bits per quantized value, 8 or 4.
+        /// @param scale_data_type Data type of scale and bias, f32 or f16.
+        desc(prop_kind aprop_kind, algorithm aalgorithm,
+             uint32_t num_threads,
+             const memory::desc &input_desc,
+             const memory::desc &indices_desc,
+             const memory::desc &offsets_desc,
+             const memory::desc &weights_desc,
+             const memory::desc &dst_desc,
+             int32_t            padding_idx,
+             int32_t            quant_bits,
+             memory::data_type  scale_data_type) {
+             error::wrap_c_api(
+                    zendnn_embedding_bag_quant_desc_init(&data,
+                                   convert_to_c(aprop_kind),
+                                   convert_to_c(aalgorithm),
+                                   num_threads,
+                                   &input_desc.data,
+                                   &indices_desc.data,
+                                   &offsets_desc.data,
+                                   weights_desc ? &weights_desc.data : nullptr,
+                                   &dst_desc.data,
+                                   padding_idx,
+                                   quant_bits,
+                                   memory::convert_to_c(scale_data_type)),
+                    "could not create an embedding_bag descriptor");
+        }
+
         /// Constructs a descriptor for an embedding_bag primitive using
         /// algorithm specific parameters, source and destination memory
         /// descriptors.
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <iostream>
+#include <cstdint>
 
 
 namespace zendnn {
@@ -17,10 +18,16 @@ class zendnnEnv {
     uint    zen_num_threads;
     uint    zenGEMMalgo;
     bool    zenBlockedFormat;
+    uint    zenBlockSize;
     bool    zenBlockedNHWC;
     uint    zenEnableMemPool;
     bool    zenLibMemPoolEnable;
     bool    zenINT8format;
+    bool    zenConvPipeline;
+    bool    zenConvPackedPatch;
+    bool    zenConvFoldBN;
+    uint    zenEmbPrefetchDist;
+    uint    zenEmbSplitMin;
 
     //setting default values
     zendnnEnv() {
@@ -28,10 +35,16 @@ class zendnnEnv {
         zen_num_threads = 1;
         zenGEMMalgo = 0;
         zenBlockedFormat = false;
+        zenBlockSize = 8;
         zenBlockedNHWC = false;
         zenEnableMemPool = 1;
         zenLibMemPoolEnable = true;
         zenINT8format = false;
+        zenConvPipeline = false;
+        zenConvPackedPatch = false;
+        zenConvFoldBN = false;
+        zenEmbPrefetchDist = 8;
+        zenEmbSplitMin = 256;
     }
 };
 
@@ -65,6 +78,15 @@ inline std::string zendnn_getenv_string(const char *name,
 zendnn::zendnnEnv readEnv();
 
 extern "C" {
+    //Convolution primitives cache transformed weights(packed, FFT or
+    //BatchNorm folded filters) across executions, keyed by the weights(and
+    //BatchNorm parameter) buffers and the weights version. Weights are not
+    //compared, zenWeightsUpdated must be called after weights of an
+    //executed primitive are updated in place or their buffer is freed, so
+    //transforms are recomputed on next execution.
+    void zenWeightsUpdated();
+    unsigned long zenWeightsVersion();
+
     void zenConvolution2D(
         const float *in_layer,
         const int no_of_images,
@@ -221,6 +243,128 @@ extern "C" {
         const int total_filters = 0
     );
 
+    void zenConvolution2DwithPool(
+        const float *in_layer,
+        const int no_of_images,
+        const int channels,
+        const int height,
+        const int width,
+        const float *filter,
+        const int no_of_filter,
+        const int kernel_h,
+        const int kernel_w,
+        const int pad_t,
+        const int pad_l,
+        const int pad_b,
+        const int pad_r,
+        const int stride_h,
+        const int stride_w,
+        const float *bias,
+        const bool relu,
+        const int conv_out_height,
+        const int conv_out_width,
+        const bool avg_pool,
+        const int pool_kernel_h,
+        const int pool_kernel_w,
+        const int pool_stride_h,
+        const int pool_stride_w,
+        const int pool_pad_t,
+        const int pool_pad_l,
+        const int pool_pad_b,
+        const int pool_pad_r,
+        float *out_layer,
+        const int out_height,
+        const int out_width
+    );
+
+    void zenInvertedResidualBlock(
+        const float *in_layer,
+        const int no_of_images,
+        const int channels,
+        const int height,
+        const int width,
+        const float *expand_filter,
+        const int expanded_channels,
+        const float *expand_scale,
+        const float *expand_mean,
+        const float *expand_offset,
+        const float *dw_filter,
+        const int kernel_h,
+        const int kernel_w,
+        const int pad_t,
+        const int pad_l,
+        const int pad_b,
+        const int pad_r,
+        const int stride_h,
+        const int stride_w,
+        const float *dw_scale,
+        const float *dw_mean,
+        const float *dw_offset,
+        const float *project_filter,
+        const int no_of_filter,
+        const float *project_scale,
+        const float *project_mean,
+        const float *project_offset,
+        const bool residual,
+        float *out_layer,
+        const int out_height,
+        const int out_width
+    );
+
+    void zenConvolution2DInt8(
+        const uint8_t *in_layer,
+        const int no_of_images,
+        const int channels,
+        const int height,
+        const int width,
+        const int8_t *filter,
+        const int no_of_filter,
+        const int kernel_h,
+        const int kernel_w,
+        const int pad_t,
+        const int pad_l,
+        const int pad_b,
+        const int pad_r,
+        const int stride_h,
+        const int stride_w,
+        const float *bias,
+        const float *scale,
+        const int scale_count,
+        const int src_zero_point,
+        const float *bn_scale,
+        const float *bn_mean,
+        const float *bn_offset,
+        const bool relu,
+        const float sum_scale,
+        void *out_layer,
+        const bool out_signed,
+        const int out_height,
+        const int out_width,
+        const bool concat = false,
+        const int filter_offset = 0,
+        const int total_filters = 0,
+        const void *packed_filter = NULL
+    );
+
+    //Size in bytes and packing of INT8 filter for zenConvolution2DInt8.
+    //Filter packed once can be passed as packed_filter for every call with
+    //the same weights, filter is then not read.
+    unsigned long zenConvolution2DInt8FilterSize(
+        const int channels,
+        const int no_of_filter,
+        const int kernel_h,
+        const int kernel_w
+    );
+
+    void zenConvolution2DInt8FilterPack(
+        const int8_t *filter,
+        const int channels,
+        const int no_of_filter,
+        const int kernel_h,
+        const int kernel_w,
+        void *packed_filter
+    );
+
     void zenBatchMatMul(
         bool Layout,
         bool TransA,
@@ -240,6 +384,199 @@ extern "C" {
         int *group_size
     );
 
+    //Grouped embedding bag over table_count f32 tables with s32 indices and
+    //offsets, mode is 0 for sum, 1 for mean and 2 for max(as in PyTorch
+    //EmbeddingBag). weights_Array and padding_idx_Array may be NULL.
+    //Output of table t is written at column offset sum(dim_Array[0..t)) of
+    //out_layer rows with leading dimension ldo.
+    //zenGroupEmbeddingBagInt64 takes s64 indices and offsets.
+    void zenGroupEmbeddingBag(
+        const int table_count,
+        const float **table_Array,
+        const int *dim_Array,
+        const int **indices_Array,
+        const int *indices_size_Array,
+        const int **offsets_Array,
+        const float **weights_Array,
+        const int *mode_Array,
+        const int *padding_idx_Array,
+        const int bags,
+        float *out_layer,
+        const int ldo
+    );
+
+    void zenGroupEmbeddingBagInt64(
+        const int table_count,
+        const float **table_Array,
+        const int *dim_Array,
+        const int64_t **indices_Array,
+        const int *indices_size_Array,
+        const int64_t **offsets_Array,
+        const float **weights_Array,
+        const int *mode_Array,
+        const int *padding_idx_Array,
+        const int bags,
+        float *out_layer,
+        const int ldo
+    );
+
+    //Embedding bag backward over f32 table of rows x dim with s32 indices
+    //and offsets, mode is 0 for sum and 1 for mean(max needs argmax of the
+    //forward pass and is not supported), weights only with sum.
+    //diff_dst is bags x dim with leading dimension ldd. Gradients of
+    //repeated rows are added, rows_out gets unique rows in ascending order
+    //and grad_out their gradients(unique x dim), both sized for
+    //indices_size rows. Returns number of unique rows, -1 on error.
+    int zenEmbeddingBagBackward(
+        const int rows,
+        const int dim,
+        const int *indices,
+        const int indices_size,
+        const int *offsets,
+        const int bags,
+        const float *weights,
+        const int mode,
+        const int padding_idx,
+        const float *diff_dst,
+        const int ldd,
+        int *rows_out,
+        float *grad_out
+    );
+
+    //Embedding bag backward fused with sparse optimizer update of table,
+    //arguments are as in zenEmbeddingBagBackward. optimizer is 0 for SGD
+    //(table -= lr*g), 1 for Adagrad(state of rows x dim, state += g*g and
+    //table -= lr*g/(sqrt(state) + eps)) and 2 for row-wise Adagrad(state of
+    //one value per row accumulating mean of g*g over the row). Each unique
+    //row is updated once by a single thread. Returns number of updated
+    //rows, -1 on error.
+    int zenEmbeddingBagUpdate(
+        float *table,
+        const int rows,
+        const int dim,
+        const int *indices,
+        const int indices_size,
+        const int *offsets,
+        const int bags,
+        const float *weights,
+        const int mode,
+        const int padding_idx,
+        const float *diff_dst,
+        const int ldd,
+        const int optimizer,
+        const float lr,
+        const float eps,
+        float *state
+    );
+
+    //Frequency aware row reordering of f32 embedding table of rows x dim.
+    //zenEmbeddingRowCount adds access counts of indices(padding_idx is
+    //skipped) to counts, it is called for warm up batches.
+    //zenEmbeddingRowReorder copies rows to table_out(not in place) in
+    //decreasing count order, so hot rows are contiguous, remap[r] is new
+    //position of row r. Returns number of rows with non zero count, -1 on
+    //error.
+    //zenEmbeddingBagRemap is embedding bag over reordered table, indices
+    //are original rows and are remapped inside the bag kernel, other
+    //arguments are as in zenGroupEmbeddingBag for a single table, out_layer
+    //is bags x dim with leading dimension ldo.
+    //Int64 variants take s64 indices and offsets, remap is s32.
+    void zenEmbeddingRowCount(
+        const int rows,
+        const int *indices,
+        const int indices_size,
+        const int padding_idx,
+        unsigned int *counts
+    );
+
+    void zenEmbeddingRowCountInt64(
+        const int rows,
+        const int64_t *indices,
+        const int indices_size,
+        const int padding_idx,
+        unsigned int *counts
+    );
+
+    int zenEmbeddingRowReorder(
+        const float *table,
+        const int rows,
+        const int dim,
+        const unsigned int *counts,
+        float *table_out,
+        int *remap
+    );
+
+    void zenEmbeddingBagRemap(
+        const float *table,
+        const int dim,
+        const int *remap,
+        const int *indices,
+        const int indices_size,
+        const int *offsets,
+        const int bags,
+        const float *weights,
+        const int mode,
+        const int padding_idx,
+        float *out_layer,
+        const int ldo
+    );
+
+    void zenEmbeddingBagRemapInt64(
+        const float *table,
+        const int dim,
+        const int *remap,
+        const int64_t *indices,
+        const int indices_size,
+        const int64_t *offsets,
+        const int bags,
+        const float *weights,
+        const int mode,
+        const int padding_idx,
+        float *out_layer,
+        const int ldo
+    );
+
+    //File backed f32 embedding table of rows x dim, for tables larger than
+    //DRAM. zenEmbeddingTableMap maps the table stored at byte offset(a
+    //multiple of sizeof(float)) of a local file read only with MADV_RANDOM
+    //and returns its first row. NULL is returned if offset is not float
+    //aligned, table size overflows or file is smaller than offset plus
+    //table. Mapped table can be used as handle of embedding bag table
+    //memory or with zen* embedding bag calls. zenEmbeddingTableUnmap unmaps
+    //it.
+    //zenEmbeddingTablePrefetch requests pages of rows of indices(of the
+    //next batch) with MADV_WILLNEED, so they are read ahead of the lookup.
+    //Returns number of page ranges requested, -1 on error.
+    //zenEmbeddingTablePrefetchInt64 takes s64 indices.
+    const float *zenEmbeddingTableMap(
+        const char *path,
+        const unsigned long offset,
+        const unsigned long rows,
+        const int dim
+    );
+
+    void zenEmbeddingTableUnmap(
+        const float *table,
+        const unsigned long rows,
+        const int dim
+    );
+
+    int zenEmbeddingTablePrefetch(
+        const float *table,
+        const int dim,
+        const int *indices,
+        const int indices_size,
+        const int padding_idx
+    );
+
+    int zenEmbeddingTablePrefetchInt64(
+        const float *table,
+        const int dim,
+        const int64_t *indices,
+        const int indices_size,
+        const int padding_idx
+    );
+
     void max_pooling(
         const float *input,
         const int number_of_images,
@@ -79,6 +79,8 @@ typedef enum {
     zendnn_s8 = 5,
     /// 8-bit unsigned integer.
     zendnn_u8 = 6,
+    /// 64-bit signed integer(embedding bag indices and offsets only).
+    zendnn_s64 = 7,
 } zendnn_data_type_t;
 
 /// Memory format kind
@@ -1177,6 +1179,8 @@ typedef enum {
     zendnn_convolution_gemm = 0x4,
     /// Ref convolution
     zendnn_convolution_ref = 0x5,
+    /// FFT convolution
+    zendnn_convolution_fft = 0x6,
     /// Direct deconvolution
     zendnn_deconvolution_direct = 0xa,
     /// Winograd deconvolution
@@ -2277,6 +2281,12 @@ typedef struct {
 
     int32_t num_threads; // no of parallel threads
 
+    /// Row-wise quantized (#zendnn_u8) table parameters, bits per value
+    /// (8 or 4) and data type of per row scale and bias (#zendnn_f32 or
+    /// #zendnn_f16). 0 and #zendnn_data_type_undef for other tables.
+    int32_t quant_bits;
+    zendnn_data_type_t quant_scale_data_type;
+
 } zendnn_embedding_bag_desc_t;
 
 /// @} zendnn_api_embedding_bag
@@ -74,6 +74,7 @@ const alg_kind_t convolution_gemm = zendnn_convolution_gemm;
 const alg_kind_t convolution_ref = zendnn_convolution_ref;
 const alg_kind_t convolution_direct = zendnn_convolution_direct;
 const alg_kind_t convolution_winograd = zendnn_convolution_winograd;
+const alg_kind_t convolution_fft = zendnn_convolution_fft;
 const alg_kind_t deconvolution_direct = zendnn_deconvolution_direct;
 const alg_kind_t deconvolution_winograd = zendnn_deconvolution_winograd;
 const alg_kind_t eltwise_relu = zendnn_eltwise_relu;
@@ -161,6 +162,7 @@ const data_type_t f32 = zendnn_f32;
 const data_type_t s32 = zendnn_s32;
 const data_type_t s8 = zendnn_s8;
 const data_type_t u8 = zendnn_u8;
+const data_type_t s64 = zendnn_s64;
 } // namespace data_type
 
 using scratchpad_mode_t = zendnn_scratchpad_mode_t;
@@ -51,7 +51,7 @@ status_t conv_desc_init(convolution_desc_t *conv_desc, prop_kind_t prop_kind,
                     padding_l)
             && one_of(alg_kind, convolution_auto, convolution_direct,
                       convolution_winograd, convolution_gemm,
-                      convolution_ref);
+                      convolution_ref, convolution_fft);
     if (!args_ok) return invalid_arguments;
 
     if (padding_r == nullptr) padding_r = padding_l;
@@ -250,7 +250,8 @@ protected:
         assert(utils::one_of(alg_kind, alg_kind::convolution_direct,
                              alg_kind::convolution_winograd,
                              alg_kind::convolution_gemm,
-                             alg_kind::convolution_ref));
+                             alg_kind::convolution_ref,
+                             alg_kind::convolution_fft));
         if (desc_.alg_kind == alg_kind::convolution_auto)
             desc_.alg_kind = alg_kind;
         return desc_.alg_kind == alg_kind;
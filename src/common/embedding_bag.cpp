@@ -18,6 +18,7 @@
 
 #include "zendnn_helper.hpp"
 #include "c_types_map.hpp"
+#include "type_helpers.hpp"
 #include "utils.hpp"
 
 using namespace zendnn::impl;
@@ -27,17 +28,20 @@ using namespace zendnn::impl::prop_kind;
 using namespace zendnn::impl::alg_kind;
 
 /* add new primitive */
-zendnn_status_t
-zendnn_embedding_bag_desc_init(embedding_bag_desc_t *desc,
-                               prop_kind_t prop_kind,
-                               alg_kind_t alg_kind,
-                               uint32_t num_threads,
-                               const memory_desc_t *input_desc,
-                               const memory_desc_t *indices_desc,
-                               const memory_desc_t *offsets_desc,
-                               const memory_desc_t *weights_desc,
-                               const memory_desc_t *dst_desc,
-                               int32_t padding_idx) {
+namespace {
+status_t
+embedding_bag_desc_init(embedding_bag_desc_t *desc,
+                        prop_kind_t prop_kind,
+                        alg_kind_t alg_kind,
+                        uint32_t num_threads,
+                        const memory_desc_t *input_desc,
+                        const memory_desc_t *indices_desc,
+                        const memory_desc_t *offsets_desc,
+                        const memory_desc_t *weights_desc,
+                        const memory_desc_t *dst_desc,
+                        int32_t padding_idx,
+                        int32_t quant_bits,
+                        data_type_t scale_data_type) {
 
     // run sanity check on parameters
     bool args_ok = !any_null(desc, input_desc, indices_desc,
@@ -53,20 +57,50 @@ zendnn_embedding_bag_desc_init(embedding_bag_desc_t *desc,
         return invalid_arguments;
     }
 
-    // currently accept only s32 type indices and offsets
-    // TODO: add support for 64bit integers if zendnn supports them
-    if (indices_desc->data_type != data_type::s32) {
+    // indices and offsets are s32 or s64(as passed by PyTorch), both of
+    // the same type
+    if (!one_of(indices_desc->data_type, data_type::s32, data_type::s64)) {
         return invalid_arguments;
     }
 
-    if (offsets_desc->data_type != data_type::s32) {
+    if (offsets_desc->data_type != indices_desc->data_type) {
         return invalid_arguments;
     }
 
-    // check the tensor sizes
+    // check the tensor sizes. u8 table is row-wise quantized, bits and
+    // scale data type are given by the caller, its columns are bytes of
+    // dst_desc->dims[1] 8 bit or 4 bit(two per byte) values and row stride
+    // leaves room for scale and bias after them.
     auto bags           = offsets_desc->dims[0];
     auto embedding_dim  = input_desc->dims[1];
-    if ((dst_desc->dims[0] != bags) || (dst_desc->dims[1] != embedding_dim)) {
+    if (dst_desc->dims[0] != bags) {
+        return invalid_arguments;
+    }
+    bool is_quant = input_desc->data_type == data_type::u8;
+    if (is_quant != (quant_bits != 0)) {
+        return invalid_arguments;
+    }
+    if (is_quant) {
+        if (!one_of(quant_bits, 8, 4)
+                || !one_of(scale_data_type, data_type::f32, data_type::f16)) {
+            return invalid_arguments;
+        }
+
+        auto qcols = quant_bits == 8 ? dst_desc->dims[1]
+                                     : (dst_desc->dims[1] + 1)/2;
+        if (embedding_dim != qcols
+                || input_desc->format_kind != format_kind::blocked) {
+            return invalid_arguments;
+        }
+
+        const auto &bd = input_desc->format_desc.blocking;
+        if (bd.inner_nblks != 0 || bd.strides[1] != 1
+                || bd.strides[0] != qcols
+                   + 2*(dim_t)types::data_type_size(scale_data_type)) {
+            return invalid_arguments;
+        }
+    }
+    else if (dst_desc->dims[1] != embedding_dim) {
         return invalid_arguments;
     }
 
@@ -85,6 +119,8 @@ zendnn_embedding_bag_desc_init(embedding_bag_desc_t *desc,
     emd.offsets_desc     = *offsets_desc;
     emd.dst_desc         = *dst_desc;
     emd.padding_idx      = padding_idx;
+    emd.quant_bits       = quant_bits;
+    emd.quant_scale_data_type = scale_data_type;
 
     // weights tensor may or may not be present.
     emd.is_weights = false;
@@ -108,3 +144,40 @@ zendnn_embedding_bag_desc_init(embedding_bag_desc_t *desc,
     *desc = emd;
     return success;
 }
+} // namespace
+
+zendnn_status_t
+zendnn_embedding_bag_desc_init(embedding_bag_desc_t *desc,
+                               prop_kind_t prop_kind,
+                               alg_kind_t alg_kind,
+                               uint32_t num_threads,
+                               const memory_desc_t *input_desc,
+                               const memory_desc_t *indices_desc,
+                               const memory_desc_t *offsets_desc,
+                               const memory_desc_t *weights_desc,
+                               const memory_desc_t *dst_desc,
+                               int32_t padding_idx) {
+    return embedding_bag_desc_init(desc, prop_kind, alg_kind, num_threads,
+                                   input_desc, indices_desc, offsets_desc,
+                                   weights_desc, dst_desc, padding_idx, 0,
+                                   data_type::undef);
+}
+
+zendnn_status_t
+zendnn_embedding_bag_quant_desc_init(embedding_bag_desc_t *desc,
+                                     prop_kind_t prop_kind,
+                                     alg_kind_t alg_kind,
+                                     uint32_t num_threads,
+                                     const memory_desc_t *input_desc,
+                                     const memory_desc_t *indices_desc,
+                                     const memory_desc_t *offsets_desc,
+                                     const memory_desc_t *weights_desc,
+                                     const memory_desc_t *dst_desc,
+                                     int32_t padding_idx,
+                                     int32_t quant_bits,
+                                     data_type_t scale_data_type) {
+    return embedding_bag_desc_init(desc, prop_kind, alg_kind, num_threads,
+                                   input_desc, indices_desc, offsets_desc,
+                                   weights_desc, dst_desc, padding_idx,
+                                   quant_bits, scale_data_type);
+}
@@ -219,6 +219,7 @@ enum {
     key_eltwise_diff_dst,
     key_eltwise_src,
     key_embed_bag_indices,
+    key_embed_bag_partials,
     key_embed_bag_weights,
     key_fusion_forward_scratchpad,
     key_fusion_inout_buffer,
@@ -286,6 +286,7 @@ static status_t zero_pad(const memory_t *memory, const exec_ctx_t &ctx) {
         case s32: return typed_zero_pad<s32>(memory, ctx);
         case s8: return typed_zero_pad<s8>(memory, ctx);
         case u8: return typed_zero_pad<u8>(memory, ctx);
+        case s64: return typed_zero_pad<s64>(memory, ctx);
         default: assert(!"memory is undefined"); return unimplemented;
     }
     return unimplemented;
@@ -744,6 +744,9 @@ size_t get_desc_hash(const embedding_bag_desc_t &desc) {
     seed = hash_combine(seed, get_md_hash(desc.dst_desc));
 
     seed = hash_combine(seed, static_cast<size_t>(desc.padding_idx));
+    seed = hash_combine(seed, static_cast<size_t>(desc.quant_bits));
+    seed = hash_combine(seed,
+                        static_cast<size_t>(desc.quant_scale_data_type));
 
     return seed;
 }
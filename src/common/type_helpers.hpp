@@ -92,6 +92,7 @@ inline size_t data_type_size(data_type_t data_type) {
         case s32: return sizeof(prec_traits<s32>::type);
         case s8: return sizeof(prec_traits<s8>::type);
         case u8: return sizeof(prec_traits<u8>::type);
+        case s64: return sizeof(prec_traits<s64>::type);
         case data_type::undef:
         default: assert(!"unknown data_type");
     }
@@ -752,7 +753,7 @@ inline bool memory_desc_sanity_check(int ndims, const dims_t dims,
     if (ndims == 0) return true;
 
     bool ok = dims != nullptr && 0 < ndims && ndims <= ZENDNN_MAX_NDIMS
-            && utils::one_of(data_type, f16, bf16, f32, s32, s8, u8);
+            && utils::one_of(data_type, f16, bf16, f32, s32, s8, u8, s64);
     if (!ok) return false;
 
     bool has_runtime_dims = false;
@@ -1,14 +1,103 @@
 ﻿/*******************************************************************************
-* Copyright (c) 2019-2021 Advanced Micro Devices, Inc. All rights reserved.
+* Copyright (c) 2019-2022 Advanced Micro Devices, Inc. All rights reserved.
 *******************************************************************************/
 
 #include <zendnn_private.hpp>
+#include <omp.h>
 #include "zendnn_logging.hpp"
+#include "cpu/x64/cpu_isa_traits.hpp"
 
 using namespace zendnn;
-// This version implements the intial version of batch normalization
-// The output from the preceding convolution is normalized , scaled and shifted
 
+#define ALIGNED_OFFSET          64
+//Floats normalized by one OMP work item, 64KB stays in L2
+#define BN_CHUNK_SIZE           (16*1024)
+
+//y = x*a[c] + b[c], with RELU y is set to 0 where it is negative. Values
+//are kept as is otherwise, so NaN and infinities pass through like in
+//zenBatchNormRef.
+//data is rows of len channels(NHWC pixels or blocked channel block).
+template <int VLEN, bool RELU>
+static inline __attribute__((always_inline)) void zenBatchNormRows(
+    float *data, const unsigned long rows, const int len, const float *a,
+    const float *b) {
+    //f32 vector, uvec is for unaligned access
+    typedef float vec __attribute__((vector_size(VLEN*sizeof(float))));
+    typedef vec uvec __attribute__((aligned(sizeof(float))));
+    const vec v_zero = vec{};
+    const int vec_end = len - len%VLEN;
+    for (unsigned long r = 0; r < rows; r++) {
+        float *x = data + r*len;
+        for (int c = 0; c < vec_end; c += VLEN) {
+            vec y = *(uvec *)(x + c) * *(const uvec *)(a + c) + *(const uvec *)(b + c);
+            *(uvec *)(x + c) = RELU ? (y < v_zero ? v_zero : y) : y;
+        }
+        for (int c = vec_end; c < len; c++) {
+            float y = x[c]*a[c] + b[c];
+            x[c] = (RELU && y < 0) ? 0 : y;
+        }
+    }
+}
+
+//Same as zenBatchNormRows for len values of one channel(NCHW plane)
+template <int VLEN, bool RELU>
+static inline __attribute__((always_inline)) void zenBatchNormPlane(
+    float *x, const unsigned long len, const float a, const float b) {
+    typedef float vec __attribute__((vector_size(VLEN*sizeof(float))));
+    typedef vec uvec __attribute__((aligned(sizeof(float))));
+    const vec v_a = vec{} + a;
+    const vec v_b = vec{} + b;
+    const vec v_zero = vec{};
+    unsigned long i = 0;
+    for (; i + VLEN <= len; i += VLEN) {
+        vec y = *(uvec *)(x + i) * v_a + v_b;
+        *(uvec *)(x + i) = RELU ? (y < v_zero ? v_zero : y) : y;
+    }
+    for (; i < len; i++) {
+        float y = x[i]*a + b;
+        x[i] = (RELU && y < 0) ? 0 : y;
+    }
+}
+
+typedef void (*zenBatchNormRowsFn)(float *, const unsigned long, const int,
+                                   const float *, const float *);
+typedef void (*zenBatchNormPlaneFn)(float *, const unsigned long, const float,
+                                    const float);
+
+template <bool RELU>
+static void zenBatchNormRowsAvx2(float *data, const unsigned long rows,
+                                 const int len, const float *a, const float *b) {
+    zenBatchNormRows<8, RELU>(data, rows, len, a, b);
+}
+
+template <bool RELU>
+static void zenBatchNormPlaneAvx2(float *x, const unsigned long len,
+                                  const float a, const float b) {
+    zenBatchNormPlane<8, RELU>(x, len, a, b);
+}
+
+template <bool RELU>
+__attribute__((target("avx512f")))
+static void zenBatchNormRowsAvx512(float *data, const unsigned long rows,
+                                   const int len, const float *a, const float *b) {
+    zenBatchNormRows<16, RELU>(data, rows, len, a, b);
+}
+
+template <bool RELU>
+__attribute__((target("avx512f")))
+static void zenBatchNormPlaneAvx512(float *x, const unsigned long len,
+                                    const float a, const float b) {
+    zenBatchNormPlane<16, RELU>(x, len, a, b);
+}
+
+// This version implements batch normalization for inference
+// The output from the preceding convolution is normalized , scaled and shifted
+// scale*(x - mean) + offset is computed as x*a + b with per channel
+// a = scale and b = offset - scale*mean, computed once.
+// data_format: 0 is NCHW, 1 is NHWC and 2 is BLOCKED(nChw{block}c with
+// block from zenEnvObj.zenBlockSize, padded channels stay zero)
+// Multi thread parallization happen at OMP level over blocks of
+// BN_CHUNK_SIZE floats of (image, channel(block), spatial)
 void zenBatchNorm(
     const int no_of_images,
     const int out_height,
@@ -23,77 +112,77 @@ void zenBatchNorm(
     zendnnEnv zenEnvObj = readEnv();
     zendnnInfo(ZENDNN_ALGOLOG, "zenBatchNorm [zendnn batchnorm]");
     unsigned int thread_qty = zenEnvObj.omp_num_threads;
+
+    bool avx512 = impl::cpu::x64::mayiuse(impl::cpu::x64::avx512_core);
+    zenBatchNormRowsFn bn_rows = avx512 ?
+                                 (relu ? zenBatchNormRowsAvx512<true> : zenBatchNormRowsAvx512<false>) :
+                                 (relu ? zenBatchNormRowsAvx2<true> : zenBatchNormRowsAvx2<false>);
+    zenBatchNormPlaneFn bn_plane = avx512 ?
+                                   (relu ? zenBatchNormPlaneAvx512<true> : zenBatchNormPlaneAvx512<false>) :
+                                   (relu ? zenBatchNormPlaneAvx2<true> : zenBatchNormPlaneAvx2<false>);
+
+    int block = data_format == 2 ? zenEnvObj.zenBlockSize : 1;
+    int channels = ((no_of_filter + block - 1)/block)*block;
+    float *a = (float *)aligned_alloc(ALIGNED_OFFSET,
+                                      sizeof(float)*2*channels);
+    if (a == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenBatchNorm Memory Error while allocating scale and shift");
+        return;
+    }
+    float *b = a + channels;
+    for (int c = 0; c < channels; c++) {
+        bool valid = c < no_of_filter;
+        a[c] = valid ? scale[c] : 0.0f;
+        b[c] = valid ? offset[c] - scale[c]*mean[c] : 0.0f;
+    }
+    const unsigned long spatial = (unsigned long)out_height*out_width;
+
+    omp_set_max_active_levels(1);
     if (data_format == 0) {       // NCHW Format
         zendnnInfo(ZENDNN_ALGOLOG, "zenBatchNorm data_format: NCHW [zendnn batchnorm]");
-        if (no_of_images > 1) {
-            #pragma omp parallel for num_threads(thread_qty)
-            for (int i=0; i<no_of_images; i++) {
-                for (int r=0; r< no_of_filter; r++) {
-                    for (int m=0; m<out_height*out_width; m++) {
-                        int index = i*no_of_filter*out_height*out_width + r*out_height*out_width + m;
-                        float val = scale[r]*(out_layer[index] - mean[r]) + offset[r];
-                        if (relu && val < 0) {
-                            out_layer[index] = 0;
-                        }
-                        else {
-                            out_layer[index] = val;
-                        }
-                    }
-                }
-            }
+        unsigned long planes = (unsigned long)no_of_images*no_of_filter;
+        unsigned long chunks = (spatial + BN_CHUNK_SIZE - 1)/BN_CHUNK_SIZE;
+        #pragma omp parallel for num_threads(thread_qty)
+        for (unsigned long item = 0; item < planes*chunks; item++) {
+            unsigned long plane = item/chunks;
+            unsigned long start = (item%chunks)*BN_CHUNK_SIZE;
+            unsigned long len = spatial - start < BN_CHUNK_SIZE ? spatial - start :
+                                BN_CHUNK_SIZE;
+            int c = plane%no_of_filter;
+            bn_plane(out_layer + plane*spatial + start, len, a[c], b[c]);
         }
-        else {
-            #pragma omp parallel for num_threads(thread_qty)
-            for (int r=0; r< no_of_filter; r++) {
-                for (int m=0; m<out_height*out_width; m++) {
-                    int index = r*out_height*out_width + m;
-                    float val = scale[r]*(out_layer[index] - mean[r]) + offset[r];
-                    if (relu && val < 0) {
-                        out_layer[index] = 0;
-                    }
-                    else {
-                        out_layer[index] = val;
-                    }
-                }
-            }
-
+    }
+    else if (data_format == 2) {  // BLOCKED Format
+        zendnnInfo(ZENDNN_ALGOLOG, "zenBatchNorm data_format: BLOCKED block=",
+                   block, " [zendnn batchnorm]");
+        unsigned long planes = (unsigned long)no_of_images*(channels/block);
+        unsigned long chunk_rows = BN_CHUNK_SIZE/block;
+        unsigned long chunks = (spatial + chunk_rows - 1)/chunk_rows;
+        #pragma omp parallel for num_threads(thread_qty)
+        for (unsigned long item = 0; item < planes*chunks; item++) {
+            unsigned long plane = item/chunks;
+            unsigned long start = (item%chunks)*chunk_rows;
+            unsigned long rows = spatial - start < chunk_rows ? spatial - start :
+                                 chunk_rows;
+            int cb = plane%(channels/block);
+            bn_rows(out_layer + (plane*spatial + start)*block, rows, block,
+                    a + cb*block, b + cb*block);
         }
     }
     else  {                      // NHWC Format
         zendnnInfo(ZENDNN_ALGOLOG, "zenBatchNorm data_format: NHWC [zendnn batchnorm]");
-        if (no_of_images > 1) {
-            #pragma omp parallel for num_threads(thread_qty)
-            for (int i=0; i<no_of_images; i++) {
-                for (int m=0; m<out_height*out_width; m++) {
-                    for (int r=0; r< no_of_filter; r++) {
-                        int index = i*no_of_filter*out_height*out_width + m*no_of_filter + r;
-                        float val = scale[r]*(out_layer[index] - mean[r]) + offset[r];
-                        if (relu && val < 0) {
-                            out_layer[index] = 0;
-                        }
-                        else {
-                            out_layer[index] = val;
-                        }
-                    }
-                }
-            }
+        unsigned long total_rows = (unsigned long)no_of_images*spatial;
+        unsigned long chunk_rows = BN_CHUNK_SIZE/no_of_filter;
+        chunk_rows = chunk_rows < 1 ? 1 : chunk_rows;
+        unsigned long chunks = (total_rows + chunk_rows - 1)/chunk_rows;
+        #pragma omp parallel for num_threads(thread_qty)
+        for (unsigned long item = 0; item < chunks; item++) {
+            unsigned long start = item*chunk_rows;
+            unsigned long rows = total_rows - start < chunk_rows ? total_rows - start :
+                                 chunk_rows;
+            bn_rows(out_layer + start*no_of_filter, rows, no_of_filter, a, b);
         }
-        else {
-            #pragma omp parallel for num_threads(thread_qty)
-            for (int m=0; m<out_height*out_width; m++) {
-                for (int r=0; r< no_of_filter; r++) {
-                    int index = m*no_of_filter  + r;
-                    float val = scale[r]*(out_layer[index] - mean[r]) + offset[r];
-                    if (relu && val < 0) {
-                        out_layer[index] = 0;
-                    }
-                    else {
-                        out_layer[index] = val;
-                    }
-                }
-            }
-
-        }
-
     }
+    free(a);
 }
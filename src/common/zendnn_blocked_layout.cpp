@@ -1,5 +1,5 @@
 ﻿/*******************************************************************************
-* Copyright (c) 2019-2021 Advanced Micro Devices, Inc. All rights reserved.
+* Copyright (c) 2019-2022 Advanced Micro Devices, Inc. All rights reserved.
 *******************************************************************************/
 
 #include <zendnn_private.hpp>
@@ -8,14 +8,19 @@
 #include <cblas.h>
 #include <time.h>
 #include <sys/time.h>
+#include <float.h>
 #include "zendnn_logging.hpp"
+#include "cpu/x64/cpu_isa_traits.hpp"
 
 using namespace zendnn;
 
 #define ALIGNED_OFFSET          64
+//No. of input channel groups(sgemm calls) zenConvolution2D_Latency_blocked_layout
+//splits the reduction into, unrelated to block size of the layout
+#define LATENCY_CHANNEL_GROUPS  8
 
 
-// This implementation uses NCHW (C/8) and parallelizes convolution by accumulation at sub channel level
+// This implementation uses NCHW (C/block) and parallelizes convolution by accumulation at sub channel level
 void zenConvolution2D_Latency_blocked_layout(
     //const unsigned char* in_layer,
     zendnnEnv zenEnvObj,
@@ -46,24 +51,14 @@ void zenConvolution2D_Latency_blocked_layout(
     struct timeval start, end;
     gettimeofday(&start, 0);
 
-    int channel_group =  8;    // Modified hardcoding of 8 based on thread quantity in future
+    int channel_group = LATENCY_CHANNEL_GROUPS;
     int remainder = channels % channel_group;
     int out_ch_per_group = (channels-remainder)/(channel_group);
-    int w_offset = kernel_h * kernel_w * no_of_filter;
     int o_h_w    = out_height*out_width;
 
     unsigned long data_col_size = ((kernel_h*kernel_w*channels)*(out_height*out_width)*sizeof(float)*no_of_images);
     data_col_size = (data_col_size%ALIGNED_OFFSET == 0) ?  data_col_size : (data_col_size/ALIGNED_OFFSET)*ALIGNED_OFFSET + (ALIGNED_OFFSET);
     float *data_col = (float *)aligned_alloc(ALIGNED_OFFSET, data_col_size);
-
-    float *out_col;
-    // out_col is an intermedidate output
-    // out_col requires excess memory allocation depending on channel groups
-    // The outputs of N channel groups are accumulated after sgemm calls
-    out_col = (float *) malloc(o_h_w * no_of_filter * sizeof(float)*(channel_group+1));
-    for (int i =0 ; i < o_h_w * no_of_filter *(channel_group+1); i++) {
-        out_col[i] = 0.0;
-    }
     if (data_col == NULL) {
         zendnnError(ZENDNN_ALGOLOG, "zenConvolution2D_Latency_blocked_layout Memory Error while allocating patch matrix");
         return;
@@ -71,44 +66,22 @@ void zenConvolution2D_Latency_blocked_layout(
 
     im2col_parNCHW(in_layer, channels, height, width, kernel_h, kernel_w, pad_h, pad_w, stride_h, stride_w, data_col);
 
+    // Outputs of channel groups are accumulated in out_layer by sgemm(beta = 1)
+    // after the first group, remainder channels form the last group
+    float beta = 0.0F;
     for (int itr=0; itr <= channel_group; itr++) {
-        if (itr < channel_group) {
-            int weight_offset = itr * out_ch_per_group *  kernel_h * kernel_w * no_of_filter;
-            int data_offset = itr * out_ch_per_group *  out_height*out_width * kernel_h*kernel_w;
-            if (out_ch_per_group)
-                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
-                            no_of_filter,  o_h_w,kernel_h*kernel_w*out_ch_per_group,  1.0F, filter + weight_offset,
-                            kernel_h*kernel_w*out_ch_per_group, data_col + data_offset,o_h_w, 0.0F, out_col + itr*o_h_w* no_of_filter, o_h_w);
-
-        }
-
-        else {
-            int weight_offset = channel_group * out_ch_per_group *  w_offset;
-            int data_offset = channel_group * out_ch_per_group *  o_h_w * kernel_h*kernel_w;
-            if (remainder)
-                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
-                            no_of_filter,  o_h_w,kernel_h*kernel_w*remainder,  1.0F, filter + weight_offset,
-                            kernel_h*kernel_w*remainder, data_col + data_offset,o_h_w, 0.0F, out_col+channel_group*o_h_w* no_of_filter, o_h_w);
+        int group_channels = (itr < channel_group) ? out_ch_per_group : remainder;
+        if (group_channels == 0) {
+            continue;
         }
+        int weight_offset = itr * out_ch_per_group *  kernel_h * kernel_w * no_of_filter;
+        int data_offset = itr * out_ch_per_group *  out_height*out_width * kernel_h*kernel_w;
+        cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                    no_of_filter,  o_h_w,kernel_h*kernel_w*group_channels,  1.0F, filter + weight_offset,
+                    kernel_h*kernel_w*group_channels, data_col + data_offset,o_h_w, beta, out_layer, o_h_w);
+        beta = 1.0F;
     }
-
-// initialize output array to zero
-    #pragma omp parallel for
-    for (int j = 0 ; j < o_h_w * no_of_filter ; j++) {
-        out_layer[j] = 0.0;
-    }
-// Accumulates the output of channels to generate out_layer
-    #pragma omp parallel for
-    for (int j = 0 ; j < o_h_w * no_of_filter ; j++) {
-        for (int ch = 0; ch <= channel_group; ch++) {
-            out_layer[j]+= out_col[j+ (ch *o_h_w * no_of_filter)];
-        }
-    }
-    // free the intermediate result
-    free(out_col);
-    out_col =NULL;
-
-
+    free(data_col);
 
 #if BIAS_ENABLED
     for (int r=0; r<no_of_filter; r++) {
@@ -150,18 +123,10 @@ void zenConvolution2D_Filterwise_Latency(
 
     unsigned int thread_qty = zenEnvObj.omp_num_threads;
     unsigned long data_col_size = ((kernel_h*kernel_w*channels)*(out_height*out_width)*sizeof(float)*no_of_images);
-    unsigned long filter_col_size = ((kernel_h*kernel_w*channels*no_of_filter)*sizeof(float));
-    unsigned long o_layer_size = ((no_of_filter)*(out_height*out_width)*sizeof(float)*no_of_images);
 
     data_col_size = (data_col_size%ALIGNED_OFFSET == 0) ?  data_col_size : (data_col_size/ALIGNED_OFFSET)*ALIGNED_OFFSET + (ALIGNED_OFFSET);
-    o_layer_size = (o_layer_size%ALIGNED_OFFSET == 0) ?  o_layer_size : (o_layer_size/ALIGNED_OFFSET)*ALIGNED_OFFSET + (ALIGNED_OFFSET);
-    filter_col_size = (filter_col_size%ALIGNED_OFFSET == 0) ?  filter_col_size : (filter_col_size/ALIGNED_OFFSET)*ALIGNED_OFFSET + (ALIGNED_OFFSET);
-
-    // Allocate memory for reordering input , output and filters
 
     float *data_col = (float *)aligned_alloc(ALIGNED_OFFSET, data_col_size);
-    float *out_col = (float *)aligned_alloc(ALIGNED_OFFSET, o_layer_size);
-    float *filter_col = (float *)aligned_alloc(ALIGNED_OFFSET, filter_col_size);
 
     if (data_col == NULL) {
         zendnnError(ZENDNN_ALGOLOG, "zenConvolution2D_Filterwise_Latency Memory Error while allocating patch matrix");
@@ -177,80 +142,31 @@ void zenConvolution2D_Filterwise_Latency(
     }
     int remainder = no_of_filter % (channel_group);
     int out_ch_per_group = (no_of_filter-remainder)/(channel_group);
-    int split_index,split_offset,index;
-
-
-    // Reorder Filters to HWCN ( N/Split )
-    // This routine should be implemented outside ZenDNN Library
-    #pragma omp parallel for
-    for (int j=0; j<kernel_h*kernel_w*channels; j++) {
-        for (int i=0; i<no_of_filter; i++) {
-            if (i < out_ch_per_group*channel_group) {
-                int block_index = ((int)floor(i/out_ch_per_group));
-                int sub_block_index =  j*out_ch_per_group;
-                int filter_index =   i%out_ch_per_group;
-                int index = kernel_h*kernel_w*channels*out_ch_per_group*block_index + sub_block_index + filter_index;
-                filter_col[index]=filter[j*no_of_filter+i];
-            }
-            else {
-                int index = kernel_h*kernel_w*channels*out_ch_per_group*channel_group + j*remainder + (i%no_of_filter)%remainder ;
-                filter_col[index]=filter[j*no_of_filter+i];
-
-            }
-        }
-    }
 
     // GEMM calls to implement parallel filter convolution
+    // Each group reads its columns of HWCN filter in place(ldb = no_of_filter)
+    // and writes its columns of NHWC output(ldc = no_of_filter), so neither
+    // filter nor output is reordered
     for (int i=0; i<no_of_images; i++) {
         unsigned long bufferOffset = ((kernel_h*kernel_w*channels)*(out_height*out_width) * i);
         unsigned long inputOffset = channels*height*width*i;
         im2rowNHWC_par(in_layer + inputOffset, channels, height, width, kernel_h, kernel_w, pad_t, pad_l, pad_b, pad_r, stride_h, stride_w, data_col + bufferOffset);
         int w_offset = kernel_h * kernel_w * channels;
         int o_h_w    = out_height*out_width;
-        int weight_offset = 0,out_offset=0;
-        int offset = i*no_of_filter*o_h_w;
-        #pragma omp parallel for
+        unsigned long offset = (unsigned long)i*no_of_filter*o_h_w;
+        #pragma omp parallel for num_threads(thread_qty)
         for (int itr=0; itr <= channel_group; itr++) {
-            if (itr < channel_group) {
-                weight_offset = ((itr * out_ch_per_group)) *  w_offset;
-                out_offset = (itr*out_ch_per_group)* o_h_w + offset;
-                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
-                            o_h_w, out_ch_per_group, w_offset, 1.0F,
-                            data_col + bufferOffset, w_offset, filter_col + weight_offset, out_ch_per_group,
-                            0.0F, out_col+ out_offset, out_ch_per_group);
-            }
-            else {
-                if (remainder) {
-                    int weight_offset = out_ch_per_group * (channel_group) *  w_offset;
-                    int out_offset = (itr * out_ch_per_group)* o_h_w + offset;
-                    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
-                                o_h_w, remainder, w_offset, 1.0F,
-                                data_col + bufferOffset, w_offset, filter_col + weight_offset, remainder,
-                                0.0F, out_col+out_offset, remainder);
-                }
-            }
-        }
-
-        // Reorder Output to NHWC from ( N/Split ) HWC
-        #pragma omp parallel for
-        for (int j=0; j<o_h_w; j++) {
-            for (int l=0; l<no_of_filter; l++) {
-                if (l < out_ch_per_group*channel_group) {
-                    int block_index = ((int)floor(l/out_ch_per_group));
-                    int sub_block_index =  j*out_ch_per_group;
-                    int filter_index =   l%out_ch_per_group;
-                    int index = o_h_w*out_ch_per_group*block_index + sub_block_index + filter_index;
-                    out_layer[offset + j*no_of_filter + l]=out_col[offset + index];
-                }
-                else {
-                    int index = o_h_w*out_ch_per_group*channel_group + j*remainder + (l%no_of_filter)%remainder ;
-                    out_layer[offset + j*no_of_filter + l]=out_col[offset + index];
-
-                }
+            int group_filters = (itr < channel_group) ? out_ch_per_group : remainder;
+            if (group_filters == 0) {
+                continue;
             }
+            int filter_col = itr * out_ch_per_group;
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                        o_h_w, group_filters, w_offset, 1.0F,
+                        data_col + bufferOffset, w_offset, filter + filter_col, no_of_filter,
+                        0.0F, out_layer + offset + filter_col, no_of_filter);
         }
 
-
         if (bias && !relu) {
             #pragma omp parallel for num_threads(thread_qty)
             for (int m=0; m<out_height*out_width; m++)
@@ -272,8 +188,340 @@ void zenConvolution2D_Filterwise_Latency(
 
     }
     free(data_col);
-    free(filter_col);
-    free(out_col);
 
 }
 
+//Computes one output row(oh) of one filter block(ocb) of blocked direct
+//convolution, OWT output pixels are kept in registers, for every input
+//channel one filter vector is loaded and broadcast input is accumulated on
+//all OWT pixels. Padding pixels read zero block.
+template <int BLK, int OWT>
+static inline __attribute__((always_inline)) void zenConvBlockedRow(
+    const float *in_image, const int icb_count, const int height,
+    const int width, const float *filter, const int ocb, const int kernel_h,
+    const int kernel_w, const int pad_t, const int pad_l, const int stride_h,
+    const int stride_w, const int oh, const int out_width, const float *mul,
+    const float *add, const bool relu, const bool sum_fused, float *out_row) {
+    //f32 vector of one channel block, uvec is for unaligned access
+    typedef float vec __attribute__((vector_size(BLK*sizeof(float))));
+    typedef vec uvec __attribute__((aligned(sizeof(float))));
+    static const float zero_block[BLK] = {0};
+    const vec v_mul = *(const uvec *)mul;
+    const vec v_add = *(const uvec *)add;
+    const vec v_zero = {0};
+    const unsigned long filter_block = (unsigned long)BLK*BLK;
+
+    for (int ow0 = 0; ow0 < out_width; ow0 += OWT) {
+        int nt = out_width - ow0 < OWT ? out_width - ow0 : OWT;
+        vec acc[OWT];
+        #pragma GCC unroll 16
+        for (int t = 0; t < OWT; ++t) {
+            acc[t] = v_zero;
+        }
+        for (int icb = 0; icb < icb_count; ++icb) {
+            for (int i = 0; i < kernel_h; ++i) {
+                int ih = oh*stride_h - pad_t + i;
+                if (ih < 0 || ih >= height) {
+                    continue;
+                }
+                const float *in_row = in_image + ((unsigned long)icb*height + ih)*width*BLK;
+                for (int j = 0; j < kernel_w; ++j) {
+                    const float *ip[OWT];
+                    #pragma GCC unroll 16
+                    for (int t = 0; t < OWT; ++t) {
+                        int iw = (ow0 + t)*stride_w - pad_l + j;
+                        ip[t] = (t < nt && iw >= 0 && iw < width) ?
+                                in_row + (unsigned long)iw*BLK : zero_block;
+                    }
+                    const float *wp = filter + (((unsigned long)ocb*icb_count + icb)*kernel_h*
+                                                kernel_w + i*kernel_w + j)*filter_block;
+                    for (int ic = 0; ic < BLK; ++ic) {
+                        const vec w = *(const uvec *)(wp + ic*BLK);
+                        #pragma GCC unroll 16
+                        for (int t = 0; t < OWT; ++t) {
+                            acc[t] += ip[t][ic]*w;
+                        }
+                    }
+                }
+            }
+        }
+        for (int t = 0; t < nt; ++t) {
+            uvec *out = (uvec *)(out_row + (unsigned long)(ow0 + t)*BLK);
+            vec y = acc[t]*v_mul + v_add;
+            if (sum_fused) {
+                y += *out;
+            }
+            if (relu) {
+                y = y > v_zero ? y : v_zero;
+            }
+            *out = y;
+        }
+    }
+}
+
+typedef void (*zenConvBlockedRowFn)(const float *, const int, const int,
+                                    const int, const float *, const int, const int, const int, const int,
+                                    const int, const int, const int, const int, const int, const float *,
+                                    const float *, const bool, const bool, float *);
+
+#define ZEN_CONV_BLOCKED_ROW_ARGS const float *in_image, const int icb_count, \
+    const int height, const int width, const float *filter, const int ocb, \
+    const int kernel_h, const int kernel_w, const int pad_t, const int pad_l, \
+    const int stride_h, const int stride_w, const int oh, const int out_width, \
+    const float *mul, const float *add, const bool relu, const bool sum_fused, \
+    float *out_row
+#define ZEN_CONV_BLOCKED_ROW_PARAMS in_image, icb_count, height, width, filter, \
+    ocb, kernel_h, kernel_w, pad_t, pad_l, stride_h, stride_w, oh, out_width, \
+    mul, add, relu, sum_fused, out_row
+
+static void zenConvBlockedRow8(ZEN_CONV_BLOCKED_ROW_ARGS) {
+    zenConvBlockedRow<8, 6>(ZEN_CONV_BLOCKED_ROW_PARAMS);
+}
+
+static void zenConvBlockedRow16(ZEN_CONV_BLOCKED_ROW_ARGS) {
+    zenConvBlockedRow<16, 6>(ZEN_CONV_BLOCKED_ROW_PARAMS);
+}
+
+//16 channel blocks with zmm registers, 12 output pixels per filter load
+__attribute__((target("avx512f")))
+static void zenConvBlockedRow16Avx512(ZEN_CONV_BLOCKED_ROW_ARGS) {
+    zenConvBlockedRow<16, 12>(ZEN_CONV_BLOCKED_ROW_PARAMS);
+}
+
+//This implementation is direct convolution on BLOCKED Format, input and
+//output stay in nChw{block}c so that chained conv, pool, BatchNorm and add
+//work without reorders. Filter is OIhw{block}i{block}o.
+//bias and BatchNorm are folded to per channel multiplier and addend and
+//applied with sum and relu while output pixels are still in registers.
+//Multi thread parallization happen at OMP level over (image, filter block,
+//output row)
+void zenConvolution2DBlocked(
+    zendnnEnv zenEnvObj,
+    const float *in_layer,
+    const int no_of_images,
+    const int channels,
+    const int height,
+    const int width,
+    const float *filter,
+    const int no_of_filter,
+    const int valid_filters,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    const float *scale,
+    const float *mean,
+    const float *offset,
+    const bool relu,
+    const bool sum_fused,
+    float *out_layer,
+    const int out_height,
+    const int out_width,
+    const int block
+) {
+    if ((in_layer == NULL)|| (filter == NULL) || (out_layer == NULL)) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DBlocked Memory is not defined for in_layer or filter or out_layer");
+        return;
+    }
+    if ((block != 8 && block != 16) || channels%block || no_of_filter%block) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DBlocked channels and filters should be padded to block 8 or 16");
+        return;
+    }
+
+    struct timeval start, end;
+    gettimeofday(&start, 0);
+
+    //y = conv*mul + add, padded filters stay zero
+    float *mul = (float *)aligned_alloc(ALIGNED_OFFSET,
+                                        sizeof(float)*no_of_filter*2);
+    if (mul == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DBlocked Memory Error while allocating post-op buffer");
+        return;
+    }
+    float *add = mul + no_of_filter;
+    for (int r = 0; r < no_of_filter; r++) {
+        float b = (bias && r < valid_filters) ? bias[r] : 0.0f;
+        if (scale && r < valid_filters) {
+            mul[r] = scale[r];
+            add[r] = scale[r]*(b - mean[r]) + offset[r];
+        }
+        else {
+            mul[r] = r < valid_filters ? 1.0f : 0.0f;
+            add[r] = b;
+        }
+    }
+
+    zenConvBlockedRowFn conv_row = zenConvBlockedRow8;
+    if (block == 16) {
+        conv_row = impl::cpu::x64::mayiuse(impl::cpu::x64::avx512_core) ?
+                   zenConvBlockedRow16Avx512 : zenConvBlockedRow16;
+    }
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    int icb_count = channels/block;
+    int ocb_count = no_of_filter/block;
+    unsigned long in_image = (unsigned long)channels*height*width;
+    unsigned long out_plane = (unsigned long)out_height*out_width*block;
+
+    omp_set_max_active_levels(1);
+    #pragma omp parallel for num_threads(thread_qty) collapse(3)
+    for (int n = 0; n < no_of_images; ++n) {
+        for (int ocb = 0; ocb < ocb_count; ++ocb) {
+            for (int oh = 0; oh < out_height; ++oh) {
+                float *out_row = out_layer + ((unsigned long)n*ocb_count + ocb)*out_plane +
+                                 (unsigned long)oh*out_width*block;
+                conv_row(in_layer + n*in_image, icb_count, height, width, filter, ocb,
+                         kernel_h, kernel_w, pad_t, pad_l, stride_h, stride_w, oh, out_width,
+                         mul + ocb*block, add + ocb*block, relu, sum_fused, out_row);
+            }
+        }
+    }
+    free(mul);
+
+    gettimeofday(&end, 0);
+    float elapsed;
+    elapsed = timedifference_msec(start, end);
+    zendnnInfo(ZENDNN_PROFLOG, "zenConvolution2DBlocked, no_of_images=",
+               no_of_images, " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " pad_t=", pad_t, " pad_l=", pad_l, " stride_h=", stride_h,
+               " stride_w=", stride_w, " block=", block, " relu=", relu,
+               " batchNorm=", scale != NULL, " sum=", sum_fused,
+               " Time=", elapsed, "ms");
+}
+
+template <int BLK>
+static void zenPoolingBlockedImpl(unsigned int thread_qty,
+                                  const float *input, const int number_of_images,
+                                  const int number_of_channel, const int height, const int width,
+                                  const int kernel_height, const int kernel_width,
+                                  const int stride_height, const int stride_width,
+                                  const int padding_height_top, const int padding_width_left,
+                                  float *output, const int out_height, const int out_width,
+                                  const bool is_max, const bool include_padding) {
+    int cb_count = number_of_channel/BLK;
+    unsigned long in_plane = (unsigned long)height*width*BLK;
+    unsigned long out_plane = (unsigned long)out_height*out_width*BLK;
+
+    #pragma omp parallel for num_threads(thread_qty) collapse(3)
+    for (int n = 0; n < number_of_images; ++n) {
+        for (int cb = 0; cb < cb_count; ++cb) {
+            for (int oh = 0; oh < out_height; ++oh) {
+                const float *in_plane_ptr = input + ((unsigned long)n*cb_count + cb)*in_plane;
+                float *out_ptr = output + ((unsigned long)n*cb_count + cb)*out_plane +
+                                 (unsigned long)oh*out_width*BLK;
+                int h_start = oh*stride_height - padding_height_top;
+                for (int ow = 0; ow < out_width; ++ow) {
+                    int w_start = ow*stride_width - padding_width_left;
+                    float acc[BLK];
+                    #pragma omp simd
+                    for (int l = 0; l < BLK; ++l) {
+                        acc[l] = is_max ? -FLT_MAX : 0.0f;
+                    }
+                    int count = 0;
+                    for (int ih = h_start; ih < h_start + kernel_height; ++ih) {
+                        if (ih < 0 || ih >= height) {
+                            continue;
+                        }
+                        for (int iw = w_start; iw < w_start + kernel_width; ++iw) {
+                            if (iw < 0 || iw >= width) {
+                                continue;
+                            }
+                            const float *ip = in_plane_ptr + ((unsigned long)ih*width + iw)*BLK;
+                            if (is_max) {
+                                #pragma omp simd
+                                for (int l = 0; l < BLK; ++l) {
+                                    acc[l] = acc[l] > ip[l] ? acc[l] : ip[l];
+                                }
+                            }
+                            else {
+                                #pragma omp simd
+                                for (int l = 0; l < BLK; ++l) {
+                                    acc[l] += ip[l];
+                                }
+                            }
+                            count++;
+                        }
+                    }
+                    if (!is_max) {
+                        float div = include_padding ? kernel_height*kernel_width : count;
+                        float inv = div > 0 ? 1.0f/div : 0.0f;
+                        #pragma omp simd
+                        for (int l = 0; l < BLK; ++l) {
+                            acc[l] *= inv;
+                        }
+                    }
+                    #pragma omp simd
+                    for (int l = 0; l < BLK; ++l) {
+                        out_ptr[(unsigned long)ow*BLK + l] = acc[l];
+                    }
+                }
+            }
+        }
+    }
+}
+
+//Max/Avg pooling on BLOCKED Format(nChw8c/nChw16c), each output pixel is
+//reduced over its window one channel block(vector) at a time.
+//Multi thread parallization happen at OMP level over (image, channel block,
+//output row)
+void zenPoolingBlocked(
+    zendnnEnv zenEnvObj,
+    const float *input,
+    const int number_of_images,
+    const int number_of_channel,
+    const int height,
+    const int width,
+    const int kernel_height,
+    const int kernel_width,
+    const int stride_height,
+    const int stride_width,
+    const int padding_height_top,
+    const int padding_width_left,
+    float *output,
+    const int out_height,
+    const int out_width,
+    const bool is_max,
+    const bool include_padding,
+    const int block
+) {
+    if ((block != 8 && block != 16) || number_of_channel%block) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenPoolingBlocked channels should be padded to block 8 or 16");
+        return;
+    }
+
+    struct timeval start, end;
+    gettimeofday(&start, 0);
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    omp_set_max_active_levels(1);
+    if (block == 16) {
+        zenPoolingBlockedImpl<16>(thread_qty, input, number_of_images,
+                                  number_of_channel, height, width, kernel_height, kernel_width,
+                                  stride_height, stride_width, padding_height_top, padding_width_left,
+                                  output, out_height, out_width, is_max, include_padding);
+    }
+    else {
+        zenPoolingBlockedImpl<8>(thread_qty, input, number_of_images,
+                                 number_of_channel, height, width, kernel_height, kernel_width,
+                                 stride_height, stride_width, padding_height_top, padding_width_left,
+                                 output, out_height, out_width, is_max, include_padding);
+    }
+
+    gettimeofday(&end, 0);
+    float elapsed;
+    elapsed = timedifference_msec(start, end);
+    zendnnInfo(ZENDNN_PROFLOG, "zenPoolingBlocked, no_of_images=",
+               number_of_images, " channels=", number_of_channel, " height=", height,
+               " width=", width, " kernel_h=", kernel_height, " kernel_w=", kernel_width,
+               " stride_h=", stride_height, " stride_w=", stride_width,
+               " pad_h_t=", padding_height_top, " pad_w_l=", padding_width_left,
+               " block=", block, " max=", is_max, " Time=", elapsed, "ms");
+}
@@ -0,0 +1,232 @@
+﻿/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <omp.h>
+#include <string.h>
+#include <sys/sysinfo.h>
+#include <time.h>
+#include <sys/time.h>
+#include "zendnn_private.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+#include "cpu/gemm/gemm.hpp"
+
+using namespace zendnn;
+using zendnn::impl::bfloat16_t;
+using zendnn::impl::dim_t;
+
+//bf16 patch tile and its f32 output tile per thread are sized to stay in L2
+//TODO: Read cache info from underlying platform and decide this value.
+#define BF16_CONV_L2_SIZE       (512*1024)
+
+//This implementation is based on im2row and bf16 gemm(gemm_bf16bf16f32).
+//Output pixels of whole batch are divided into tiles, for each tile the bf16
+//patch matrix is built in a per thread buffer and multiplied with the bf16
+//filter with f32 accumulation. Bias and ReLU are applied on f32 tile and it
+//is either written as f32 or converted to bf16 before it leaves the cache.
+//1x1 convolution with unit stride and no padding uses input as patch matrix.
+//I/p and o/p format will be NHWC and filter format is HWCN
+//Multi thread parallization happen at OMP level over output pixel tiles
+void zenConvolution2DBF16Ver1(
+    zendnnEnv zenEnvObj,
+    const bfloat16_t *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const bfloat16_t *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    const bool relu,
+    void *out_layer,
+    const bool out_bf16,
+    const int out_height,
+    const int out_width,
+    const int filter_offset,
+    const int total_filters
+) {
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    bool patch_required = !(kernel_h == 1 && kernel_w == 1 &&
+                            stride_h == 1 && stride_w == 1 &&
+                            out_height == height && out_width == width);
+    int K = kernel_h*kernel_w*channels;
+
+    //Tile size in output pixels, such that patch and f32 output tile fits L2
+    unsigned long total_rows = (unsigned long)images*out_height*out_width;
+    unsigned long row_size = (patch_required ? K*sizeof(bfloat16_t) : 0) +
+                             (out_bf16 ? no_of_filter*sizeof(float) : 0);
+    unsigned long tile_rows = row_size ? BF16_CONV_L2_SIZE/row_size : total_rows;
+    tile_rows = tile_rows < 1 ? 1 : tile_rows;
+    //Keep all threads busy for smaller problem size
+    if (total_rows < tile_rows*thread_qty) {
+        tile_rows = (total_rows + thread_qty - 1)/thread_qty;
+    }
+    unsigned long tile_count = (total_rows + tile_rows - 1)/tile_rows;
+    if (thread_qty > tile_count) {
+        thread_qty = tile_count;
+    }
+
+    unsigned long patch_size = patch_required ? tile_rows*K : 0;
+    unsigned long out_tile_size = out_bf16 ? tile_rows*no_of_filter : 0;
+    //Keep per thread buffer aligned
+    unsigned long thread_buf_size = patch_size*sizeof(bfloat16_t) +
+                                    out_tile_size*sizeof(float);
+    thread_buf_size = ((thread_buf_size + ALIGNED_OFFSET - 1)/ALIGNED_OFFSET)*
+                      ALIGNED_OFFSET;
+    char *data_buf = NULL;
+    if (thread_buf_size) {
+        data_buf = (char *)aligned_alloc(ALIGNED_OFFSET,
+                                         thread_buf_size*thread_qty);
+        if (data_buf == NULL) {
+            zendnnError(ZENDNN_ALGOLOG,
+                        "zenConvolution2DBF16Ver1 Memory Error while allocating patch matrix");
+            return;
+        }
+    }
+
+    zendnnInfo(ZENDNN_ALGOLOG, "zenConvolution2DBF16Ver1, patch_required=",
+               patch_required, " tile_rows=", tile_rows, " tile_count=", tile_count,
+               " thread_qty=", thread_qty);
+
+    unsigned long out_pixels = (unsigned long)out_height*out_width;
+    omp_set_max_active_levels(1);
+    #pragma omp parallel num_threads(thread_qty)
+    {
+        char *thread_buf = data_buf + thread_buf_size*omp_get_thread_num();
+        float *out_tile = (float *)thread_buf;
+        bfloat16_t *patch = (bfloat16_t *)(thread_buf + out_tile_size*sizeof(float));
+
+        #pragma omp for
+        for (unsigned long tile = 0; tile < tile_count; tile++) {
+            unsigned long row_start = tile*tile_rows;
+            unsigned long row_end = row_start + tile_rows;
+            row_end = row_end > total_rows ? total_rows : row_end;
+            int rows = row_end - row_start;
+
+            const bfloat16_t *data_col = in_layer + row_start*channels;
+            if (patch_required) {
+                //bf16 im2row, padding is zero
+                for (int m = 0; m < rows; m++) {
+                    unsigned long pixel = row_start + m;
+                    int image = pixel/out_pixels;
+                    int oh = (pixel%out_pixels)/out_width;
+                    int ow = (pixel%out_pixels)%out_width;
+                    bfloat16_t *patch_row = patch + (unsigned long)m*K;
+                    for (int i = 0; i < kernel_h; i++) {
+                        int ih = oh*stride_h - pad_t + i;
+                        for (int j = 0; j < kernel_w; j++) {
+                            int iw = ow*stride_w - pad_l + j;
+                            bfloat16_t *dst = patch_row + (i*kernel_w + j)*channels;
+                            if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
+                                memcpy(dst, in_layer + (((unsigned long)image*height + ih)*width + iw)*
+                                       channels, sizeof(bfloat16_t)*channels);
+                            }
+                            else {
+                                memset(dst, 0, sizeof(bfloat16_t)*channels);
+                            }
+                        }
+                    }
+                }
+                data_col = patch;
+            }
+
+            //gemm_bf16bf16f32 is column major, filter and patch are swapped
+            const char trans = 'N';
+            const float alpha = 1.0f, beta = 0.0f;
+            const dim_t M = no_of_filter, N = rows, Kdim = K;
+            const dim_t lda = no_of_filter, ldb = K;
+            if (out_bf16) {
+                const dim_t ldc = no_of_filter;
+                impl::cpu::gemm_bf16bf16f32(&trans, &trans, &M, &N, &Kdim, &alpha, filter, &lda,
+                                            data_col, &ldb, &beta, out_tile, &ldc);
+                if (bias || relu) {
+                    zenPostOps(zenEnvObj, out_tile, NULL, rows, 1, no_of_filter,
+                               no_of_filter, 0, bias, relu, 0, NULL, 1);
+                }
+                for (int m = 0; m < rows; m++) {
+                    impl::cvt_float_to_bfloat16((bfloat16_t *)out_layer + (row_start + m)*total_filters +
+                                                filter_offset, out_tile + (unsigned long)m*no_of_filter, no_of_filter);
+                }
+            }
+            else {
+                const dim_t ldc = total_filters;
+                unsigned long outputOffset = row_start*total_filters + filter_offset;
+                impl::cpu::gemm_bf16bf16f32(&trans, &trans, &M, &N, &Kdim, &alpha, filter, &lda,
+                                            data_col, &ldb, &beta, (float *)out_layer + outputOffset, &ldc);
+                if (bias || relu) {
+                    zenPostOps(zenEnvObj, (float *)out_layer, NULL, rows, 1, no_of_filter,
+                               total_filters, outputOffset, bias, relu, 0, NULL, 1);
+                }
+            }
+        }
+    }
+    free(data_buf);
+}
+
+void zenConvolution2DBF16(
+    const bfloat16_t *in_layer,
+    const int batchsize,
+    const int channels,
+    const int height,
+    const int width,
+    const bfloat16_t *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    const bool relu,
+    void *out_layer,
+    const bool out_bf16,
+    const int out_height,
+    const int out_width,
+    const bool concat,
+    const int filter_offset,
+    const int total_filters
+) {
+    //TODO: perform other checks...eg. for all input dimansions
+    if ((in_layer == NULL)|| (filter == NULL) || (out_layer == NULL)) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DBF16 Memory is not defined for in_layer or filter or out_layer");
+        return;
+    }
+
+    //TODO: This should be part of zendnn initialization
+    zendnnEnv zenEnvObj = readEnv();
+    //Post-ops are applied on NHWC output tile
+    zenEnvObj.zenBlockedFormat = 0;
+
+    struct timeval start, end;
+    gettimeofday(&start, 0);
+
+    int ldc = concat ? total_filters : no_of_filter;
+    int offset = concat ? filter_offset : 0;
+    zenConvolution2DBF16Ver1(zenEnvObj, in_layer, batchsize, channels, height,
+                             width, filter, no_of_filter, kernel_h, kernel_w, pad_t, pad_l,
+                             stride_h, stride_w, bias, relu, out_layer, out_bf16, out_height,
+                             out_width, offset, ldc);
+
+    gettimeofday(&end, 0);
+    float elapsed;
+    elapsed = timedifference_msec(start, end);
+    zendnnInfo(ZENDNN_PROFLOG, "zenConvolution2DBF16, no_of_images=", batchsize,
+               " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " pad_t=", pad_t, " pad_l=", pad_l,
+               " pad_b=", pad_b, " pad_r=", pad_r,
+               " stride_h=", stride_h, " stride_w=",stride_w,
+               " relu=", relu, " out_bf16=", out_bf16,
+               " Time=", elapsed, "ms");
+}
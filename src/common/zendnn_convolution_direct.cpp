@@ -8,6 +8,7 @@
 #include <cblas.h>
 #include <time.h>
 #include <sys/time.h>
+#include <immintrin.h>
 #include "zendnn_logging.hpp"
 
 #define ALIGNED_OFFSET          64
@@ -53,8 +54,6 @@ void zenConvolution2D_direct(
                " pad_b=", pad_b, " pad_r=", pad_r,
                " stride_h=", stride_h, " stride_w=",stride_w);
 
-    printf(" CblasRowMajor CblasTrans M, N, LDA \t%d\t%d\t%d\n",
-           channels*kernel_h*kernel_w, no_of_filter, no_of_filter);
     unsigned int thread_qty = zenEnvObj.omp_num_threads;
     //Need to change this for latency optimization
     if (thread_qty > no_of_images) {
@@ -217,9 +216,6 @@ void zenConvolution2D_directVer2(
         return;
     }
 
-    //Need to optimize this
-    //float *filterNew = (float *)filter;//transpose(filter, no_of_filter, kernel_h*kernel_w*channels);
-    float *filterNew = transpose(filter, kernel_h*kernel_w*channels, no_of_filter);
     //float *directOut = (float*) malloc(no_of_filter * sizeof(float)*thread_qty);
 
 
@@ -244,7 +240,6 @@ void zenConvolution2D_directVer2(
 
             unsigned int data_col_offset = 0;
             unsigned int out_count = 0;
-            float temp_out = 0;
 
             int h = 0;
             int h_pad = -pad_t;
@@ -259,19 +254,15 @@ void zenConvolution2D_directVer2(
                     for (int ih = h_pad; ih < h_pad + kernel_h; ++ih) {
                         for (int iw = w_pad; iw < w_pad + kernel_w; ++iw) {
                             if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                                for (int f=0; f<no_of_filter; f++) {
-                                    //cblas_sgemv(CblasRowMajor, CblasNoTrans, 1, channels, 1.0f,
-                                    //filterNew + (data_col_offset*channels) + (f*channels*kernel_h*kernel_w),
-                                    //                  channels, in_layer + (inputOffset) + (ih * width + iw) * channels,
-                                    //                        1, 0.0f, &temp_out, 1);
-
-                                    temp_out = cblas_sdot(channels,
-                                                          filterNew+(data_col_offset*channels) + (f*channels*kernel_h*kernel_w), 1,
-                                                          in_layer + (inputOffset) + (ih * width + iw) * channels, 1);
-
-                                    //directOut[directOutOffset + f] += temp_out;
-                                    out_layer[outputOffset + (no_of_filter*out_count) + f]  += temp_out;
-                                }
+                                //HWCN filter of this tap is a channels x no_of_filter
+                                //row major matrix, sgemv with its transpose
+                                //accumulates all filters at once, so filter is used
+                                //as is, without a transposed copy
+                                cblas_sgemv(CblasRowMajor, CblasTrans, channels,
+                                            no_of_filter, 1.0f,
+                                            filter + ((unsigned long)data_col_offset*channels*no_of_filter),
+                                            no_of_filter, in_layer + (inputOffset) + (ih * width + iw) * channels,
+                                            1, 1.0f, out_layer + outputOffset + (no_of_filter*out_count), 1);
                             }
                             /*
                                         else {
@@ -444,3 +435,353 @@ void zenConvolution2D_directVer3(
     //free(directOut);
     free(data_col);
 }
+
+//Low input channel(first layer) direct convolution works on a block of
+//LOW_IC_OC_BLOCK filters(two AVX2 vectors) and up to LOW_IC_OW_BLOCK output
+//pixels of a row, 12 accumulators stay in ymm registers.
+#define LOW_IC_OC_BLOCK         16
+#define LOW_IC_OW_BLOCK         6
+
+//Computes OWB output pixels x LOW_IC_OC_BLOCK filters of one output row and
+//applies post-ops on the way out.
+//Kernel taps [i_begin, i_end) x [j_begin, j_end) must be inside the input for
+//all OWB pixels, in_offset is input offset(in pixels) of tap (0,0) of first
+//pixel and can be negative when it lies in padding.
+//filter_blk is packed as [kernel_h][kernel_w][IC][LOW_IC_OC_BLOCK]
+template <int IC, int OWB>
+static inline __attribute__((always_inline)) void zenConvLowICBlock(
+    const float *in_image,
+    const long in_offset,
+    const int width,
+    const int stride_w,
+    const float *filter_blk,
+    const int kernel_w,
+    const int i_begin,
+    const int i_end,
+    const int j_begin,
+    const int j_end,
+    const float *mul,
+    const float *add,
+    const bool relu,
+    const bool sum_fused,
+    const float *elementwise_input,
+    float *out,
+    const unsigned long out_offset,
+    const int ldc,
+    const int nc
+) {
+    __m256 acc[2*OWB];
+    #pragma GCC unroll 16
+    for (int t = 0; t < 2*OWB; t++) {
+        acc[t] = _mm256_setzero_ps();
+    }
+
+    for (int i = i_begin; i < i_end; i++) {
+        const float *w_row = filter_blk + (unsigned long)i*kernel_w*IC*LOW_IC_OC_BLOCK;
+        for (int j = j_begin; j < j_end; j++) {
+            const float *src = in_image + (in_offset + (long)i*width + j)*IC;
+            const float *w = w_row + j*IC*LOW_IC_OC_BLOCK;
+            #pragma GCC unroll 4
+            for (int c = 0; c < IC; c++) {
+                __m256 w0 = _mm256_loadu_ps(w + c*LOW_IC_OC_BLOCK);
+                __m256 w1 = _mm256_loadu_ps(w + c*LOW_IC_OC_BLOCK + 8);
+                #pragma GCC unroll 16
+                for (int p = 0; p < OWB; p++) {
+                    __m256 x = _mm256_broadcast_ss(src + p*stride_w*IC + c);
+                    acc[2*p] = _mm256_fmadd_ps(x, w0, acc[2*p]);
+                    acc[2*p + 1] = _mm256_fmadd_ps(x, w1, acc[2*p + 1]);
+                }
+            }
+        }
+    }
+
+    //y = (acc + old output if sum)*scale + bias (+ elementwise), then relu
+    if (nc == LOW_IC_OC_BLOCK) {
+        __m256 mul0 = _mm256_loadu_ps(mul), mul1 = _mm256_loadu_ps(mul + 8);
+        __m256 add0 = _mm256_loadu_ps(add), add1 = _mm256_loadu_ps(add + 8);
+        __m256 zero = _mm256_setzero_ps();
+        #pragma GCC unroll 16
+        for (int p = 0; p < OWB; p++) {
+            unsigned long offset = out_offset + (unsigned long)p*ldc;
+            __m256 y0 = acc[2*p], y1 = acc[2*p + 1];
+            if (sum_fused) {
+                y0 = _mm256_add_ps(y0, _mm256_loadu_ps(out + offset));
+                y1 = _mm256_add_ps(y1, _mm256_loadu_ps(out + offset + 8));
+            }
+            y0 = _mm256_fmadd_ps(y0, mul0, add0);
+            y1 = _mm256_fmadd_ps(y1, mul1, add1);
+            if (elementwise_input) {
+                y0 = _mm256_add_ps(y0, _mm256_loadu_ps(elementwise_input + offset));
+                y1 = _mm256_add_ps(y1, _mm256_loadu_ps(elementwise_input + offset + 8));
+            }
+            if (relu) {
+                y0 = _mm256_max_ps(y0, zero);
+                y1 = _mm256_max_ps(y1, zero);
+            }
+            _mm256_storeu_ps(out + offset, y0);
+            _mm256_storeu_ps(out + offset + 8, y1);
+        }
+    }
+    else {
+        //Last filter block, only nc filters are valid
+        float y[LOW_IC_OC_BLOCK];
+        for (int p = 0; p < OWB; p++) {
+            unsigned long offset = out_offset + (unsigned long)p*ldc;
+            _mm256_storeu_ps(y, acc[2*p]);
+            _mm256_storeu_ps(y + 8, acc[2*p + 1]);
+            for (int k = 0; k < nc; k++) {
+                float v = y[k];
+                if (sum_fused) {
+                    v += out[offset + k];
+                }
+                v = v*mul[k] + add[k];
+                if (elementwise_input) {
+                    v += elementwise_input[offset + k];
+                }
+                out[offset + k] = (relu && v < 0) ? 0 : v;
+            }
+        }
+    }
+}
+
+//Computes one output row for one block of filters. Pixels whose kernel
+//window is fully inside the input width are processed LOW_IC_OW_BLOCK at a
+//time, border pixels one at a time with clipped kernel window.
+template <int IC>
+static void zenConvLowICRow(
+    const float *in_image,
+    const int height,
+    const int width,
+    const float *filter_blk,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int stride_h,
+    const int stride_w,
+    const int oh,
+    const int out_width,
+    const float *mul,
+    const float *add,
+    const bool relu,
+    const bool sum_fused,
+    const float *elementwise_input,
+    float *out,
+    const unsigned long out_offset,
+    const int ldc,
+    const int nc
+) {
+    int ih = oh*stride_h - pad_t;
+    int i_begin = ih < 0 ? -ih : 0;
+    int i_end = height - ih < kernel_h ? height - ih : kernel_h;
+
+    //[ow_lo, ow_hi) have full kernel window inside the input width
+    int ow_lo = (pad_l + stride_w - 1)/stride_w;
+    int ow_hi = width + pad_l >= kernel_w ? (width + pad_l - kernel_w)/stride_w + 1
+                : 0;
+    ow_lo = ow_lo > out_width ? out_width : ow_lo;
+    ow_hi = ow_hi > out_width ? out_width : ow_hi;
+    ow_hi = ow_hi < ow_lo ? ow_lo : ow_hi;
+
+#define LOW_IC_BLOCK_ARGS(ow, j_begin, j_end) \
+    in_image, (long)ih*width + (ow)*stride_w - pad_l, width, stride_w, \
+    filter_blk, kernel_w, i_begin, i_end, j_begin, j_end, mul, add, relu, \
+    sum_fused, elementwise_input, out, out_offset + (unsigned long)(ow)*ldc, ldc, nc
+
+    for (int ow = 0; ow < out_width; ow++) {
+        if (ow == ow_lo) {
+            int count = ow_hi - ow_lo;
+            for (; count >= LOW_IC_OW_BLOCK; count -= LOW_IC_OW_BLOCK) {
+                zenConvLowICBlock<IC, LOW_IC_OW_BLOCK>(LOW_IC_BLOCK_ARGS(ow, 0, kernel_w));
+                ow += LOW_IC_OW_BLOCK;
+            }
+            switch (count) {
+            case 5:
+                zenConvLowICBlock<IC, 5>(LOW_IC_BLOCK_ARGS(ow, 0, kernel_w));
+                break;
+            case 4:
+                zenConvLowICBlock<IC, 4>(LOW_IC_BLOCK_ARGS(ow, 0, kernel_w));
+                break;
+            case 3:
+                zenConvLowICBlock<IC, 3>(LOW_IC_BLOCK_ARGS(ow, 0, kernel_w));
+                break;
+            case 2:
+                zenConvLowICBlock<IC, 2>(LOW_IC_BLOCK_ARGS(ow, 0, kernel_w));
+                break;
+            case 1:
+                zenConvLowICBlock<IC, 1>(LOW_IC_BLOCK_ARGS(ow, 0, kernel_w));
+                break;
+            default:
+                break;
+            }
+            ow += count;
+            if (ow >= out_width) {
+                break;
+            }
+        }
+        int iw = ow*stride_w - pad_l;
+        int j_begin = iw < 0 ? -iw : 0;
+        int j_end = width - iw < kernel_w ? width - iw : kernel_w;
+        zenConvLowICBlock<IC, 1>(LOW_IC_BLOCK_ARGS(ow, j_begin, j_end));
+    }
+#undef LOW_IC_BLOCK_ARGS
+}
+
+typedef void (*zenConvLowICRowFn)(const float *, const int, const int,
+                                  const float *, const int, const int, const int, const int, const int,
+                                  const int, const int, const int, const float *, const float *,
+                                  const bool, const bool, const float *, float *, const unsigned long,
+                                  const int, const int);
+
+unsigned long zenConvolution2DDirectLowICFilterSize(
+    const int channels,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w
+) {
+    unsigned long filter_blocks = (no_of_filter + LOW_IC_OC_BLOCK - 1)/
+                                  LOW_IC_OC_BLOCK;
+    return (unsigned long)kernel_h*kernel_w*channels*LOW_IC_OC_BLOCK*
+           filter_blocks;
+}
+
+//Packs HWCN filter as [filter block][kernel_h][kernel_w][channels]
+//[LOW_IC_OC_BLOCK], filters of last block beyond no_of_filter are zero
+void zenConvolution2DDirectLowICFilterPack(
+    const float *filter,
+    const int channels,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    float *packed_filter
+) {
+    int filter_blocks = (no_of_filter + LOW_IC_OC_BLOCK - 1)/LOW_IC_OC_BLOCK;
+    unsigned long taps = (unsigned long)kernel_h*kernel_w*channels;
+    for (int b = 0; b < filter_blocks; b++) {
+        float *dst = packed_filter + b*taps*LOW_IC_OC_BLOCK;
+        for (unsigned long t = 0; t < taps; t++) {
+            for (int k = 0; k < LOW_IC_OC_BLOCK; k++) {
+                int f = b*LOW_IC_OC_BLOCK + k;
+                dst[t*LOW_IC_OC_BLOCK + k] = f < no_of_filter ? filter[t*no_of_filter + f] : 0;
+            }
+        }
+    }
+}
+
+//This implementation is direct convolution for layers with very few input
+//channels(e.g. first layer of CNNs with RGB input), where patch matrix has
+//K = kernel_h*kernel_w*channels too small to use gemm micro kernels well.
+//Filters are repacked in blocks of LOW_IC_OC_BLOCK and kernel is specialized
+//at compile time for each supported channel count, it vectorizes over
+//filters and output width. Bias, BatchNorm scale, sum and ReLU are fused.
+//Filter packed once by zenConvolution2DDirectLowICFilterPack can be passed
+//as packed_filter, filter is packed on every call otherwise.
+//I/p and o/p format will be NHWC and filter format is HWCN
+//Multi thread parallization happen at OMP level over images, output rows and
+//filter blocks
+void zenConvolution2DDirectLowIC(
+    zendnnEnv zenEnvObj,
+    const float *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const float *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    float *out_layer,
+    const int out_height,
+    const int out_width,
+    const bool relu,
+    const bool sum_fused,
+    const float *scale,
+    const float *elementwise_input,
+    const bool concat,
+    const int filter_offset,
+    const int total_filters,
+    const float *packed_filter
+) {
+    zenConvLowICRowFn conv_row = NULL;
+    switch (channels) {
+    case 1:
+        conv_row = zenConvLowICRow<1>;
+        break;
+    case 2:
+        conv_row = zenConvLowICRow<2>;
+        break;
+    case 3:
+        conv_row = zenConvLowICRow<3>;
+        break;
+    case 4:
+        conv_row = zenConvLowICRow<4>;
+        break;
+    default:
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DDirectLowIC channels=", channels, " is not supported");
+        return;
+    }
+
+    int ldc = concat ? total_filters : no_of_filter;
+    int offset = concat ? filter_offset : 0;
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    int filter_blocks = (no_of_filter + LOW_IC_OC_BLOCK - 1)/LOW_IC_OC_BLOCK;
+    unsigned long blk_size = (unsigned long)kernel_h*kernel_w*channels*
+                             LOW_IC_OC_BLOCK;
+
+    zendnnInfo(ZENDNN_ALGOLOG, "zenConvolution2DDirectLowIC, no_of_images=",
+               images, " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " stride_h=", stride_h, " stride_w=", stride_w, " thread_qty=", thread_qty,
+               " prepacked=", packed_filter != NULL);
+
+    //Post-op multiplier and addend, followed by packed filter when it is
+    //not prepacked
+    unsigned long post_size = 2*filter_blocks*LOW_IC_OC_BLOCK;
+    unsigned long buf_size = post_size + (packed_filter ? 0 : blk_size*filter_blocks);
+    float *buf = (float *)aligned_alloc(ALIGNED_OFFSET, sizeof(float)*buf_size);
+    if (buf == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DDirectLowIC Memory Error while allocating packed filter");
+        return;
+    }
+    float *mul = buf;
+    float *add = mul + filter_blocks*LOW_IC_OC_BLOCK;
+    const float *filter_packed = packed_filter;
+    if (!packed_filter) {
+        zenConvolution2DDirectLowICFilterPack(filter, channels, no_of_filter,
+                                              kernel_h, kernel_w, buf + post_size);
+        filter_packed = buf + post_size;
+    }
+    for (int f = 0; f < filter_blocks*LOW_IC_OC_BLOCK; f++) {
+        bool valid = f < no_of_filter;
+        mul[f] = (valid && scale) ? scale[f] : 1.0f;
+        add[f] = (valid && bias) ? bias[f] : 0.0f;
+    }
+
+    omp_set_max_active_levels(1);
+    #pragma omp parallel for num_threads(thread_qty) collapse(3)
+    for (int n = 0; n < images; n++) {
+        for (int oh = 0; oh < out_height; oh++) {
+            for (int b = 0; b < filter_blocks; b++) {
+                int nc = no_of_filter - b*LOW_IC_OC_BLOCK;
+                nc = nc > LOW_IC_OC_BLOCK ? LOW_IC_OC_BLOCK : nc;
+                unsigned long out_offset = ((unsigned long)n*out_height + oh)*out_width*ldc +
+                                           offset + b*LOW_IC_OC_BLOCK;
+                conv_row(in_layer + (unsigned long)n*height*width*channels, height, width,
+                         filter_packed + b*blk_size, kernel_h, kernel_w, pad_t, pad_l,
+                         stride_h, stride_w, oh, out_width, mul + b*LOW_IC_OC_BLOCK,
+                         add + b*LOW_IC_OC_BLOCK, relu, sum_fused, elementwise_input,
+                         out_layer, out_offset, ldc, nc);
+            }
+        }
+    }
+    free(buf);
+}
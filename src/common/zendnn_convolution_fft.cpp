@@ -0,0 +1,418 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <omp.h>
+#include <math.h>
+#include <string.h>
+#include <cblas.h>
+#include <time.h>
+#include <sys/time.h>
+#include "zendnn_convolution_fft.hpp"
+#include "zendnn_logging.hpp"
+
+using namespace zendnn;
+
+//Transformed input and gemm output of one pass over tiles are kept within
+//this size, remaining tiles are processed in further passes.
+//TODO: Read cache info from underlying platform and decide this value.
+#define FFT_CONV_BUFFER_SIZE    (32*1024*1024)
+//FFT size is at least this times kernel size, so that at least half of
+//every transformed tile is valid output
+#define FFT_CONV_KERNEL_FACTOR  2
+
+//cos/sin table of radix-2 FFT of size n, n/2 entries each
+static void zenFFTTwiddle(const int n, float *cos_tab, float *sin_tab) {
+    for (int j = 0; j < n/2; j++) {
+        double angle = -2.0*M_PI*j/n;
+        cos_tab[j] = cos(angle);
+        sin_tab[j] = sin(angle);
+    }
+}
+
+//In place radix-2 complex FFT of n elements, where element i is the vector
+//of len values at re + i*stride and im + i*stride. Every butterfly works on
+//whole vectors(channels or filters), which are contiguous and vectorized.
+//Inverse uses conjugate twiddles and is not scaled.
+static void zenFFT1D(float *re, float *im, const int n,
+                     const unsigned long stride, const int len, const float *cos_tab,
+                     const float *sin_tab, const bool inverse) {
+    if (n < 2) {
+        return;
+    }
+    //Bit reversal permutation
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float *ar = re + i*stride, *ai = im + i*stride;
+            float *br = re + j*stride, *bi = im + j*stride;
+            #pragma omp simd
+            for (int c = 0; c < len; c++) {
+                float tr = ar[c], ti = ai[c];
+                ar[c] = br[c];
+                ai[c] = bi[c];
+                br[c] = tr;
+                bi[c] = ti;
+            }
+        }
+    }
+    for (int m = 2; m <= n; m <<= 1) {
+        int half = m >> 1;
+        int step = n/m;
+        for (int j = 0; j < half; j++) {
+            const float wr = cos_tab[j*step];
+            const float wi = inverse ? -sin_tab[j*step] : sin_tab[j*step];
+            for (int base = j; base < n; base += m) {
+                float *ar = re + base*stride, *ai = im + base*stride;
+                float *br = ar + half*stride, *bi = ai + half*stride;
+                #pragma omp simd
+                for (int c = 0; c < len; c++) {
+                    float tr = br[c]*wr - bi[c]*wi;
+                    float ti = br[c]*wi + bi[c]*wr;
+                    br[c] = ar[c] - tr;
+                    bi[c] = ai[c] - ti;
+                    ar[c] += tr;
+                    ai[c] += ti;
+                }
+            }
+        }
+    }
+}
+
+//Forward 2D FFT of real data in re(im is zero) with [fft_h][fft_w][len]
+//layout. Only columns 0..fft_w/2 are transformed along height, rest of the
+//spectrum follows from symmetry of real input.
+static void zenFFT2DForward(float *re, float *im, const int fft_h,
+                            const int fft_w, const int len, const float *tw) {
+    const float *h_cos = tw, *h_sin = tw + fft_h/2;
+    const float *w_cos = tw + 2*(fft_h/2), *w_sin = w_cos + fft_w/2;
+    unsigned long row = (unsigned long)fft_w*len;
+    for (int y = 0; y < fft_h; y++) {
+        zenFFT1D(re + y*row, im + y*row, fft_w, len, len, w_cos, w_sin, false);
+    }
+    for (int x = 0; x <= fft_w/2; x++) {
+        zenFFT1D(re + x*len, im + x*len, fft_h, row, len, h_cos, h_sin, false);
+    }
+}
+
+//Inverse of zenFFT2DForward, columns 0..fft_w/2 of spectrum are input and
+//real result is left in re
+static void zenFFT2DInverse(float *re, float *im, const int fft_h,
+                            const int fft_w, const int len, const float *tw) {
+    const float *h_cos = tw, *h_sin = tw + fft_h/2;
+    const float *w_cos = tw + 2*(fft_h/2), *w_sin = w_cos + fft_w/2;
+    unsigned long row = (unsigned long)fft_w*len;
+    for (int x = 0; x <= fft_w/2; x++) {
+        zenFFT1D(re + x*len, im + x*len, fft_h, row, len, h_cos, h_sin, true);
+    }
+    for (int y = 0; y < fft_h; y++) {
+        float *r = re + y*row, *i = im + y*row;
+        //Every row is spectrum of a real signal
+        for (int x = fft_w/2 + 1; x < fft_w; x++) {
+            const float *sr = r + (unsigned long)(fft_w - x)*len;
+            const float *si = i + (unsigned long)(fft_w - x)*len;
+            float *dr = r + (unsigned long)x*len, *di = i + (unsigned long)x*len;
+            #pragma omp simd
+            for (int c = 0; c < len; c++) {
+                dr[c] = sr[c];
+                di[c] = -si[c];
+            }
+        }
+        zenFFT1D(r, i, fft_w, len, len, w_cos, w_sin, true);
+    }
+}
+
+int zenConvolution2DFFTSize(const int kernel, const int out_size) {
+    if (kernel == 1) {
+        return 1;
+    }
+    int size = 1;
+    while (size < FFT_CONV_KERNEL_FACTOR*kernel) {
+        size <<= 1;
+    }
+    //Tile need not be larger than whole output
+    int max_size = 1;
+    while (max_size < out_size + kernel - 1) {
+        max_size <<= 1;
+    }
+    return size < max_size ? size : max_size;
+}
+
+unsigned long zenConvolution2DFFTFilterSize(const int channels,
+        const int no_of_filter, const int fft_h, const int fft_w) {
+    return 2*(unsigned long)fft_h*(fft_w/2 + 1)*channels*no_of_filter;
+}
+
+void zenConvolution2DFFTFilterTransform(
+    zendnnEnv zenEnvObj,
+    const float *filter,
+    const int channels,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int fft_h,
+    const int fft_w,
+    float *filter_fft
+) {
+    int half_w = fft_w/2 + 1;
+    unsigned long bins = (unsigned long)fft_h*half_w;
+    unsigned long plane = bins*channels*no_of_filter;
+    unsigned long ws_size = (unsigned long)fft_h*fft_w*no_of_filter;
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    if (thread_qty > channels) {
+        thread_qty = channels;
+    }
+
+    //Twiddles followed by one complex tile of filters per thread
+    float *tw = (float *)aligned_alloc(ALIGNED_OFFSET,
+                                       sizeof(float)*(fft_h + fft_w + 2*ws_size*thread_qty));
+    if (tw == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DFFTFilterTransform Memory Error while allocating work space");
+        return;
+    }
+    float *ws = tw + fft_h + fft_w;
+    zenFFTTwiddle(fft_h, tw, tw + fft_h/2);
+    zenFFTTwiddle(fft_w, tw + 2*(fft_h/2), tw + 2*(fft_h/2) + fft_w/2);
+
+    const float norm = 1.0f/(fft_h*fft_w);
+    omp_set_max_active_levels(1);
+    #pragma omp parallel for num_threads(thread_qty)
+    for (int c = 0; c < channels; c++) {
+        float *re = ws + 2*ws_size*omp_get_thread_num();
+        float *im = re + ws_size;
+        memset(re, 0, sizeof(float)*2*ws_size);
+        for (int i = 0; i < kernel_h; i++) {
+            for (int j = 0; j < kernel_w; j++) {
+                memcpy(re + ((unsigned long)i*fft_w + j)*no_of_filter,
+                       filter + (((unsigned long)i*kernel_w + j)*channels + c)*no_of_filter,
+                       sizeof(float)*no_of_filter);
+            }
+        }
+        zenFFT2DForward(re, im, fft_h, fft_w, no_of_filter, tw);
+        for (int y = 0; y < fft_h; y++) {
+            for (int x = 0; x < half_w; x++) {
+                unsigned long src = ((unsigned long)y*fft_w + x)*no_of_filter;
+                unsigned long dst = (((unsigned long)y*half_w + x)*channels + c)*
+                                    no_of_filter;
+                #pragma omp simd
+                for (int k = 0; k < no_of_filter; k++) {
+                    filter_fft[dst + k] = re[src + k]*norm;
+                    filter_fft[plane + dst + k] = -im[src + k]*norm;
+                }
+            }
+        }
+    }
+    free(tw);
+}
+
+//This implementation is based on FFT and sgemm(BLIS)
+//Tiles of whole batch are processed in passes, each pass does
+//1. forward FFT of input tiles, vectorized over channels
+//2. complex multiply accumulate over channels of every frequency, done as
+//   sgemm of [tiles x channels] and [channels x filters] per frequency
+//3. inverse FFT of output tiles, vectorized over filters, with post-ops
+//Multi thread parallization happen at OMP level over tiles and frequencies
+void zenConvolution2DFFT(
+    zendnnEnv zenEnvObj,
+    const float *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const float *filter_fft,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int fft_h,
+    const int fft_w,
+    const int pad_t,
+    const int pad_l,
+    const float *bias,
+    float *out_layer,
+    const int out_height,
+    const int out_width,
+    const bool relu,
+    const bool sum_fused,
+    const float *scale,
+    const bool concat,
+    const int filter_offset,
+    const int total_filters
+) {
+    struct timeval start, end;
+    gettimeofday(&start, 0);
+
+    int ldc = concat ? total_filters : no_of_filter;
+    int offset = concat ? filter_offset : 0;
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+
+    int tile_h = fft_h - kernel_h + 1;
+    int tile_w = fft_w - kernel_w + 1;
+    int tiles_h = (out_height + tile_h - 1)/tile_h;
+    int tiles_w = (out_width + tile_w - 1)/tile_w;
+    unsigned long tiles_per_image = (unsigned long)tiles_h*tiles_w;
+    unsigned long total_tiles = tiles_per_image*images;
+    int half_w = fft_w/2 + 1;
+    unsigned long bins = (unsigned long)fft_h*half_w;
+    unsigned long plane = bins*channels*no_of_filter;
+
+    //Tiles per pass, transformed input and gemm output of a tile are complex
+    unsigned long tile_size = 2*bins*(channels + no_of_filter);
+    unsigned long chunk = FFT_CONV_BUFFER_SIZE/(sizeof(float)*tile_size);
+    chunk = chunk < 1 ? 1 : chunk;
+    chunk = chunk > total_tiles ? total_tiles : chunk;
+    unsigned long ws_size = (unsigned long)fft_h*fft_w*
+                            (channels > no_of_filter ? channels : no_of_filter);
+
+    zendnnInfo(ZENDNN_ALGOLOG, "zenConvolution2DFFT, no_of_images=", images,
+               " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " fft_h=", fft_h, " fft_w=", fft_w, " total_tiles=", total_tiles,
+               " chunk=", chunk, " thread_qty=", thread_qty);
+
+    //Twiddles, transformed input, gemm output and one complex tile per thread
+    unsigned long x_size = 2*bins*chunk*channels;
+    unsigned long y_size = 2*bins*chunk*no_of_filter;
+    float *tw = (float *)aligned_alloc(ALIGNED_OFFSET,
+                                       sizeof(float)*(fft_h + fft_w + x_size + y_size + 2*ws_size*thread_qty));
+    if (tw == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DFFT Memory Error while allocating work space");
+        return;
+    }
+    float *x_buf = tw + fft_h + fft_w;
+    float *y_buf = x_buf + x_size;
+    float *ws = y_buf + y_size;
+    zenFFTTwiddle(fft_h, tw, tw + fft_h/2);
+    zenFFTTwiddle(fft_w, tw + 2*(fft_h/2), tw + 2*(fft_h/2) + fft_w/2);
+
+    omp_set_max_active_levels(1);
+    for (unsigned long t0 = 0; t0 < total_tiles; t0 += chunk) {
+        int tiles = total_tiles - t0 < chunk ? total_tiles - t0 : chunk;
+        float *x_re = x_buf, *x_im = x_buf + bins*tiles*channels;
+        float *y_re = y_buf, *y_im = y_buf + bins*tiles*no_of_filter;
+
+        //Forward transform of input tiles, padding is zero
+        #pragma omp parallel for num_threads(thread_qty)
+        for (int t = 0; t < tiles; t++) {
+            float *re = ws + 2*ws_size*omp_get_thread_num();
+            float *im = re + ws_size;
+            unsigned long tile = t0 + t;
+            int n = tile/tiles_per_image;
+            int r = tile%tiles_per_image;
+            int ih0 = (r/tiles_w)*tile_h - pad_t;
+            int iw0 = (r%tiles_w)*tile_w - pad_l;
+            const float *image = in_layer + (unsigned long)n*height*width*channels;
+            for (int y = 0; y < fft_h; y++) {
+                int ih = ih0 + y;
+                float *dst = re + (unsigned long)y*fft_w*channels;
+                if (ih < 0 || ih >= height) {
+                    memset(dst, 0, sizeof(float)*fft_w*channels);
+                    continue;
+                }
+                for (int x = 0; x < fft_w; x++) {
+                    int iw = iw0 + x;
+                    if (iw >= 0 && iw < width) {
+                        memcpy(dst + (unsigned long)x*channels,
+                               image + ((unsigned long)ih*width + iw)*channels, sizeof(float)*channels);
+                    }
+                    else {
+                        memset(dst + (unsigned long)x*channels, 0, sizeof(float)*channels);
+                    }
+                }
+            }
+            memset(im, 0, sizeof(float)*fft_h*fft_w*channels);
+            zenFFT2DForward(re, im, fft_h, fft_w, channels, tw);
+            for (int y = 0; y < fft_h; y++) {
+                for (int x = 0; x < half_w; x++) {
+                    unsigned long src = ((unsigned long)y*fft_w + x)*channels;
+                    unsigned long dst = (((unsigned long)y*half_w + x)*tiles + t)*channels;
+                    memcpy(x_re + dst, re + src, sizeof(float)*channels);
+                    memcpy(x_im + dst, im + src, sizeof(float)*channels);
+                }
+            }
+        }
+
+        //(xr + i*xi)*(wr + i*wi) summed over channels for every frequency
+        #pragma omp parallel for num_threads(thread_qty)
+        for (long b = 0; b < (long)bins; b++) {
+            const float *xr = x_re + b*tiles*channels, *xi = x_im + b*tiles*channels;
+            const float *wr = filter_fft + b*channels*no_of_filter;
+            const float *wi = filter_fft + plane + b*channels*no_of_filter;
+            float *yr = y_re + b*tiles*no_of_filter, *yi = y_im + b*tiles*no_of_filter;
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, tiles, no_of_filter,
+                        channels, 1.0f, xr, channels, wr, no_of_filter, 0.0f, yr, no_of_filter);
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, tiles, no_of_filter,
+                        channels, -1.0f, xi, channels, wi, no_of_filter, 1.0f, yr, no_of_filter);
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, tiles, no_of_filter,
+                        channels, 1.0f, xr, channels, wi, no_of_filter, 0.0f, yi, no_of_filter);
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, tiles, no_of_filter,
+                        channels, 1.0f, xi, channels, wr, no_of_filter, 1.0f, yi, no_of_filter);
+        }
+
+        //Inverse transform of output tiles, valid part is written with post-ops
+        #pragma omp parallel for num_threads(thread_qty)
+        for (int t = 0; t < tiles; t++) {
+            float *re = ws + 2*ws_size*omp_get_thread_num();
+            float *im = re + ws_size;
+            for (int y = 0; y < fft_h; y++) {
+                for (int x = 0; x < half_w; x++) {
+                    unsigned long src = (((unsigned long)y*half_w + x)*tiles + t)*no_of_filter;
+                    unsigned long dst = ((unsigned long)y*fft_w + x)*no_of_filter;
+                    memcpy(re + dst, y_re + src, sizeof(float)*no_of_filter);
+                    memcpy(im + dst, y_im + src, sizeof(float)*no_of_filter);
+                }
+            }
+            zenFFT2DInverse(re, im, fft_h, fft_w, no_of_filter, tw);
+
+            unsigned long tile = t0 + t;
+            int n = tile/tiles_per_image;
+            int r = tile%tiles_per_image;
+            int oh0 = (r/tiles_w)*tile_h;
+            int ow0 = (r%tiles_w)*tile_w;
+            int rows = out_height - oh0 < tile_h ? out_height - oh0 : tile_h;
+            int cols = out_width - ow0 < tile_w ? out_width - ow0 : tile_w;
+            for (int y = 0; y < rows; y++) {
+                for (int x = 0; x < cols; x++) {
+                    float *out = out_layer + (((unsigned long)n*out_height + oh0 + y)*out_width +
+                                              ow0 + x)*ldc + offset;
+                    const float *v = re + ((unsigned long)y*fft_w + x)*no_of_filter;
+                    #pragma omp simd
+                    for (int k = 0; k < no_of_filter; k++) {
+                        float o = v[k];
+                        if (sum_fused) {
+                            o += out[k];
+                        }
+                        if (scale) {
+                            o *= scale[k];
+                        }
+                        if (bias) {
+                            o += bias[k];
+                        }
+                        if (relu) {
+                            o = o > 0 ? o : 0;
+                        }
+                        out[k] = o;
+                    }
+                }
+            }
+        }
+    }
+    free(tw);
+
+    gettimeofday(&end, 0);
+    float elapsed;
+    elapsed = timedifference_msec(start, end);
+    zendnnInfo(ZENDNN_PROFLOG, "zenConvolution2DFFT, no_of_images=", images,
+               " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " pad_t=", pad_t, " pad_l=", pad_l,
+               " relu=", relu, " sum_fused=", sum_fused,
+               " isConcat=", concat, " filter_offset=", filter_offset,
+               " total_filters=", total_filters,
+               " Time=", elapsed, "ms");
+}
@@ -0,0 +1,69 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#ifndef ZENDNN_CONVOLUTION_FFT_HPP
+#define ZENDNN_CONVOLUTION_FFT_HPP
+
+#include "zendnn_private.hpp"
+
+//FFT(tiled overlap-save) convolution for stride 1 kernels.
+//Output is divided into tiles, each input tile of size fft_h x fft_w is
+//transformed to frequency domain, multiplied with transformed filter and
+//transformed back, tile_h = fft_h - kernel_h + 1 valid rows(similarly for
+//columns) are kept.
+//I/p and o/p format will be NHWC and filter format is HWCN
+
+//FFT size(power of 2) along one dimension for given kernel and output size
+int zenConvolution2DFFTSize(const int kernel, const int out_size);
+
+//Size in floats of frequency domain filter
+unsigned long zenConvolution2DFFTFilterSize(const int channels,
+        const int no_of_filter, const int fft_h, const int fft_w);
+
+//Transforms HWCN filter to frequency domain. Result is kept as real and
+//imaginary planes of [fft_h][fft_w/2 + 1][channels][no_of_filter], it is
+//conjugated(convolution in network is a correlation) and scaled by
+//1/(fft_h*fft_w) so that it can be reused by zenConvolution2DFFT as is.
+void zenConvolution2DFFTFilterTransform(
+    zendnnEnv zenEnvObj,
+    const float *filter,
+    const int channels,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int fft_h,
+    const int fft_w,
+    float *filter_fft
+);
+
+//filter_fft is output of zenConvolution2DFFTFilterTransform.
+//Post-ops: out = (conv + out if sum_fused)*scale + bias, then relu
+void zenConvolution2DFFT(
+    zendnnEnv zenEnvObj,
+    const float *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const float *filter_fft,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int fft_h,
+    const int fft_w,
+    const int pad_t,
+    const int pad_l,
+    const float *bias,
+    float *out_layer,
+    const int out_height,
+    const int out_width,
+    const bool relu,
+    const bool sum_fused,
+    const float *scale,
+    const bool concat,
+    const int filter_offset,
+    const int total_filters
+);
+
+#endif
@@ -3,10 +3,15 @@
 *******************************************************************************/
 
 #include <omp.h>
+#include <string.h>
 #include <sys/sysinfo.h>
 #include <cblas.h>
 #include <time.h>
 #include <sys/time.h>
+#include <sched.h>
+#include <immintrin.h>
+#include <atomic>
+#include <vector>
 #include "zendnn_convolution_winograd.hpp"
 #include "zendnn_private.hpp"
 #include "zendnn_logging.hpp"
@@ -24,6 +29,22 @@ using namespace zendnn;
 #define CONV_INPUT_HEIGHT       80 //Based on heuristic with googlenet,resnet and vgg. After 80 transformation function degrades the performance
 #define SMALL_CONV_INPUT        10 //Based on heuristic with googlenet,resnet and vgg. After 10 transformation function degrades the performance
 #define SPLIT_CONV_INPUT        20
+//One patch tile of pipelined convolution, producer and consumer share a core
+//and two tiles(double buffer) are sized to stay in its L2.
+//TODO: Read cache info from underlying platform and decide this value.
+#define CONV_PIPELINE_TILE_SIZE (192*1024)
+//Pipeline counters are kept this many longs apart to avoid false sharing
+#define CONV_PIPELINE_STATE_STRIDE 16
+//Spin iterations before waiting thread yields the core
+#define CONV_PIPELINE_SPIN_COUNT 1024
+//Blocking of packed patch convolution, MR x NR register block of AVX2
+//microkernel, MC x KC packed patch block stays in L2 and KC x NR filter
+//strip stays in L1.
+//TODO: Read cache info from underlying platform and decide this value.
+#define CONV_PACKED_MR          6
+#define CONV_PACKED_NR          16
+#define CONV_PACKED_MC          144
+#define CONV_PACKED_KC          256
 
 
 #define DIRECT_CONV_GEMV        0
@@ -1341,6 +1362,156 @@ void zenConvolution2DsmallGemm1x1(
 }
 
 
+//This implementation handles 1x1 kernel with stride and/or padding without
+//forming patch matrix.
+//For 1x1 kernel, one output row(out_width pixels) maps to every stride_w'th
+//pixel of one input row. In NHWC this is a strided view of the input with
+//lda = stride_w*channels, so each output row is computed with one GEMM
+//directly on input. BLIS gathers the strided rows while packing A.
+//Output pixels which fall in padding region don't touch input, they are set
+//to zero(or left as is for sum fusion) before post-ops.
+//I/p and o/p format will be NHWC and filter format is HWCN
+//Multi thread parallization happen at OMP level over (image, output row)
+void zenConvolution2DGemm1x1Strided(
+    zendnnEnv zenEnvObj,
+    const float *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const float *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    float *out_layer,
+    const int out_height,
+    const int out_width,
+    const bool relu,
+    const bool sum_fused,
+    const float *scale,
+    const float *elementwise_input,
+    const bool concat,
+    const int filter_offset,
+    const int total_filters
+) {
+
+    zendnnInfo(ZENDNN_ALGOLOG, "zenConvolution2DGemm1x1Strided, no_of_images=",
+               images,
+               " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " pad_t=", pad_t, " pad_l=", pad_l,
+               " pad_b=", pad_b, " pad_r=", pad_r,
+               " stride_h=", stride_h, " stride_w=",stride_w,
+               " isConcat=", concat, " filter_offset=", filter_offset,
+               " total_filters=", total_filters);
+
+    float gemm_beta = 0.0;
+    if (sum_fused) {
+        gemm_beta = 1.0;
+    }
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+
+    unsigned int ldc = no_of_filter;
+    if (concat) {
+        ldc = total_filters;
+    }
+
+    //Output columns [ow_start, ow_end) map inside input width, rest of the
+    //columns read padding only.
+    int ow_start = (pad_l + stride_w - 1)/stride_w;
+    int ow_end = (width - 1 + pad_l)/stride_w + 1;
+    ow_end = ow_end < out_width ? ow_end : out_width;
+    ow_start = ow_start < ow_end ? ow_start : ow_end;
+    int valid_width = ow_end - ow_start;
+
+    //Each (image, output row) pair is one GEMM of M=out_width
+    unsigned long row_count = (unsigned long)images*out_height;
+    int blis_num_threads = 1;
+#if BLIS_EXPERT
+    //Enable Nested parallelism when output rows are not able to use all threads
+    if (thread_qty > row_count) {
+        blis_num_threads = thread_qty/row_count;
+        thread_qty = row_count;
+    }
+    omp_set_max_active_levels(2);
+#else
+    if (thread_qty > row_count) {
+        thread_qty = row_count;
+    }
+    omp_set_max_active_levels(1);
+#endif
+
+    #pragma omp parallel num_threads(thread_qty)
+    {
+#if BLIS_EXPERT
+        //creating blis expert interface
+        blis_expert blis_obj(blis_num_threads, BLIS_NO_TRANSPOSE, BLIS_NO_TRANSPOSE);
+        bli_setsc(gemm_beta, 0.0, &blis_obj.beta);
+        bli_obj_create_with_attached_buffer(blis_obj.dt, channels, no_of_filter,
+                                            (void *)filter, no_of_filter, 1, &blis_obj.b);
+#endif
+        #pragma omp for
+        for (unsigned long row = 0; row < row_count; row++) {
+            int image = row/out_height;
+            int oh = row%out_height;
+            int ih = oh*stride_h - pad_t;
+
+            unsigned long outputOffset = ((unsigned long)ldc*out_width*row) +
+                                         filter_offset;
+
+            bool valid_row = (ih >= 0 && ih < height);
+
+            //Zero the output pixels which read only padding
+            if (!sum_fused) {
+                int zero_end = valid_row ? ow_start : out_width;
+                int zero_start = valid_row ? ow_end : out_width;
+                for (int ow = 0; ow < zero_end; ow++)
+                    memset(out_layer + outputOffset + (unsigned long)ow*ldc, 0,
+                           sizeof(float)*no_of_filter);
+                for (int ow = zero_start; ow < out_width; ow++)
+                    memset(out_layer + outputOffset + (unsigned long)ow*ldc, 0,
+                           sizeof(float)*no_of_filter);
+            }
+
+            if (valid_row && valid_width > 0) {
+                unsigned long inputOffset = ((unsigned long)image*height*width +
+                                             (unsigned long)ih*width +
+                                             ((unsigned long)ow_start*stride_w - pad_l))*channels;
+                unsigned long validOffset = outputOffset + (unsigned long)ow_start*ldc;
+#if BLIS_EXPERT
+                bli_obj_create_with_attached_buffer(blis_obj.dt, valid_width, channels,
+                                                    (void *)(in_layer+inputOffset),
+                                                    (unsigned long)stride_w*channels, 1, &blis_obj.a);
+                bli_obj_create_with_attached_buffer(blis_obj.dt, valid_width, no_of_filter,
+                                                    out_layer+validOffset, ldc, 1, &blis_obj.c);
+                bli_gemm_ex(&blis_obj.alpha, &blis_obj.a, &blis_obj.b, &blis_obj.beta,
+                            &blis_obj.c, NULL, &blis_obj.rntm);
+#else
+                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, valid_width,
+                            no_of_filter, channels, 1.0f,
+                            in_layer+inputOffset, stride_w*channels, filter, no_of_filter,
+                            gemm_beta,
+                            out_layer+validOffset, ldc);
+#endif
+            }
+
+            zenPostOps(zenEnvObj, out_layer, elementwise_input, out_width, 1,
+                       no_of_filter, ldc,
+                       outputOffset, bias,
+                       relu, 0, scale, blis_num_threads);
+        }
+    }
+}
+
+
 //This implementation is based on im2col and gemm(BLIS) where im2col is performed on input
 //images/featureMap one by one followed by gemm call to blis which computes the feature map for the i/p image
 //and then add bias value on it.
@@ -1532,186 +1703,16 @@ void zenConvolution2DsmallGemmSplit(
                 //if (!(kernel_h == 1 && kernel_w == 1 &&  out_height == height &&
                 //      out_width == width)) {
 
-                int w_pad = -pad_l;
                 if (merge_count == 0) {
                     data_col_offset = 0;
                 }
 
-                //To enable unrolling and better vectorization, (depth == 3) path unrolled the loop
-                //along channel, this address first layer of convolution where no. of channels
-                //in Image is 3.
-                //For (depth%8 == 0), common case for other conv layers, vectorization is enabled by
-                //to tell compiler to generate AVX256 SIMD instruction using (simd_blocks*8) loop.
-                //Observed perf improvement with googlenet and alexnet.
-
-                if (channels == 3) {
-                    for (int w = 0; w < width_col; ++w) {
-#if 1
-                        //Unrolling of inner loop for kernel_w * kernel_h
-                        int ih = h_pad;
-                        int iw = w_pad;
-                        bool unrool_flag = (ih < (h_pad + kernel_h)) && (ih >= 0) &&
-                                           ((ih + kernel_h) < height) && (iw < (w_pad + kernel_w)) && (iw >= 0) &&
-                                           ((iw + kernel_w) < width);
-                        if ((kernel_h == 3)  && unrool_flag) {
-
-                            unsigned long offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_3x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-
-                            data_col_offset += 9;
-                            offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_3x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-
-                            data_col_offset += 9;
-                            offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_3x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-                            data_col_offset += 9;
-
-                        }
-                        else if ((kernel_h == 7)  && unrool_flag) {
-
-                            unsigned long offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_7x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-
-                            data_col_offset += 21;
-                            offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_7x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-
-                            data_col_offset += 21;
-                            offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_7x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-
-                            data_col_offset += 21;
-                            offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_7x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-
-                            data_col_offset += 21;
-                            offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_7x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-
-                            data_col_offset += 21;
-                            offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_7x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-
-                            data_col_offset += 21;
-                            offset = (inputOffset) + (ih * width + iw) * channels;
-                            im2row_unrool_7x3(data_col_tmp, data_col_offset, in_layer, offset);
-                            ++ih;
-
-                            data_col_offset += 21;
-                        }
-                        else {
-                            for (int ih = h_pad; ih < h_pad + kernel_h; ++ih) {
-                                for (int iw = w_pad; iw < w_pad + kernel_w; ++iw) {
-                                    if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                                        unsigned long offset = (inputOffset) + (ih * width + iw) * channels;
-                                        //#pragma omp simd
-                                        //for (int k=0; k<channels; k++) {
-                                        data_col_tmp[data_col_offset + 0] = in_layer[offset + 0];
-                                        data_col_tmp[data_col_offset + 1] = in_layer[offset + 1];
-                                        data_col_tmp[data_col_offset + 2] = in_layer[offset + 2];
-                                        //}
-                                    }
-                                    else {
-                                        // This should be simply padded with zero.
-                                        //#pragma omp simd
-                                        //for (int k=0; k<channels; k++) {
-                                        data_col_tmp[data_col_offset + 0] = 0;
-                                        data_col_tmp[data_col_offset + 1] = 0;
-                                        data_col_tmp[data_col_offset + 2] = 0;
-                                        //}
-                                    }
-                                    data_col_offset += channels;
-                                }
-                            }
-                        }
-#else
-                        for (int ih = h_pad; ih < h_pad + kernel_h; ++ih) {
-                            for (int iw = w_pad; iw < w_pad + kernel_w; ++iw) {
-                                if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                                    unsigned long offset = (inputOffset) + (ih * width + iw) * channels;
-                                    //#pragma omp simd
-                                    //for (int k=0; k<channels; k++) {
-                                    data_col_tmp[data_col_offset + 0] = in_layer[offset + 0];
-                                    data_col_tmp[data_col_offset + 1] = in_layer[offset + 1];
-                                    data_col_tmp[data_col_offset + 2] = in_layer[offset + 2];
-                                    //}
-                                }
-                                else {
-                                    // This should be simply padded with zero.
-                                    //#pragma omp simd
-                                    //for (int k=0; k<channels; k++) {
-                                    data_col_tmp[data_col_offset + 0] = 0;
-                                    data_col_tmp[data_col_offset + 1] = 0;
-                                    data_col_tmp[data_col_offset + 2] = 0;
-                                    //}
-                                }
-                                data_col_offset += channels;
-                            }
-                        }
-#endif
-                        w_pad += stride_w;
-                    }
-                }
-                else if ((channels%8) == 0) {
-                    int simd_blocks = channels/8;
-                    for (int w = 0; w < width_col; ++w) {
-                        for (int ih = h_pad; ih < h_pad + kernel_h; ++ih) {
-                            for (int iw = w_pad; iw < w_pad + kernel_w; ++iw) {
-                                if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                                    unsigned long offset = (inputOffset) + (ih * width + iw) * channels;
-                                    #pragma omp simd
-                                    for (int k=0; k<simd_blocks*8; k++) {
-                                        data_col_tmp[data_col_offset + k] = in_layer[offset + k];
-                                    }
-                                }
-                                else {
-                                    // This should be simply padded with zero.
-                                    #pragma omp simd
-                                    for (int k=0; k<simd_blocks*8; k++) {
-                                        data_col_tmp[data_col_offset + k] = 0;
-                                    }
-                                }
-                                data_col_offset += channels;
-                            }
-                        }
-                        w_pad += stride_w;
-                    }
-
-                }
-                else {
-                    for (int w = 0; w < width_col; ++w) {
-                        for (int ih = h_pad; ih < h_pad + kernel_h; ++ih) {
-                            for (int iw = w_pad; iw < w_pad + kernel_w; ++iw) {
-                                if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                                    unsigned long offset = (inputOffset) + (ih * width + iw) * channels;
-                                    #pragma omp simd
-                                    for (int k=0; k<channels; k++) {
-                                        data_col_tmp[data_col_offset + k] = in_layer[offset + k];
-                                    }
-                                }
-                                else {
-                                    // This should be simply padded with zero.
-                                    #pragma omp simd
-                                    for (int k=0; k<channels; k++) {
-                                        data_col_tmp[data_col_offset + k] = 0;
-                                    }
-                                }
-                                data_col_offset += channels;
-                            }
-                        }
-                        w_pad += stride_w;
-                    }
-                }
+                //Specialized im2row kernels, loop bounds are compile time for
+                //first layer (channels == 3) and 3x3 filters
+                im2rowNHWCrow(in_layer + inputOffset, channels, height, width, kernel_h,
+                              kernel_w, pad_l, stride_w, h_pad, width_col,
+                              data_col_tmp + data_col_offset);
+                data_col_offset += width_col*kernel_h*kernel_w*channels;
                 //}
                 //else
                 //  data_col_tmp = data_col + patchInputOffset +
@@ -1768,6 +1769,359 @@ void zenConvolution2DsmallGemmSplit(
 
 
 
+//Computes C[m x n] (+)= A_panel[m x kc]*B[kc x n] for one register block,
+//m <= CONV_PACKED_MR and n <= CONV_PACKED_NR. A_panel is in packed layout
+//(element(r, k) at k*CONV_PACKED_MR + r) and B is read in place from HWCN
+//filter, FULL is false for column tail, which uses masked load/store.
+template <bool FULL>
+static inline void zenPackedGemmKernel(const int kc, const float *a,
+                                       const float *b, const int ldb, float *c, const int ldc, const int m,
+                                       const int n, const bool accumulate) {
+    __m256 acc[CONV_PACKED_MR][2];
+    for (int r = 0; r < CONV_PACKED_MR; ++r) {
+        acc[r][0] = _mm256_setzero_ps();
+        acc[r][1] = _mm256_setzero_ps();
+    }
+    const __m256i mask0 = _mm256_cmpgt_epi32(_mm256_set1_epi32(n),
+                          _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i mask1 = _mm256_cmpgt_epi32(_mm256_set1_epi32(n),
+                          _mm256_setr_epi32(8, 9, 10, 11, 12, 13, 14, 15));
+    for (int k = 0; k < kc; ++k) {
+        __m256 b0 = FULL ? _mm256_loadu_ps(b) : _mm256_maskload_ps(b, mask0);
+        __m256 b1 = FULL ? _mm256_loadu_ps(b + 8) : _mm256_maskload_ps(b + 8, mask1);
+        for (int r = 0; r < CONV_PACKED_MR; ++r) {
+            __m256 a_r = _mm256_broadcast_ss(a + r);
+            acc[r][0] = _mm256_fmadd_ps(a_r, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(a_r, b1, acc[r][1]);
+        }
+        a += CONV_PACKED_MR;
+        b += ldb;
+    }
+    for (int r = 0; r < m; ++r) {
+        float *c_r = c + (unsigned long)r*ldc;
+        if (FULL) {
+            if (accumulate) {
+                acc[r][0] = _mm256_add_ps(acc[r][0], _mm256_loadu_ps(c_r));
+                acc[r][1] = _mm256_add_ps(acc[r][1], _mm256_loadu_ps(c_r + 8));
+            }
+            _mm256_storeu_ps(c_r, acc[r][0]);
+            _mm256_storeu_ps(c_r + 8, acc[r][1]);
+        }
+        else {
+            if (accumulate) {
+                acc[r][0] = _mm256_add_ps(acc[r][0], _mm256_maskload_ps(c_r, mask0));
+                acc[r][1] = _mm256_add_ps(acc[r][1], _mm256_maskload_ps(c_r + 8, mask1));
+            }
+            _mm256_maskstore_ps(c_r, mask0, acc[r][0]);
+            _mm256_maskstore_ps(c_r + 8, mask1, acc[r][1]);
+        }
+    }
+}
+
+//This implementation is based on im2row and gemm where im2row writes the
+//patch matrix directly in packed A panel layout consumed by AVX2 microkernel.
+//With row major patch matrix, gemm packs it again in its own panel format so
+//every patch element is written twice, here it is written once.
+//Output pixels of whole batch are divided into CONV_PACKED_MC tiles, for each
+//tile and CONV_PACKED_KC slice of patch columns the packed block stays in L2
+//and B(filter) strip of CONV_PACKED_NR columns stays in L1.
+//I/p and o/p format will be NHWC and filter format is HWCN
+//Multi thread parallization happen at OMP level over output pixel tiles
+//Enabled with ZENDNN_CONV_PACKED_PATCH=1
+void zenConvolution2DsmallGemmPacked(
+    zendnnEnv zenEnvObj,
+    const float *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const float *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    float *out_layer,
+    const int out_height,
+    const int out_width,
+    const bool relu,
+    const bool sum_fused,
+    const float *scale,
+    const float *elementwise_input,
+    const bool concat,
+    const int filter_offset,
+    const int total_filters
+) {
+    unsigned int ldc = no_of_filter;
+    if (concat) {
+        ldc = total_filters;
+    }
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    int K = kernel_h*kernel_w*channels;
+    unsigned long total_rows = (unsigned long)images*out_height*out_width;
+    unsigned long tile_count = (total_rows + CONV_PACKED_MC - 1)/CONV_PACKED_MC;
+    if (thread_qty > tile_count) {
+        thread_qty = tile_count;
+    }
+
+    zendnnInfo(ZENDNN_ALGOLOG, "zenConvolution2DsmallGemmPacked, no_of_images=",
+               images, " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " stride_h=", stride_h, " stride_w=", stride_w, " tile_count=", tile_count,
+               " thread_qty=", thread_qty);
+
+    //Packed block of MC patches x KC columns per thread
+    unsigned long block_size = (unsigned long)CONV_PACKED_MC*CONV_PACKED_KC;
+    float *data_col = (float *)aligned_alloc(ALIGNED_OFFSET,
+                      sizeof(float)*block_size*thread_qty);
+    if (data_col == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DsmallGemmPacked Memory Error while allocating patch matrix");
+        return;
+    }
+
+    omp_set_max_active_levels(1);
+    #pragma omp parallel num_threads(thread_qty)
+    {
+        float *block = data_col + block_size*omp_get_thread_num();
+
+        #pragma omp for
+        for (unsigned long tile = 0; tile < tile_count; tile++) {
+            unsigned long row_start = tile*CONV_PACKED_MC;
+            int rows = total_rows - row_start < CONV_PACKED_MC ? total_rows - row_start :
+                       CONV_PACKED_MC;
+            unsigned long outputOffset = row_start*ldc + filter_offset;
+            float *out_tile = out_layer + outputOffset;
+
+            for (int k_start = 0; k_start < K; k_start += CONV_PACKED_KC) {
+                int kc = K - k_start < CONV_PACKED_KC ? K - k_start : CONV_PACKED_KC;
+                //sum post-op accumulates first slice to existing output
+                bool accumulate = sum_fused || k_start > 0;
+                im2rowNHWCpacked(in_layer, channels, height, width, kernel_h, kernel_w,
+                                 pad_t, pad_l, stride_h, stride_w, out_height, out_width,
+                                 row_start, rows, k_start, kc, CONV_PACKED_MR, block);
+
+                const float *b_slice = filter + (unsigned long)k_start*no_of_filter;
+                for (int n = 0; n < no_of_filter; n += CONV_PACKED_NR) {
+                    int nr = no_of_filter - n < CONV_PACKED_NR ? no_of_filter - n :
+                             CONV_PACKED_NR;
+                    for (int m = 0; m < rows; m += CONV_PACKED_MR) {
+                        int mr = rows - m < CONV_PACKED_MR ? rows - m : CONV_PACKED_MR;
+                        const float *a_panel = block + (unsigned long)m*kc;
+                        float *c = out_tile + (unsigned long)m*ldc + n;
+                        if (nr == CONV_PACKED_NR) {
+                            zenPackedGemmKernel<true>(kc, a_panel, b_slice + n, no_of_filter,
+                                                      c, ldc, mr, nr, accumulate);
+                        }
+                        else {
+                            zenPackedGemmKernel<false>(kc, a_panel, b_slice + n, no_of_filter,
+                                                       c, ldc, mr, nr, accumulate);
+                        }
+                    }
+                }
+            }
+            //Output tile is still in cache
+            zenPostOps(zenEnvObj, out_layer, elementwise_input, rows, 1, no_of_filter,
+                       ldc, outputOffset, bias, relu, 0, scale, 1);
+        }
+    }
+    free(data_col);
+}
+
+
+//Waits till counter reaches at least target, spins with pause and yields
+//the core when the other stage of pipeline is slow
+static inline void zenPipelineWait(const std::atomic<long> &counter,
+                                   const long target) {
+    int spin = 0;
+    while (counter.load(std::memory_order_acquire) < target) {
+        _mm_pause();
+        if (++spin == CONV_PIPELINE_SPIN_COUNT) {
+            spin = 0;
+            sched_yield();
+        }
+    }
+}
+
+//This implementation is based on im2row and gemm(BLIS) with im2row and gemm
+//overlapped in a software pipeline.
+//Threads are paired, in each pair the producer thread builds patch matrix of
+//a band of output rows while the consumer thread runs gemm and post-ops on the
+//previous band. Patch tiles are double buffered and sized to stay in L2.
+//With OMP_PLACES=cores, pair of threads are bound to the same core (proc_bind
+//close), so one SMT sibling forms patches while the other computes.
+//Work(image, band of output rows) is distributed round robin over pairs.
+//I/p and o/p format will be NHWC and filter format is HWCN
+//Enabled with ZENDNN_CONV_PIPELINE=1
+void zenConvolution2DsmallGemmPipelined(
+    zendnnEnv zenEnvObj,
+    const float *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const float *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    float *out_layer,
+    const int out_height,
+    const int out_width,
+    const bool relu,
+    const bool sum_fused,
+    const float *scale,
+    const float *elementwise_input,
+    const bool concat,
+    const int filter_offset,
+    const int total_filters
+) {
+    float gemm_beta = 0.0;
+    if (sum_fused) {
+        gemm_beta = 1.0;
+    }
+
+    unsigned int ldc = no_of_filter;
+    if (concat) {
+        ldc = total_filters;
+    }
+
+    //Patch tile is a band of complete output rows
+    int K = kernel_h*kernel_w*channels;
+    unsigned long row_size = (unsigned long)out_width*K;
+    int band_rows = CONV_PIPELINE_TILE_SIZE/(row_size*sizeof(float));
+    band_rows = band_rows < 1 ? 1 : band_rows;
+    band_rows = band_rows > out_height ? out_height : band_rows;
+    int bands = (out_height + band_rows - 1)/band_rows;
+    long work_count = (long)images*bands;
+
+    unsigned int pipelines = zenEnvObj.omp_num_threads/2;
+    pipelines = pipelines < 1 ? 1 : pipelines;
+    if (pipelines > work_count) {
+        pipelines = work_count;
+    }
+
+    zendnnInfo(ZENDNN_ALGOLOG, "zenConvolution2DsmallGemmPipelined, no_of_images=",
+               images, " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " stride_h=", stride_h, " stride_w=", stride_w, " band_rows=", band_rows,
+               " pipelines=", pipelines);
+
+    //Keep each tile aligned
+    unsigned long tile_size = band_rows*row_size;
+    tile_size = ((tile_size*sizeof(float) + ALIGNED_OFFSET - 1)/ALIGNED_OFFSET)*
+                ALIGNED_OFFSET/sizeof(float);
+    float *data_col = (float *)aligned_alloc(ALIGNED_OFFSET,
+                      sizeof(float)*tile_size*2*pipelines);
+    if (data_col == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DsmallGemmPipelined Memory Error while allocating patch matrix");
+        return;
+    }
+
+    //Per pipeline count of bands produced(patch ready) and consumed(tile free)
+    std::vector<std::atomic<long>> pipe_state(2*pipelines*
+                                              CONV_PIPELINE_STATE_STRIDE);
+    for (auto &state : pipe_state) {
+        state.store(0, std::memory_order_relaxed);
+    }
+
+    unsigned long image_size = (unsigned long)channels*height*width;
+    unsigned long out_image_size = (unsigned long)ldc*out_height*out_width;
+
+    omp_set_max_active_levels(1);
+    #pragma omp parallel num_threads(2*pipelines) proc_bind(close)
+    {
+        //Team can be smaller than requested(OMP_THREAD_LIMIT, OMP_DYNAMIC,
+        //nested call), pairs are formed from threads actually running. A
+        //single thread runs both stages of every band itself, an odd last
+        //thread is left idle.
+        unsigned int team_pipelines = omp_get_num_threads()/2;
+        bool serial = team_pipelines == 0;
+        if (serial) {
+            team_pipelines = 1;
+        }
+        if (team_pipelines < pipelines && omp_get_thread_num() == 0) {
+            zendnnInfo(ZENDNN_ALGOLOG,
+                       "zenConvolution2DsmallGemmPipelined, team of ", omp_get_num_threads(),
+                       " threads runs ", team_pipelines, " pipelines");
+        }
+        unsigned int pipe = omp_get_thread_num()/2;
+        bool producer = serial || (omp_get_thread_num()%2) == 0;
+        bool consumer = serial || (omp_get_thread_num()%2) == 1;
+        if (pipe >= team_pipelines) {
+            producer = consumer = false;
+        }
+        std::atomic<long> &produced = pipe_state[2*pipe*CONV_PIPELINE_STATE_STRIDE];
+        std::atomic<long> &consumed = pipe_state[(2*pipe + 1)*
+                                                 CONV_PIPELINE_STATE_STRIDE];
+        float *tiles[2] = {data_col + 2*pipe*tile_size,
+                           data_col + (2*pipe + 1)*tile_size
+                          };
+#if BLIS_EXPERT
+        blis_expert blis_obj(1, BLIS_NO_TRANSPOSE, BLIS_NO_TRANSPOSE);
+        bli_setsc(gemm_beta, 0.0, &blis_obj.beta);
+#endif
+        long seq = 0;
+        for (long item = pipe; (producer || consumer) && item < work_count;
+                item += team_pipelines, seq++) {
+            int image = item/bands;
+            int row_start = (item%bands)*band_rows;
+            int rows = out_height - row_start < band_rows ? out_height - row_start :
+                       band_rows;
+            float *tile = tiles[seq%2];
+
+            if (producer) {
+                //Tile is free once consumer is done with band (seq - 2)
+                zenPipelineWait(consumed, seq - 1);
+                for (int r = 0; r < rows; r++) {
+                    im2rowNHWCrow(in_layer + image*image_size, channels, height, width,
+                                  kernel_h, kernel_w, pad_l, stride_w,
+                                  (row_start + r)*stride_h - pad_t, out_width, tile + r*row_size);
+                }
+                produced.store(seq + 1, std::memory_order_release);
+            }
+            if (consumer) {
+                zenPipelineWait(produced, seq + 1);
+                unsigned long outputOffset = image*out_image_size +
+                                             (unsigned long)row_start*out_width*ldc + filter_offset;
+#if BLIS_EXPERT
+                bli_obj_create_with_attached_buffer(blis_obj.dt, out_width*rows, K,
+                                                    tile, K, 1, &blis_obj.a);
+                bli_obj_create_with_attached_buffer(blis_obj.dt, K, no_of_filter,
+                                                    (void *)filter, no_of_filter, 1, &blis_obj.b);
+                bli_obj_create_with_attached_buffer(blis_obj.dt, out_width*rows,
+                                                    no_of_filter,
+                                                    out_layer + outputOffset, ldc, 1, &blis_obj.c);
+                bli_gemm_ex(&blis_obj.alpha, &blis_obj.a, &blis_obj.b, &blis_obj.beta,
+                            &blis_obj.c, NULL, &blis_obj.rntm);
+#else
+                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, out_width*rows,
+                            no_of_filter, K, 1.0f, tile, K, filter, no_of_filter, gemm_beta,
+                            out_layer + outputOffset, ldc);
+#endif
+                zenPostOps(zenEnvObj, out_layer, elementwise_input, out_width, rows,
+                           no_of_filter, ldc, outputOffset, bias, relu, 0, scale, 1);
+                consumed.store(seq + 1, std::memory_order_release);
+            }
+        }
+    }
+    free(data_col);
+}
+
+
 //This implementation is based on im2col and gemm(BLIS) where im2col is performed on input
 //images/featureMap one by one followed by gemm call to blis which computes the feature map for the i/p image
 //and then add bias value on it.
@@ -2930,30 +3284,10 @@ void zenConvolution2DsmallGemmMergeLatency(
         //Im2row tranformation
         for (int j = 0; j < mergeChunkSize; ++j) {
             h = i*mergeFactor + j;
-            int w_pad = -pad_l;
             h_pad = -pad_t + (h * stride_h);
-            for (int w = 0; w < width_col; ++w) {
-                for (int ih = h_pad; ih < h_pad + kernel_h; ++ih) {
-                    for (int iw = w_pad; iw < w_pad + kernel_w; ++iw) {
-                        if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                            int offset = (ih * width + iw) * channels;
-                            #pragma omp simd
-                            for (int k=0; k<channels; k++) {
-                                data_col[k] = in_layer[offset + k];
-                            }
-                        }
-                        else {
-                            // This should be simply padded with zero.
-                            #pragma omp simd
-                            for (int k=0; k<channels; k++) {
-                                data_col[k] = 0;
-                            }
-                        }
-                        data_col += channels;
-                    }
-                }
-                w_pad += stride_w;
-            }
+            im2rowNHWCrow(in_layer, channels, height, width, kernel_h, kernel_w, pad_l,
+                          stride_w, h_pad, width_col, data_col);
+            data_col += (unsigned long)width_col*kernel_h*kernel_w*channels;
             if (j == (mergeChunkSize-1)) {
                 unsigned int outOffset = (ldc*width_col*(h-(mergeChunkSize-1)) + filter_offset);
 #if BLIS_EXPERT
@@ -3035,7 +3369,15 @@ void zenConvolution2Dgemm(
     struct timeval start, end;
     gettimeofday(&start, 0);
 
-    if (batchsize > 1) {
+    if (channels <= CONV_DIRECT_LOW_IC) {
+        //Low input channel(first layer) convolution for both BS paths
+        zenConvolution2DDirectLowIC(zenEnvObj, in_layer, batchsize, channels, height,
+                                    width, filter, no_of_filter,
+                                    kernel_h, kernel_w, pad_t, pad_l, pad_b, pad_r, stride_h, stride_w, bias,
+                                    out_layer, out_height, out_width, relu, sum_fused, scale, elementwise_input,
+                                    concat, filter_offset, total_filters, NULL);
+    }
+    else if (batchsize > 1) {
         //Throughput path BS > 1
 #if DIRECT_CONV_GEMV
         //This is direct convolution which is GEMV and sdot base...currently not optimized
@@ -3094,7 +3436,24 @@ void zenConvolution2Dgemm(
         }
         else
 #endif
-            if ((kernel_h != 1 && kernel_w != 1 && out_height*out_width >= no_of_filter)) {
+            if (zenEnvObj.zenConvPackedPatch && !(kernel_h == 1 && kernel_w == 1)) {
+                //Patch matrix is written once, in gemm packed layout
+                zenConvolution2DsmallGemmPacked(zenEnvObj, in_layer, batchsize, channels,
+                                                height, width, filter, no_of_filter,
+                                                kernel_h, kernel_w, pad_t, pad_l, pad_b, pad_r, stride_h, stride_w, bias,
+                                                out_layer, out_height, out_width, relu, sum_fused, scale, elementwise_input,
+                                                concat, filter_offset, total_filters);
+            }
+            else if (zenEnvObj.zenConvPipeline && zenEnvObj.omp_num_threads > 1 &&
+                    !(kernel_h == 1 && kernel_w == 1)) {
+                //Overlaps patch matrix formation with gemm on paired threads
+                zenConvolution2DsmallGemmPipelined(zenEnvObj, in_layer, batchsize, channels,
+                                                   height, width, filter, no_of_filter,
+                                                   kernel_h, kernel_w, pad_t, pad_l, pad_b, pad_r, stride_h, stride_w, bias,
+                                                   out_layer, out_height, out_width, relu, sum_fused, scale, elementwise_input,
+                                                   concat, filter_offset, total_filters);
+            }
+            else if ((kernel_h != 1 && kernel_w != 1 && out_height*out_width >= no_of_filter)) {
                 //This ALGO performs best when input height and width > 20
                 //For height and width < 20, spiltting adds overhead for GEMM calls(causes more GEMM calls on samll sizes)
                 zenConvolution2DsmallGemmSplit(zenEnvObj, in_layer, batchsize, channels, height,
@@ -3103,6 +3462,16 @@ void zenConvolution2Dgemm(
                                                out_layer, out_height, out_width, relu, sum_fused, scale, elementwise_input,
                                                concat, filter_offset, total_filters);
             }
+            else if ((kernel_h == 1 && kernel_w == 1) && !(out_height == height &&
+                     out_width == width)) {
+                //This Algo handles strided/padded 1x1 kernel where GEMM reads
+                //strided input directly and patch matrix formation is not required
+                zenConvolution2DGemm1x1Strided(zenEnvObj, in_layer, batchsize, channels, height,
+                                               width, filter, no_of_filter,
+                                               kernel_h, kernel_w, pad_t, pad_l, pad_b, pad_r, stride_h, stride_w, bias,
+                                               out_layer, out_height, out_width, relu, sum_fused, scale, elementwise_input,
+                                               concat, filter_offset, total_filters);
+            }
 #if 0
         //This Algo handles 1x1 kernel where patch matrix formation is not required
             else if ((kernel_h == 1 && kernel_w == 1 &&  out_height == height &&
@@ -3172,6 +3541,13 @@ void zenConvolution2Dgemm(
                                               out_layer, out_height, out_width, relu, sum_fused, scale, elementwise_input,
                                               concat, filter_offset, total_filters);
 
+        else if (kernel_h == 1 && kernel_w == 1)
+            //This Algo handles strided/padded 1x1 kernel without patch matrix
+            zenConvolution2DGemm1x1Strided(zenEnvObj, in_layer, batchsize, channels, height,
+                                           width, filter, no_of_filter,
+                                           kernel_h, kernel_w, pad_t, pad_l, pad_b, pad_r, stride_h, stride_w, bias,
+                                           out_layer, out_height, out_width, relu, sum_fused, scale, elementwise_input,
+                                           concat, filter_offset, total_filters);
         else if (0)
             //TODO: Need to try zenConvolution2DsmallGemmSplitLatency if i/p height or width > 300
             zenConvolution2DsmallGemmSplitLatency(zenEnvObj, in_layer, batchsize, channels,
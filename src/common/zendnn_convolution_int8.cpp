@@ -0,0 +1,466 @@
+﻿/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <omp.h>
+#include <string.h>
+#include <math.h>
+#include <immintrin.h>
+#include <limits>
+#include <sys/sysinfo.h>
+#include <time.h>
+#include <sys/time.h>
+#include "cpu/x64/cpu_isa_traits.hpp"
+#include "zendnn_private.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+using namespace zendnn;
+
+//Patch tile(u8) per thread is sized to stay in L2 while all output channel
+//blocks are computed for it.
+//TODO: Read cache info from underlying platform and decide this value.
+#define INT8_CONV_L2_SIZE       (256*1024)
+//Register blocking of int8 micro kernel: INT8_CONV_MR output pixels x
+//INT8_CONV_NR output channels(2 ymm) of s32 accumulators
+#define INT8_CONV_MR            4
+#define INT8_CONV_NR            16
+
+//AVX2: filter is packed as [K4/2][N16][2] int16, u8 x s8 products of two
+//consecutive K are summed in s32 by vpmaddwd without any saturation.
+static void zenInt8PackFilterAvx2(const int8_t *filter, const int K,
+                                  const int N, const int K4, const int N16, int16_t *packed) {
+    memset(packed, 0, sizeof(int16_t)*K4*N16);
+    #pragma omp parallel for
+    for (int k = 0; k < K; k++) {
+        for (int n = 0; n < N; n++) {
+            packed[((unsigned long)(k/2)*N16 + n)*2 + k%2] = filter[(unsigned long)k*N + n];
+        }
+    }
+}
+
+//VNNI: filter is packed as [K4/4][N16][4] s8, one s32 lane holds four
+//consecutive K of one output channel as consumed by vpdpbusd.
+static void zenInt8PackFilterVnni(const int8_t *filter, const int K,
+                                  const int N, const int K4, const int N16, int8_t *packed) {
+    memset(packed, 0, sizeof(int8_t)*K4*N16);
+    #pragma omp parallel for
+    for (int k = 0; k < K; k++) {
+        for (int n = 0; n < N; n++) {
+            packed[((unsigned long)(k/4)*N16 + n)*4 + k%4] = filter[(unsigned long)k*N + n];
+        }
+    }
+}
+
+//acc[MR][INT8_CONV_NR] = a[MR][K4](u8) * b[K4][INT8_CONV_NR](s8)
+template <int MR>
+static inline void zenInt8KernelAvx2(const uint8_t *a, const int lda,
+                                     const int16_t *b, const int K4, const int N16, int32_t *acc) {
+    __m256i c[MR][2];
+    for (int r = 0; r < MR; r++) {
+        c[r][0] = _mm256_setzero_si256();
+        c[r][1] = _mm256_setzero_si256();
+    }
+    for (int k = 0; k < K4; k += 2) {
+        const int16_t *bk = b + (unsigned long)(k/2)*N16*2;
+        __m256i b0 = _mm256_loadu_si256((const __m256i *)bk);
+        __m256i b1 = _mm256_loadu_si256((const __m256i *)(bk + 16));
+        for (int r = 0; r < MR; r++) {
+            const uint8_t *ak = a + (unsigned long)r*lda + k;
+            __m256i av = _mm256_set1_epi32(ak[0] | (ak[1] << 16));
+            c[r][0] = _mm256_add_epi32(c[r][0], _mm256_madd_epi16(av, b0));
+            c[r][1] = _mm256_add_epi32(c[r][1], _mm256_madd_epi16(av, b1));
+        }
+    }
+    for (int r = 0; r < MR; r++) {
+        _mm256_storeu_si256((__m256i *)(acc + r*INT8_CONV_NR), c[r][0]);
+        _mm256_storeu_si256((__m256i *)(acc + r*INT8_CONV_NR + 8), c[r][1]);
+    }
+}
+
+template <int MR>
+__attribute__((target("avx512f,avx512bw,avx512vl,avx512vnni")))
+static void zenInt8KernelVnni(const uint8_t *a, const int lda,
+                              const int8_t *b, const int K4, const int N16, int32_t *acc) {
+    __m256i c[MR][2];
+    for (int r = 0; r < MR; r++) {
+        c[r][0] = _mm256_setzero_si256();
+        c[r][1] = _mm256_setzero_si256();
+    }
+    for (int k = 0; k < K4; k += 4) {
+        const int8_t *bk = b + (unsigned long)(k/4)*N16*4;
+        __m256i b0 = _mm256_loadu_si256((const __m256i *)bk);
+        __m256i b1 = _mm256_loadu_si256((const __m256i *)(bk + 32));
+        for (int r = 0; r < MR; r++) {
+            int32_t a4;
+            memcpy(&a4, a + (unsigned long)r*lda + k, sizeof(int32_t));
+            __m256i av = _mm256_set1_epi32(a4);
+            c[r][0] = _mm256_dpbusd_epi32(c[r][0], av, b0);
+            c[r][1] = _mm256_dpbusd_epi32(c[r][1], av, b1);
+        }
+    }
+    for (int r = 0; r < MR; r++) {
+        _mm256_storeu_si256((__m256i *)(acc + r*INT8_CONV_NR), c[r][0]);
+        _mm256_storeu_si256((__m256i *)(acc + r*INT8_CONV_NR + 8), c[r][1]);
+    }
+}
+
+template <int MR>
+static inline void zenInt8Kernel(const bool vnni, const uint8_t *a,
+                                 const int lda, const void *b, const int K4, const int N16, int32_t *acc) {
+    if (vnni) {
+        zenInt8KernelVnni<MR>(a, lda, (const int8_t *)b, K4, N16, acc);
+    }
+    else {
+        zenInt8KernelAvx2<MR>(a, lda, (const int16_t *)b, K4, N16, acc);
+    }
+}
+
+//Requantize s32 accumulators of one output pixel:
+//dst = saturate(round(relu(acc*scale + shift + sum_scale*dst)))
+template <typename dst_t>
+static inline void zenInt8Requantize(const int32_t *acc, const int n_count,
+                                     const float *scale, const float *shift, const float sum_scale,
+                                     const bool relu, const float lower, const float upper, dst_t *dst) {
+    #pragma omp simd
+    for (int n = 0; n < n_count; n++) {
+        float out = acc[n]*scale[n] + shift[n];
+        if (sum_scale != 0.0f) {
+            out += sum_scale*dst[n];
+        }
+        if (relu && out < 0.0f) {
+            out = 0.0f;
+        }
+        out = out < lower ? lower : out;
+        out = out > upper ? upper : out;
+        dst[n] = (dst_t)nearbyintf(out);
+    }
+}
+
+//This implementation is based on im2row and int8 gemm(u8s8s32).
+//Output pixels of whole batch are divided into tiles, for each tile the u8
+//patch matrix is built in a per thread buffer sized to L2 and multiplied with
+//the packed s8 filter. s32 accumulators are requantized to u8/s8 right in
+//registers with fused per channel scale, bias, zero-point compensation, sum
+//and ReLU, so no s32 output is written to memory.
+//Padding is filled with src_zero_point so compensation is uniform for all
+//output pixels.
+//VNNI(vpdpbusd) is used where available, AVX2 falls back to vpmaddwd.
+//I/p and o/p format will be NHWC and filter format is HWCN
+//Multi thread parallization happen at OMP level over output pixel tiles
+template <typename dst_t>
+static void zenConvolution2DInt8Ver1(
+    zendnnEnv zenEnvObj,
+    const uint8_t *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const void *packed_filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int stride_h,
+    const int stride_w,
+    const float *scale,
+    const float *shift,
+    const int src_zero_point,
+    const bool relu,
+    const float sum_scale,
+    dst_t *out_layer,
+    const int out_height,
+    const int out_width,
+    const int filter_offset,
+    const int total_filters
+) {
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    bool vnni = impl::cpu::x64::mayiuse(impl::cpu::x64::avx512_core_vnni);
+    const float lower = (float)std::numeric_limits<dst_t>::lowest();
+    const float upper = (float)std::numeric_limits<dst_t>::max();
+
+    int K = kernel_h*kernel_w*channels;
+    int K4 = ((K + 3)/4)*4;
+    int N16 = ((no_of_filter + INT8_CONV_NR - 1)/INT8_CONV_NR)*INT8_CONV_NR;
+
+    //Tile size in output pixels, such that patch tile fits in L2
+    unsigned long total_rows = (unsigned long)images*out_height*out_width;
+    unsigned long tile_rows = INT8_CONV_L2_SIZE/K4;
+    tile_rows = (tile_rows/INT8_CONV_MR)*INT8_CONV_MR;
+    tile_rows = tile_rows < INT8_CONV_MR ? INT8_CONV_MR : tile_rows;
+    //Keep all threads busy for smaller problem size
+    if (total_rows < tile_rows*thread_qty) {
+        tile_rows = (total_rows + thread_qty - 1)/thread_qty;
+        tile_rows = ((tile_rows + INT8_CONV_MR - 1)/INT8_CONV_MR)*INT8_CONV_MR;
+    }
+    unsigned long tile_count = (total_rows + tile_rows - 1)/tile_rows;
+    if (thread_qty > tile_count) {
+        thread_qty = tile_count;
+    }
+
+    uint8_t *patch_buf = (uint8_t *)aligned_alloc(ALIGNED_OFFSET,
+                         tile_rows*K4*thread_qty);
+    if (patch_buf == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DInt8Ver1 Memory Error while allocating patch matrix");
+        return;
+    }
+
+    zendnnInfo(ZENDNN_ALGOLOG, "zenConvolution2DInt8Ver1, vnni=", vnni,
+               " tile_rows=", tile_rows, " tile_count=", tile_count,
+               " thread_qty=", thread_qty);
+
+    unsigned long out_pixels = (unsigned long)out_height*out_width;
+    omp_set_max_active_levels(1);
+    #pragma omp parallel num_threads(thread_qty)
+    {
+        uint8_t *patch = patch_buf + tile_rows*K4*omp_get_thread_num();
+        int32_t acc[INT8_CONV_MR*INT8_CONV_NR];
+
+        #pragma omp for
+        for (unsigned long tile = 0; tile < tile_count; tile++) {
+            unsigned long row_start = tile*tile_rows;
+            unsigned long row_end = row_start + tile_rows;
+            row_end = row_end > total_rows ? total_rows : row_end;
+            int rows = row_end - row_start;
+
+            //u8 im2row, out of bound taps are src_zero_point
+            for (int m = 0; m < rows; m++) {
+                unsigned long pixel = row_start + m;
+                int image = pixel/out_pixels;
+                int oh = (pixel%out_pixels)/out_width;
+                int ow = (pixel%out_pixels)%out_width;
+                uint8_t *patch_row = patch + (unsigned long)m*K4;
+                for (int i = 0; i < kernel_h; i++) {
+                    int ih = oh*stride_h - pad_t + i;
+                    for (int j = 0; j < kernel_w; j++) {
+                        int iw = ow*stride_w - pad_l + j;
+                        uint8_t *dst = patch_row + (i*kernel_w + j)*channels;
+                        if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
+                            memcpy(dst, in_layer + (((unsigned long)image*height + ih)*width + iw)*
+                                   channels, channels);
+                        }
+                        else {
+                            memset(dst, src_zero_point, channels);
+                        }
+                    }
+                }
+                memset(patch_row + K, 0, K4 - K);
+            }
+
+            for (int n0 = 0; n0 < no_of_filter; n0 += INT8_CONV_NR) {
+                int n_count = no_of_filter - n0 < INT8_CONV_NR ? no_of_filter - n0 :
+                              INT8_CONV_NR;
+                const void *b = vnni ? (const void *)((const int8_t *)packed_filter + n0*4) :
+                                (const void *)((const int16_t *)packed_filter + n0*2);
+                for (int m0 = 0; m0 < rows; m0 += INT8_CONV_MR) {
+                    int mr = rows - m0 < INT8_CONV_MR ? rows - m0 : INT8_CONV_MR;
+                    const uint8_t *a = patch + (unsigned long)m0*K4;
+                    switch (mr) {
+                    case 4:
+                        zenInt8Kernel<4>(vnni, a, K4, b, K4, N16, acc);
+                        break;
+                    case 3:
+                        zenInt8Kernel<3>(vnni, a, K4, b, K4, N16, acc);
+                        break;
+                    case 2:
+                        zenInt8Kernel<2>(vnni, a, K4, b, K4, N16, acc);
+                        break;
+                    default:
+                        zenInt8Kernel<1>(vnni, a, K4, b, K4, N16, acc);
+                        break;
+                    }
+                    for (int r = 0; r < mr; r++) {
+                        dst_t *out = out_layer + (row_start + m0 + r)*total_filters +
+                                     filter_offset + n0;
+                        zenInt8Requantize(acc + r*INT8_CONV_NR, n_count, scale + n0,
+                                          shift + n0, sum_scale, relu, lower, upper, out);
+                    }
+                }
+            }
+        }
+    }
+    free(patch_buf);
+}
+
+//Packed filter is [K4][N16] s8(VNNI) or s16(AVX2) as consumed by
+//zenInt8Kernel, followed by s32 sum of each filter column used for src
+//zero-point compensation.
+static unsigned long zenInt8PackedWeightsBytes(const bool vnni, const int K4,
+        const int N16) {
+    unsigned long bytes = (unsigned long)K4*N16*(vnni ? sizeof(int8_t) :
+                          sizeof(int16_t));
+    return ((bytes + ALIGNED_OFFSET - 1)/ALIGNED_OFFSET)*ALIGNED_OFFSET;
+}
+
+unsigned long zenConvolution2DInt8FilterSize(
+    const int channels,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w
+) {
+    bool vnni = impl::cpu::x64::mayiuse(impl::cpu::x64::avx512_core_vnni);
+    int K = kernel_h*kernel_w*channels;
+    int K4 = ((K + 3)/4)*4;
+    int N16 = ((no_of_filter + INT8_CONV_NR - 1)/INT8_CONV_NR)*INT8_CONV_NR;
+    return zenInt8PackedWeightsBytes(vnni, K4, N16) + sizeof(int32_t)*N16;
+}
+
+void zenConvolution2DInt8FilterPack(
+    const int8_t *filter,
+    const int channels,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    void *packed_filter
+) {
+    bool vnni = impl::cpu::x64::mayiuse(impl::cpu::x64::avx512_core_vnni);
+    int K = kernel_h*kernel_w*channels;
+    int K4 = ((K + 3)/4)*4;
+    int N16 = ((no_of_filter + INT8_CONV_NR - 1)/INT8_CONV_NR)*INT8_CONV_NR;
+    if (vnni) {
+        zenInt8PackFilterVnni(filter, K, no_of_filter, K4, N16,
+                              (int8_t *)packed_filter);
+    }
+    else {
+        zenInt8PackFilterAvx2(filter, K, no_of_filter, K4, N16,
+                              (int16_t *)packed_filter);
+    }
+
+    int32_t *filter_sum = (int32_t *)((char *)packed_filter +
+                                      zenInt8PackedWeightsBytes(vnni, K4, N16));
+    #pragma omp parallel for
+    for (int r=0; r <no_of_filter; r++) {
+        int32_t sum = 0;
+        for (int k=0; k<K; k++) {
+            sum += filter[(unsigned long)k*no_of_filter + r];
+        }
+        filter_sum[r] = sum;
+    }
+}
+
+void zenConvolution2DInt8(
+    const uint8_t *in_layer,
+    const int batchsize,
+    const int channels,
+    const int height,
+    const int width,
+    const int8_t *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    const float *scale,
+    const int scale_count,
+    const int src_zero_point,
+    const float *bn_scale,
+    const float *bn_mean,
+    const float *bn_offset,
+    const bool relu,
+    const float sum_scale,
+    void *out_layer,
+    const bool out_signed,
+    const int out_height,
+    const int out_width,
+    const bool concat,
+    const int filter_offset,
+    const int total_filters,
+    const void *packed_filter
+) {
+    //TODO: perform other checks...eg. for all input dimansions
+    if ((in_layer == NULL)|| ((filter == NULL) && (packed_filter == NULL)) ||
+            (out_layer == NULL) || (scale == NULL)) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DInt8 Memory is not defined for in_layer or filter or out_layer or scale");
+        return;
+    }
+
+    //TODO: This should be part of zendnn initialization
+    zendnnEnv zenEnvObj = readEnv();
+
+    struct timeval start, end;
+    gettimeofday(&start, 0);
+
+    //Filter is packed per call unless caller passes it packed once by
+    //zenConvolution2DInt8FilterPack
+    void *own_packed = NULL;
+    if (packed_filter == NULL) {
+        own_packed = aligned_alloc(ALIGNED_OFFSET,
+                                   zenConvolution2DInt8FilterSize(channels, no_of_filter, kernel_h,
+                                           kernel_w));
+        if (own_packed == NULL) {
+            zendnnError(ZENDNN_ALGOLOG,
+                        "zenConvolution2DInt8 Memory Error while allocating packed filter");
+            return;
+        }
+        zenConvolution2DInt8FilterPack(filter, channels, no_of_filter, kernel_h,
+                                       kernel_w, own_packed);
+        packed_filter = own_packed;
+    }
+    bool vnni = impl::cpu::x64::mayiuse(impl::cpu::x64::avx512_core_vnni);
+    int K = kernel_h*kernel_w*channels;
+    int K4 = ((K + 3)/4)*4;
+    int N16 = ((no_of_filter + INT8_CONV_NR - 1)/INT8_CONV_NR)*INT8_CONV_NR;
+    const int32_t *filter_sum = (const int32_t *)((const char *)packed_filter +
+                                zenInt8PackedWeightsBytes(vnni, K4, N16));
+
+    //Fold bias, zero-point compensation and BatchNorm into per channel
+    //scale/shift applied on s32 accumulators
+    //dst = scale*(acc - src_zero_point*sum(filter) + bias)
+    float *scale_shift = (float *)malloc(sizeof(float)*2*no_of_filter);
+    if (scale_shift == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DInt8 Memory Error while allocating scale");
+        free(own_packed);
+        return;
+    }
+    float *eff_scale = scale_shift;
+    float *eff_shift = scale_shift + no_of_filter;
+    for (int r=0; r <no_of_filter; r++) {
+        float s = scale[scale_count > 1 ? r : 0];
+        float b = (bias != NULL) ? bias[r] : 0.0f;
+        eff_scale[r] = s;
+        eff_shift[r] = s*(b - (float)src_zero_point*filter_sum[r]);
+        if (bn_scale != NULL) {
+            eff_scale[r] = bn_scale[r]*eff_scale[r];
+            eff_shift[r] = bn_scale[r]*(eff_shift[r] - bn_mean[r]) + bn_offset[r];
+        }
+    }
+
+    int ldc = concat ? total_filters : no_of_filter;
+    int offset = concat ? filter_offset : 0;
+    if (out_signed) {
+        zenConvolution2DInt8Ver1(zenEnvObj, in_layer, batchsize, channels, height,
+                                 width, packed_filter, no_of_filter, kernel_h, kernel_w, pad_t, pad_l,
+                                 stride_h, stride_w, eff_scale, eff_shift, src_zero_point, relu,
+                                 sum_scale, (int8_t *)out_layer, out_height, out_width, offset, ldc);
+    }
+    else {
+        zenConvolution2DInt8Ver1(zenEnvObj, in_layer, batchsize, channels, height,
+                                 width, packed_filter, no_of_filter, kernel_h, kernel_w, pad_t, pad_l,
+                                 stride_h, stride_w, eff_scale, eff_shift, src_zero_point, relu,
+                                 sum_scale, (uint8_t *)out_layer, out_height, out_width, offset, ldc);
+    }
+    free(scale_shift);
+    free(own_packed);
+
+    gettimeofday(&end, 0);
+    float elapsed;
+    elapsed = timedifference_msec(start, end);
+    zendnnInfo(ZENDNN_PROFLOG, "zenConvolution2DInt8, no_of_images=", batchsize,
+               " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " pad_t=", pad_t, " pad_l=", pad_l,
+               " pad_b=", pad_b, " pad_r=", pad_r,
+               " stride_h=", stride_h, " stride_w=",stride_w,
+               " src_zero_point=", src_zero_point, " relu=", relu, " sum_scale=", sum_scale,
+               " batchNorm=", (bn_scale != NULL), " out_signed=", out_signed,
+               " prepacked=", (own_packed == NULL), " Time=", elapsed, "ms");
+}
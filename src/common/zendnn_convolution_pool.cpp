@@ -0,0 +1,347 @@
+﻿/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <omp.h>
+#include <string.h>
+#include <sys/sysinfo.h>
+#include <cblas.h>
+#include <time.h>
+#include <sys/time.h>
+#include "zendnn_private.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+using namespace zendnn;
+
+//L2 cache per core(512KB with ROME/MILAN), conv output band and its patch
+//matrix are sized to stay in this budget till they are pooled.
+//TODO: Read cache info from underlying platform and decide this value.
+#define CONV_POOL_L2_SIZE       (512*1024)
+
+//Pool conv output rows [conv_row_start, conv_row_start+conv_rows) held in
+//conv_band into pooled rows [pool_row_start, pool_row_end) of out_layer.
+//conv_band is NHWC with ldc=no_of_filter, out_layer points to current image.
+static void zenPoolConvBand(
+    const float *conv_band,
+    const int conv_row_start,
+    const int conv_rows,
+    const int conv_out_width,
+    const int no_of_filter,
+    const bool avg_pool,
+    const int pool_kernel_h,
+    const int pool_kernel_w,
+    const int pool_stride_h,
+    const int pool_stride_w,
+    const int pool_pad_t,
+    const int pool_pad_l,
+    float *out_layer,
+    const int pool_row_start,
+    const int pool_row_end,
+    const int out_width
+) {
+    for (int ph = pool_row_start; ph < pool_row_end; ph++) {
+        int h_start = ph*pool_stride_h - pool_pad_t;
+        int h_end = h_start + pool_kernel_h;
+        h_start = h_start < conv_row_start ? conv_row_start : h_start;
+        h_end = h_end > (conv_row_start + conv_rows) ? (conv_row_start + conv_rows) :
+                h_end;
+        for (int pw = 0; pw < out_width; pw++) {
+            int w_start = pw*pool_stride_w - pool_pad_l;
+            int w_end = w_start + pool_kernel_w;
+            w_start = w_start < 0 ? 0 : w_start;
+            w_end = w_end > conv_out_width ? conv_out_width : w_end;
+
+            float *tmp_output = out_layer + ((unsigned long)ph*out_width + pw)
+                                *no_of_filter;
+            if (avg_pool) {
+                #pragma omp simd
+                for (int k=0; k<no_of_filter; k++) {
+                    tmp_output[k] = 0;
+                }
+            }
+            else if (h_end <= h_start || w_end <= w_start) {
+                //Window lies entirely in padding, there is no element to
+                //take max of, output 0 instead of -FLT_MAX
+                #pragma omp simd
+                for (int k=0; k<no_of_filter; k++) {
+                    tmp_output[k] = 0;
+                }
+                continue;
+            }
+            else {
+                #pragma omp simd
+                for (int k=0; k<no_of_filter; k++) {
+                    tmp_output[k] = -FLT_MAX;
+                }
+            }
+            for (int ih = h_start; ih < h_end; ih++) {
+                const float *conv_row = conv_band + ((unsigned long)(ih - conv_row_start)*
+                                                     conv_out_width)*no_of_filter;
+                for (int iw = w_start; iw < w_end; iw++) {
+                    const float *conv_pixel = conv_row + (unsigned long)iw*no_of_filter;
+                    if (avg_pool) {
+                        #pragma omp simd
+                        for (int k=0; k<no_of_filter; k++) {
+                            tmp_output[k] += conv_pixel[k];
+                        }
+                    }
+                    else {
+                        #pragma omp simd
+                        for (int k=0; k<no_of_filter; k++) {
+                            tmp_output[k] = (tmp_output[k] > conv_pixel[k])?
+                                            tmp_output[k]:conv_pixel[k];
+                        }
+                    }
+                }
+            }
+            //Padding is excluded from average, same as avg_pooling
+            if (avg_pool) {
+                int avg_count = (h_end - h_start)*(w_end - w_start);
+                float avg_scale = avg_count > 0 ? 1.0f/avg_count : 0.0f;
+                #pragma omp simd
+                for (int k=0; k<no_of_filter; k++) {
+                    tmp_output[k] *= avg_scale;
+                }
+            }
+        }
+    }
+}
+
+//This implementation fuses convolution with following max/avg pooling.
+//Pooled output rows are divided into bands, for each band the conv output
+//rows required by its pooling windows are computed with im2row + gemm(BLIS)
+//into a per thread buffer sized to L2 and pooled right away. Only the pooled
+//tensor is written to memory, conv output never goes to DRAM.
+//Conv rows shared by two bands(pool_kernel_h > pool_stride_h) are recomputed.
+//I/p and o/p format will be NHWC and filter format is HWCN
+//Multi thread parallization happen at OMP level over (image, band)
+void zenConvolution2DwithPoolingVer1(
+    zendnnEnv zenEnvObj,
+    const float *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const float *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    const bool relu,
+    const int conv_out_height,
+    const int conv_out_width,
+    const bool avg_pool,
+    const int pool_kernel_h,
+    const int pool_kernel_w,
+    const int pool_stride_h,
+    const int pool_stride_w,
+    const int pool_pad_t,
+    const int pool_pad_l,
+    float *out_layer,
+    const int out_height,
+    const int out_width
+) {
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    bool patch_required = !(kernel_h == 1 && kernel_w == 1 &&
+                            stride_h == 1 && stride_w == 1 &&
+                            conv_out_height == height && conv_out_width == width);
+    int patch_width = kernel_h*kernel_w*channels;
+
+    //Band size in pooled rows, such that conv rows and its patch matrix fits
+    //in L2
+    unsigned long row_size = (unsigned long)conv_out_width*(no_of_filter +
+                             (patch_required ? patch_width : 0))*sizeof(float);
+    int conv_rows_fit = CONV_POOL_L2_SIZE/row_size;
+    int band_rows = (conv_rows_fit - pool_kernel_h)/pool_stride_h + 1;
+    band_rows = band_rows < 1 ? 1 : band_rows;
+    band_rows = band_rows > out_height ? out_height : band_rows;
+
+    //Keep all threads busy, split bands further for smaller batch size
+    int band_count = (out_height + band_rows - 1)/band_rows;
+    if ((unsigned long)images*band_count < thread_qty) {
+        int min_band_count = (thread_qty + images - 1)/images;
+        min_band_count = min_band_count > out_height ? out_height : min_band_count;
+        band_rows = (out_height + min_band_count - 1)/min_band_count;
+        band_count = (out_height + band_rows - 1)/band_rows;
+    }
+    int work_count = images*band_count;
+    if (thread_qty > work_count) {
+        thread_qty = work_count;
+    }
+
+    //Max no. of conv rows required by one band
+    int band_conv_rows = (band_rows - 1)*pool_stride_h + pool_kernel_h;
+    band_conv_rows = band_conv_rows > conv_out_height ? conv_out_height :
+                     band_conv_rows;
+    unsigned long conv_band_size = (unsigned long)band_conv_rows*conv_out_width*
+                                   no_of_filter;
+    unsigned long patch_band_size = patch_required ? (unsigned long)
+                                    band_conv_rows*conv_out_width*patch_width : 0;
+    unsigned long thread_buf_size = conv_band_size + patch_band_size;
+    //Keep per thread buffer aligned
+    thread_buf_size = ((thread_buf_size*sizeof(float) + ALIGNED_OFFSET - 1)/
+                       ALIGNED_OFFSET)*ALIGNED_OFFSET/sizeof(float);
+
+    float *data_buf = (float *)aligned_alloc(ALIGNED_OFFSET,
+                      thread_buf_size*thread_qty*sizeof(float));
+    if (data_buf == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DwithPoolingVer1 Memory Error while allocating conv band");
+        return;
+    }
+
+    zendnnInfo(ZENDNN_ALGOLOG, "zenConvolution2DwithPoolingVer1, band_rows=",
+               band_rows, " band_count=", band_count, " thread_qty=", thread_qty);
+
+    omp_set_max_active_levels(1);
+    #pragma omp parallel num_threads(thread_qty)
+    {
+        float *conv_band = data_buf + thread_buf_size*omp_get_thread_num();
+        float *patch_band = conv_band + conv_band_size;
+#if BLIS_EXPERT
+        //creating blis expert interface
+        blis_expert blis_obj(1, BLIS_NO_TRANSPOSE, BLIS_NO_TRANSPOSE);
+        bli_obj_create_with_attached_buffer(blis_obj.dt, patch_width,
+                                            no_of_filter,
+                                            (void *)filter, no_of_filter, 1, &blis_obj.b);
+#endif
+        #pragma omp for
+        for (int work = 0; work < work_count; work++) {
+            int image = work/band_count;
+            int pool_row_start = (work%band_count)*band_rows;
+            int pool_row_end = pool_row_start + band_rows;
+            pool_row_end = pool_row_end > out_height ? out_height : pool_row_end;
+
+            //Conv rows required by pooling windows of this band
+            int conv_row_start = pool_row_start*pool_stride_h - pool_pad_t;
+            int conv_row_end = (pool_row_end - 1)*pool_stride_h - pool_pad_t +
+                               pool_kernel_h;
+            conv_row_start = conv_row_start < 0 ? 0 : conv_row_start;
+            conv_row_end = conv_row_end > conv_out_height ? conv_out_height :
+                           conv_row_end;
+            int conv_rows = conv_row_end - conv_row_start;
+            if (conv_rows <= 0) {
+                conv_rows = 0;
+            }
+
+            unsigned long inputOffset = (unsigned long)height*width*channels*image;
+            const float *data_col = patch_band;
+            if (patch_required) {
+                im2rowNHWCsplit(in_layer + inputOffset, channels, height, width, kernel_h,
+                                kernel_w, pad_t, pad_l, pad_b, pad_r,
+                                stride_h, stride_w, patch_band, conv_rows, conv_row_start, 1);
+            }
+            else {
+                data_col = in_layer + inputOffset + (unsigned long)conv_row_start*width*
+                           channels;
+            }
+
+            if (conv_rows) {
+#if BLIS_EXPERT
+                bli_obj_create_with_attached_buffer(blis_obj.dt, conv_out_width*conv_rows,
+                                                    patch_width,
+                                                    (void *)data_col, patch_width, 1, &blis_obj.a);
+                bli_obj_create_with_attached_buffer(blis_obj.dt, conv_out_width*conv_rows,
+                                                    no_of_filter,
+                                                    conv_band, no_of_filter, 1, &blis_obj.c);
+                bli_gemm_ex(&blis_obj.alpha, &blis_obj.a, &blis_obj.b, &blis_obj.beta,
+                            &blis_obj.c, NULL, &blis_obj.rntm);
+#else
+                cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans,
+                            conv_out_width*conv_rows, no_of_filter, patch_width, 1.0f,
+                            data_col, patch_width, filter, no_of_filter, 0.0f,
+                            conv_band, no_of_filter);
+#endif
+                //Bias and ReLU are applied on conv band before pooling
+                zenPostOps(zenEnvObj, conv_band, NULL, conv_out_width, conv_rows,
+                           no_of_filter, no_of_filter, 0, bias, relu, 0, NULL, 1);
+            }
+
+            zenPoolConvBand(conv_band, conv_row_start, conv_rows, conv_out_width,
+                            no_of_filter, avg_pool, pool_kernel_h, pool_kernel_w,
+                            pool_stride_h, pool_stride_w, pool_pad_t, pool_pad_l,
+                            out_layer + (unsigned long)image*out_height*out_width*no_of_filter,
+                            pool_row_start, pool_row_end, out_width);
+        }
+    }
+    free(data_buf);
+}
+
+void zenConvolution2DwithPool(
+    const float *in_layer,
+    const int batchsize,
+    const int channels,
+    const int height,
+    const int width,
+    const float *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    const bool relu,
+    const int conv_out_height,
+    const int conv_out_width,
+    const bool avg_pool,
+    const int pool_kernel_h,
+    const int pool_kernel_w,
+    const int pool_stride_h,
+    const int pool_stride_w,
+    const int pool_pad_t,
+    const int pool_pad_l,
+    const int pool_pad_b,
+    const int pool_pad_r,
+    float *out_layer,
+    const int out_height,
+    const int out_width
+) {
+    //TODO: perform other checks...eg. for all input dimansions
+    if ((in_layer == NULL)|| (filter == NULL) || (out_layer == NULL)) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenConvolution2DwithPool Memory is not defined for in_layer or filter or out_layer");
+        return;
+    }
+
+    //TODO: This should be part of zendnn initialization
+    zendnnEnv zenEnvObj = readEnv();
+
+    struct timeval start, end;
+    gettimeofday(&start, 0);
+
+    zenConvolution2DwithPoolingVer1(zenEnvObj, in_layer, batchsize, channels,
+                                    height, width, filter, no_of_filter,
+                                    kernel_h, kernel_w, pad_t, pad_l, pad_b, pad_r, stride_h, stride_w,
+                                    bias, relu, conv_out_height, conv_out_width,
+                                    avg_pool, pool_kernel_h, pool_kernel_w,
+                                    pool_stride_h, pool_stride_w, pool_pad_t, pool_pad_l,
+                                    out_layer, out_height, out_width);
+
+    gettimeofday(&end, 0);
+    float elapsed;
+    elapsed = timedifference_msec(start, end);
+    zendnnInfo(ZENDNN_PROFLOG, "zenConvolution2DwithPool, no_of_images=", batchsize,
+               " channels=", channels, " height=", height, " width=", width,
+               " no_of_filter=", no_of_filter, " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " pad_t=", pad_t, " pad_l=", pad_l,
+               " pad_b=", pad_b, " pad_r=", pad_r,
+               " stride_h=", stride_h, " stride_w=",stride_w,
+               " relu=", relu, " avg_pool=", avg_pool,
+               " pool_kernel_h=", pool_kernel_h, " pool_kernel_w=", pool_kernel_w,
+               " pool_stride_h=", pool_stride_h, " pool_stride_w=", pool_stride_w,
+               " pool_pad_t=", pool_pad_t, " pool_pad_l=", pool_pad_l,
+               " pool_pad_b=", pool_pad_b, " pool_pad_r=", pool_pad_r,
+               " Time=", elapsed, "ms");
+}
@@ -48,6 +48,7 @@ const char *zendnn_dt2str(zendnn_data_type_t v) {
     if (v == zendnn_s32) return "s32";
     if (v == zendnn_s8) return "s8";
     if (v == zendnn_u8) return "u8";
+    if (v == zendnn_s64) return "s64";
     assert(!"unknown dt");
     return "unknown dt";
 }
@@ -857,6 +858,7 @@ const char *zendnn_alg_kind2str(zendnn_alg_kind_t v) {
     if (v == zendnn_convolution_ref) return "convolution_ref";
     if (v == zendnn_convolution_direct) return "convolution_direct";
     if (v == zendnn_convolution_winograd) return "convolution_winograd";
+    if (v == zendnn_convolution_fft) return "convolution_fft";
     if (v == zendnn_convolution_auto) return "convolution_auto";
     if (v == zendnn_deconvolution_direct) return "deconvolution_direct";
     if (v == zendnn_deconvolution_winograd) return "deconvolution_winograd";
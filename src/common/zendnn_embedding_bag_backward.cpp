@@ -0,0 +1,303 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <zendnn_private.hpp>
+#include <omp.h>
+#include <math.h>
+#include <algorithm>
+#include "zendnn_logging.hpp"
+
+using namespace zendnn;
+
+#define EMB_MODE_SUM            0
+#define EMB_MODE_MEAN           1
+
+#define EMB_OPT_SGD             0
+#define EMB_OPT_ADAGRAD         1
+#define EMB_OPT_ROWWISE_ADAGRAD 2
+
+//Buckets per thread, bucket k holds rows [k*rows/buckets, (k+1)*rows/buckets)
+#define EMB_GRAD_BUCKETS        8
+
+//Deduplicated gradient rows of an embedding bag batch.
+//Each non padding index i is a key (row << 32 | i), keys are bucketed by
+//row range and sorted within the bucket, so repeated rows are adjacent and
+//a row belongs to a single bucket. Buckets are processed by different
+//threads, gradient of a unique row is reduced once from diff_dst rows of
+//its bags and handed to row_fn(row, grad, unique position), so rows are
+//updated without atomics and without a dense gradient of the table.
+//Returns number of unique rows, -1 on error.
+template <typename F>
+static long emb_grad_rows(
+    const char *name,
+    const int rows,
+    const int dim,
+    const int *indices,
+    const int indices_size,
+    const int *offsets,
+    const int bags,
+    const float *weights,
+    const int mode,
+    const int padding_idx,
+    const float *diff_dst,
+    const int ldd,
+    F row_fn
+) {
+    zendnnEnv zenEnvObj = readEnv();
+    zendnnInfo(ZENDNN_ALGOLOG, name, ", rows=", rows, " dim=", dim,
+               " indices=", indices_size, " bags=", bags, " mode=", mode);
+
+    if (!indices || !offsets || !diff_dst || rows <= 0 || dim <= 0
+            || bags <= 0 || ldd < dim) {
+        zendnnError(ZENDNN_ALGOLOG, name,
+                    " Memory is not defined for indices or offsets or diff_dst or dims are invalid");
+        return -1;
+    }
+    if ((mode != EMB_MODE_SUM && mode != EMB_MODE_MEAN)
+            || (weights && mode != EMB_MODE_SUM)) {
+        zendnnError(ZENDNN_ALGOLOG, name, " unsupported mode ", mode,
+                    weights ? " with per sample weights" : "");
+        return -1;
+    }
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    if (thread_qty == 0) {
+        thread_qty = 1;
+    }
+    long buckets = (long)thread_qty*EMB_GRAD_BUCKETS;
+    if (buckets > rows) {
+        buckets = rows;
+    }
+
+    unsigned long *keys = (unsigned long *)malloc(sizeof(unsigned long)
+                          *indices_size);
+    int *bag_of = (int *)malloc(sizeof(int)*indices_size);
+    float *scale = (float *)malloc(sizeof(float)*indices_size);
+    long *bucket_first = (long *)calloc(buckets + 1, sizeof(long));
+    long *bucket_unique = (long *)calloc(buckets + 1, sizeof(long));
+    float *grad = (float *)malloc(sizeof(float)*thread_qty*dim);
+    auto free_all = [&]() {
+        free(keys);
+        free(bag_of);
+        free(scale);
+        free(bucket_first);
+        free(bucket_unique);
+        free(grad);
+    };
+    if ((indices_size && (!keys || !bag_of || !scale)) || !bucket_first
+            || !bucket_unique || !grad) {
+        zendnnError(ZENDNN_ALGOLOG, name,
+                    " Memory Error while allocating gradient rows");
+        free_all();
+        return -1;
+    }
+
+    omp_set_max_active_levels(1);
+
+    //bag and gradient scale of each index, mean is over non padding rows
+    #pragma omp parallel for num_threads(thread_qty)
+    for (int b = 0; b < bags; b++) {
+        int first = offsets[b];
+        int last = b < bags - 1 ? offsets[b + 1] : indices_size;
+        float bag_scale = 1.0f;
+        if (mode == EMB_MODE_MEAN) {
+            int valid = 0;
+            for (int i = first; i < last; i++) {
+                valid += indices[i] != padding_idx;
+            }
+            bag_scale = valid ? 1.0f/valid : 0.0f;
+        }
+        for (int i = first; i < last; i++) {
+            bag_of[i] = b;
+            scale[i] = weights ? weights[i] : bag_scale;
+        }
+    }
+
+    //bucket by row range, counting pass and scatter
+    for (int i = 0; i < indices_size; i++) {
+        int row = indices[i];
+        if (row == padding_idx) {
+            continue;
+        }
+        if (row < 0 || row >= rows) {
+            zendnnError(ZENDNN_ALGOLOG, name, " index ", row,
+                        " is out of range of ", rows, " rows");
+            free_all();
+            return -1;
+        }
+        bucket_first[(long)row*buckets/rows + 1]++;
+    }
+    for (long k = 0; k < buckets; k++) {
+        bucket_first[k + 1] += bucket_first[k];
+    }
+    for (int i = 0; i < indices_size; i++) {
+        int row = indices[i];
+        if (row == padding_idx) {
+            continue;
+        }
+        long k = (long)row*buckets/rows;
+        keys[bucket_first[k]++] = ((unsigned long)row << 32) | (unsigned)i;
+    }
+    for (long k = buckets; k > 0; k--) {
+        bucket_first[k] = bucket_first[k - 1];
+    }
+    bucket_first[0] = 0;
+
+    //sort each bucket and count its unique rows
+    #pragma omp parallel for num_threads(thread_qty) schedule(dynamic)
+    for (long k = 0; k < buckets; k++) {
+        std::sort(keys + bucket_first[k], keys + bucket_first[k + 1]);
+        long unique = 0;
+        for (long p = bucket_first[k]; p < bucket_first[k + 1]; p++) {
+            unique += p == bucket_first[k]
+                      || (keys[p] >> 32) != (keys[p - 1] >> 32);
+        }
+        bucket_unique[k + 1] = unique;
+    }
+    for (long k = 0; k < buckets; k++) {
+        bucket_unique[k + 1] += bucket_unique[k];
+    }
+
+    #pragma omp parallel num_threads(thread_qty)
+    {
+        float *g = grad + (long)omp_get_thread_num()*dim;
+        #pragma omp for schedule(dynamic)
+        for (long k = 0; k < buckets; k++) {
+            long position = bucket_unique[k];
+            long p = bucket_first[k];
+            while (p < bucket_first[k + 1]) {
+                int row = keys[p] >> 32;
+                for (int j = 0; j < dim; j++) {
+                    g[j] = 0.0f;
+                }
+                for (; p < bucket_first[k + 1]
+                        && (int)(keys[p] >> 32) == row; p++) {
+                    int i = keys[p] & 0xffffffffUL;
+                    const float *dd = diff_dst + (long)bag_of[i]*ldd;
+                    float s = scale[i];
+                    #pragma omp simd
+                    for (int j = 0; j < dim; j++) {
+                        g[j] += s*dd[j];
+                    }
+                }
+                row_fn(row, g, position++);
+            }
+        }
+    }
+
+    long unique = bucket_unique[buckets];
+    free_all();
+    return unique;
+}
+
+//Sparse gradient of embedding bag, unique rows in ascending order and
+//their gradients.
+int zenEmbeddingBagBackward(
+    const int rows,
+    const int dim,
+    const int *indices,
+    const int indices_size,
+    const int *offsets,
+    const int bags,
+    const float *weights,
+    const int mode,
+    const int padding_idx,
+    const float *diff_dst,
+    const int ldd,
+    int *rows_out,
+    float *grad_out
+) {
+    if (!rows_out || !grad_out) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenEmbeddingBagBackward Memory is not defined for rows_out or grad_out");
+        return -1;
+    }
+    return emb_grad_rows("zenEmbeddingBagBackward", rows, dim, indices,
+                         indices_size, offsets, bags, weights, mode,
+                         padding_idx, diff_dst, ldd,
+    [=](int row, const float *g, long position) {
+        rows_out[position] = row;
+        std::copy(g, g + dim, grad_out + position*dim);
+    });
+}
+
+//Embedding bag backward fused with sparse optimizer update, gradient of
+//a unique row is applied to table(and optimizer state) while it is hot in
+//cache and is never written to memory.
+int zenEmbeddingBagUpdate(
+    float *table,
+    const int rows,
+    const int dim,
+    const int *indices,
+    const int indices_size,
+    const int *offsets,
+    const int bags,
+    const float *weights,
+    const int mode,
+    const int padding_idx,
+    const float *diff_dst,
+    const int ldd,
+    const int optimizer,
+    const float lr,
+    const float eps,
+    float *state
+) {
+    if (!table || optimizer < EMB_OPT_SGD
+            || optimizer > EMB_OPT_ROWWISE_ADAGRAD
+            || (optimizer != EMB_OPT_SGD && !state)) {
+        zendnnError(ZENDNN_ALGOLOG, "zenEmbeddingBagUpdate optimizer ",
+                    optimizer, " is not supported or table or state is not defined");
+        return -1;
+    }
+
+    const char *name = "zenEmbeddingBagUpdate";
+    long unique;
+    if (optimizer == EMB_OPT_SGD) {
+        unique = emb_grad_rows(name, rows, dim, indices, indices_size,
+                               offsets, bags, weights, mode, padding_idx,
+                               diff_dst, ldd,
+        [=](int row, const float *g, long) {
+            float *t = table + (long)row*dim;
+            #pragma omp simd
+            for (int j = 0; j < dim; j++) {
+                t[j] -= lr*g[j];
+            }
+        });
+    }
+    else if (optimizer == EMB_OPT_ADAGRAD) {
+        unique = emb_grad_rows(name, rows, dim, indices, indices_size,
+                               offsets, bags, weights, mode, padding_idx,
+                               diff_dst, ldd,
+        [=](int row, const float *g, long) {
+            float *t = table + (long)row*dim;
+            float *s = state + (long)row*dim;
+            #pragma omp simd
+            for (int j = 0; j < dim; j++) {
+                s[j] += g[j]*g[j];
+                t[j] -= lr*g[j]/(sqrtf(s[j]) + eps);
+            }
+        });
+    }
+    else {
+        //one state value per row, accumulates mean of squared gradient
+        unique = emb_grad_rows(name, rows, dim, indices, indices_size,
+                               offsets, bags, weights, mode, padding_idx,
+                               diff_dst, ldd,
+        [=](int row, const float *g, long) {
+            float *t = table + (long)row*dim;
+            float sq = 0.0f;
+            #pragma omp simd reduction(+:sq)
+            for (int j = 0; j < dim; j++) {
+                sq += g[j]*g[j];
+            }
+            state[row] += sq/dim;
+            float step = lr/(sqrtf(state[row]) + eps);
+            #pragma omp simd
+            for (int j = 0; j < dim; j++) {
+                t[j] -= step*g[j];
+            }
+        });
+    }
+    return (int)unique;
+}
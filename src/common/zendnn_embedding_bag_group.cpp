@@ -0,0 +1,163 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <zendnn_private.hpp>
+#include <omp.h>
+#include "zendnn_logging.hpp"
+#include "cpu/embedding_bag_kernels.hpp"
+
+using namespace zendnn;
+using zendnn::impl::cpu::emb_bag_kernel_t;
+using zendnn::impl::cpu::get_emb_bag_kernel;
+
+#define EMB_MODE_SUM            0
+#define EMB_MODE_MEAN           1
+#define EMB_MODE_MAX            2
+
+//Grouped embedding bag for DLRM style models, all tables of the group are
+//looked up in a single OMP parallel region instead of one primitive
+//execution(and one parallel region) per table.
+//Tables share the batch, bag b of table t is written to
+//out_layer[b*ldo + column offset of t ... + dim_Array[t]) where column offset
+//of t is sum of dim_Array of previous tables, so output is the concatenated
+//layout consumed by interaction layer. ldo >= sum of dim_Array, it allows
+//the caller to leave room for dense features in the same buffer.
+//Work item is (table, bag), items are ordered table major so a thread mostly
+//walks bags of a single table.
+//idx_t is index and offset type, int or int64_t.
+template <typename idx_t>
+static void zenGroupEmbeddingBagImpl(
+    const int table_count,
+    const float **table_Array,
+    const int *dim_Array,
+    const idx_t **indices_Array,
+    const int *indices_size_Array,
+    const idx_t **offsets_Array,
+    const float **weights_Array,
+    const int *mode_Array,
+    const int *padding_idx_Array,
+    const int bags,
+    float *out_layer,
+    const int ldo
+) {
+    zendnnEnv zenEnvObj = readEnv();
+    zendnnInfo(ZENDNN_ALGOLOG, "zenGroupEmbeddingBag, table_count=",
+               table_count, " bags=", bags, " ldo=", ldo);
+
+    if (!table_Array || !dim_Array || !indices_Array || !indices_size_Array
+            || !offsets_Array || !mode_Array || !out_layer) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenGroupEmbeddingBag Memory is not defined for tables or indices or offsets or out_layer");
+        return;
+    }
+
+    //Column offset of each table in concatenated output and its kernel
+    int *column_offset = (int *)malloc(sizeof(int)*table_count);
+    emb_bag_kernel_t<float, float, idx_t> *kernel =
+        (emb_bag_kernel_t<float, float, idx_t> *)
+        malloc(sizeof(emb_bag_kernel_t<float, float, idx_t>)*table_count);
+    if (column_offset == NULL || kernel == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenGroupEmbeddingBag Memory Error while allocating column offsets");
+        free(column_offset);
+        free(kernel);
+        return;
+    }
+    int total_dim = 0;
+    for (int t = 0; t < table_count; t++) {
+        bool weighted = weights_Array && weights_Array[t];
+        if (mode_Array[t] < EMB_MODE_SUM || mode_Array[t] > EMB_MODE_MAX
+                || (weighted && mode_Array[t] != EMB_MODE_SUM)) {
+            zendnnError(ZENDNN_ALGOLOG, "zenGroupEmbeddingBag table ", t,
+                        " unsupported mode ", mode_Array[t],
+                        weighted ? " with per sample weights" : "");
+            free(column_offset);
+            free(kernel);
+            return;
+        }
+        kernel[t] = get_emb_bag_kernel<float, float, idx_t>(
+                        mode_Array[t] == EMB_MODE_MAX, weighted);
+        column_offset[t] = total_dim;
+        total_dim += dim_Array[t];
+    }
+    if (ldo < total_dim) {
+        zendnnError(ZENDNN_ALGOLOG, "zenGroupEmbeddingBag ldo=", ldo,
+                    " is less than concatenated dim ", total_dim);
+        free(column_offset);
+        free(kernel);
+        return;
+    }
+
+    unsigned long total_items = (unsigned long)table_count*bags;
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    int pf_dist = zenEnvObj.zenEmbPrefetchDist;
+    if (total_items < thread_qty) {
+        thread_qty = total_items;
+    }
+    if (thread_qty == 0) {
+        free(column_offset);
+        free(kernel);
+        return;
+    }
+
+    omp_set_max_active_levels(1);
+    #pragma omp parallel for num_threads(thread_qty)
+    for (unsigned long item = 0; item < total_items; item++) {
+        int t = item/bags;
+        int b = item%bags;
+        const idx_t *offsets = offsets_Array[t];
+        idx_t first = offsets[b];
+        idx_t last = b < bags - 1 ? offsets[b + 1] : indices_size_Array[t];
+        int padding_idx = padding_idx_Array ? padding_idx_Array[t] : -1;
+        const float *weights = weights_Array && weights_Array[t] ?
+                               weights_Array[t] + first : NULL;
+        kernel[t](table_Array[t], indices_Array[t] + first, dim_Array[t],
+                  weights, last - first, padding_idx, dim_Array[t],
+                  mode_Array[t] == EMB_MODE_MEAN, pf_dist,
+                  out_layer + (unsigned long)b*ldo + column_offset[t]);
+    }
+    free(column_offset);
+    free(kernel);
+}
+
+void zenGroupEmbeddingBag(
+    const int table_count,
+    const float **table_Array,
+    const int *dim_Array,
+    const int **indices_Array,
+    const int *indices_size_Array,
+    const int **offsets_Array,
+    const float **weights_Array,
+    const int *mode_Array,
+    const int *padding_idx_Array,
+    const int bags,
+    float *out_layer,
+    const int ldo
+) {
+    zenGroupEmbeddingBagImpl<int>(table_count, table_Array, dim_Array,
+                                  indices_Array, indices_size_Array,
+                                  offsets_Array, weights_Array, mode_Array,
+                                  padding_idx_Array, bags, out_layer, ldo);
+}
+
+void zenGroupEmbeddingBagInt64(
+    const int table_count,
+    const float **table_Array,
+    const int *dim_Array,
+    const int64_t **indices_Array,
+    const int *indices_size_Array,
+    const int64_t **offsets_Array,
+    const float **weights_Array,
+    const int *mode_Array,
+    const int *padding_idx_Array,
+    const int bags,
+    float *out_layer,
+    const int ldo
+) {
+    zenGroupEmbeddingBagImpl<int64_t>(table_count, table_Array, dim_Array,
+                                      indices_Array, indices_size_Array,
+                                      offsets_Array, weights_Array,
+                                      mode_Array, padding_idx_Array, bags,
+                                      out_layer, ldo);
+}
@@ -0,0 +1,224 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <zendnn_private.hpp>
+#include <omp.h>
+#include <algorithm>
+#include "zendnn_logging.hpp"
+#include "cpu/embedding_bag_kernels.hpp"
+
+using namespace zendnn;
+using zendnn::impl::cpu::emb_bag_remap_kernel_t;
+using zendnn::impl::cpu::get_emb_bag_remap_kernel;
+
+#define EMB_MODE_SUM            0
+#define EMB_MODE_MEAN           1
+#define EMB_MODE_MAX            2
+
+//Frequency aware row reordering of embedding tables.
+//Lookups are skewed, a small set of hot rows takes most of them, but in
+//table order hot rows are spread over the whole table so nearly every
+//lookup misses TLB and cache. Access counts are collected over warm up
+//batches(zenEmbeddingRowCount), rows are copied in decreasing count order
+//so hot rows are contiguous at the start of the reordered table
+//(zenEmbeddingRowReorder), and lookups go through the row remap inside the
+//bag kernel(zenEmbeddingBagRemap), so callers keep their indices.
+//Counts and lookups take int or int64_t(idx_t) indices and offsets, remap
+//is int.
+
+template <typename idx_t>
+static void zenEmbeddingRowCountImpl(
+    const int rows,
+    const idx_t *indices,
+    const int indices_size,
+    const int padding_idx,
+    unsigned int *counts
+) {
+    zendnnEnv zenEnvObj = readEnv();
+    zendnnInfo(ZENDNN_ALGOLOG, "zenEmbeddingRowCount, rows=", rows,
+               " indices=", indices_size);
+
+    if (!indices || !counts) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenEmbeddingRowCount Memory is not defined for indices or counts");
+        return;
+    }
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    omp_set_max_active_levels(1);
+    #pragma omp parallel for num_threads(thread_qty)
+    for (int i = 0; i < indices_size; i++) {
+        idx_t row = indices[i];
+        if (row != padding_idx && row >= 0 && row < rows) {
+            #pragma omp atomic
+            counts[row]++;
+        }
+    }
+}
+
+void zenEmbeddingRowCount(
+    const int rows,
+    const int *indices,
+    const int indices_size,
+    const int padding_idx,
+    unsigned int *counts
+) {
+    zenEmbeddingRowCountImpl<int>(rows, indices, indices_size, padding_idx,
+                                  counts);
+}
+
+void zenEmbeddingRowCountInt64(
+    const int rows,
+    const int64_t *indices,
+    const int indices_size,
+    const int padding_idx,
+    unsigned int *counts
+) {
+    zenEmbeddingRowCountImpl<int64_t>(rows, indices, indices_size,
+                                      padding_idx, counts);
+}
+
+int zenEmbeddingRowReorder(
+    const float *table,
+    const int rows,
+    const int dim,
+    const unsigned int *counts,
+    float *table_out,
+    int *remap
+) {
+    zendnnEnv zenEnvObj = readEnv();
+    zendnnInfo(ZENDNN_ALGOLOG, "zenEmbeddingRowReorder, rows=", rows,
+               " dim=", dim);
+
+    if (!table || !counts || !table_out || !remap || table == table_out) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenEmbeddingRowReorder Memory is not defined for table or counts or table_out or remap");
+        return -1;
+    }
+
+    //new position p holds row order[p], ties keep table order
+    int *order = (int *)malloc(sizeof(int)*rows);
+    if (order == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenEmbeddingRowReorder Memory Error while allocating row order");
+        return -1;
+    }
+    for (int r = 0; r < rows; r++) {
+        order[r] = r;
+    }
+    std::sort(order, order + rows, [=](int a, int b) {
+        return counts[a] != counts[b] ? counts[a] > counts[b] : a < b;
+    });
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    omp_set_max_active_levels(1);
+    #pragma omp parallel for num_threads(thread_qty)
+    for (int p = 0; p < rows; p++) {
+        remap[order[p]] = p;
+        memcpy(table_out + (unsigned long)p*dim,
+               table + (unsigned long)order[p]*dim, sizeof(float)*dim);
+    }
+
+    int hot_rows = 0;
+    while (hot_rows < rows && counts[order[hot_rows]]) {
+        hot_rows++;
+    }
+    free(order);
+    return hot_rows;
+}
+
+template <typename idx_t>
+static void zenEmbeddingBagRemapImpl(
+    const float *table,
+    const int dim,
+    const int *remap,
+    const idx_t *indices,
+    const int indices_size,
+    const idx_t *offsets,
+    const int bags,
+    const float *weights,
+    const int mode,
+    const int padding_idx,
+    float *out_layer,
+    const int ldo
+) {
+    zendnnEnv zenEnvObj = readEnv();
+    zendnnInfo(ZENDNN_ALGOLOG, "zenEmbeddingBagRemap, dim=", dim,
+               " bags=", bags, " mode=", mode);
+
+    if (!table || !remap || !indices || !offsets || !out_layer) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenEmbeddingBagRemap Memory is not defined for table or remap or indices or offsets or out_layer");
+        return;
+    }
+    if (mode < EMB_MODE_SUM || mode > EMB_MODE_MAX
+            || (weights && mode != EMB_MODE_SUM) || ldo < dim) {
+        zendnnError(ZENDNN_ALGOLOG, "zenEmbeddingBagRemap unsupported mode ",
+                    mode, weights ? " with per sample weights" : "",
+                    " or ldo=", ldo, " is less than dim ", dim);
+        return;
+    }
+
+    emb_bag_remap_kernel_t<float, float, idx_t> kernel
+        = get_emb_bag_remap_kernel<float, float, idx_t>(mode == EMB_MODE_MAX,
+                weights != NULL);
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    int pf_dist = zenEnvObj.zenEmbPrefetchDist;
+    if ((unsigned int)bags < thread_qty) {
+        thread_qty = bags;
+    }
+    if (thread_qty == 0) {
+        return;
+    }
+
+    omp_set_max_active_levels(1);
+    #pragma omp parallel for num_threads(thread_qty)
+    for (int b = 0; b < bags; b++) {
+        idx_t first = offsets[b];
+        idx_t last = b < bags - 1 ? offsets[b + 1] : indices_size;
+        kernel(table, indices + first, remap, dim,
+               weights ? weights + first : NULL, last - first, padding_idx,
+               dim, mode == EMB_MODE_MEAN, pf_dist,
+               out_layer + (unsigned long)b*ldo);
+    }
+}
+
+void zenEmbeddingBagRemap(
+    const float *table,
+    const int dim,
+    const int *remap,
+    const int *indices,
+    const int indices_size,
+    const int *offsets,
+    const int bags,
+    const float *weights,
+    const int mode,
+    const int padding_idx,
+    float *out_layer,
+    const int ldo
+) {
+    zenEmbeddingBagRemapImpl<int>(table, dim, remap, indices, indices_size,
+                                  offsets, bags, weights, mode, padding_idx,
+                                  out_layer, ldo);
+}
+
+void zenEmbeddingBagRemapInt64(
+    const float *table,
+    const int dim,
+    const int *remap,
+    const int64_t *indices,
+    const int indices_size,
+    const int64_t *offsets,
+    const int bags,
+    const float *weights,
+    const int mode,
+    const int padding_idx,
+    float *out_layer,
+    const int ldo
+) {
+    zenEmbeddingBagRemapImpl<int64_t>(table, dim, remap, indices,
+                                      indices_size, offsets, bags, weights,
+                                      mode, padding_idx, out_layer, ldo);
+}
@@ -0,0 +1,222 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <zendnn_private.hpp>
+#include <omp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <limits.h>
+#include <algorithm>
+#include "zendnn_logging.hpp"
+
+using namespace zendnn;
+
+//File backed embedding tables for tables larger than DRAM.
+//Table is mapped read only from a local file, pages are read on demand by
+//page faults of the gather. Access is random, so readahead around faults is
+//disabled(MADV_RANDOM) and pages of the next batch are requested ahead of
+//its lookup with MADV_WILLNEED(zenEmbeddingTablePrefetch), which starts
+//asynchronous reads, so the bag kernels mostly find rows in page cache.
+
+//first and last page(inclusive) of a mapped row range
+struct emb_page_range {
+    unsigned long first, last;
+};
+
+static unsigned long emb_page_size() {
+    long page = sysconf(_SC_PAGESIZE);
+    return page > 0 ? page : 4096;
+}
+
+const float *zenEmbeddingTableMap(
+    const char *path,
+    const unsigned long offset,
+    const unsigned long rows,
+    const int dim
+) {
+    zendnnInfo(ZENDNN_ALGOLOG, "zenEmbeddingTableMap, path=",
+               path ? path : "NULL", " offset=", offset, " rows=", rows,
+               " dim=", dim);
+
+    if (!path || rows == 0 || dim <= 0) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenEmbeddingTableMap path is not defined or table is empty");
+        return NULL;
+    }
+
+    //rows are read as floats, table must be float aligned in the file
+    //(mapping is page aligned)
+    if (offset % sizeof(float) != 0) {
+        zendnnError(ZENDNN_ALGOLOG, "zenEmbeddingTableMap offset ", offset,
+                    " is not a multiple of ", sizeof(float), " bytes");
+        return NULL;
+    }
+
+    //table size and its end in the file must not wrap around
+    unsigned long row_bytes = (unsigned long)dim*sizeof(float);
+    if (rows > ULONG_MAX/row_bytes || offset > ULONG_MAX - rows*row_bytes) {
+        zendnnError(ZENDNN_ALGOLOG, "zenEmbeddingTableMap table of ", rows,
+                    " rows at offset ", offset, " is too large");
+        return NULL;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        zendnnError(ZENDNN_ALGOLOG, "zenEmbeddingTableMap can not open ",
+                    path);
+        return NULL;
+    }
+
+    unsigned long bytes = rows*row_bytes;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 0
+            || (unsigned long)st.st_size < offset
+            || (unsigned long)st.st_size - offset < bytes) {
+        zendnnError(ZENDNN_ALGOLOG, "zenEmbeddingTableMap file ", path,
+                    " is smaller than table of ", bytes, " bytes at offset ",
+                    offset);
+        close(fd);
+        return NULL;
+    }
+
+    //mmap offset is page aligned, table starts inside first page
+    unsigned long page = emb_page_size();
+    unsigned long base_offset = offset/page*page;
+    unsigned long length = offset - base_offset + bytes;
+    void *base = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, base_offset);
+    close(fd);
+    if (base == MAP_FAILED) {
+        zendnnError(ZENDNN_ALGOLOG, "zenEmbeddingTableMap mmap of ", path,
+                    " failed");
+        return NULL;
+    }
+    if (madvise(base, length, MADV_RANDOM) != 0) {
+        zendnnInfo(ZENDNN_ALGOLOG,
+                   "zenEmbeddingTableMap madvise(MADV_RANDOM) failed");
+    }
+
+    return (const float *)((const char *)base + (offset - base_offset));
+}
+
+void zenEmbeddingTableUnmap(
+    const float *table,
+    const unsigned long rows,
+    const int dim
+) {
+    if (!table) {
+        return;
+    }
+    unsigned long page = emb_page_size();
+    unsigned long addr = (unsigned long)table;
+    unsigned long base = addr/page*page;
+    if (munmap((void *)base, addr - base + rows*dim*sizeof(float)) != 0) {
+        zendnnError(ZENDNN_ALGOLOG, "zenEmbeddingTableUnmap munmap failed");
+    }
+}
+
+//idx_t is index type, int or int64_t
+template <typename idx_t>
+static int zenEmbeddingTablePrefetchImpl(
+    const float *table,
+    const int dim,
+    const idx_t *indices,
+    const int indices_size,
+    const int padding_idx
+) {
+    zendnnEnv zenEnvObj = readEnv();
+    zendnnInfo(ZENDNN_ALGOLOG, "zenEmbeddingTablePrefetch, dim=", dim,
+               " indices=", indices_size);
+
+    if (!table || !indices || dim <= 0) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenEmbeddingTablePrefetch Memory is not defined for table or indices");
+        return -1;
+    }
+
+    emb_page_range *ranges = (emb_page_range *)malloc(sizeof(emb_page_range)
+                             *indices_size);
+    if (indices_size && ranges == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenEmbeddingTablePrefetch Memory Error while allocating page ranges");
+        return -1;
+    }
+
+    //page range of each looked up row, sorted and merged so each page is
+    //advised once and adjacent rows share a call
+    unsigned long page = emb_page_size();
+    unsigned long addr = (unsigned long)table;
+    unsigned long row_bytes = (unsigned long)dim*sizeof(float);
+    int count = 0;
+    for (int i = 0; i < indices_size; i++) {
+        if (indices[i] == padding_idx || indices[i] < 0) {
+            continue;
+        }
+        unsigned long row = addr + (unsigned long)indices[i]*row_bytes;
+        ranges[count].first = row/page;
+        ranges[count].last = (row + row_bytes - 1)/page;
+        count++;
+    }
+    std::sort(ranges, ranges + count,
+    [](const emb_page_range &a, const emb_page_range &b) {
+        return a.first < b.first;
+    });
+    int merged = 0;
+    for (int i = 0; i < count; i++) {
+        if (merged && ranges[i].first <= ranges[merged - 1].last + 1) {
+            ranges[merged - 1].last = std::max(ranges[merged - 1].last,
+                                               ranges[i].last);
+        }
+        else {
+            ranges[merged++] = ranges[i];
+        }
+    }
+
+    //madvise is a system call per range, ranges are issued by threads
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    if ((unsigned int)merged < thread_qty) {
+        thread_qty = merged;
+    }
+    int failed = 0;
+    if (thread_qty) {
+        omp_set_max_active_levels(1);
+        #pragma omp parallel for num_threads(thread_qty) reduction(+:failed)
+        for (int r = 0; r < merged; r++) {
+            failed += madvise((void *)(ranges[r].first*page),
+                              (ranges[r].last - ranges[r].first + 1)*page,
+                              MADV_WILLNEED) != 0;
+        }
+    }
+    free(ranges);
+
+    if (failed) {
+        zendnnInfo(ZENDNN_ALGOLOG,
+                   "zenEmbeddingTablePrefetch madvise failed for ", failed,
+                   " of ", merged, " page ranges");
+    }
+    return merged;
+}
+
+int zenEmbeddingTablePrefetch(
+    const float *table,
+    const int dim,
+    const int *indices,
+    const int indices_size,
+    const int padding_idx
+) {
+    return zenEmbeddingTablePrefetchImpl<int>(table, dim, indices,
+            indices_size, padding_idx);
+}
+
+int zenEmbeddingTablePrefetchInt64(
+    const float *table,
+    const int dim,
+    const int64_t *indices,
+    const int indices_size,
+    const int padding_idx
+) {
+    return zenEmbeddingTablePrefetchImpl<int64_t>(table, dim, indices,
+            indices_size, padding_idx);
+}
@@ -0,0 +1,354 @@
+﻿/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <omp.h>
+#include <string.h>
+#include <sys/sysinfo.h>
+#include <cblas.h>
+#include <time.h>
+#include <sys/time.h>
+#include "zendnn_private.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+using namespace zendnn;
+
+//L2 cache per core(512KB with ROME/MILAN), expanded input rows and depthwise
+//output rows of one tile are sized to stay in this budget.
+//TODO: Read cache info from underlying platform and decide this value.
+#define INVERTED_RESIDUAL_L2_SIZE       (512*1024)
+//Upper bound for ReLU6 applied after expand and depthwise stage
+#define INVERTED_RESIDUAL_RELU6_BOUND   6.0f
+
+//Single thread 1x1 convolution(gemm) used by expand and project stage
+//out = in[rows x channels] * filter[channels x no_of_filter]
+static inline void zenPointwiseGemm(
+    const float *in,
+    const int rows,
+    const int channels,
+    const float *filter,
+    const int no_of_filter,
+    float *out
+) {
+#if BLIS_EXPERT
+    blis_expert blis_obj(1, BLIS_NO_TRANSPOSE, BLIS_NO_TRANSPOSE);
+    bli_obj_create_with_attached_buffer(blis_obj.dt, rows, channels,
+                                        (void *)in, channels, 1, &blis_obj.a);
+    bli_obj_create_with_attached_buffer(blis_obj.dt, channels, no_of_filter,
+                                        (void *)filter, no_of_filter, 1, &blis_obj.b);
+    bli_obj_create_with_attached_buffer(blis_obj.dt, rows, no_of_filter,
+                                        out, no_of_filter, 1, &blis_obj.c);
+    bli_gemm_ex(&blis_obj.alpha, &blis_obj.a, &blis_obj.b, &blis_obj.beta,
+                &blis_obj.c, NULL, &blis_obj.rntm);
+#else
+    cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, rows, no_of_filter,
+                channels, 1.0f, in, channels, filter, no_of_filter, 0.0f,
+                out, no_of_filter);
+#endif
+}
+
+//Depthwise convolution on a tile of expanded rows.
+//in holds expanded rows [in_row_start, in_row_start+in_rows) of one image,
+//out receives output rows [out_row_start, out_row_end). filter is HWC.
+//Rows/columns outside the input are treated as zero padding.
+static void zenDepthwiseTile(
+    const float *in,
+    const int in_row_start,
+    const int in_rows,
+    const int width,
+    const int channels,
+    const float *filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int stride_h,
+    const int stride_w,
+    float *out,
+    const int out_row_start,
+    const int out_row_end,
+    const int out_width
+) {
+    for (int oh = out_row_start; oh < out_row_end; oh++) {
+        int h_start = oh*stride_h - pad_t;
+        for (int ow = 0; ow < out_width; ow++) {
+            int w_start = ow*stride_w - pad_l;
+            float *tmp_output = out + ((unsigned long)(oh - out_row_start)*out_width + ow)*
+                                channels;
+            #pragma omp simd
+            for (int c = 0; c < channels; c++) {
+                tmp_output[c] = 0;
+            }
+            for (int kh = 0; kh < kernel_h; kh++) {
+                int ih = h_start + kh;
+                if (ih < in_row_start || ih >= (in_row_start + in_rows)) {
+                    continue;
+                }
+                for (int kw = 0; kw < kernel_w; kw++) {
+                    int iw = w_start + kw;
+                    if (iw < 0 || iw >= width) {
+                        continue;
+                    }
+                    const float *in_pixel = in + ((unsigned long)(ih - in_row_start)*width + iw)*
+                                            channels;
+                    const float *filter_pixel = filter + ((unsigned long)kh*kernel_w + kw)*
+                                                channels;
+                    #pragma omp simd
+                    for (int c = 0; c < channels; c++) {
+                        tmp_output[c] += in_pixel[c] * filter_pixel[c];
+                    }
+                }
+            }
+        }
+    }
+}
+
+//This implementation fuses MobileNetV2/EfficientNet inverted residual block
+//  expand 1x1 conv + BN + ReLU6 -> depthwise conv + BN + ReLU6 ->
+//  project 1x1 conv + BN (+ residual add)
+//Output rows are divided into tiles, for each tile the expanded input rows
+//(including depthwise halo) are computed into a per thread buffer sized to
+//L2 and consumed right away by depthwise and project stage. Only the block
+//output is written to memory, the 6x wider expanded tensor never goes to
+//DRAM. Halo rows shared between tiles are recomputed.
+//I/p and o/p format will be NHWC and filter format is HWCN
+//Multi thread parallization happen at OMP level over (image, tile)
+void zenInvertedResidualBlockVer1(
+    zendnnEnv zenEnvObj,
+    const float *in_layer,
+    const int images,
+    const int channels,
+    const int height,
+    const int width,
+    const float *expand_filter,
+    const int expanded_channels,
+    const float *expand_scale,
+    const float *expand_bias,
+    const float *dw_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int stride_h,
+    const int stride_w,
+    const float *dw_scale,
+    const float *dw_bias,
+    const float *project_filter,
+    const int no_of_filter,
+    const float *project_scale,
+    const float *project_bias,
+    const bool residual,
+    float *out_layer,
+    const int out_height,
+    const int out_width
+) {
+
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    bool expand = (expand_filter != NULL);
+
+    //Tile size in output rows, such that expanded input rows and depthwise
+    //output rows fits in L2
+    unsigned long in_row_size = expand ? (unsigned long)width*expanded_channels*
+                                sizeof(float) : 0;
+    unsigned long out_row_size = (unsigned long)out_width*expanded_channels*
+                                 sizeof(float);
+    int tile_rows = 1;
+    while (tile_rows < out_height &&
+            ((tile_rows*stride_h + kernel_h)*in_row_size + (tile_rows + 1)*
+             out_row_size) <= INVERTED_RESIDUAL_L2_SIZE) {
+        tile_rows++;
+    }
+
+    //Keep all threads busy, split tiles further for smaller batch size
+    int tile_count = (out_height + tile_rows - 1)/tile_rows;
+    if ((unsigned long)images*tile_count < thread_qty) {
+        int min_tile_count = (thread_qty + images - 1)/images;
+        min_tile_count = min_tile_count > out_height ? out_height : min_tile_count;
+        tile_rows = (out_height + min_tile_count - 1)/min_tile_count;
+        tile_count = (out_height + tile_rows - 1)/tile_rows;
+    }
+    int work_count = images*tile_count;
+    if (thread_qty > work_count) {
+        thread_qty = work_count;
+    }
+
+    //Max no. of input rows required by one tile
+    int tile_in_rows = (tile_rows - 1)*stride_h + kernel_h;
+    tile_in_rows = tile_in_rows > height ? height : tile_in_rows;
+    unsigned long expand_buf_size = expand ? (unsigned long)tile_in_rows*width*
+                                    expanded_channels : 0;
+    unsigned long dw_buf_size = (unsigned long)tile_rows*out_width*
+                                expanded_channels;
+    unsigned long thread_buf_size = expand_buf_size + dw_buf_size;
+    //Keep per thread buffer aligned
+    thread_buf_size = ((thread_buf_size*sizeof(float) + ALIGNED_OFFSET - 1)/
+                       ALIGNED_OFFSET)*ALIGNED_OFFSET/sizeof(float);
+
+    float *data_buf = (float *)aligned_alloc(ALIGNED_OFFSET,
+                      thread_buf_size*thread_qty*sizeof(float));
+    if (data_buf == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenInvertedResidualBlockVer1 Memory Error while allocating tile buffer");
+        return;
+    }
+
+    zendnnInfo(ZENDNN_ALGOLOG, "zenInvertedResidualBlockVer1, tile_rows=",
+               tile_rows, " tile_count=", tile_count, " thread_qty=", thread_qty);
+
+    omp_set_max_active_levels(1);
+    #pragma omp parallel num_threads(thread_qty)
+    {
+        float *expand_buf = data_buf + thread_buf_size*omp_get_thread_num();
+        float *dw_buf = expand_buf + expand_buf_size;
+
+        #pragma omp for
+        for (int work = 0; work < work_count; work++) {
+            int image = work/tile_count;
+            int out_row_start = (work%tile_count)*tile_rows;
+            int out_row_end = out_row_start + tile_rows;
+            out_row_end = out_row_end > out_height ? out_height : out_row_end;
+            int out_rows = out_row_end - out_row_start;
+
+            //Input rows required by depthwise windows of this tile
+            int in_row_start = out_row_start*stride_h - pad_t;
+            int in_row_end = (out_row_end - 1)*stride_h - pad_t + kernel_h;
+            in_row_start = in_row_start < 0 ? 0 : in_row_start;
+            in_row_end = in_row_end > height ? height : in_row_end;
+            int in_rows = in_row_end - in_row_start;
+
+            unsigned long inputOffset = ((unsigned long)image*height + in_row_start)*
+                                        width*channels;
+            const float *dw_input = in_layer + inputOffset;
+            if (expand && in_rows > 0) {
+                //Expand stage: 1x1 conv + BN + ReLU6
+                zenPointwiseGemm(in_layer + inputOffset, in_rows*width, channels,
+                                 expand_filter, expanded_channels, expand_buf);
+                zenPostOps(zenEnvObj, expand_buf, NULL, width, in_rows,
+                           expanded_channels, expanded_channels, 0, expand_bias, true, 0,
+                           expand_scale, 1);
+                zenClipOp(zenEnvObj, expand_buf, INVERTED_RESIDUAL_RELU6_BOUND,
+                          (unsigned long)in_rows*width*expanded_channels);
+                dw_input = expand_buf;
+            }
+
+            //Depthwise stage: kxk depthwise conv + BN + ReLU6
+            zenDepthwiseTile(dw_input, in_row_start, in_rows, width, expanded_channels,
+                             dw_filter, kernel_h, kernel_w, pad_t, pad_l, stride_h, stride_w,
+                             dw_buf, out_row_start, out_row_end, out_width);
+            zenPostOps(zenEnvObj, dw_buf, NULL, out_width, out_rows,
+                       expanded_channels, expanded_channels, 0, dw_bias, true, 0,
+                       dw_scale, 1);
+            zenClipOp(zenEnvObj, dw_buf, INVERTED_RESIDUAL_RELU6_BOUND,
+                      (unsigned long)out_rows*out_width*expanded_channels);
+
+            //Project stage: 1x1 conv + BN, residual add with block input
+            unsigned long outputOffset = ((unsigned long)image*out_height + out_row_start)*
+                                         out_width*no_of_filter;
+            zenPointwiseGemm(dw_buf, out_rows*out_width, expanded_channels,
+                             project_filter, no_of_filter, out_layer + outputOffset);
+            zenPostOps(zenEnvObj, out_layer, residual ? in_layer : NULL, out_width,
+                       out_rows, no_of_filter, no_of_filter, outputOffset, project_bias,
+                       false, 0, project_scale, 1);
+        }
+    }
+    free(data_buf);
+}
+
+void zenInvertedResidualBlock(
+    const float *in_layer,
+    const int batchsize,
+    const int channels,
+    const int height,
+    const int width,
+    const float *expand_filter,
+    const int expanded_channels,
+    const float *expand_scale,
+    const float *expand_mean,
+    const float *expand_offset,
+    const float *dw_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *dw_scale,
+    const float *dw_mean,
+    const float *dw_offset,
+    const float *project_filter,
+    const int no_of_filter,
+    const float *project_scale,
+    const float *project_mean,
+    const float *project_offset,
+    const bool residual,
+    float *out_layer,
+    const int out_height,
+    const int out_width
+) {
+    //TODO: perform other checks...eg. for all input dimansions
+    if ((in_layer == NULL)|| (dw_filter == NULL) || (project_filter == NULL) ||
+            (out_layer == NULL)) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenInvertedResidualBlock Memory is not defined for in_layer or filter or out_layer");
+        return;
+    }
+    if ((expand_filter == NULL && expanded_channels != channels) ||
+            (residual && (channels != no_of_filter || out_height != height ||
+                          out_width != width))) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenInvertedResidualBlock Input/Output dimensions are not supported");
+        return;
+    }
+
+    //TODO: This should be part of zendnn initialization
+    zendnnEnv zenEnvObj = readEnv();
+
+    struct timeval start, end;
+    gettimeofday(&start, 0);
+
+    //Fold BatchNorm mean and offset into bias for each stage, scale is
+    //applied by zenPostOps
+    float *bias = (float *)malloc(sizeof(float)*(2*expanded_channels +
+                                  no_of_filter));
+    if (bias == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenInvertedResidualBlock Memory Error while allocating bias");
+        return;
+    }
+    float *expand_bias = bias;
+    float *dw_bias = bias + expanded_channels;
+    float *project_bias = dw_bias + expanded_channels;
+    if (expand_filter != NULL) {
+        for (int r=0; r <expanded_channels; r++) {
+            expand_bias[r] = expand_offset[r]-(expand_scale[r]*expand_mean[r]);
+        }
+    }
+    for (int r=0; r <expanded_channels; r++) {
+        dw_bias[r] = dw_offset[r]-(dw_scale[r]*dw_mean[r]);
+    }
+    for (int r=0; r <no_of_filter; r++) {
+        project_bias[r] = project_offset[r]-(project_scale[r]*project_mean[r]);
+    }
+
+    zenInvertedResidualBlockVer1(zenEnvObj, in_layer, batchsize, channels, height,
+                                 width, expand_filter, expanded_channels, expand_scale, expand_bias,
+                                 dw_filter, kernel_h, kernel_w, pad_t, pad_l, stride_h, stride_w,
+                                 dw_scale, dw_bias, project_filter, no_of_filter, project_scale,
+                                 project_bias, residual, out_layer, out_height, out_width);
+    free(bias);
+
+    gettimeofday(&end, 0);
+    float elapsed;
+    elapsed = timedifference_msec(start, end);
+    zendnnInfo(ZENDNN_PROFLOG, "zenInvertedResidualBlock, no_of_images=", batchsize,
+               " channels=", channels, " height=", height, " width=", width,
+               " expanded_channels=", expanded_channels, " no_of_filter=", no_of_filter,
+               " kernel_h=", kernel_h, " kernel_w=", kernel_w,
+               " pad_t=", pad_t, " pad_l=", pad_l,
+               " pad_b=", pad_b, " pad_r=", pad_r,
+               " stride_h=", stride_h, " stride_w=",stride_w,
+               " residual=", residual, " Time=", elapsed, "ms");
+}
@@ -0,0 +1,202 @@
+﻿/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*******************************************************************************/
+
+#include <zendnn_private.hpp>
+#include <omp.h>
+#include <sys/sysinfo.h>
+#include <time.h>
+#include <sys/time.h>
+#include "zendnn_logging.hpp"
+#include "cpu/gemm/gemm.hpp"
+
+using namespace zendnn;
+using zendnn::impl::bfloat16_t;
+using zendnn::impl::dim_t;
+
+//f32 tile of bf16 output is sized to stay in L2 till it is converted
+//TODO: Read cache info from underlying platform and decide this value.
+#define BF16_MATMUL_L2_SIZE     (256*1024)
+
+//Row major C[m x n] = alpha*A[m x k]*B[k x n] + beta*C with bf16 A/B and
+//f32 accumulation, gemm_bf16bf16f32 is column major so A and B are swapped.
+static inline void zenGemmBF16(const bool transpose_input,
+                               const bool transpose_filter, const int m, const int k, const int n,
+                               const float alpha, const bfloat16_t *input, const int lda,
+                               const bfloat16_t *filter, const int ldb, const float beta, float *output,
+                               const int ldc) {
+    const char transa = transpose_filter ? 'T' : 'N';
+    const char transb = transpose_input ? 'T' : 'N';
+    const dim_t M = n, N = m, K = k;
+    const dim_t lda_ = ldb, ldb_ = lda, ldc_ = ldc;
+    impl::cpu::gemm_bf16bf16f32(&transa, &transb, &M, &N, &K, &alpha, filter, &lda_,
+                                input, &ldb_, &beta, output, &ldc_);
+}
+
+//This implementation computes bf16 MatMul(bf16 input, bf16 filter, f32
+//accumulation) with fused bias, ReLU/GeLU.
+//For f32 output gemm writes to output directly and post-ops are applied in
+//place. For bf16 output, output is divided into (row, column) tiles, each
+//thread computes f32 tile in L2 sized buffer, applies post-ops and converts
+//it to bf16, so no f32 copy of output is written to memory.
+void zenMatMul_gemm_bf16(
+    zendnnEnv zenEnvObj,
+    const bool transpose_input,
+    const bool transpose_filter,
+    const int m,
+    const int k,
+    const int n,
+    const float alpha,
+    const bfloat16_t *input,
+    const int lda,
+    const bfloat16_t *filter,
+    const int ldb,
+    const float *bias,
+    const bool relu,
+    const int gelu,
+    const float beta,
+    void *output,
+    const int ldc,
+    const bool out_bf16
+) {
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+
+    if (!out_bf16) {
+        float *out = (float *)output;
+        zenGemmBF16(transpose_input, transpose_filter, m, k, n, alpha, input, lda,
+                    filter, ldb, beta, out, ldc);
+        if (bias || relu || gelu) {
+            zenPostOps(zenEnvObj, out, NULL, m, 1, n, ldc, 0, bias, relu, gelu,
+                       NULL, thread_qty);
+        }
+        return;
+    }
+
+    bfloat16_t *out = (bfloat16_t *)output;
+    //Split columns only when rows are not enough to keep all threads busy
+    int col_tile = n;
+    if ((unsigned int)m < thread_qty) {
+        int col_split = (thread_qty + m - 1)/m;
+        col_tile = (n + col_split - 1)/col_split;
+        //Keep columns tile multiple of 16(one zmm of f32)
+        col_tile = ((col_tile + 15)/16)*16;
+        col_tile = col_tile > n ? n : col_tile;
+    }
+    int row_tile = BF16_MATMUL_L2_SIZE/(col_tile*sizeof(float));
+    row_tile = row_tile < 1 ? 1 : row_tile;
+    int rows_per_thread = (m + thread_qty - 1)/thread_qty;
+    row_tile = row_tile > rows_per_thread ? rows_per_thread : row_tile;
+
+    int row_tile_count = (m + row_tile - 1)/row_tile;
+    int col_tile_count = (n + col_tile - 1)/col_tile;
+    int tile_count = row_tile_count*col_tile_count;
+    if (thread_qty > tile_count) {
+        thread_qty = tile_count;
+    }
+
+    float *tile_buf = (float *)aligned_alloc(ALIGNED_OFFSET,
+                      sizeof(float)*row_tile*col_tile*thread_qty);
+    if (tile_buf == NULL) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenMatMul_gemm_bf16 Memory Error while allocating output tile");
+        return;
+    }
+
+    omp_set_max_active_levels(1);
+    #pragma omp parallel num_threads(thread_qty)
+    {
+        float *tile = tile_buf + (unsigned long)row_tile*col_tile*omp_get_thread_num();
+
+        #pragma omp for
+        for (int t = 0; t < tile_count; t++) {
+            int row_start = (t/col_tile_count)*row_tile;
+            int col_start = (t%col_tile_count)*col_tile;
+            int rows = m - row_start < row_tile ? m - row_start : row_tile;
+            int cols = n - col_start < col_tile ? n - col_start : col_tile;
+
+            const bfloat16_t *a = input + (transpose_input ? row_start :
+                                           (unsigned long)row_start*lda);
+            const bfloat16_t *b = filter + (transpose_filter ? (unsigned long)col_start*ldb :
+                                            col_start);
+            //sum post-op, existing bf16 output is accumulated in f32
+            if (beta != 0.0f) {
+                for (int r = 0; r < rows; r++) {
+                    impl::cvt_bfloat16_to_float(tile + (unsigned long)r*cols,
+                                                out + (unsigned long)(row_start + r)*ldc + col_start, cols);
+                }
+            }
+            zenGemmBF16(transpose_input, transpose_filter, rows, k, cols, alpha, a, lda,
+                        b, ldb, beta, tile, cols);
+            if (bias || relu || gelu) {
+                zenPostOps(zenEnvObj, tile, NULL, rows, 1, cols, cols, 0,
+                           bias ? bias + col_start : NULL, relu, gelu, NULL, 1);
+            }
+            for (int r = 0; r < rows; r++) {
+                impl::cvt_float_to_bfloat16(out + (unsigned long)(row_start + r)*ldc + col_start,
+                                            tile + (unsigned long)r*cols, cols);
+            }
+        }
+    }
+    free(tile_buf);
+}
+
+void zenMatMulBF16(
+    const bool transpose_input,
+    const bool transpose_filter,
+    const int batch_size,
+    const int no_of_images,
+    const int no_of_channels,
+    const int no_of_filters,
+    const float alpha,
+    const bfloat16_t *input,
+    const int lda,
+    const bfloat16_t *filter,
+    const int ldb,
+    const float *bias,
+    const bool relu,
+    const int gelu,
+    const float beta,
+    void *output,
+    const int ldc,
+    const bool out_bf16
+) {
+    //Check for NULL pointers
+    if ((input == NULL)|| (filter == NULL) || (output == NULL)) {
+        zendnnError(ZENDNN_ALGOLOG,
+                    "zenMatMulBF16 Memory is not defined for input or filter or output");
+        return;
+    }
+
+    // Get the number of threads that could be used for parallelization
+    zendnnEnv zenEnvObj = readEnv();
+    //Set Format to GEMM as Matrix multiplication is always GEMM
+    zenEnvObj.zenBlockedFormat = 0;
+
+    // prologue code for time profiling of this kernel
+    struct timeval start, end;
+    gettimeofday(&start, 0);
+
+    unsigned long out_size = (unsigned long)no_of_images*no_of_filters;
+    for (int i=0; i<batch_size; ++i) {
+        void *out = out_bf16 ? (void *)((bfloat16_t *)output + i*out_size) :
+                    (void *)((float *)output + i*out_size);
+        zenMatMul_gemm_bf16(zenEnvObj, transpose_input, transpose_filter,
+                            no_of_images, no_of_channels, no_of_filters, alpha,
+                            input + ((unsigned long)i*no_of_images*no_of_channels), lda,
+                            filter + ((unsigned long)i*no_of_channels*no_of_filters), ldb,
+                            bias, relu, gelu, beta, out, ldc, out_bf16);
+    }
+
+    // Code for time profiling of this kernel
+    gettimeofday(&end, 0);
+    float elapsed = timedifference_msec(start, end);
+
+    zendnnInfo(ZENDNN_PROFLOG, "zenMatMulBF16,",
+               " transa=", transpose_input ? "CblasTrans," : "CblasNoTrans,",
+               " transb=", transpose_filter ? "CblasTrans," : "CblasNoTrans,",
+               " batch=", batch_size, " m=", no_of_images, " k=", no_of_channels,
+               " n=", no_of_filters, " lda=", lda, " ldb=", ldb,
+               " ldc=", ldc, " alpha=", alpha, " beta=", beta,
+               " relu=", relu, " gelu=", gelu, " out_bf16=", out_bf16,
+               " Time=", elapsed, "ms");
+}
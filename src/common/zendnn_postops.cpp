@@ -518,10 +518,11 @@ void zenPostOps(
         gettimeofday(&start, 0);
 
         // This section of the code enables Batchorm , Elementwise & Relu support for Blocked Format
-        int filter_block = no_of_filter/8;          // Assumes Filters are multiple of 8
-        // If Filters are not multiple of 8 , source call should ensure padding
-        unsigned long index = 0;
-        unsigned long blocked_out_height_width = 8*out_height*out_width;
+        // Channel block is 8(nChw8c) or 16(nChw16c) based on ISA, see readEnv()
+        const int block = zenEnvObj.zenBlockSize;
+        int filter_block = no_of_filter/block;      // Assumes Filters are multiple of block
+        // If Filters are not multiple of block , source call should ensure padding
+        unsigned long blocked_out_height_width = (unsigned long)block*out_height*out_width;
         if (scale) {
 
             if (relu) {
@@ -529,11 +530,11 @@ void zenPostOps(
                     #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                     for (int i=0; i< batch_size; i++)
                         for (int r=0; r< filter_block; r++) {
-                            index = blocked_out_height_width*(i*filter_block + r);
-                            unsigned long index_filter = 8*r;
+                            unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                            unsigned long index_filter = block*r;
                             #pragma omp simd
-                            for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                for (int n=0; n < 8; n++) {
+                            for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                for (int n=0; n < block; n++) {
                                     out_layer[index + m + n]  = scale[index_filter + n]*(out_layer[index + m + n] -
                                                                 mean[index_filter + n])
                                                                 + offset[index_filter + n]  + elementwise_input[index + m + n];
@@ -547,11 +548,11 @@ void zenPostOps(
                     #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                     for (int i=0; i< batch_size; i++)
                         for (int r=0; r< filter_block; r++) {
-                            index = blocked_out_height_width*(i*filter_block + r);
-                            unsigned long index_filter = 8*r;
+                            unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                            unsigned long index_filter = block*r;
                             #pragma omp simd
-                            for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                for (int n=0; n < 8; n++) {
+                            for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                for (int n=0; n < block; n++) {
                                     out_layer[index + m +n]  = scale[index_filter + n]*(out_layer[index + m + n] -
                                                                mean[index_filter + n])
                                                                + offset[index_filter + n];
@@ -571,11 +572,11 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
-                                for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                    for (int n=0; n < 8; n++) {
+                                for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                    for (int n=0; n < block; n++) {
                                         out_layer[index+m + n]  = scale[index_filter + n]*(out_layer[index+m + n] -
                                                                   mean[index_filter + n])
                                                                   + offset[index_filter + n]  + elementwise_input[index+m + n];
@@ -591,11 +592,11 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
-                                for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                    for (int n=0; n < 8; n++) {
+                                for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                    for (int n=0; n < block; n++) {
                                         out_layer[index+m +n]  = scale[index_filter + n]*(out_layer[index+m+n] -
                                                                  mean[index_filter + n])
                                                                  + offset[index_filter + n];
@@ -613,11 +614,11 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
-                                for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                    for (int n=0; n < 8; n++) {
+                                for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                    for (int n=0; n < block; n++) {
                                         out_layer[index+m + n]  = scale[index_filter + n]*(out_layer[index+m + n] -
                                                                   mean[index_filter + n])
                                                                   + offset[index_filter + n]  + elementwise_input[index+m + n];
@@ -631,11 +632,11 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
-                                for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                    for (int n=0; n < 8; n++) {
+                                for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                    for (int n=0; n < block; n++) {
                                         out_layer[index+m +n]  = scale[index_filter + n]*(out_layer[index+m+n] -
                                                                  mean[index_filter + n])
                                                                  + offset[index_filter + n];
@@ -651,11 +652,11 @@ void zenPostOps(
                 #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                 for (int i=0; i< batch_size; i++)
                     for (int r=0; r< filter_block; r++) {
-                        index = blocked_out_height_width*(i*filter_block + r);
-                        unsigned long index_filter = 8*r;
+                        unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                        unsigned long index_filter = block*r;
                         #pragma omp simd
-                        for (int m=0; m< blocked_out_height_width; m=m+8) {
-                            for (int n=0; n < 8; n++) {
+                        for (int m=0; m< blocked_out_height_width; m=m+block) {
+                            for (int n=0; n < block; n++) {
                                 out_layer[index+m + n]  = scale[index_filter + n]*(out_layer[index+m + n] -
                                                           mean[index_filter + n])
                                                           + offset[index_filter + n]  + elementwise_input[index+m + n];
@@ -667,11 +668,11 @@ void zenPostOps(
                 #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                 for (int i=0; i< batch_size; i++)
                     for (int r=0; r< filter_block; r++) {
-                        index = blocked_out_height_width*(i*filter_block + r);
-                        unsigned long index_filter = 8*r;
+                        unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                        unsigned long index_filter = block*r;
                         #pragma omp simd
-                        for (int m=0; m< 8*out_height*out_width; m=m+8) {
-                            for (int n=0; n < 8; n++) {
+                        for (int m=0; m< blocked_out_height_width; m=m+block) {
+                            for (int n=0; n < block; n++) {
                                 out_layer[index+m +n]  = scale[index_filter + n]*(out_layer[index+m+n] -
                                                          mean[index_filter + n])
                                                          + offset[index_filter + n];
@@ -686,11 +687,11 @@ void zenPostOps(
                     #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                     for (int i=0; i< batch_size; i++)
                         for (int r=0; r< filter_block; r++) {
-                            index = blocked_out_height_width*(i*filter_block + r);
-                            unsigned long index_filter = 8*r;
+                            unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                            unsigned long index_filter = block*r;
                             #pragma omp simd
-                            for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                for (int n=0; n < 8; n++) {
+                            for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                for (int n=0; n < block; n++) {
                                     out_layer[index + m + n] = out_layer[index + m + n] + bias[index_filter + n];
                                     out_layer[index + m + n] = out_layer[index + m + n]>0 ? out_layer[index + m +
                                                                n] :
@@ -703,11 +704,11 @@ void zenPostOps(
                     #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                     for (int i=0; i< batch_size; i++)
                         for (int r=0; r< filter_block; r++) {
-                            index = blocked_out_height_width*(i*filter_block + r);
-                            unsigned long index_filter = 8*r;
+                            unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                            unsigned long index_filter = block*r;
                             #pragma omp simd
-                            for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                for (int n=0; n < 8; n++) {
+                            for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                for (int n=0; n < block; n++) {
                                     out_layer[index + m + n] = out_layer[index + m + n] + bias[index_filter + n] +
                                                                elementwise_input[index + m + n];
                                     out_layer[index + m + n]=out_layer[index + m + n]>0 ? out_layer[index + m + n] :
@@ -720,8 +721,8 @@ void zenPostOps(
                     #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                     for (int i=0; i< batch_size; i++)
                         for (int r=0; r< filter_block; r++) {
-                            index = blocked_out_height_width*(i*filter_block + r);
-                            unsigned long index_filter = 8*r;
+                            unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                            unsigned long index_filter = block*r;
                             #pragma omp simd
                             for (int m=0; m< blocked_out_height_width; m++) {
                                 out_layer[index + m] = out_layer[index + m ] + elementwise_input[index + m ];
@@ -739,11 +740,11 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
-                                for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                    for (int n=0; n < 8; n++) {
+                                for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                    for (int n=0; n < block; n++) {
                                         out_layer[index + m + n] = out_layer[index + m + n] + bias[index_filter + n];
                                         out_layer[index + m + n] = 0.5 * out_layer[index + m + n] * (1 + tanhf(
                                                                        gelu_const *
@@ -757,11 +758,11 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
-                                for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                    for (int n=0; n < 8; n++) {
+                                for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                    for (int n=0; n < block; n++) {
                                         out_layer[index + m + n] = out_layer[index + m + n] + bias[index_filter + n] +
                                                                    elementwise_input[index + m + n];
                                         out_layer[index + m + n] = 0.5 * out_layer[index + m + n] * (1 + tanhf(
@@ -776,8 +777,8 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
                                 for (int m=0; m< blocked_out_height_width; m++) {
                                     out_layer[index + m ] = out_layer[index + m ] + elementwise_input[index + m ];
@@ -793,11 +794,11 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
-                                for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                    for (int n=0; n < 8; n++) {
+                                for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                    for (int n=0; n < block; n++) {
                                         out_layer[index + m + n] = out_layer[index + m + n] + bias[index_filter + n];
                                         out_layer[index + m + n] = 0.5 * out_layer[index + m + n] *
                                                                    (1 + erff(out_layer[index + m + n]/1.414213));
@@ -809,11 +810,11 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
-                                for (int m=0; m< blocked_out_height_width; m=m+8) {
-                                    for (int n=0; n < 8; n++) {
+                                for (int m=0; m< blocked_out_height_width; m=m+block) {
+                                    for (int n=0; n < block; n++) {
                                         out_layer[index + m + n] = out_layer[index + m + n] + bias[index_filter + n] +
                                                                    elementwise_input[index + m + n];
                                         out_layer[index + m + n] = 0.5 * out_layer[index + m + n] *
@@ -826,8 +827,8 @@ void zenPostOps(
                         #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                         for (int i=0; i< batch_size; i++)
                             for (int r=0; r< filter_block; r++) {
-                                index = blocked_out_height_width*(i*filter_block + r);
-                                unsigned long index_filter = 8*r;
+                                unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                                unsigned long index_filter = block*r;
                                 #pragma omp simd
                                 for (int m=0; m< blocked_out_height_width; m++) {
                                     out_layer[index + m ] = out_layer[index + m ] + elementwise_input[index + m ];
@@ -842,11 +843,11 @@ void zenPostOps(
                 #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                 for (int i=0; i< batch_size; i++)
                     for (int r=0; r< filter_block; r++) {
-                        index = blocked_out_height_width*(i*filter_block + r);
-                        unsigned long index_filter = 8*r;
+                        unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                        unsigned long index_filter = block*r;
                         #pragma omp simd
-                        for (int m=0; m< blocked_out_height_width; m=m+8) {
-                            for (int n=0; n < 8; n++) {
+                        for (int m=0; m< blocked_out_height_width; m=m+block) {
+                            for (int n=0; n < block; n++) {
                                 out_layer[index + m + n] = out_layer[index + m + n] + bias[index_filter + n];
                             }
                         }
@@ -856,11 +857,11 @@ void zenPostOps(
                 #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                 for (int i=0; i< batch_size; i++)
                     for (int r=0; r< filter_block; r++) {
-                        index = blocked_out_height_width*(i*filter_block + r);
-                        unsigned long index_filter = 8*r;
+                        unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                        unsigned long index_filter = block*r;
                         #pragma omp simd
-                        for (int m=0; m< 8*out_height*out_width; m=m+8) {
-                            for (int n=0; n < 8; n++) {
+                        for (int m=0; m< blocked_out_height_width; m=m+block) {
+                            for (int n=0; n < block; n++) {
                                 out_layer[index + m + n] = out_layer[index + m + n] + bias[index_filter + n] +
                                                            elementwise_input[index + m + n];
                             }
@@ -871,8 +872,8 @@ void zenPostOps(
                 #pragma omp parallel for num_threads(no_of_threads) collapse(2)
                 for (int i=0; i< batch_size; i++)
                     for (int r=0; r< filter_block; r++) {
-                        index = blocked_out_height_width*(i*filter_block + r);
-                        unsigned long index_filter = 8*r;
+                        unsigned long index = blocked_out_height_width*(i*filter_block + r);
+                        unsigned long index_filter = block*r;
                         #pragma omp simd
                         for (int m=0; m< blocked_out_height_width; m++) {
                             out_layer[index + m] = out_layer[index + m] + elementwise_input[index + m];
@@ -14,6 +14,10 @@
 #ifndef ZENDNN_PRIVATE_HPP
 #define ZENDNN_PRIVATE_HPP
 
+//Upto this many input channels(first layer) direct convolution is used, as
+//K of patch matrix is too small for gemm
+#define CONV_DIRECT_LOW_IC      4
+
 extern "C"
 {
     float timedifference_msec(struct timeval t0, struct timeval t1);
@@ -123,13 +127,29 @@ extern "C"
                         const int pad_t, const int pad_l, const int pad_b, const int pad_r,
                         const int stride_h, const int stride_w, float *col_data);
 
+//im2row for one output row starting at input row h_pad, specialized kernels
+//are picked for common filter shapes
+    void im2rowNHWCrow(const float *input_data, const int depth, const int height,
+                       const int width, const int filter_h, const int filter_w,
+                       const int pad_l, const int stride_w, const int h_pad,
+                       const int width_col, float *col_data);
+
+//im2row for a range of output pixels and patch columns, written in GEMM
+//packed A layout(panels of mr rows, element(r, k) at k*mr + r)
+    void im2rowNHWCpacked(const float *input_data, const int depth,
+                          const int height, const int width, const int filter_h, const int filter_w,
+                          const int pad_t, const int pad_l, const int stride_h, const int stride_w,
+                          const int height_col, const int width_col, const unsigned long pixel_start,
+                          const int rows, const int k_start, const int kc, const int mr,
+                          float *panel_data);
+
 
 
 
 
 
-//Out of place transpose
-    float *transpose(const float *matrix, int n, int m);
+//Out of place transpose into caller provided buffer
+    void transpose(const float *matrix, int n, int m, float *transposed);
 
     void NCHW2NHWC(const float *nchw_data, int N, int C, int H, int W,
                    float *nhwc_data);
@@ -231,6 +251,60 @@ extern "C"
         const bool relu
     );
 
+//Direct convolution on BLOCKED Format, src and dst are nChw{block}c and
+//filter is OIhw{block}i{block}o, channels and no_of_filter are padded to
+//block. bias, BatchNorm, sum and relu are fused.
+    void zenConvolution2DBlocked(
+        zendnnEnv zenEnvObj,
+        const float *in_layer,
+        const int no_of_images,
+        const int channels,
+        const int height,
+        const int width,
+        const float *filter,
+        const int no_of_filter,
+        const int valid_filters,
+        const int kernel_h,
+        const int kernel_w,
+        const int pad_t,
+        const int pad_l,
+        const int stride_h,
+        const int stride_w,
+        const float *bias,
+        const float *scale,
+        const float *mean,
+        const float *offset,
+        const bool relu,
+        const bool sum_fused,
+        float *out_layer,
+        const int out_height,
+        const int out_width,
+        const int block
+    );
+
+//Max/Avg pooling on BLOCKED Format(nChw{block}c), channels are padded to
+//block
+    void zenPoolingBlocked(
+        zendnnEnv zenEnvObj,
+        const float *input,
+        const int number_of_images,
+        const int number_of_channel,
+        const int height,
+        const int width,
+        const int kernel_height,
+        const int kernel_width,
+        const int stride_height,
+        const int stride_width,
+        const int padding_height_top,
+        const int padding_width_left,
+        float *output,
+        const int out_height,
+        const int out_width,
+        const bool is_max,
+        const bool include_padding,
+        const int block
+    );
+
     void zenBatchNorm(
         const int no_of_images,
         const int out_height,
@@ -589,6 +663,58 @@ extern "C"
         const float *elementwise_input
     );
 
+    //Size in floats of filter packed for zenConvolution2DDirectLowIC
+    unsigned long zenConvolution2DDirectLowICFilterSize(
+        const int channels,
+        const int no_of_filter,
+        const int kernel_h,
+        const int kernel_w
+    );
+
+    //Packs HWCN filter for zenConvolution2DDirectLowIC, packed_filter has
+    //zenConvolution2DDirectLowICFilterSize floats and needs no alignment
+    void zenConvolution2DDirectLowICFilterPack(
+        const float *filter,
+        const int channels,
+        const int no_of_filter,
+        const int kernel_h,
+        const int kernel_w,
+        float *packed_filter
+    );
+
+    //packed_filter is NULL or filter packed by
+    //zenConvolution2DDirectLowICFilterPack
+    void zenConvolution2DDirectLowIC(
+        zendnnEnv zenEnvObj,
+        const float *in_layer,
+        const int images,
+        const int channels,
+        const int height,
+        const int width,
+        const float *filter,
+        const int no_of_filter,
+        const int kernel_h,
+        const int kernel_w,
+        const int pad_t,
+        const int pad_l,
+        const int pad_b,
+        const int pad_r,
+        const int stride_h,
+        const int stride_w,
+        const float *bias,
+        float *out_layer,
+        const int out_height,
+        const int out_width,
+        const bool relu,
+        const bool sum_fused,
+        const float *scale,
+        const float *elementwise_input,
+        const bool concat,
+        const int filter_offset,
+        const int total_filters,
+        const float *packed_filter
+    );
+
     void zenMatmulSplit(
         zendnnEnv zenEnvObj,
         const bool Layout,
@@ -608,20 +734,58 @@ extern "C"
         float *output,
         const int ldc
     );
-
-    void im2row_unrool_3x3(
-        float *data_col_tmp,
-        unsigned long data_col_offset,
-        const float *in_layer,
-        unsigned long offset
-    );
-
-    void im2row_unrool_7x3(
-        float *data_col_tmp,
-        unsigned long data_col_offset,
-        const float *in_layer,
-        unsigned long offset
-    );
 }
 
+//bf16 variants take zendnn::impl::bfloat16_t, hence declared outside of
+//extern "C"
+#include "common/bfloat16.hpp"
+
+void zenMatMulBF16(
+    const bool transpose_input,
+    const bool transpose_filter,
+    const int batch_size,
+    const int no_of_images,
+    const int no_of_channels,
+    const int no_of_filters,
+    const float alpha,
+    const zendnn::impl::bfloat16_t *input,
+    const int lda,
+    const zendnn::impl::bfloat16_t *filter,
+    const int ldb,
+    const float *bias,
+    const bool relu,
+    const int gelu,
+    const float beta,
+    void *output,
+    const int ldc,
+    const bool out_bf16
+);
+
+void zenConvolution2DBF16(
+    const zendnn::impl::bfloat16_t *in_layer,
+    const int no_of_images,
+    const int channels,
+    const int height,
+    const int width,
+    const zendnn::impl::bfloat16_t *filter,
+    const int no_of_filter,
+    const int kernel_h,
+    const int kernel_w,
+    const int pad_t,
+    const int pad_l,
+    const int pad_b,
+    const int pad_r,
+    const int stride_h,
+    const int stride_w,
+    const float *bias,
+    const bool relu,
+    void *out_layer,
+    const bool out_bf16,
+    const int out_height,
+    const int out_width,
+    const bool concat = false,
+    const int filter_offset = 0,
+    const int total_filters = 0
+);
+
 #endif
@@ -70,6 +70,10 @@ template <>
 struct prec_traits<data_type::u8> {
     typedef uint8_t type;
 };
+template <>
+struct prec_traits<data_type::s64> {
+    typedef int64_t type;
+};
 
 template <>
 struct data_traits<float16_t> {
@@ -95,6 +99,10 @@ template <>
 struct data_traits<uint8_t> {
     static constexpr data_type_t data_type = data_type::u8;
 };
+template <>
+struct data_traits<int64_t> {
+    static constexpr data_type_t data_type = data_type::s64;
+};
 
 template <>
 struct typesize_traits<4> {
@@ -7,7 +7,10 @@
 #include <omp.h>
 #include <string.h>
 #include <stdbool.h> // for padding_zone()
+#include <immintrin.h>
+#include <atomic>
 #include <zendnn_private.hpp>
+#include "cpu/x64/cpu_isa_traits.hpp"
 #include "zendnn_logging.hpp"
 #include "zendnn_helper.hpp"
 
@@ -18,6 +21,17 @@ using namespace zendnn;
 ZenLibMemoryPool *ZenLibMemoryPool::zenLibMemPoolArr[ZEN_LIB_MEM_POOL_LIMIT] = {NULL};
 int ZenLibMemoryPool::zenLibMemPoolCount = 0;
 
+//Version of weights seen by primitives caching weights transforms, bumped
+//by zenWeightsUpdated
+static std::atomic<unsigned long> zenWeightsVersionCounter(0);
+
+unsigned long zenWeightsVersion() {
+    return zenWeightsVersionCounter.load(std::memory_order_acquire);
+}
+
+void zenWeightsUpdated() {
+    zenWeightsVersionCounter.fetch_add(1, std::memory_order_acq_rel);
+}
 
 //Read env variables for zendnn
 zendnnEnv readEnv() {
@@ -31,6 +45,16 @@ zendnnEnv readEnv() {
 
     //ZENDNN_BLOCKED_FORMAT is to enable/disable BLOCKED Format.
     envObj.zenBlockedFormat = zendnn_getenv_int("ZENDNN_BLOCKED_FORMAT", 0);
+    //Channel block of BLOCKED Format(nChw8c/nChw16c) is one vector register
+    //of f32, 16 channels with AVX-512 and 8 channels otherwise.
+    //ZENDNN_BLOCK_SIZE overrides it, 8 is always valid and 16 only with
+    //AVX-512, other values keep the default.
+    envObj.zenBlockSize = impl::cpu::x64::mayiuse(impl::cpu::x64::avx512_core) ?
+                          16 : 8;
+    int blockSize = zendnn_getenv_int("ZENDNN_BLOCK_SIZE", envObj.zenBlockSize);
+    if (blockSize == 8 || (blockSize == 16 && envObj.zenBlockSize == 16)) {
+        envObj.zenBlockSize = blockSize;
+    }
 
     //TODO: change ZENDNN_ENABLE_MEMPOOL to ZENDNN_ENABLE_TF_MEMPOOL
     //use ZENDNN_ENABLE_ONNX_MEMPOOL for ONNX
@@ -48,6 +72,27 @@ zendnnEnv readEnv() {
     //ZENDNN_INT8_SUPPORT is to enable/disable INT8 support
     envObj.zenINT8format = zendnn_getenv_int("ZENDNN_INT8_SUPPORT", 0);
 
+    //ZENDNN_CONV_PIPELINE is to overlap im2row and gemm on paired threads in
+    //throughput convolution path
+    envObj.zenConvPipeline = zendnn_getenv_int("ZENDNN_CONV_PIPELINE", 0);
+
+    //ZENDNN_CONV_PACKED_PATCH is to build im2row patches directly in gemm
+    //packed panel layout in convolution gemm path
+    envObj.zenConvPackedPatch = zendnn_getenv_int("ZENDNN_CONV_PACKED_PATCH", 0);
+
+    //ZENDNN_CONV_FOLD_BN is to fold BatchNorm into convolution weights and bias
+    //once per primitive, BatchNorm parameters are expected to be constant
+    envObj.zenConvFoldBN = zendnn_getenv_int("ZENDNN_CONV_FOLD_BN", 0);
+
+    //ZENDNN_EMB_PREFETCH_DIST is distance(in bag rows) of software prefetch
+    //in embedding bag kernels, 0 disables prefetch
+    envObj.zenEmbPrefetchDist = zendnn_getenv_int("ZENDNN_EMB_PREFETCH_DIST", 8);
+
+    //ZENDNN_EMB_SPLIT_MIN is length(in indices) up to which an embedding bag
+    //is never split across threads, work is balanced by number of indices
+    //and longer bags are split with a reduction of partial results
+    envObj.zenEmbSplitMin = zendnn_getenv_int("ZENDNN_EMB_SPLIT_MIN", 256);
+
     //ZENDNN_BLOCKED_NHWC is added to support NHWC data format for CONV DIRECT ALGO
     envObj.zenBlockedNHWC = zendnn_getenv_int("ZENDNN_NHWC_BLOCKED",0);
 
@@ -231,6 +276,128 @@ void im2col_parNCHW(const float *data_im, const int channels,
 }
 
 
+//Lane masks for AVX2 masked load/store of channel tails, a tail of r floats
+//uses 8 entries starting at (8 - r)
+static const int zenTailMaskTable[16] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+//Copies N floats, N = 0 means length is known only at run time (n)
+template <int N>
+static inline void zenCopyFloats(float *dst, const float *src, int n) {
+    const int len = N ? N : n;
+    int k = 0;
+    for (; k + 8 <= len; k += 8) {
+        _mm256_storeu_ps(dst + k, _mm256_loadu_ps(src + k));
+    }
+    if (k < len) {
+        __m256i mask = _mm256_loadu_si256((const __m256i *)(zenTailMaskTable + 8 -
+                                          (len - k)));
+        _mm256_maskstore_ps(dst + k, mask, _mm256_maskload_ps(src + k, mask));
+    }
+}
+
+//Zero fills N floats, N = 0 means length is known only at run time (n)
+template <int N>
+static inline void zenZeroFloats(float *dst, int n) {
+    const int len = N ? N : n;
+    const __m256 zero = _mm256_setzero_ps();
+    int k = 0;
+    for (; k + 8 <= len; k += 8) {
+        _mm256_storeu_ps(dst + k, zero);
+    }
+    if (k < len) {
+        __m256i mask = _mm256_loadu_si256((const __m256i *)(zenTailMaskTable + 8 -
+                                          (len - k)));
+        _mm256_maskstore_ps(dst + k, mask, zero);
+    }
+}
+
+//Builds patch matrix rows for one output row (width_col patches).
+//In NHWC, the KW input pixels under one kernel row are contiguous, so when
+//kernel row is fully inside the image it is a single KW*C copy, rows in the
+//padding are a single KW*C zero fill and only partially padded kernel rows
+//are handled pixel by pixel.
+//KH, KW, SW and C are compile time filter height, width, stride along width
+//and channels, 0 means the value is taken from run time argument.
+template <int KH, int KW, int SW, int C>
+static void zenIm2rowRow(const float *input_data, const int depth,
+                         const int height, const int width, const int filter_h, const int filter_w,
+                         const int pad_l, const int stride_w, const int h_pad, const int width_col,
+                         float *col_data) {
+    const int kh = KH ? KH : filter_h;
+    const int kw = KW ? KW : filter_w;
+    const int sw = SW ? SW : stride_w;
+    const int c = C ? C : depth;
+    const int row_len = kw*c;
+    int w_pad = -pad_l;
+    for (int w = 0; w < width_col; ++w) {
+        bool w_inside = w_pad >= 0 && w_pad + kw <= width;
+        for (int i = 0; i < kh; ++i) {
+            int ih = h_pad + i;
+            if (ih < 0 || ih >= height) {
+                zenZeroFloats<KW*C>(col_data, row_len);
+            }
+            else if (w_inside) {
+                zenCopyFloats<KW*C>(col_data, input_data + ((unsigned long)ih*width +
+                                    w_pad)*c, row_len);
+            }
+            else {
+                for (int j = 0; j < kw; ++j) {
+                    int iw = w_pad + j;
+                    if (iw >= 0 && iw < width) {
+                        zenCopyFloats<C>(col_data + j*c, input_data + ((unsigned long)ih*width +
+                                         iw)*c, c);
+                    }
+                    else {
+                        zenZeroFloats<C>(col_data + j*c, c);
+                    }
+                }
+            }
+            col_data += row_len;
+        }
+        w_pad += sw;
+    }
+}
+
+typedef void (*zenIm2rowRowFn)(const float *, const int, const int, const int,
+                               const int, const int, const int, const int, const int, const int, float *);
+
+//Picks specialized im2row kernel for common filter shapes, stem layers with
+//3 input channels and 3x3 layers get fully compile time loop bounds.
+static zenIm2rowRowFn zenIm2rowSelect(const int depth, const int filter_h,
+                                      const int filter_w, const int stride_w) {
+    if (depth == 3) {
+        if (filter_h == 7 && filter_w == 7) {
+            return stride_w == 2 ? zenIm2rowRow<7, 7, 2, 3> : zenIm2rowRow<7, 7, 0, 3>;
+        }
+        if (filter_h == 3 && filter_w == 3) {
+            return stride_w == 1 ? zenIm2rowRow<3, 3, 1, 3> :
+                   stride_w == 2 ? zenIm2rowRow<3, 3, 2, 3> : zenIm2rowRow<3, 3, 0, 3>;
+        }
+        return zenIm2rowRow<0, 0, 0, 3>;
+    }
+    if (filter_h == 3 && filter_w == 3) {
+        return stride_w == 1 ? zenIm2rowRow<3, 3, 1, 0> :
+               stride_w == 2 ? zenIm2rowRow<3, 3, 2, 0> : zenIm2rowRow<3, 3, 0, 0>;
+    }
+    if (filter_h == 1 && filter_w == 1) {
+        return zenIm2rowRow<1, 1, 0, 0>;
+    }
+    return zenIm2rowRow<0, 0, 0, 0>;
+}
+
+//im2row for a single output row, col_data receives
+//width_col*filter_h*filter_w*depth floats.
+void im2rowNHWCrow(const float *input_data, const int depth, const int height,
+                   const int width, const int filter_h, const int filter_w,
+                   const int pad_l, const int stride_w, const int h_pad,
+                   const int width_col, float *col_data) {
+    zenIm2rowSelect(depth, filter_h, filter_w, stride_w)(input_data, depth,
+            height, width, filter_h, filter_w, pad_l, stride_w, h_pad, width_col,
+            col_data);
+}
+
 //based on Low-memory GEMM-based convolution algorithms for deep neural networks
 //https://arxiv.org/pdf/1709.03395.pdf
 //Defined in tensorflow
@@ -241,34 +408,13 @@ void im2rowNHWC(const float *input_data, const int depth, const int height,
                 const int stride_h, const int stride_w, float *col_data) {
     int height_col = (height + pad_t + pad_b - filter_h) / stride_h + 1;
     int width_col = (width + pad_l + pad_r - filter_w) / stride_w + 1;
+    unsigned long out_width = (unsigned long)width_col*filter_h*filter_w*depth;
+    zenIm2rowRowFn im2row_row = zenIm2rowSelect(depth, filter_h, filter_w,
+                                stride_w);
 
-    int h = 0;
-    int h_pad = -pad_t;
-    for (h = 0; h < height_col; ++h) {
-        int w_pad = -pad_l;
-        for (int w = 0; w < width_col; ++w) {
-            for (int ih = h_pad; ih < h_pad + filter_h; ++ih) {
-                for (int iw = w_pad; iw < w_pad + filter_w; ++iw) {
-                    if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                        int offset = (ih * width + iw) * depth;
-                        #pragma omp simd
-                        for (int k=0; k<depth; k++) {
-                            col_data[k] = input_data[offset + k];
-                        }
-                    }
-                    else {
-                        // This should be simply padded with zero.
-                        #pragma omp simd
-                        for (int k=0; k<depth; k++) {
-                            col_data[k] = 0;
-                        }
-                    }
-                    col_data += depth;
-                }
-            }
-            w_pad += stride_w;
-        }
-        h_pad += stride_h;
+    for (int h = 0; h < height_col; ++h) {
+        im2row_row(input_data, depth, height, width, filter_h, filter_w, pad_l,
+                   stride_w, -pad_t + h*stride_h, width_col, col_data + h*out_width);
     }
 }
 void im2rowNHWCsplit(const float *input_data, const int depth, const int height,
@@ -279,120 +425,17 @@ void im2rowNHWCsplit(const float *input_data, const int depth, const int height,
                      const int heightStart, const int no_of_threads) {
 
     int width_col = (width + pad_l + pad_r - filter_w) / stride_w + 1;
-    int out_width = ((width + pad_l + pad_r - filter_w) / stride_w + 1)*filter_h*
-                    depth * filter_w;
-    float *col_data_old = col_data;
-
-    int h = 0;
-    int h_pad = -pad_t;
-    int w_pad = -pad_l;
-    int h_offset = -pad_t;
-    if (heightStart > 0) {
-        h_offset = heightStart*stride_h-pad_t;
-    }
-    else {
-        h_offset = -pad_t;
-    }
-    //To enable unrolling and better vectorization, (depth == 3) path unrolled the loop
-    //along channel, this address first layer of convolution where no. of channels
-    //in Image is 3.
-    //For (depth%8 == 0), common case for other conv layers, vectorization is enabled by
-    //to tell compiler to generate AVX256 SIMD instruction using (simd_blocks*8) loop.
-    //Observed perf improvement with googlenet and alexnet.
-    if (depth == 3) {
-        #pragma omp parallel for num_threads(no_of_threads) private(h_pad, w_pad, col_data)
-        for (int i = 0; i < heightColOffset; ++i) {
-            w_pad = -pad_l;
-            h_pad = h_offset + (i * stride_h);
-            col_data = col_data_old + (i*out_width);
-            for (int w = 0; w < width_col; ++w) {
-                for (int ih = h_pad; ih < h_pad + filter_h; ++ih) {
-                    for (int iw = w_pad; iw < w_pad + filter_w; ++iw) {
-                        if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                            int offset = (ih * width + iw) * depth;
-                            //#pragma omp simd
-                            //for (int k=0; k<depth; k++) {
-                            col_data[0] = input_data[offset + 0];
-                            col_data[1] = input_data[offset + 1];
-                            col_data[2] = input_data[offset + 2];
-                            //}
-                        }
-                        else {
-                            // This should be simply padded with zero.
-                            //#pragma omp simd
-                            //for (int k=0; k<depth; k++) {
-                            col_data[0] = 0;
-                            col_data[1] = 0;
-                            col_data[2] = 0;
-                            //}
-                        }
-                        col_data += depth;
-                    }
-                }
-                w_pad += stride_w;
-            }
-        }
-    }
-    else if ((depth%8) == 0) {
-        int simd_blocks = depth/8;
-        #pragma omp parallel for num_threads(no_of_threads) private(h_pad, w_pad, col_data)
-        for (int i = 0; i < heightColOffset; ++i) {
-            w_pad = -pad_l;
-            h_pad = h_offset + (i * stride_h);
-            col_data = col_data_old + (i*out_width);
-            for (int w = 0; w < width_col; ++w) {
-                for (int ih = h_pad; ih < h_pad + filter_h; ++ih) {
-                    for (int iw = w_pad; iw < w_pad + filter_w; ++iw) {
-                        if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                            int offset = (ih * width + iw) * depth;
-                            #pragma omp simd
-                            for (int k=0; k<simd_blocks*8; k++) {
-                                col_data[k] = input_data[offset + k];
-                            }
-                        }
-                        else {
-                            // This should be simply padded with zero.
-                            #pragma omp simd
-                            for (int k=0; k<simd_blocks*8; k++) {
-                                col_data[k] = 0;
-                            }
-                        }
-                        col_data += depth;
-                    }
-                }
-                w_pad += stride_w;
-            }
-        }
-    }
-    else {
-        #pragma omp parallel for num_threads(no_of_threads) private(h_pad, w_pad, col_data)
-        for (int i = 0; i < heightColOffset; ++i) {
-            w_pad = -pad_l;
-            h_pad = h_offset + (i * stride_h);
-            col_data = col_data_old + (i*out_width);
-            for (int w = 0; w < width_col; ++w) {
-                for (int ih = h_pad; ih < h_pad + filter_h; ++ih) {
-                    for (int iw = w_pad; iw < w_pad + filter_w; ++iw) {
-                        if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                            int offset = (ih * width + iw) * depth;
-                            #pragma omp simd
-                            for (int k=0; k<depth; k++) {
-                                col_data[k] = input_data[offset + k];
-                            }
-                        }
-                        else {
-                            // This should be simply padded with zero.
-                            #pragma omp simd
-                            for (int k=0; k<depth; k++) {
-                                col_data[k] = 0;
-                            }
-                        }
-                        col_data += depth;
-                    }
-                }
-                w_pad += stride_w;
-            }
-        }
+    unsigned long out_width = (unsigned long)width_col*filter_h*filter_w*depth;
+    int h_offset = heightStart*stride_h - pad_t;
+    //Loop bounds are compile time for stem (depth == 3) and 3x3 filters,
+    //channel tails use masked AVX2 load/store.
+    zenIm2rowRowFn im2row_row = zenIm2rowSelect(depth, filter_h, filter_w,
+                                stride_w);
+
+    #pragma omp parallel for num_threads(no_of_threads)
+    for (int i = 0; i < heightColOffset; ++i) {
+        im2row_row(input_data, depth, height, width, filter_h, filter_w, pad_l,
+                   stride_w, h_offset + i*stride_h, width_col, col_data + i*out_width);
     }
 }
 
@@ -406,41 +449,120 @@ void im2rowNHWC_par(const float *input_data, const int depth, const int height,
                     const int stride_h, const int stride_w, float *col_data) {
     int height_col = (height + pad_t + pad_b - filter_h) / stride_h + 1;
     int width_col = (width + pad_l + pad_r - filter_w) / stride_w + 1;
+    unsigned long out_width = (unsigned long)width_col*filter_h*filter_w*depth;
+    zenIm2rowRowFn im2row_row = zenIm2rowSelect(depth, filter_h, filter_w,
+                                stride_w);
+
+    #pragma omp parallel for
+    for (int h = 0; h < height_col; ++h) {
+        im2row_row(input_data, depth, height, width, filter_h, filter_w, pad_l,
+                   stride_w, -pad_t + h*stride_h, width_col, col_data + h*out_width);
+    }
+}
+
+//8x8 in-register transpose, r[i] receives column i of the 8 rows
+static inline void zenTranspose8x8Regs(__m256 r[8]) {
+    __m256 t[8];
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        r[i] = _mm256_shuffle_ps(t[i], t[i + 2], 0x44);
+        r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], 0xEE);
+        r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+        r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], 0xEE);
+    }
+    for (int i = 0; i < 4; i++) {
+        t[i] = _mm256_permute2f128_ps(r[i], r[i + 4], 0x20);
+        t[i + 4] = _mm256_permute2f128_ps(r[i], r[i + 4], 0x31);
+    }
+    for (int i = 0; i < 8; i++) {
+        r[i] = t[i];
+    }
+}
 
-    int out_width = ((width + pad_l + pad_r - filter_w) / stride_w + 1)*filter_h*
-                    depth * filter_w;
-    float *col_data_old = col_data;
-
-
-    int h = 0;
-    int h_pad = -pad_t;
-    int count = 0;
-    #pragma omp parallel for private(h, col_data, h_pad)
-    for (h = 0; h < height_col; ++h) {
-        int w_pad = -pad_l;
-        h_pad = -pad_t + (h * stride_h);
-        col_data = col_data_old + (h*out_width);
-        //int w_pad = -pad_l + (h * width_col * stride_w);
-        //printf("Start %d\n", w_pad);
-        for (int w = 0; w < width_col; ++w) {
-            for (int ih = h_pad; ih < h_pad + filter_h; ++ih) {
-                for (int iw = w_pad; iw < w_pad + filter_w; ++iw) {
-                    if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
-                        memcpy(col_data, input_data + (ih * width + iw) * depth,
-                               sizeof(float) * depth);
+//Builds patch matrix of output pixels [pixel_start, pixel_start + rows) of
+//whole batch, restricted to columns [k_start, k_start + kc), directly in the
+//GEMM packed A layout. Pixels are grouped in panels of mr rows, within a
+//panel element (r, k) is stored at k*mr + r, so microkernel reads mr patch
+//values for every k with a single contiguous load. Last panel is zero padded
+//to mr rows. Each source run of a kernel tap is a contiguous range of
+//channels, for mr <= 8 runs are copied 8 channels at a time with vector
+//loads of the mr rows and an in-register transpose, padding rows and
+//remaining channels read a zero with unit stride 0.
+void im2rowNHWCpacked(const float *input_data, const int depth,
+                      const int height, const int width, const int filter_h, const int filter_w,
+                      const int pad_t, const int pad_l, const int stride_h, const int stride_w,
+                      const int height_col, const int width_col, const unsigned long pixel_start,
+                      const int rows, const int k_start, const int kc, const int mr,
+                      float *panel_data) {
+    static const float zero = 0.0f;
+    const unsigned long out_pixels = (unsigned long)height_col*width_col;
+    const int k_end = k_start + kc;
+    //mr is at most 16(register blocking of microkernel)
+    const float *src[16];
+    int step[16];
+    //Image offset and top left input position of panel rows
+    unsigned long image_off[16];
+    int ih0[16], iw0[16];
+
+    for (int p = 0; p < rows; p += mr) {
+        for (int r = 0; r < mr && p + r < rows; ++r) {
+            unsigned long pixel = pixel_start + p + r;
+            image_off[r] = pixel/out_pixels*height;
+            ih0[r] = (pixel%out_pixels)/width_col*stride_h - pad_t;
+            iw0[r] = (pixel%out_pixels)%width_col*stride_w - pad_l;
+        }
+        int k = k_start;
+        while (k < k_end) {
+            int tap = k/depth;
+            int c = k%depth;
+            int len = depth - c < k_end - k ? depth - c : k_end - k;
+            int i = tap/filter_w;
+            int j = tap%filter_w;
+            for (int r = 0; r < mr; ++r) {
+                src[r] = &zero;
+                step[r] = 0;
+                if (p + r >= rows) {
+                    continue;
+                }
+                int ih = ih0[r] + i;
+                int iw = iw0[r] + j;
+                if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
+                    src[r] = input_data + ((image_off[r] + ih)*width + iw)*depth + c;
+                    step[r] = 1;
+                }
+            }
+            int l = 0;
+            if (mr <= 8) {
+                const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(mr),
+                                     _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+                for (; l + 8 <= len; l += 8) {
+                    __m256 v[8];
+                    for (int r = 0; r < 8; ++r) {
+                        v[r] = r < mr && step[r] ? _mm256_loadu_ps(src[r] + l) :
+                               _mm256_setzero_ps();
                     }
-                    else {
-                        // This should be simply padded with zero.
-                        memset(col_data, 0, sizeof(float) * depth);
-                        //printf("%d\n", depth);
+                    zenTranspose8x8Regs(v);
+                    //lanes past mr are overwritten by next store, last
+                    //store is masked to stay inside the panel
+                    for (int t = 0; t < 7; ++t) {
+                        _mm256_storeu_ps(panel_data, v[t]);
+                        panel_data += mr;
                     }
-                    col_data += depth;
-                    count += depth;
+                    _mm256_maskstore_ps(panel_data, mask, v[7]);
+                    panel_data += mr;
                 }
             }
-            w_pad += stride_w;
+            for (; l < len; ++l) {
+                for (int r = 0; r < mr; ++r) {
+                    panel_data[r] = src[r][l*step[r]];
+                }
+                panel_data += mr;
+            }
+            k += len;
         }
-        //printf("End %d\n", w_pad);
     }
 }
 
@@ -449,29 +571,6 @@ float timedifference_msec(struct timeval t0, struct timeval t1) {
 }
 
 
-//OOP transpose for NHWC format when kernel is transposed
-float *transpose(const float *matrix, int n, int m) {
-    int i = 0;
-    int j = 0;
-    float num;
-    float *transposed=(float *)malloc(sizeof(float)*n*m);
-    if (transposed == NULL) {
-        zendnnError(ZENDNN_ALGOLOG, "transpose Memory Error");
-    }
-    while (i < n) {
-        j = 0;
-        while (j < m) {
-            num = *(matrix + i*m + j);
-            *(transposed + i+n*j) = num;
-            j++;
-        }
-        i++;
-    }
-
-    return transposed;
-}
-
-
 void *malloc_safe(size_t size) {
     void *ptr = malloc(size);
     if (ptr == NULL) {
@@ -482,101 +581,133 @@ void *malloc_safe(size_t size) {
     }
 }
 
-void NCHW2NHWC(const float *nchw_data, int N, int C, int H, int W,
-               float *nhwc_data) {
-    for (int n = 0; n < N; n++) {
-        int in_batch_offset = n * C * H * W;
-        int out_batch_offset = n * H * W * C;
-        for (int c = 0; c < C; ++c) {
-            int in_ch_offset = c * H * W + in_batch_offset;
-            int out_ch_offset = out_batch_offset + c;
-            for (int h = 0; h < H; ++h) {
-                int in_row_offset = h * W + in_ch_offset;
-                int out_row_offset = out_ch_offset + h * W * C;
-                for (int w = 0; w < W; ++w) {
-                    int in_addr = w + in_row_offset;
-                    int out_addr = out_row_offset + w * C;
-                    nhwc_data[out_addr] = nchw_data[in_addr];
-                }
-            }
-        }
+//Layout conversion tile edge in elements for both H*W and C. A 64x64 f32
+//source tile and its transpose (32KB) stay in L1/L2 while it is converted.
+#define LAYOUT_TILE     64
+
+//8x8 in-register transpose, src rows are lds apart and dst rows are ldd apart
+static inline void zenTranspose8x8(const float *src, unsigned long lds,
+                                   float *dst, unsigned long ldd) {
+    __m256 r[8];
+    for (int i = 0; i < 8; i++) {
+        r[i] = _mm256_loadu_ps(src + i*lds);
+    }
+    zenTranspose8x8Regs(r);
+    for (int i = 0; i < 8; i++) {
+        _mm256_storeu_ps(dst + i*ldd, r[i]);
     }
 }
 
-void NHWC2NCHW(const float *nhwc_data, int N, int C, int H, int W,
-
-               float *nchw_data) {
-
-    for (int n = 0; n < N; ++n) {
-
-        int in_batch_offset = n * H * W * C;
-
-        int out_batch_offset = n * C * H * W;
-
-        for (int h = 0; h < H; ++h) {
-
-            int in_row_offset = in_batch_offset + h * W * C;
-
-            int out_row_offset = out_batch_offset + h * W;
-
-            for (int w = 0; w < W; ++w) {
-
-                int in_col_offset = in_row_offset + w * C;
+//16x16 in-register transpose, used when AVX-512 is available
+__attribute__((target("avx512f")))
+static inline void zenTranspose16x16(const float *src, unsigned long lds,
+                                     float *dst, unsigned long ldd) {
+    __m512 r[16], t[16];
+    for (int i = 0; i < 16; i++) {
+        r[i] = _mm512_loadu_ps(src + i*lds);
+    }
+    for (int i = 0; i < 16; i += 2) {
+        t[i] = _mm512_unpacklo_ps(r[i], r[i + 1]);
+        t[i + 1] = _mm512_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 16; i += 4) {
+        r[i] = _mm512_shuffle_ps(t[i], t[i + 2], 0x44);
+        r[i + 1] = _mm512_shuffle_ps(t[i], t[i + 2], 0xEE);
+        r[i + 2] = _mm512_shuffle_ps(t[i + 1], t[i + 3], 0x44);
+        r[i + 3] = _mm512_shuffle_ps(t[i + 1], t[i + 3], 0xEE);
+    }
+    for (int i = 0; i < 16; i += 8) {
+        for (int j = 0; j < 4; j++) {
+            t[i + j] = _mm512_shuffle_f32x4(r[i + j], r[i + j + 4], 0x88);
+            t[i + j + 4] = _mm512_shuffle_f32x4(r[i + j], r[i + j + 4], 0xDD);
+        }
+    }
+    for (int i = 0; i < 8; i++) {
+        _mm512_storeu_ps(dst + i*ldd, _mm512_shuffle_f32x4(t[i], t[i + 8], 0x88));
+        _mm512_storeu_ps(dst + (i + 8)*ldd, _mm512_shuffle_f32x4(t[i], t[i + 8],
+                         0xDD));
+    }
+}
 
-                int out_col_offset = out_row_offset + w;
+//Transposes one rows x cols tile, dst[j*ldd + i] = src[i*lds + j].
+//Full blocks of vec x vec go through in-register transpose, edges are scalar.
+static inline void zenTransposeTile(const float *src, int rows, int cols,
+                                    unsigned long lds, float *dst, unsigned long ldd, bool avx512) {
+    int vec = avx512 ? 16 : 8;
+    int rows_vec = (rows/vec)*vec;
+    int cols_vec = (cols/vec)*vec;
+    for (int i = 0; i < rows_vec; i += vec) {
+        for (int j = 0; j < cols_vec; j += vec) {
+            if (avx512) {
+                zenTranspose16x16(src + i*lds + j, lds, dst + j*ldd + i, ldd);
+            }
+            else {
+                zenTranspose8x8(src + i*lds + j, lds, dst + j*ldd + i, ldd);
+            }
+        }
+        for (int ii = i; ii < i + vec; ii++) {
+            for (int j = cols_vec; j < cols; j++) {
+                dst[j*ldd + ii] = src[ii*lds + j];
+            }
+        }
+    }
+    for (int i = rows_vec; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            dst[j*ldd + i] = src[i*lds + j];
+        }
+    }
+}
 
-                for (int c = 0; c < C; ++c) {
+//Transposes N matrices of rows x cols, each src[n] is row major [rows][cols]
+//and dst[n] becomes [cols][rows].
+//Multi thread parallization happen at OMP level over (n, row tile, col tile)
+static void zenTransposeBatch(const float *src, float *dst, int N, int rows,
+                              int cols) {
+    unsigned long image_size = (unsigned long)rows*cols;
+    if (rows == 1 || cols == 1) {
+        memcpy(dst, src, sizeof(float)*N*image_size);
+        return;
+    }
 
-                    int in_addr = in_col_offset + c;
+    zendnnEnv zenEnvObj = readEnv();
+    unsigned int thread_qty = zenEnvObj.omp_num_threads;
+    bool avx512 = impl::cpu::x64::mayiuse(impl::cpu::x64::avx512_core);
 
-                    int out_addr = out_col_offset + c * H * W;
+    long row_tiles = (rows + LAYOUT_TILE - 1)/LAYOUT_TILE;
+    long col_tiles = (cols + LAYOUT_TILE - 1)/LAYOUT_TILE;
+    long tile_count = N*row_tiles*col_tiles;
+    if (thread_qty > tile_count) {
+        thread_qty = tile_count;
+    }
 
-                    nchw_data[out_addr] = nhwc_data[in_addr];
-                }
-            }
-        }
+    omp_set_max_active_levels(1);
+    #pragma omp parallel for num_threads(thread_qty)
+    for (long tile = 0; tile < tile_count; tile++) {
+        long n = tile/(row_tiles*col_tiles);
+        long i = ((tile/col_tiles)%row_tiles)*LAYOUT_TILE;
+        long j = (tile%col_tiles)*LAYOUT_TILE;
+        int tile_rows = rows - i < LAYOUT_TILE ? rows - i : LAYOUT_TILE;
+        int tile_cols = cols - j < LAYOUT_TILE ? cols - j : LAYOUT_TILE;
+        zenTransposeTile(src + n*image_size + i*cols + j, tile_rows, tile_cols,
+                         cols, dst + n*image_size + j*rows + i, rows, avx512);
     }
 }
 
-//Unrool im2row for kernel_width=3 and input_channel=3
-void im2row_unrool_3x3(float *data_col_tmp, unsigned long data_col_offset,
-                       const float *in_layer, unsigned long offset) {
-
-    data_col_tmp[data_col_offset + 0] = in_layer[offset + 0];
-    data_col_tmp[data_col_offset + 1] = in_layer[offset + 1];
-    data_col_tmp[data_col_offset + 2] = in_layer[offset + 2];
-    data_col_tmp[data_col_offset + 3] = in_layer[offset + 3];
-    data_col_tmp[data_col_offset + 4] = in_layer[offset + 4];
-    data_col_tmp[data_col_offset + 5] = in_layer[offset + 5];
-    data_col_tmp[data_col_offset + 6] = in_layer[offset + 6];
-    data_col_tmp[data_col_offset + 7] = in_layer[offset + 7];
-    data_col_tmp[data_col_offset + 8] = in_layer[offset + 8];
+//NCHW to NHWC is a per image transpose of [C][H*W] to [H*W][C]
+void NCHW2NHWC(const float *nchw_data, int N, int C, int H, int W,
+               float *nhwc_data) {
+    zenTransposeBatch(nchw_data, nhwc_data, N, C, H*W);
+}
+
+//NHWC to NCHW is a per image transpose of [H*W][C] to [C][H*W]
+void NHWC2NCHW(const float *nhwc_data, int N, int C, int H, int W,
+               float *nchw_data) {
+    zenTransposeBatch(nhwc_data, nchw_data, N, H*W, C);
 }
 
-//Unrool im2row for kernel_width=7 and input_channel=3
-void im2row_unrool_7x3(float *data_col_tmp, unsigned long data_col_offset,
-                       const float *in_layer, unsigned long offset) {
-
-    data_col_tmp[data_col_offset + 0] = in_layer[offset + 0];
-    data_col_tmp[data_col_offset + 1] = in_layer[offset + 1];
-    data_col_tmp[data_col_offset + 2] = in_layer[offset + 2];
-    data_col_tmp[data_col_offset + 3] = in_layer[offset + 3];
-    data_col_tmp[data_col_offset + 4] = in_layer[offset + 4];
-    data_col_tmp[data_col_offset + 5] = in_layer[offset + 5];
-    data_col_tmp[data_col_offset + 6] = in_layer[offset + 6];
-    data_col_tmp[data_col_offset + 7] = in_layer[offset + 7];
-    data_col_tmp[data_col_offset + 8] = in_layer[offset + 8];
-    data_col_tmp[data_col_offset + 9] = in_layer[offset + 9];
-    data_col_tmp[data_col_offset + 10] = in_layer[offset + 10];
-    data_col_tmp[data_col_offset + 11] = in_layer[offset + 11];
-    data_col_tmp[data_col_offset + 12] = in_layer[offset + 12];
-    data_col_tmp[data_col_offset + 13] = in_layer[offset + 13];
-    data_col_tmp[data_col_offset + 14] = in_layer[offset + 14];
-    data_col_tmp[data_col_offset + 15] = in_layer[offset + 15];
-    data_col_tmp[data_col_offset + 16] = in_layer[offset + 16];
-    data_col_tmp[data_col_offset + 17] = in_layer[offset + 17];
-    data_col_tmp[data_col_offset + 18] = in_layer[offset + 18];
-    data_col_tmp[data_col_offset + 19] = in_layer[offset + 19];
-    data_col_tmp[data_col_offset + 20] = in_layer[offset + 20];
+//OOP transpose for NHWC format when kernel is transposed
+//matrix is n x m row major, transposed (m x n) is provided by caller
+void transpose(const float *matrix, int n, int m, float *transposed) {
+    zenTransposeBatch(matrix, transposed, 1, n, m);
 }
 
@@ -29,18 +29,13 @@ avx2_embedding_bag_t<data_type>::execute(const exec_ctx_t &ctx) const {
     pre_process(ctx, params);
 
     auto  algo                = pd()->desc()->alg_kind;
-    bool &is_weights          = params.is_weights;
+    bool  is_max              = algo == alg_kind::embedding_bag_max;
+    bool  is_mean             = algo == alg_kind::embedding_bag_mean;
 
-    switch(algo) {
-    case alg_kind::embedding_bag_sum:
-      return is_weights ? avx2_sum_wt(params) : avx2_sum(params);
-    case alg_kind::embedding_bag_mean:
-      return is_weights ? avx2_mean_wt(params) : avx2_mean(params);
-    case alg_kind::embedding_bag_max:
-      return is_weights ? avx2_max_wt(params) : avx2_max(params);
-    }
+    if (pd()->desc()->indices_desc.data_type == s64)
+        return avx2_bags<int64_t>(params, is_max, is_mean);
 
-    return status::unimplemented;
+    return avx2_bags<int32_t>(params, is_max, is_mean);
 }
 
 /*
@@ -56,6 +51,9 @@ avx2_embedding_bag_t<data_type>::pre_process(const exec_ctx_t &ctx,
     // get algorithm params
     params.is_weights  = pd()->desc()->is_weights;
     params.padding_idx = pd()->desc()->padding_idx;
+    params.pf_dist     = pd()->pf_dist_;
+    params.split_min   = pd()->split_min_;
+    params.num_threads = pd()->desc()->num_threads;
 
     // get the tensors
     params.input =
@@ -87,13 +85,9 @@ avx2_embedding_bag_t<data_type>::pre_process(const exec_ctx_t &ctx,
 
     // get scratchpad memory
     using namespace memory_tracking::names;
-    using input_type   = typename prec_traits<data_type>::type;
-
     auto scratchpad          = ctx.get_scratchpad_grantor();
-    params.scratchpad_indices
-      = scratchpad.template get(key_embed_bag_indices);
-    params.scratchpad_weights
-      = scratchpad.template get(key_embed_bag_weights);
+    params.partials
+      = scratchpad.template get<float>(key_embed_bag_partials);
 
     // initialize output to zero
     params.dst_size     = dst_mdw.nelems();
@@ -102,561 +96,45 @@ avx2_embedding_bag_t<data_type>::pre_process(const exec_ctx_t &ctx,
 }
 
 /*
- * sum without weights
- */
-template<>
-status_t
-avx2_embedding_bag_t<f32>::avx2_sum(const emb_params_t &params) const {
-
-    const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
-    dst_type     *dst           = static_cast<dst_type *>(params.dst);
-
-    const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / AVX2_PS_COUNT;
-    const int32_t dim_embed_rem = params.dim_embed % AVX2_PS_COUNT;
-
-    // scratchpad buffers
-    indices_type* scratchpad_indices
-      = static_cast<indices_type *>(params.scratchpad_indices);
-
-    // zero fill output tensor
-    std::fill(dst, (dst+ dst_size), 0);
-
-    parallel_nd(offset_size,
-    [=](dim_t thrd) {
-        // compute start and end indices of the bag
-        auto first = offsets[thrd];
-        auto last  = (thrd < (offset_size-1)) ?
-                     offsets[thrd +1] : indices_size;
-
-        // preprocess indices and weights
-        if (padding_idx >= 0) {
-            auto next = first;
-            for (auto i = first; i < last; ++i) {
-                if (indices[i] != padding_idx) {
-                    scratchpad_indices[next++] = indices[i]*dim_embed;
-                }
-            }
-            last = next;
-        }
-        else {
-            for (auto i = first; i < last; ++i) {
-                scratchpad_indices[i] = indices[i]*dim_embed;
-            }
-        }
-
-        float *dst_base        = dst + (thrd * dim_embed);
-        float *in_base         = const_cast<float *>(input);
-        float *dst_ptr         = dst_base;
-        int    shift           = 0;
-
-        for(auto j = 0; j < dim_embed_div; ++j) {
-            __m256 sum     = _mm256_setzero_ps();
-
-            for(auto i = first; i < last; ++i) {
-                auto in_ptr = in_base + scratchpad_indices[i];
-                __m256 aa   = _mm256_loadu_ps(in_ptr);
-                sum         = _mm256_add_ps(aa, sum);
-            }
-
-            _mm256_storeu_ps(dst_ptr, sum);
-
-            shift   += AVX2_PS_COUNT;
-            in_base = const_cast<float *>(input)  + shift;
-            dst_ptr = dst_base + shift;
-        }
-
-        // remaining vector
-        for(auto i = first; i < last; ++i) {
-            auto in_ptr  = in_base + scratchpad_indices[i];
-            for(auto j = 0; j < dim_embed_rem; ++j) {
-                dst_ptr[j] += in_ptr[j];
-            }
-        }
-    });
-
-    return status::success;
-}
-
-/*
- * sum with weights
- */
-template<>
-status_t
-avx2_embedding_bag_t<f32>::avx2_sum_wt(const emb_params_t &params) const {
-
-    const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
-    const input_type   *weights = static_cast<input_type *>(params.weights);
-
-    dst_type     *dst           = static_cast<dst_type *>(params.dst);
-
-    const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / AVX2_PS_COUNT;
-    const int32_t dim_embed_rem = params.dim_embed % AVX2_PS_COUNT;
-
-    // scratchpad buffers
-    indices_type* scratchpad_indices
-      = static_cast<indices_type *>(params.scratchpad_indices);
-    input_type* scratchpad_weights
-      = static_cast<input_type *>(params.scratchpad_weights);
-
-    // zero fill output tensor
-    std::fill(dst, (dst+ dst_size), 0);
-
-    parallel_nd(offset_size,
-    [=](dim_t thrd) {
-        // compute start and end indices of the bag
-        auto first = offsets[thrd];
-        auto last  = (thrd < (offset_size-1)) ?
-                     offsets[thrd +1] : indices_size;
-
-        // preprocess indices and weights
-        if (padding_idx >= 0) {
-            auto next = first;
-            for (auto i = first; i < last; ++i) {
-                if (indices[i] != padding_idx) {
-                    scratchpad_indices[next]   = indices[i]*dim_embed;
-                    scratchpad_weights[next++] = weights[i];
-                }
-            }
-            last = next;
-        }
-        else {
-            for (auto i = first; i < last; ++i) {
-                scratchpad_indices[i] = indices[i]*dim_embed;
-            }
-        }
-
-        auto wts = (padding_idx >= 0) ? scratchpad_weights : weights;
-
-        float *dst_base        = dst + (thrd * dim_embed);
-        float *in_base         = const_cast<float *>(input);
-        float *dst_ptr         = dst_base;
-        int    shift           = 0;
-
-        for(auto j = 0; j < dim_embed_div; ++j) {
-            __m256 sum     = _mm256_setzero_ps();
-
-            for(auto i = first; i < last; ++i) {
-                auto in_ptr = in_base + scratchpad_indices[i];
-                __m256 aa = _mm256_loadu_ps(in_ptr);
-                __m256 bb = _mm256_set1_ps(wts[i]);
-                sum       = _mm256_fmadd_ps(aa, bb, sum);
-            }
-
-            _mm256_storeu_ps(dst_ptr, sum);
-
-            shift   += AVX2_PS_COUNT;
-            in_base = const_cast<float *>(input)  + shift;
-            dst_ptr = dst_base + shift;
-        }
-
-        // remaining vector
-        for(auto i = first; i < last; ++i) {
-            auto in_ptr  = in_base + scratchpad_indices[i];
-            for(auto j = 0; j < dim_embed_rem; ++j) {
-                dst_ptr[j] += wts[i]*in_ptr[j];
-            }
-        }
-    });
-
-    return status::success;
-}
-
-/*
- * mean without weights or padding index
- */
-template<>
-status_t
-avx2_embedding_bag_t<f32>::avx2_mean(const emb_params_t &params) const {
-
-    const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
-    dst_type     *dst           = static_cast<dst_type *>(params.dst);
-
-    const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / AVX2_PS_COUNT;
-    const int32_t dim_embed_rem = params.dim_embed % AVX2_PS_COUNT;
-
-    // scratchpad buffers
-    indices_type* scratchpad_indices
-      = static_cast<indices_type *>(params.scratchpad_indices);
-
-    // zero fill output tensor
-    std::fill(dst, (dst+ dst_size), 0);
-
-    parallel_nd(offset_size,
-    [=](dim_t thrd) {
-        // compute start and end indices of the bag
-        auto first = offsets[thrd];
-        auto last  = (thrd < (offset_size-1)) ?
-                     offsets[thrd +1] : indices_size;
-
-        // preprocess indices and weights
-        if (padding_idx >= 0) {
-            auto next = first;
-            for (auto i = first; i < last; ++i) {
-                if (indices[i] != padding_idx) {
-                    scratchpad_indices[next++] = indices[i]*dim_embed;
-                }
-            }
-            last = next;
-        }
-        else {
-            for (auto i = first; i < last; ++i) {
-                scratchpad_indices[i] = indices[i]*dim_embed;
-            }
-        }
-
-        float   *dst_base        = dst + (thrd * dim_embed);
-        float   *in_base         = const_cast<float *>(input);
-        float   *dst_ptr         = dst_base;
-        int      shift           = 0;
-        float    dn              = 1.0/(float)(last - first);
-
-        for(auto j = 0; j < dim_embed_div; ++j) {
-            __m256 sum     = _mm256_setzero_ps();
-
-            for(auto i = first; i < last; ++i) {
-	        auto in_ptr = in_base + scratchpad_indices[i];
-                __m256 aa   = _mm256_loadu_ps(in_ptr);
-                sum         = _mm256_add_ps(aa, sum);
-            }
-
-            __m256 ddn    = _mm256_set1_ps(dn);
-            sum           = _mm256_mul_ps(sum, ddn);
-            _mm256_storeu_ps(dst_ptr, sum);
-
-            shift   += AVX2_PS_COUNT;
-            in_base = const_cast<float *>(input)  + shift;
-            dst_ptr = dst_base + shift;
-        }
-
-        // remaining vector
-        for(auto i = first; i < last; ++i) {
-            auto in_ptr  = in_base + scratchpad_indices[i];
-            for(auto j = 0; j < dim_embed_rem; ++j) {
-                dst_ptr[j] += in_ptr[j];
-            }
-        }
-        for(auto j = 0; j < dim_embed_rem; ++j) {
-            dst_ptr[j] *= dn;
-        }
-    });
-
-    return status::success;
-}
-
-/*
- * mean with weights but without padding index
+ * sum, mean or max of each bag, with or without weights. shared kernel
+ * reduces the bag in place from user indices(skipping padding index)
+ * keeping output row in vector registers.
+ * threads get equal number of indices(emb_bag_balanced), long bags are
+ * split across threads and reduced from partial results in scratchpad.
+ * weighted mean is reduced as weighted sum and divided by sum of weights.
  */
-template<>
-status_t
-avx2_embedding_bag_t<f32>::avx2_mean_wt(const emb_params_t &params) const {
-
-    const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
-    const input_type   *weights = static_cast<input_type *>(params.weights);
-
-    dst_type     *dst           = static_cast<dst_type *>(params.dst);
-
-    const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / AVX2_PS_COUNT;
-    const int32_t dim_embed_rem = params.dim_embed % AVX2_PS_COUNT;
-
-    // scratchpad buffers
-    indices_type* scratchpad_indices
-      = static_cast<indices_type *>(params.scratchpad_indices);
-    input_type* scratchpad_weights
-      = static_cast<input_type *>(params.scratchpad_weights);
-
-    // zero fill output tensor
-    std::fill(dst, (dst+ dst_size), 0);
-
-    parallel_nd(offset_size,
-    [=](dim_t thrd) {
-        // compute start and end indices of the bag
-        auto first = offsets[thrd];
-        auto last  = (thrd < (offset_size-1)) ?
-                     offsets[thrd +1] : indices_size;
-
-        // preprocess indices and weights
-        float dn = 0;
-        if (padding_idx >= 0) {
-            auto next = first;
-            for (auto i = first; i < last; ++i) {
-                if (indices[i] != padding_idx) {
-                    scratchpad_indices[next]   = indices[i]*dim_embed;
-                    scratchpad_weights[next++] = weights[i];
-                    dn += weights[i];
-                }
-            }
-            last = next;
-        }
-        else {
-            for (auto i = first; i < last; ++i) {
-                scratchpad_indices[i] = indices[i]*dim_embed;
-                dn += weights[i];
-            }
-        }
-        dn = 1/dn;
-
-        auto wts = (padding_idx >= 0) ? scratchpad_weights : weights;
-
-        float *dst_base        = dst + (thrd * dim_embed);
-        float *in_base         = const_cast<float *>(input);
-        float *dst_ptr         = dst_base;
-        int    shift           = 0;
-
-        for(auto j = 0; j < dim_embed_div; ++j) {
-            __m256 sum     = _mm256_setzero_ps();
-
-            for(auto i = first; i < last; ++i) {
-                auto in_ptr = in_base + scratchpad_indices[i];
-                __m256 aa = _mm256_loadu_ps(in_ptr);
-                __m256 bb = _mm256_set1_ps(wts[i]);
-                sum       = _mm256_fmadd_ps(aa, bb, sum);
-            }
-
-            __m256 ddn    = _mm256_set1_ps(dn);
-            sum           = _mm256_mul_ps(sum, ddn);
-            _mm256_storeu_ps(dst_ptr, sum);
-
-            shift   += AVX2_PS_COUNT;
-            in_base = const_cast<float *>(input)  + shift;
-            dst_ptr = dst_base + shift;
-        }
-
-        // remaining vector
-        for(auto i = first; i < last; ++i) {
-            auto in_ptr  = in_base + scratchpad_indices[i];
-            for(auto j = 0; j < dim_embed_rem; ++j) {
-                dst_ptr[j] += wts[i]*in_ptr[j];
-            }
-        }
-        for(auto j = 0; j < dim_embed_rem; ++j) {
-            dst_ptr[j] *= dn;
-        }
-    });
-
-    return status::success;
-}
-
-/*
- * max without weights or padding index
- */
-template<>
-status_t
-avx2_embedding_bag_t<f32>::avx2_max(const emb_params_t &params) const {
-
-    const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
-    dst_type     *dst           = static_cast<dst_type *>(params.dst);
-
-    const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / AVX2_PS_COUNT;
-    const int32_t dim_embed_rem = params.dim_embed % AVX2_PS_COUNT;
-
-    // scratchpad buffers
-    indices_type* scratchpad_indices
-      = static_cast<indices_type *>(params.scratchpad_indices);
-
-    // zero fill output tensor
-    std::fill(dst, (dst+ dst_size), 0);
-
-    parallel_nd(offset_size,
-    [=](dim_t thrd) {
-        // compute start and end indices of the bag
-        auto first = offsets[thrd];
-        auto last  = (thrd < (offset_size-1)) ?
-                     offsets[thrd +1] : indices_size;
-
-        // preprocess indices and weights
-        if (padding_idx >= 0) {
-            auto next = first;
-            for (auto i = first; i < last; ++i) {
-                if (indices[i] != padding_idx) {
-                    scratchpad_indices[next++]   = indices[i]*dim_embed;
-                }
-            }
-            last = next;
-        }
-        else {
-            for (auto i = first; i < last; ++i) {
-                scratchpad_indices[i] = indices[i]*dim_embed;
-            }
-        }
-
-        float *dst_base        = dst + (thrd * dim_embed);
-        float *in_base         = const_cast<float *>(input);
-        float *dst_ptr         = dst_base;
-        int    shift           = 0;
-
-        for(auto j = 0; j < dim_embed_div; ++j) {
-            auto in_ptr    = in_base + scratchpad_indices[first];
-            __m256 mx      = _mm256_loadu_ps(in_ptr);
-
-            for(auto i = first + 1; i < last; ++i) {
-                auto in_ptr = in_base + scratchpad_indices[i];
-                __m256 aa   = _mm256_loadu_ps(in_ptr);
-                mx          = _mm256_max_ps(mx, aa);
-            }
-
-            _mm256_storeu_ps(dst_ptr, mx);
-
-            shift   += AVX2_PS_COUNT;
-            in_base = const_cast<float *>(input)  + shift;
-            dst_ptr = dst_base + shift;
-        }
-
-        // remaining vector
-        auto in_ptr  = in_base + scratchpad_indices[first];
-        for(auto j = 0; j < dim_embed_rem; ++j) {
-            dst_ptr[j] = in_ptr[j];
-        }
-
-        for(auto i = first + 1; i < last; ++i) {
-            auto in_ptr  = in_base + scratchpad_indices[i];
-            for(auto j = 0; j < dim_embed_rem; ++j) {
-                if(in_ptr[j] > dst_ptr[j])
-                    dst_ptr[j] = in_ptr[j];
-            }
-        }
-    });
-
-    return status::success;
-}
-
-/*
- * max with weights
- */
-template<>
+template<data_type_t data_type>
+template<typename idx_type>
 status_t
-avx2_embedding_bag_t<f32>::avx2_max_wt(const emb_params_t &params) const {
+avx2_embedding_bag_t<data_type>::avx2_bags(const emb_params_t &params,
+                                           bool is_max, bool is_mean) const {
 
     const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
+    const idx_type     *indices = static_cast<idx_type *>(params.indices);
+    const idx_type     *offsets = static_cast<idx_type *>(params.offsets);
     const input_type   *weights = static_cast<input_type *>(params.weights);
 
     dst_type     *dst           = static_cast<dst_type *>(params.dst);
 
+    const bool    &is_weights       = params.is_weights;
     const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / AVX2_PS_COUNT;
-    const int32_t dim_embed_rem = params.dim_embed % AVX2_PS_COUNT;
-
-    // scratchpad buffers
-    indices_type* scratchpad_indices
-      = static_cast<indices_type *>(params.scratchpad_indices);
-    input_type* scratchpad_weights
-      = static_cast<input_type *>(params.scratchpad_weights);
-
-    // zero fill output tensor
-    std::fill(dst, (dst+ dst_size), 0);
-
-    parallel_nd(offset_size,
-    [=](dim_t thrd) {
-        // compute start and end indices of the bag
-        auto first = offsets[thrd];
-        auto last  = (thrd < (offset_size-1)) ?
-                     offsets[thrd +1] : indices_size;
-
-        // preprocess indices and weights
-        if (padding_idx >= 0) {
-            auto next = first;
-            for (auto i = first; i < last; ++i) {
-                if (indices[i] != padding_idx) {
-                    scratchpad_indices[next]   = indices[i]*dim_embed;
-                    scratchpad_weights[next++] = weights[i];
-                }
-            }
-            last = next;
-        }
-        else {
-            for (auto i = first; i < last; ++i) {
-                scratchpad_indices[i] = indices[i]*dim_embed;
-            }
-        }
-
-        auto wts = (padding_idx >= 0) ? scratchpad_weights : weights;
-
-        float *dst_base        = dst + (thrd * dim_embed);
-        float *in_base         = const_cast<float *>(input);
-        float *dst_ptr         = dst_base;
-        int    shift           = 0;
-
-        for(auto j = 0; j < dim_embed_div; ++j) {
-            auto in_ptr    = in_base + scratchpad_indices[first];
-            __m256 mx      = _mm256_loadu_ps(in_ptr);
-            __m256 bb      = _mm256_set1_ps(wts[first]);
-            mx             = _mm256_mul_ps(mx,bb);
-
-            for(auto i = first +1; i < last; ++i) {
-                auto in_ptr = in_base + scratchpad_indices[i];
-                __m256 aa = _mm256_loadu_ps(in_ptr);
-                bb        = _mm256_set1_ps(wts[i]);
-                __m256 cc = _mm256_mul_ps(aa,bb);
-                mx        = _mm256_max_ps(mx, cc);
-            }
-
-            _mm256_storeu_ps(dst_ptr, mx);
-
-            shift   += AVX2_PS_COUNT;
-            in_base = const_cast<float *>(input)  + shift;
-            dst_ptr = dst_base + shift;
-        }
-
-        // remaining vector
-        auto in_ptr  = in_base + scratchpad_indices[first];
-        for(auto j = 0; j < dim_embed_rem; ++j) {
-            dst_ptr[j] = wts[first]*in_ptr[j];
-        }
-
-        for(auto i = first +1; i < last; ++i) {
-            auto in_ptr  = in_base + scratchpad_indices[i];
-            for(auto j = 0; j < dim_embed_rem; ++j) {
-                if(wts[i]*in_ptr[j] > dst_ptr[j])
-                    dst_ptr[j] = wts[i]*in_ptr[j];
-            }
-        }
-    });
+    const int64_t &indices_size     = params.indices_size;
+    const int64_t &offset_size      = params.offset_size;
+    const int32_t &pf_dist          = params.pf_dist;
+    const int32_t &padding_idx      = params.padding_idx;
+
+    const emb_bag_kernel_t<input_type, dst_type, idx_type> kernel
+        = get_emb_bag_kernel<input_type, dst_type, idx_type>(is_max,
+                                                             is_weights);
+    const emb_bag_kernel_t<input_type, float, idx_type> part_kernel
+        = get_emb_bag_kernel<input_type, float, idx_type>(is_max,
+                                                          is_weights);
+
+    emb_bag_balanced<input_type, idx_type, dst_type>(kernel, part_kernel,
+            input, dim_embed, indices, offsets, indices_size, offset_size,
+            is_weights ? weights : nullptr, padding_idx, dim_embed, is_max,
+            is_mean, pf_dist, params.split_min, params.num_threads,
+            params.partials, dst);
 
     return status::success;
 }
@@ -20,9 +20,9 @@
 #include "cpu/primitive_attr_postops.hpp"
 
 #include "cpu/cpu_embedding_bag_pd.hpp"
-
-#define  AVX2_PS_COUNT             (8)
-#define  SCRATCHPAD_LEN            (2048)
+#include "cpu/embedding_bag_kernels.hpp"
+#include "cpu/embedding_bag_balance.hpp"
+#include "zendnn_helper.hpp"
 
 namespace zendnn {
 namespace impl {
@@ -30,21 +30,20 @@ namespace cpu {
 
 /* adding for embedding_bag */
 struct emb_params_t {
-    using indices_type = int32_t;
-    using offsets_type = int32_t;
-
     bool            is_weights;
-    indices_type    padding_idx;
+    int32_t         padding_idx;
     void            *input;
     void            *indices;
     void            *offsets;
     void            *dst;
     void            *weights;
-    void            *scratchpad_indices;
-    void            *scratchpad_weights;
+    float           *partials;
     int32_t         dim_embed;
-    int32_t         indices_size, offset_size;
-    int32_t         dst_size;
+    int64_t         indices_size, offset_size;
+    int64_t         dst_size;
+    int32_t         pf_dist;
+    int64_t         split_min;
+    int             num_threads;
 };
 
 template <impl::data_type_t data_type>
@@ -60,16 +59,29 @@ struct avx2_embedding_bag_t : public primitive_t {
                 return status::unimplemented;
             }
 
-            //initialize scratchpad
+            if (desc()->input_desc.data_type != data_type
+                    || desc()->dst_desc.data_type != data_type) {
+                return status::unimplemented;
+            }
+
+            //initialize scratchpad, partial results of bags split across
+            //threads
             using namespace memory_tracking::names;
             auto scratchpad = scratchpad_registry().registrar();
             scratchpad.template
-              book<int>(key_embed_bag_indices, SCRATCHPAD_LEN);
-            scratchpad.template
-              book<input_type>(key_embed_bag_weights, SCRATCHPAD_LEN);
+              book<float>(key_embed_bag_partials,
+                          emb_balance_scratch_size(desc()->num_threads,
+                                                   desc()->dst_desc.dims[1]));
+
+            zendnn::zendnnEnv zenEnvObj = readEnv();
+            pf_dist_   = zenEnvObj.zenEmbPrefetchDist;
+            split_min_ = zenEnvObj.zenEmbSplitMin;
 
             return status::success;
         }
+
+        int32_t pf_dist_   = EMB_PREFETCH_DIST;
+        int64_t split_min_ = EMB_SPLIT_MIN;
     };
     // constructor using pd_t
     avx2_embedding_bag_t(const pd_t *apd) : primitive_t(apd) {}
@@ -80,8 +92,6 @@ struct avx2_embedding_bag_t : public primitive_t {
     }
 
     using input_type   = typename prec_traits<data_type>::type;
-    using indices_type = int32_t;
-    using offsets_type = int32_t;
     using dst_type     = input_type;
 
     // exec() override from primitive_t
@@ -94,20 +104,9 @@ private:
 
     status_t pre_process(const exec_ctx_t &ctx,
                          emb_params_t &params) const;
-    status_t avx2_sum(const emb_params_t &params) const;
-    status_t avx2_sum_wt(const emb_params_t &params) const;
-    status_t avx2_sum_pd(const emb_params_t &params) const;
-    status_t avx2_sum_wt_pd(const emb_params_t &params) const;
-
-    status_t avx2_mean(const emb_params_t &params) const;
-    status_t avx2_mean_wt(const emb_params_t &params) const;
-    status_t avx2_mean_pd(const emb_params_t &params) const;
-    status_t avx2_mean_wt_pd(const emb_params_t &params) const;
-
-    status_t avx2_max(const emb_params_t &params) const;
-    status_t avx2_max_wt(const emb_params_t &params) const;
-    status_t avx2_max_pd(const emb_params_t &params) const;
-    status_t avx2_max_wt_pd(const emb_params_t &params) const;
+    template <typename idx_type>
+    status_t avx2_bags(const emb_params_t &params, bool is_max,
+                       bool is_mean) const;
 
 };
 
@@ -0,0 +1,104 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#include "common/c_types_map.hpp"
+#include "common/zendnn_thread.hpp"
+#include "common/type_helpers.hpp"
+
+#include "cpu/cpu_primitive.hpp"
+
+#include "cpu/avx2_embedding_bag_quant.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+
+using namespace data_type;
+
+status_t
+avx2_embedding_bag_quant_t::execute(const exec_ctx_t &ctx) const {
+
+#if ZENDNN_CPU_THREADING_RUNTIME != ZENDNN_RUNTIME_OMP
+    assert(!"threading env need to be omp for embedding_bag");
+#endif
+
+    auto  algo    = pd()->desc()->alg_kind;
+    bool  is_max  = algo == alg_kind::embedding_bag_max;
+    bool  is_mean = algo == alg_kind::embedding_bag_mean;
+
+    // weighted mean and max are not supported
+    if (pd()->desc()->is_weights && (is_max || is_mean))
+        return status::unimplemented;
+
+    bool is_bf16_dst = pd()->dst_md()->data_type == bf16;
+    if (pd()->desc()->indices_desc.data_type == s64)
+        return is_bf16_dst
+               ? quant_bags<bfloat16_t, int64_t>(ctx, is_max, is_mean)
+               : quant_bags<float, int64_t>(ctx, is_max, is_mean);
+
+    return is_bf16_dst
+           ? quant_bags<bfloat16_t, int32_t>(ctx, is_max, is_mean)
+           : quant_bags<float, int32_t>(ctx, is_max, is_mean);
+}
+
+/*
+ * sum, mean or max of each bag, indices index quantized rows directly and
+ * padding index is skipped by the kernel. threads get equal number of
+ * indices(emb_bag_balanced), scratchpad holds partial results of bags split
+ * across threads.
+ */
+template<typename dst_type, typename idx_type>
+status_t
+avx2_embedding_bag_quant_t::quant_bags(const exec_ctx_t &ctx, bool is_max,
+                                       bool is_mean) const {
+
+    const bool    is_weights  = pd()->desc()->is_weights;
+    const int32_t padding_idx = pd()->desc()->padding_idx;
+    const int64_t row_stride  = pd()->row_stride_;
+    const int32_t pf_dist     = pd()->pf_dist_;
+
+    const uint8_t      *input   = static_cast<const uint8_t *>
+                                  (ctx.host_ptr(ZENDNN_ARG_SRC_0));
+    const idx_type     *indices = static_cast<const idx_type *>
+                                  (ctx.host_ptr(ZENDNN_ARG_SRC_1));
+    const idx_type     *offsets = static_cast<const idx_type *>
+                                  (ctx.host_ptr(ZENDNN_ARG_SRC_2));
+    const float        *weights = is_weights
+                                  ? static_cast<const float *>
+                                  (ctx.host_ptr(ZENDNN_ARG_SRC_3))
+                                  : nullptr;
+    dst_type           *dst     = static_cast<dst_type *>
+                                  (ctx.host_ptr(ZENDNN_ARG_DST));
+
+    memory_desc_wrapper indices_mdw(pd()->src_md(ZENDNN_ARG_SRC_1));
+    memory_desc_wrapper offsets_mdw(pd()->src_md(ZENDNN_ARG_SRC_2));
+
+    const int32_t dim_embed    = pd()->dst_md()->dims[1];
+    const int64_t indices_size = indices_mdw.nelems();
+    const int64_t offset_size  = offsets_mdw.nelems();
+
+    using namespace memory_tracking::names;
+    float *partials = ctx.get_scratchpad_grantor().template get<float>(
+                          key_embed_bag_partials);
+
+    const emb_qbag_kernel_t<dst_type, idx_type> kernel
+        = get_emb_qbag_kernel<dst_type, idx_type>(pd()->bits_,
+                pd()->is_f16_scale_, is_max, is_weights);
+
+    const emb_qbag_kernel_t<float, idx_type> part_kernel
+        = get_emb_qbag_kernel<float, idx_type>(pd()->bits_,
+                pd()->is_f16_scale_, is_max, is_weights);
+
+    emb_bag_balanced<uint8_t, idx_type, dst_type>(kernel, part_kernel,
+            input, row_stride, indices, offsets, indices_size, offset_size,
+            weights, padding_idx, dim_embed, is_max, is_mean, pf_dist,
+            pd()->split_min_, pd()->desc()->num_threads, partials, dst);
+
+    return status::success;
+}
+
+} //namespace cpu
+}
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#ifndef CPU_AVX2_EMBEDDING_BAG_QUANT_HPP
+#define CPU_AVX2_EMBEDDING_BAG_QUANT_HPP
+
+#include <iostream>
+#include <assert.h>
+#include <cstdint>
+
+#include "common/c_types_map.hpp"
+#include "common/primitive.hpp"
+#include "common/type_helpers.hpp"
+#include "common/utils.hpp"
+
+#include "cpu/platform.hpp"
+
+#include "cpu/x64/cpu_isa_traits.hpp"
+
+#include "cpu/cpu_embedding_bag_pd.hpp"
+#include "cpu/embedding_bag_kernels.hpp"
+#include "cpu/embedding_bag_balance.hpp"
+#include "zendnn_helper.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+
+/* embedding bag over row-wise quantized table, values are dequantized in
+ * the bag kernels.
+ * table is u8 of dims {rows, bytes of quantized values}, bits(8 or 4, two
+ * values per byte) and scale data type(f32 or f16) are given by the desc
+ * (zendnn_embedding_bag_quant_desc_init). row stride leaves room after the
+ * values for scale and bias, the desc checks it.
+ */
+struct avx2_embedding_bag_quant_t : public primitive_t {
+    struct pd_t : public cpu_embedding_bag_pd_t {
+        using cpu_embedding_bag_pd_t::cpu_embedding_bag_pd_t;
+
+        DECLARE_COMMON_PD_T("avx2_quant:any", avx2_embedding_bag_quant_t);
+
+        status_t init(engine_t *engine) {
+            using namespace data_type;
+
+            bool ok = x64::mayiuse(x64::avx2)
+                && desc()->input_desc.data_type == u8
+                && utils::one_of(desc()->quant_bits, 8, 4)
+                && utils::one_of(desc()->dst_desc.data_type, f32, bf16)
+                && IMPLICATION(desc()->is_weights,
+                               desc()->weights_desc.data_type == f32);
+            if (!ok)
+                return status::unimplemented;
+
+            memory_desc_wrapper input_mdw(&desc()->input_desc);
+            if (input_mdw.ndims() != 2 || !input_mdw.is_blocking_desc())
+                return status::unimplemented;
+
+            const auto &bd = input_mdw.blocking_desc();
+            if (bd.inner_nblks != 0 || bd.strides[1] != 1)
+                return status::unimplemented;
+
+            const dim_t dim   = desc()->dst_desc.dims[1];
+            bits_             = desc()->quant_bits;
+            is_f16_scale_     = desc()->quant_scale_data_type == f16;
+            row_stride_       = bd.strides[0];
+
+            zendnn::zendnnEnv zenEnvObj = readEnv();
+            pf_dist_   = zenEnvObj.zenEmbPrefetchDist;
+            split_min_ = zenEnvObj.zenEmbSplitMin;
+
+            //initialize scratchpad, partial results of bags split across
+            //threads
+            using namespace memory_tracking::names;
+            auto scratchpad = scratchpad_registry().registrar();
+            scratchpad.template
+              book<float>(key_embed_bag_partials,
+                          emb_balance_scratch_size(desc()->num_threads, dim));
+
+            return status::success;
+        }
+
+        int32_t bits_          = 8;
+        bool    is_f16_scale_  = false;
+        int64_t row_stride_    = 0;
+        int32_t pf_dist_       = EMB_PREFETCH_DIST;
+        int64_t split_min_     = EMB_SPLIT_MIN;
+    };
+    // constructor using pd_t
+    avx2_embedding_bag_quant_t(const pd_t *apd) : primitive_t(apd) {}
+
+    // init() override from primitive_t
+    status_t init(engine_t *engine) override {
+        return status::success;
+    }
+
+    // exec() override from primitive_t
+    status_t execute(const exec_ctx_t &ctx) const override;
+
+private:
+    const pd_t *pd() const {
+        return (const pd_t *)primitive_t::pd().get();
+    }
+
+    template <typename dst_type, typename idx_type>
+    status_t quant_bags(const exec_ctx_t &ctx, bool is_max,
+                        bool is_mean) const;
+};
+
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+#endif
@@ -39,17 +39,22 @@ avx2_embedding_bag_v2_t<data_type>::execute(const exec_ctx_t &ctx) const {
 
     auto  algo                = pd()->desc()->alg_kind;
     bool &is_weights          = params.is_weights;
-
-    switch(algo) {
-    case alg_kind::embedding_bag_sum:
-        return is_weights ? avx2_sum_wt(params) : avx2_sum(params);
-    case alg_kind::embedding_bag_mean:
-        return is_weights ? avx2_mean_wt(params) : avx2_mean(params);
-    case alg_kind::embedding_bag_max:
-        return is_weights ? avx2_max_wt(params) : avx2_max(params);
-    }
-
-    return status::unimplemented;
+    bool  is_max              = algo == alg_kind::embedding_bag_max;
+    bool  is_mean             = algo == alg_kind::embedding_bag_mean;
+
+    // weighted mean and max are not supported
+    if (is_weights && (is_max || is_mean))
+        return status::unimplemented;
+
+    bool is_bf16_dst = pd()->dst_md()->data_type == bf16;
+    if (pd()->desc()->indices_desc.data_type == s64)
+        return is_bf16_dst
+               ? avx2_bags<bfloat16_t, int64_t>(params, is_max, is_mean)
+               : avx2_bags<float, int64_t>(params, is_max, is_mean);
+
+    return is_bf16_dst
+           ? avx2_bags<bfloat16_t, int32_t>(params, is_max, is_mean)
+           : avx2_bags<float, int32_t>(params, is_max, is_mean);
 }
 
 /*
@@ -66,6 +71,8 @@ avx2_embedding_bag_v2_t<data_type>::pre_process(const exec_ctx_t &ctx,
     params.is_weights   = pd()->desc()->is_weights;
     params.padding_idx  = pd()->desc()->padding_idx;
     params.num_threads  = pd()->desc()->num_threads;
+    params.pf_dist      = pd()->pf_dist_;
+    params.split_min    = pd()->split_min_;
 
     // get the tensors
     params.input =
@@ -83,6 +90,12 @@ avx2_embedding_bag_v2_t<data_type>::pre_process(const exec_ctx_t &ctx,
 
     params.dst = static_cast<void *>(ctx.host_ptr(ZENDNN_ARG_DST));
 
+    // get scratchpad memory
+    using namespace memory_tracking::names;
+
+    auto scratchpad  = ctx.get_scratchpad_grantor();
+    params.partials  = scratchpad.template get<float>(key_embed_bag_partials);
+
     // get memory descriptors
     memory_desc_wrapper input_mdw(pd()->src_md(ZENDNN_ARG_SRC_0));
     memory_desc_wrapper indices_mdw(pd()->src_md(ZENDNN_ARG_SRC_1));
@@ -95,425 +108,61 @@ avx2_embedding_bag_v2_t<data_type>::pre_process(const exec_ctx_t &ctx,
     params.offset_size       = offsets_mdw.nelems();
     params.indices_size      = indices_mdw.nelems();
 
-    // get scratchpad memory
-    using namespace memory_tracking::names;
-    using input_type   = typename prec_traits<data_type>::type;
-
-    auto pad_grantr     = ctx.get_scratchpad_grantor();
-    params.pad_indices  = pad_grantr.template get(key_embed_bag_indices);
-    params.pad_weights  = pad_grantr.template get(key_embed_bag_weights);
-
     // initialize output to zero
     params.dst_size     = dst_mdw.nelems();
 
-    if (params.offset_size < params.num_threads)
-        params.num_threads = params.offset_size;
-
-    if (params.indices_size > EMB_SCRATCHPAD_LEN_V2)
-        return status::out_of_memory;
-
     return status;
 }
 
 /*
- * sum without weights
- */
-template<>
-status_t
-avx2_embedding_bag_v2_t<f32>::avx2_sum(const emb_params_v2_t &params) const {
-
-    const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
-    dst_type     *dst           = static_cast<dst_type *>(params.dst);
-
-    const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / EMB_AVX2_PS_COUNT_V2;
-    const int32_t dim_embed_rem = params.dim_embed % EMB_AVX2_PS_COUNT_V2;
-
-#pragma omp parallel num_threads(params.num_threads)
-    {
-        int nthr     = omp_get_num_threads();
-        int ithr     = omp_get_thread_num();
-
-        int sbuf_offset     = ithr*EMB_SCRATCHPAD_LEN_V2/nthr;
-        indices_type* sidx  = static_cast<indices_type*>(params.pad_indices);
-        sidx               += sbuf_offset;
-
-        #pragma omp for
-        for (auto oi = 0; oi < offset_size; ++oi) {
-            auto ofirst = offsets[oi];
-            auto olast  = oi < (offset_size -1) ? offsets[oi+1] : indices_size;
-
-            // preprocess indices
-            int last = 0;
-            if (padding_idx >= 0) {
-                for (auto i = ofirst; i < olast; ++i) {
-                    if (indices[i] != padding_idx) {
-                        sidx[last++] = indices[i]*dim_embed;
-                    }
-                }
-            }
-            else {
-                for (auto i = ofirst; i < olast; ++i) {
-                    sidx[last++] = indices[i]*dim_embed;
-                }
-            }
-
-            float *dst_base        = dst + (oi * dim_embed);
-            float *in_base         = const_cast<float *>(input);
-            float *dst_ptr         = dst_base;
-            int    shift           = 0;
-
-            for(auto j = 0; j < dim_embed_div; ++j) {
-                __m256 sum     = _mm256_setzero_ps();
-
-                for(auto i = 0; i < last; ++i) {
-                    auto in_ptr = in_base + sidx[i];
-                    __m256 aa   = _mm256_loadu_ps(in_ptr);
-                    sum         = _mm256_add_ps(aa, sum);
-                }
-
-                _mm256_storeu_ps(dst_ptr, sum);
-
-                shift   += EMB_AVX2_PS_COUNT_V2;
-                in_base = const_cast<float *>(input)  + shift;
-                dst_ptr = dst_base + shift;
-            }
-
-            // remaining vector
-            if (dim_embed_rem) {
-                auto in_ptr  = in_base + sidx[0];
-                for(auto j = 0; j < dim_embed_rem; ++j) {
-                    dst_ptr[j] = in_ptr[j];
-                }
-
-                for(auto i = 1; i < last; ++i) {
-                    auto in_ptr  = in_base + sidx[i];
-                    for(auto j = 0; j < dim_embed_rem; ++j) {
-                        dst_ptr[j] += in_ptr[j];
-                    }
-                }
-            }
-          } //for oi
-        } // omp parallel
-    return status::success;
-}
-
-/*
- * sum with weights
- */
-template<>
-status_t
-avx2_embedding_bag_v2_t<f32>::avx2_sum_wt(const emb_params_v2_t &params) const {
-
-    const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
-    const input_type   *weights = static_cast<input_type *>(params.weights);
-
-    dst_type     *dst           = static_cast<dst_type *>(params.dst);
-
-    const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / EMB_AVX2_PS_COUNT_V2;
-    const int32_t dim_embed_rem = params.dim_embed % EMB_AVX2_PS_COUNT_V2;
-
-#pragma omp parallel num_threads(params.num_threads)
-    {
-        int nthr     = omp_get_num_threads();
-        int ithr     = omp_get_thread_num();
-
-        int sbuf_offset     = ithr*EMB_SCRATCHPAD_LEN_V2/nthr;
-        indices_type* sidx  = static_cast<indices_type*>(params.pad_indices);
-        float* swt          = static_cast<float*>(params.pad_weights);
-        sidx               += sbuf_offset;
-        swt                += sbuf_offset;
-
-        #pragma omp for
-        for (auto oi = 0; oi < offset_size; ++oi) {
-            auto ofirst = offsets[oi];
-            auto olast  = oi < (offset_size -1) ? offsets[oi+1] : indices_size;
-
-            // preprocess indices
-            int last = 0;
-            if (padding_idx >= 0) {
-                for (auto i = ofirst; i < olast; ++i) {
-                    if (indices[i] != padding_idx) {
-                        swt[last]    = static_cast<float>(weights[i]);
-                        sidx[last++] = indices[i]*dim_embed;
-                    }
-                }
-            }
-            else {
-                for (auto i = ofirst; i < olast; ++i) {
-                    swt[last]    = static_cast<float>(weights[i]);
-                    sidx[last++] = indices[i]*dim_embed;
-                }
-            }
-
-            float *dst_base        = dst + (oi * dim_embed);
-            float *in_base         = const_cast<float *>(input);
-            float *dst_ptr         = dst_base;
-            int    shift           = 0;
-
-            for(auto j = 0; j < dim_embed_div; ++j) {
-                __m256 sum     = _mm256_setzero_ps();
-
-                for(auto i = 0; i < last; ++i) {
-                    auto in_ptr = in_base + sidx[i];
-                    __m256 aa   = _mm256_loadu_ps(in_ptr);
-                    __m256 bb   = _mm256_set1_ps(swt[i]);
-                    sum         = _mm256_fmadd_ps(aa, bb, sum);
-                }
-
-                _mm256_storeu_ps(dst_ptr, sum);
-
-                shift   += EMB_AVX2_PS_COUNT_V2;
-                in_base = const_cast<float *>(input)  + shift;
-                dst_ptr = dst_base + shift;
-            }
-
-            // remaining vector
-            if (dim_embed_rem) {
-                auto in_ptr  = in_base + sidx[0];
-                for(auto j = 0; j < dim_embed_rem; ++j) {
-                    dst_ptr[j] = swt[0]*in_ptr[j];
-                }
-
-                for(auto i = 1; i < last; ++i) {
-                    auto in_ptr  = in_base + sidx[i];
-                    for(auto j = 0; j < dim_embed_rem; ++j) {
-                        dst_ptr[j] += swt[i]*in_ptr[j];
-                    }
-                }
-            }
-        } //for oi
-    } // omp parallel
-
-    return status::success;
-}
-
-/*
- * mean without weights or padding index
- */
-template<>
-status_t
-avx2_embedding_bag_v2_t<f32>::avx2_mean(const emb_params_v2_t &params) const {
-
-    const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
-    dst_type     *dst           = static_cast<dst_type *>(params.dst);
-
-    const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / EMB_AVX2_PS_COUNT_V2;
-    const int32_t dim_embed_rem = params.dim_embed % EMB_AVX2_PS_COUNT_V2;
-
-#pragma omp parallel num_threads(params.num_threads)
-    {
-        int nthr     = omp_get_num_threads();
-        int ithr     = omp_get_thread_num();
-
-        int sbuf_offset     = ithr*EMB_SCRATCHPAD_LEN_V2/nthr;
-        indices_type* sidx  = static_cast<indices_type*>(params.pad_indices);
-        sidx               += sbuf_offset;
-
-        #pragma omp for
-        for (auto oi = 0; oi < offset_size; ++oi) {
-            auto ofirst = offsets[oi];
-            auto olast  = oi < (offset_size -1) ? offsets[oi+1] : indices_size;
-
-            // preprocess indices
-            int last = 0;
-            if (padding_idx >= 0) {
-                for (auto i = ofirst; i < olast; ++i) {
-                    if (indices[i] != padding_idx) {
-                        sidx[last++] = indices[i]*dim_embed;
-                    }
-                }
-            }
-            else {
-                for (auto i = ofirst; i < olast; ++i) {
-                    sidx[last++] = indices[i]*dim_embed;
-                }
-            }
-
-            float *dst_base        = dst + (oi * dim_embed);
-            float *in_base         = const_cast<float *>(input);
-            float *dst_ptr         = dst_base;
-            int    shift           = 0;
-            float  dn              = 1.0/(float)(last);
-
-
-            for(auto j = 0; j < dim_embed_div; ++j) {
-                __m256 sum     = _mm256_setzero_ps();
-
-                for(auto i = 0; i < last; ++i) {
-                    auto in_ptr = in_base + sidx[i];
-                    __m256 aa   = _mm256_loadu_ps(in_ptr);
-                    sum         = _mm256_add_ps(sum, aa);
-                }
-
-                __m256 ddn    = _mm256_set1_ps(dn);
-                sum           = _mm256_mul_ps(sum, ddn);
-                _mm256_storeu_ps(dst_ptr, sum);
-
-                shift   += EMB_AVX2_PS_COUNT_V2;
-                in_base = const_cast<float *>(input)  + shift;
-                dst_ptr = dst_base + shift;
-            }
-
-            // remaining vector
-            if (dim_embed_rem) {
-                auto in_ptr  = in_base + sidx[0];
-                for(auto j = 0; j < dim_embed_rem; ++j) {
-                    dst_ptr[j] = in_ptr[j];
-                }
-
-                for(auto i = 1; i < last; ++i) {
-                    auto in_ptr  = in_base + sidx[i];
-                    for(auto j = 0; j < dim_embed_rem; ++j) {
-                        dst_ptr[j] += in_ptr[j];
-                    }
-                }
-
-                for(auto j = 0; j < dim_embed_rem; ++j) {
-                    dst_ptr[j] *= dn;
-                }
-            }
-        } //for oi
-    } // omp parallel
-
-    return status::success;
-}
-
-/*
- * mean with weights but without padding index
+ * sum, mean or max of each bag, with or without weights. shared kernel
+ * reduces the bag keeping output row in vector registers, it reads user
+ * indices and weights of the bag in place and skips padding index, so
+ * there is no limit on number of indices.
+ * row address is computed by kernel in 64 bit, so tables beyond 2^31
+ * elements work with s32 indices as well.
+ * threads get equal number of indices(emb_bag_balanced) instead of equal
+ * number of bags, so a few long bags of power law traffic are split across
+ * threads and short bags are grouped.
  */
-template<>
-status_t
-avx2_embedding_bag_v2_t<f32>::avx2_mean_wt(const emb_params_v2_t &params) const {
-    return status::unimplemented;
-}
-
-/*
- * max without weights or padding index
- */
-template<>
+template<data_type_t data_type>
+template<typename dst_type, typename idx_type>
 status_t
-avx2_embedding_bag_v2_t<f32>::avx2_max(const emb_params_v2_t &params) const {
+avx2_embedding_bag_v2_t<data_type>::avx2_bags(const emb_params_v2_t &params,
+                                              bool is_max, bool is_mean) const {
 
     const input_type   *input   = static_cast<input_type *>(params.input);
-    const indices_type *indices = static_cast<indices_type *>(params.indices);
-    const offsets_type *offsets = static_cast<offsets_type *>(params.offsets);
+    const idx_type     *indices = static_cast<idx_type *>(params.indices);
+    const idx_type     *offsets = static_cast<idx_type *>(params.offsets);
+    const float        *weights = static_cast<float *>(params.weights);
     dst_type     *dst           = static_cast<dst_type *>(params.dst);
 
+    const bool    &is_weights       = params.is_weights;
     const int32_t &dim_embed        = params.dim_embed;
-    const int32_t &indices_size     = params.indices_size;
-    const int32_t &offset_size      = params.offset_size;
-    const int32_t &dst_size         = params.dst_size;
-    const indices_type &padding_idx = params.padding_idx;
-
-    const int32_t dim_embed_div = params.dim_embed / EMB_AVX2_PS_COUNT_V2;
-    const int32_t dim_embed_rem = params.dim_embed % EMB_AVX2_PS_COUNT_V2;
-
-#pragma omp parallel num_threads(params.num_threads)
-    {
-        int nthr     = omp_get_num_threads();
-        int ithr     = omp_get_thread_num();
-
-        int sbuf_offset     = ithr*EMB_SCRATCHPAD_LEN_V2/nthr;
-        indices_type* sidx  = static_cast<indices_type*>(params.pad_indices);
-        sidx               += sbuf_offset;
-
-        #pragma omp for
-        for (auto oi = 0; oi < offset_size; ++oi) {
-            auto ofirst = offsets[oi];
-            auto olast  = oi < (offset_size -1) ? offsets[oi+1] : indices_size;
-
-            // preprocess indices
-            int last = 0;
-            if (padding_idx >= 0) {
-                for (auto i = ofirst; i < olast; ++i) {
-                    if (indices[i] != padding_idx) {
-                        sidx[last++] = indices[i]*dim_embed;
-                    }
-                }
-            }
-            else {
-                for (auto i = ofirst; i < olast; ++i) {
-                    sidx[last++] = indices[i]*dim_embed;
-                }
-            }
-
-            float *dst_base        = dst + (oi * dim_embed);
-            float *in_base         = const_cast<float *>(input);
-            float *dst_ptr         = dst_base;
-            int    shift           = 0;
-
-            for(auto j = 0; j < dim_embed_div; ++j) {
-                auto in_ptr = in_base + sidx[0];
-                __m256 mx   = _mm256_loadu_ps(in_ptr);
-
-                for(auto i = 1; i < last; ++i) {
-                    auto in_ptr = in_base + sidx[i];
-                    __m256 aa   = _mm256_loadu_ps(in_ptr);
-                    mx          = _mm256_max_ps(mx, aa);
-                }
-
-                _mm256_storeu_ps(dst_ptr, mx);
-
-                shift   += EMB_AVX2_PS_COUNT_V2;
-                in_base = const_cast<float *>(input)  + shift;
-                dst_ptr = dst_base + shift;
-            }
-
-            // remaining vector
-            if (dim_embed_rem) {
-                auto in_ptr  = in_base + sidx[0];
-                for(auto j = 0; j < dim_embed_rem; ++j) {
-                    dst_ptr[j] = in_ptr[j];
-                }
-
-                for(auto i = 1; i < last; ++i) {
-                    auto in_ptr  = in_base + sidx[i];
-                    for(auto j = 0; j < dim_embed_rem; ++j) {
-                        dst_ptr[j] = dst_ptr[j] > in_ptr[j] ? dst_ptr[j]:
-                                                              in_ptr[j];
-                    }
-                }
-            }
-        } //for oi
-    } // omp parallel
+    const int64_t &indices_size     = params.indices_size;
+    const int64_t &offset_size      = params.offset_size;
+    const int32_t &pf_dist          = params.pf_dist;
+    const int32_t &padding_idx      = params.padding_idx;
+
+    const emb_bag_kernel_t<input_type, dst_type, idx_type> kernel
+        = get_emb_bag_kernel<input_type, dst_type, idx_type>(is_max,
+                                                             is_weights);
+    const emb_bag_kernel_t<input_type, float, idx_type> part_kernel
+        = get_emb_bag_kernel<input_type, float, idx_type>(is_max,
+                                                          is_weights);
+
+    emb_bag_balanced<input_type, idx_type, dst_type>(kernel, part_kernel,
+            input, dim_embed, indices, offsets, indices_size, offset_size,
+            is_weights ? weights : nullptr, padding_idx, dim_embed, is_max,
+            is_mean, pf_dist, params.split_min, params.num_threads,
+            params.partials, dst);
 
     return status::success;
 }
 
-/*
- * max with weights
- */
-template<>
-status_t
-avx2_embedding_bag_v2_t<f32>::avx2_max_wt(const emb_params_v2_t &params) const {
-    return status::unimplemented;
-}
-
 template struct avx2_embedding_bag_v2_t<f32>;
+template struct avx2_embedding_bag_v2_t<bf16>;
+template struct avx2_embedding_bag_v2_t<f16>;
 
 } //namespace cpu
 }
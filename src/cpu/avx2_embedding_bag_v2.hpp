@@ -19,10 +19,12 @@
 #include "cpu/platform.hpp"
 #include "cpu/primitive_attr_postops.hpp"
 
-#include "cpu/cpu_embedding_bag_pd.hpp"
+#include "cpu/x64/cpu_isa_traits.hpp"
 
-#define  EMB_AVX2_PS_COUNT_V2             (8)
-#define  EMB_SCRATCHPAD_LEN_V2            (2048)
+#include "cpu/cpu_embedding_bag_pd.hpp"
+#include "cpu/embedding_bag_kernels.hpp"
+#include "cpu/embedding_bag_balance.hpp"
+#include "zendnn_helper.hpp"
 
 namespace zendnn {
 namespace impl {
@@ -30,23 +32,21 @@ namespace cpu {
 
 /* adding for embedding_bag */
 struct emb_params_v2_t {
-    using indices_type = int32_t;
-    using offsets_type = int32_t;
-
     bool            is_weights;
-    indices_type    padding_idx;
+    int32_t         padding_idx;
     uint32_t        num_threads;
     void            *input;
     void            *indices;
     void            *offsets;
     void            *dst;
     void            *weights;
-    void            *pad_indices;
-    void            *pad_weights;
     int32_t         dim_embed;
-    int32_t         indices_size;
-    int32_t         offset_size;
-    int32_t         dst_size;
+    int64_t         indices_size;
+    int64_t         offset_size;
+    int64_t         dst_size;
+    int32_t         pf_dist;
+    int64_t         split_min;
+    float           *partials;
 };
 
 template <impl::data_type_t data_type>
@@ -54,26 +54,48 @@ struct avx2_embedding_bag_v2_t : public primitive_t {
     struct pd_t : public cpu_embedding_bag_pd_t {
         using cpu_embedding_bag_pd_t::cpu_embedding_bag_pd_t;
         using input_type   = typename prec_traits<data_type>::type;
-        using indices_type = int32_t;
-        using offsets_type = int32_t;
 
         DECLARE_COMMON_PD_T("avx2_v2:any", avx2_embedding_bag_v2_t);
 
         status_t init(engine_t *engine) {
-            if(! platform::has_data_type_support(data_type)) {
+            using namespace data_type;
+
+            // tables are f32, bf16 or f16, accumulation is in f32 and
+            // output is f32 or bf16. bf16 and f16 are converted on load
+            // with AVX2 shift and F16C.
+            bool ok = desc()->input_desc.data_type == data_type
+                && utils::one_of(desc()->dst_desc.data_type, f32, bf16)
+                && IMPLICATION(desc()->is_weights,
+                               desc()->weights_desc.data_type == f32);
+            if (!ok)
                 return status::unimplemented;
+
+            if (data_type == f32) {
+                if (! platform::has_data_type_support(data_type))
+                    return status::unimplemented;
             }
+            else if (! x64::mayiuse(x64::avx2)) {
+                return status::unimplemented;
+            }
+
+            zendnn::zendnnEnv zenEnvObj = readEnv();
+            pf_dist_   = zenEnvObj.zenEmbPrefetchDist;
+            split_min_ = zenEnvObj.zenEmbSplitMin;
 
-            //initialize scratchpad
+            //initialize scratchpad, partial results of bags split across
+            //threads
             using namespace memory_tracking::names;
             auto scratchpad = scratchpad_registry().registrar();
             scratchpad.template
-            book<indices_type>(key_embed_bag_indices, EMB_SCRATCHPAD_LEN_V2);
-            scratchpad.template
-            book<input_type>(key_embed_bag_weights, EMB_SCRATCHPAD_LEN_V2);
+              book<float>(key_embed_bag_partials,
+                          emb_balance_scratch_size(desc()->num_threads,
+                                                   desc()->dst_desc.dims[1]));
 
             return status::success;
         }
+
+        int32_t pf_dist_   = EMB_PREFETCH_DIST;
+        int64_t split_min_ = EMB_SPLIT_MIN;
     };
     // constructor using pd_t
     avx2_embedding_bag_v2_t(const pd_t *apd) : primitive_t(apd) {}
@@ -84,9 +106,6 @@ struct avx2_embedding_bag_v2_t : public primitive_t {
     }
 
     using input_type   = typename prec_traits<data_type>::type;
-    using indices_type = int32_t;
-    using offsets_type = int32_t;
-    using dst_type     = input_type;
 
     // exec() override from primitive_t
     status_t execute(const exec_ctx_t &ctx) const override;
@@ -98,20 +117,9 @@ private:
 
     status_t pre_process(const exec_ctx_t &ctx,
                          emb_params_v2_t &params) const;
-    status_t avx2_sum(const emb_params_v2_t &params) const;
-    status_t avx2_sum_wt(const emb_params_v2_t &params) const;
-    status_t avx2_sum_pd(const emb_params_v2_t &params) const;
-    status_t avx2_sum_wt_pd(const emb_params_v2_t &params) const;
-
-    status_t avx2_mean(const emb_params_v2_t &params) const;
-    status_t avx2_mean_wt(const emb_params_v2_t &params) const;
-    status_t avx2_mean_pd(const emb_params_v2_t &params) const;
-    status_t avx2_mean_wt_pd(const emb_params_v2_t &params) const;
-
-    status_t avx2_max(const emb_params_v2_t &params) const;
-    status_t avx2_max_wt(const emb_params_v2_t &params) const;
-    status_t avx2_max_pd(const emb_params_v2_t &params) const;
-    status_t avx2_max_wt_pd(const emb_params_v2_t &params) const;
+    template <typename dst_type, typename idx_type>
+    status_t avx2_bags(const emb_params_v2_t &params, bool is_max,
+                       bool is_mean) const;
 
 };
 
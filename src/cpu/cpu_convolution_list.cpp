@@ -72,6 +72,9 @@
     using namespace zendnn::impl::cpu::aarch64;
 #endif
 #include "cpu/x64/zendnn_convolution.hpp"
+#include "cpu/x64/zendnn_x8s8s32x_convolution.hpp"
+#include "cpu/x64/zendnn_bf16_convolution.hpp"
+#include "cpu/x64/zendnn_blocked_convolution.hpp"
 #include "common/zendnn_private.hpp"
 
 namespace zendnn {
@@ -107,6 +110,7 @@ const std::map<conv_impl_key_t, std::vector<pd_create_f>> impl_list_map {
     // FWD fp
 #if ZENDNN_ENABLE
     {   {forward, f32, f32, f32}, {
+            CPU_INSTANCE_X64(zendnn_blocked_convolution_fwd_t)
 #if ZENDNN_DIRECT_CONV
             CPU_INSTANCE_X64(jit_avx2_1x1_convolution_fwd_t)
             CPU_INSTANCE_X64(jit_avx2_convolution_fwd_t)
@@ -117,15 +121,29 @@ const std::map<conv_impl_key_t, std::vector<pd_create_f>> impl_list_map {
             CPU_INSTANCE_X64(zendnn_convolution_fwd_t)
         }
     },
+    {   {forward, bf16, bf16, f32}, {
+            CPU_INSTANCE_X64(zendnn_bf16_convolution_fwd_t<f32>)
+            CPU_INSTANCE_X64(gemm_bf16_convolution_fwd_t<f32>)
+            CPU_INSTANCE(ref_convolution_fwd_t<bf16, bf16, f32, f32>)
+        }
+    },
+    {   {forward, bf16, bf16, bf16}, {
+            CPU_INSTANCE_X64(zendnn_bf16_convolution_fwd_t<bf16>)
+            CPU_INSTANCE_X64(gemm_bf16_convolution_fwd_t<bf16>)
+            CPU_INSTANCE(ref_convolution_fwd_t<bf16, bf16, bf16, f32>)
+        }
+    },
 #if ZENDNN_DIRECT_CONV
     {   {forward, u8, s8,u8}, {
             // Quantization Support
             // unsigned int8 input, signed int8  filters, unsigned int8 output (int32 bias accumulation)
+            CPU_INSTANCE_X64(zendnn_x8s8s32x_convolution_fwd_t<u8>)
             CPU_INSTANCE_X64(jit_uni_x8s8s32x_1x1_convolution_fwd_t<avx2, u8, u8>)
             CPU_INSTANCE_X64(jit_uni_x8s8s32x_convolution_fwd_t<avx2, u8, u8>)
         }
     },
     {   {forward, u8, s8,s8}, {
+            CPU_INSTANCE_X64(zendnn_x8s8s32x_convolution_fwd_t<s8>)
             CPU_INSTANCE_X64(jit_uni_x8s8s32x_1x1_convolution_fwd_t<avx2, u8, s8>)
             CPU_INSTANCE_X64(jit_uni_x8s8s32x_convolution_fwd_t<avx2, u8, s8>)
         }
@@ -143,7 +161,17 @@ const std::map<conv_impl_key_t, std::vector<pd_create_f>> impl_list_map {
             CPU_INSTANCE_X64(jit_uni_x8s8s32x_convolution_fwd_t<avx2, s8, s8>)
         }
     },
-#endif
+#else //ZENDNN_DIRECT_CONV
+    {   {forward, u8, s8,u8}, {
+            // Quantization Support with ZENDNN_INT8_SUPPORT=1
+            CPU_INSTANCE_X64(zendnn_x8s8s32x_convolution_fwd_t<u8>)
+        }
+    },
+    {   {forward, u8, s8,s8}, {
+            CPU_INSTANCE_X64(zendnn_x8s8s32x_convolution_fwd_t<s8>)
+        }
+    },
+#endif //ZENDNN_DIRECT_CONV
 #else //ZENDNN_ENABLE
     {   {forward, f32, f32, f32}, {
             CPU_INSTANCE_X64(ip_convolution_fwd_t)
@@ -7,6 +7,7 @@
 #include "cpu/ref_embedding_bag.hpp"
 #include "cpu/avx2_embedding_bag.hpp"
 #include "cpu/avx2_embedding_bag_v2.hpp"
+#include "cpu/avx2_embedding_bag_quant.hpp"
 
 namespace zendnn {
 namespace impl {
@@ -21,6 +22,9 @@ using namespace zendnn::impl::data_type;
 // clang-format off
 const pd_create_f impl_list[] = {
     CPU_INSTANCE(avx2_embedding_bag_v2_t<f32>)
+    CPU_INSTANCE(avx2_embedding_bag_v2_t<bf16>)
+    CPU_INSTANCE(avx2_embedding_bag_v2_t<f16>)
+    CPU_INSTANCE(avx2_embedding_bag_quant_t)
     CPU_INSTANCE(avx2_embedding_bag_t<f32>)
     CPU_INSTANCE(ref_embedding_bag_t<f32>)
     /* eol */
@@ -53,6 +53,7 @@ const pd_create_f impl_list[] = {
 #if ZENDNN_ENABLE
 #if ZENDNN_BLOCKED_POOLING
         CPU_INSTANCE_X64(jit_uni_pooling_fwd_t<avx2, f32>)
+        CPU_INSTANCE_X64(zendnn_pooling_fwd_t<avx512_core, f32>)
         CPU_INSTANCE(nchw_pooling_fwd_t<f32>)
         CPU_INSTANCE(ref_pooling_fwd_t<f32>)
 #endif
@@ -0,0 +1,201 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#ifndef CPU_EMBEDDING_BAG_BALANCE_HPP
+#define CPU_EMBEDDING_BAG_BALANCE_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include "common/zendnn_thread.hpp"
+
+// default length(in indices) of bags which are never split across threads
+#define  EMB_SPLIT_MIN              (256)
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+
+/* load balanced embedding bag scheduler.
+ * work of bag b is one unit for its output row plus one unit per index, so
+ * bag b is units [offsets[b] + b, offsets[b+1] + b + 1) of total
+ * indices_size + bags units. units are split into nthr equal ranges, one
+ * range per thread, so short bags are grouped and long bags are split.
+ * a range boundary falling inside a bag of at most split_min indices is
+ * moved to start of the bag, such bags are never split.
+ * bag completely inside a range is reduced by kernel into dst. pieces of a
+ * split bag are reduced by part_kernel(f32 output, mean false) into
+ * partials(3*dim floats per thread, emb_balance_scratch_size), thread
+ * holding first piece of the bag adds(or max) pieces of following threads
+ * and writes dst. weighted mean(is_mean && wts) is always reduced through
+ * partials and divided by sum of weights.
+ */
+template <typename tab_t, typename idx_t, typename out_t>
+using emb_balance_kernel_t = void (*)(const tab_t *table, const idx_t *rows,
+                                      int64_t row_stride, const float *wts,
+                                      int32_t count, int32_t padding_idx,
+                                      int32_t dim, bool mean,
+                                      int32_t pf_dist, out_t *dst);
+
+inline size_t emb_balance_scratch_size(int nthr, int32_t dim) {
+    return (size_t)nthr * 3 * dim;
+}
+
+template <typename tab_t, typename idx_t, typename out_t>
+void emb_bag_balanced(emb_balance_kernel_t<tab_t, idx_t, out_t> kernel,
+                      emb_balance_kernel_t<tab_t, idx_t, float> part_kernel,
+                      const tab_t *table, int64_t row_stride,
+                      const idx_t *indices, const idx_t *offsets,
+                      int64_t indices_size, int64_t bags, const float *wts,
+                      int32_t padding_idx, int32_t dim, bool is_max,
+                      bool is_mean, int32_t pf_dist, int64_t split_min,
+                      int nthr, float *partials, out_t *dst) {
+
+    if (bags <= 0)
+        return;
+
+    // first unit of bag b, bags is end of last bag
+    auto bag_unit = [=](int64_t b) -> int64_t {
+        return (b < bags ? (int64_t)offsets[b] : indices_size) + b;
+    };
+    // bag holding unit u
+    auto unit_bag = [=](int64_t u) -> int64_t {
+        int64_t lo = 0, hi = bags - 1;
+        while (lo < hi) {
+            int64_t mid = (lo + hi + 1) / 2;
+            if (bag_unit(mid) <= u)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        return lo;
+    };
+
+    const int64_t total = indices_size + bags;
+    if (total < nthr)
+        nthr = (int)total;
+
+    std::vector<int64_t> bound(nthr + 1);
+    bound[0]    = 0;
+    bound[nthr] = total;
+    for (int t = 1; t < nthr; ++t) {
+        int64_t u  = total * t / nthr;
+        int64_t b  = unit_bag(u);
+        int64_t hu = bag_unit(b);
+        if (u > hu && bag_unit(b + 1) - hu - 1 <= split_min)
+            u = hu;
+        bound[t] = std::max(u, bound[t - 1]);
+    }
+
+    // bag and divisor(valid rows, or sum of weights for weighted mean) of
+    // first(head) and last(tail) split piece of each range
+    std::vector<int64_t> head_bag(nthr, -1), tail_bag(nthr, -1);
+    std::vector<float>   head_den(nthr, 0.f), tail_den(nthr, 0.f);
+
+    const bool is_wmean = is_mean && wts;
+
+    auto finish = [=](const float *acc, float den, out_t *out) {
+        if (den == 0.f) {
+            for (int32_t j = 0; j < dim; ++j)
+                out[j] = 0.f;
+            return;
+        }
+        float scale = is_mean ? 1.f / den : 1.f;
+        for (int32_t j = 0; j < dim; ++j)
+            out[j] = acc[j] * scale;
+    };
+
+    parallel(nthr, [&](int ithr, int nthr_) {
+        for (int t = ithr; t < nthr; t += nthr_) {
+            const int64_t lo = bound[t], hi = bound[t + 1];
+            if (lo >= hi)
+                continue;
+
+            for (int64_t b = unit_bag(lo); b < bags && bag_unit(b) < hi; ++b) {
+                const int64_t hu     = bag_unit(b);
+                const int64_t hu_end = bag_unit(b + 1);
+                const bool    starts = hu >= lo;
+                const bool    ends   = hu_end <= hi;
+                const int64_t first  = (starts ? hu + 1 : lo) - b - 1;
+                const int64_t last   = (ends ? hu_end : hi) - b - 1;
+                const float  *w      = wts ? wts + first : nullptr;
+
+                if (starts && ends && !is_wmean) {
+                    kernel(table, indices + first, row_stride, w,
+                           last - first, padding_idx, dim, is_mean, pf_dist,
+                           dst + b * dim);
+                    continue;
+                }
+
+                float *acc = partials
+                             + ((size_t)t * 3 + (!starts ? 0 : ends ? 2 : 1))
+                             * dim;
+                part_kernel(table, indices + first, row_stride, w,
+                            last - first, padding_idx, dim, false, pf_dist,
+                            acc);
+
+                float den = 0.f;
+                for (int64_t i = first; i < last; ++i) {
+                    if (indices[i] != padding_idx)
+                        den += is_wmean ? wts[i] : 1.f;
+                }
+
+                if (starts && ends) {
+                    finish(acc, den, dst + b * dim);
+                }
+                else if (!starts) {
+                    head_bag[t] = b;
+                    head_den[t] = den;
+                }
+                else {
+                    tail_bag[t] = b;
+                    tail_den[t] = den;
+                }
+            }
+        }
+    });
+
+    // reduce split bags, pieces of a bag are in consecutive non empty ranges
+    parallel(nthr, [&](int ithr, int nthr_) {
+        for (int t = ithr; t < nthr; t += nthr_) {
+            const int64_t b = tail_bag[t];
+            if (b < 0)
+                continue;
+
+            float *acc = partials + (size_t)t * 3 * dim + dim;
+            float  den = tail_den[t];
+            for (int u = t + 1; u < nthr; ++u) {
+                if (bound[u] == bound[u + 1])
+                    continue;
+                if (head_bag[u] != b)
+                    break;
+
+                const float *piece = partials + (size_t)u * 3 * dim;
+                if (is_max) {
+                    if (head_den[u] == 0.f)
+                        continue;
+                    if (den == 0.f)
+                        std::copy(piece, piece + dim, acc);
+                    else
+                        for (int32_t j = 0; j < dim; ++j)
+                            acc[j] = std::max(acc[j], piece[j]);
+                }
+                else {
+                    for (int32_t j = 0; j < dim; ++j)
+                        acc[j] += piece[j];
+                }
+                den += head_den[u];
+            }
+            finish(acc, den, dst + b * dim);
+        }
+    });
+}
+
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+#endif
@@ -0,0 +1,678 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#include <cstring>
+#include <immintrin.h>
+
+#include "common/bit_cast.hpp"
+
+#include "cpu/platform.hpp"
+#include "cpu/x64/cpu_isa_traits.hpp"
+
+#include "cpu/embedding_bag_kernels.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+
+namespace {
+
+static_assert(EMB_KERNEL_NV == 8, "emb_bag_row handles 0-7 tail vectors");
+
+#define EMB_INLINE inline __attribute__((always_inline))
+
+// vectors of VLEN elements, u* types are for unaligned access
+template <int VLEN>
+struct emb_vec_t {
+    typedef float    f32  __attribute__((vector_size(VLEN*sizeof(float))));
+    typedef f32      uf32 __attribute__((aligned(sizeof(float))));
+    typedef uint32_t u32  __attribute__((vector_size(VLEN*sizeof(uint32_t))));
+    typedef uint16_t u16  __attribute__((vector_size(VLEN*sizeof(uint16_t))));
+    typedef u16      uu16 __attribute__((aligned(sizeof(uint16_t))));
+    typedef uint8_t  u8   __attribute__((vector_size(VLEN*sizeof(uint8_t))));
+    typedef u8       uu8  __attribute__((aligned(1)));
+    // VLEN/2 lanes, for 4 bit values
+    typedef uint8_t  u8h  __attribute__((vector_size(VLEN/2*sizeof(uint8_t))));
+    typedef u8h      uu8h __attribute__((aligned(1)));
+    typedef uint16_t u16h __attribute__((vector_size(VLEN/2*sizeof(uint16_t))));
+};
+
+EMB_INLINE float emb_bf16_to_f32(uint16_t raw) {
+    return utils::bit_cast<float>((uint32_t)raw << 16);
+}
+
+// round to nearest even, NaN stays(quiet) NaN
+EMB_INLINE uint16_t emb_f32_to_bf16(float f) {
+    uint32_t u = utils::bit_cast<uint32_t>(f);
+    if (f != f)
+        return (u >> 16) | 0x40;
+    return (u + 0x7fff + ((u >> 16) & 1)) >> 16;
+}
+
+/* conversion of VLEN(vector) or one(scalar) element of table or dst type
+ * to/from f32
+ */
+template <int VLEN, typename data_t>
+struct emb_io_t;
+
+template <int VLEN>
+struct emb_io_t<VLEN, float> {
+    typedef typename emb_vec_t<VLEN>::f32  f32;
+    typedef typename emb_vec_t<VLEN>::uf32 uf32;
+
+    static EMB_INLINE void load(f32 &x, const float *p) {
+        x = *(const uf32 *)p;
+    }
+    static EMB_INLINE float load1(const float *p) {
+        return *p;
+    }
+    static EMB_INLINE void store(float *p, const f32 &x) {
+        *(uf32 *)p = x;
+    }
+    static EMB_INLINE void store1(float *p, float x) {
+        *p = x;
+    }
+};
+
+// bf16 is upper half of f32, converted by shift
+template <int VLEN>
+struct emb_io_t<VLEN, bfloat16_t> {
+    typedef typename emb_vec_t<VLEN>::f32  f32;
+    typedef typename emb_vec_t<VLEN>::u32  u32;
+    typedef typename emb_vec_t<VLEN>::u16  u16;
+    typedef typename emb_vec_t<VLEN>::uu16 uu16;
+
+    static EMB_INLINE void load(f32 &x, const bfloat16_t *p) {
+        u16 h = *(const uu16 *)p;
+        x = (f32)(__builtin_convertvector(h, u32) << 16);
+    }
+    static EMB_INLINE float load1(const bfloat16_t *p) {
+        return emb_bf16_to_f32(p->raw_bits_);
+    }
+    static EMB_INLINE void store(bfloat16_t *p, const f32 &x) {
+        u32 u   = (u32)x;
+        u32 rne = (u + 0x7fff + ((u >> 16) & 1)) >> 16;
+        u32 nan = (u32)(x != x);
+        u32 r   = (nan & ((u >> 16) | 0x40)) | (~nan & rne);
+        *(uu16 *)p = __builtin_convertvector(r, u16);
+    }
+    static EMB_INLINE void store1(bfloat16_t *p, float x) {
+        p->raw_bits_ = emb_f32_to_bf16(x);
+    }
+};
+
+// f16 is converted by vcvtph2ps(F16C with AVX2, AVX-512F)
+template <>
+struct emb_io_t<8, float16_t> {
+    typedef emb_vec_t<8>::f32 f32;
+
+    static EMB_INLINE void load(f32 &x, const float16_t *p) {
+        x = (f32)_mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)p));
+    }
+    static EMB_INLINE float load1(const float16_t *p) {
+        return (float)*p;
+    }
+};
+
+// load is not always_inline as AVX-512 intrinsic can't be inlined into
+// generic block templates, it is inlined by flatten of emb_bag_avx512.
+template <>
+struct emb_io_t<16, float16_t> {
+    typedef emb_vec_t<16>::f32 f32;
+
+    __attribute__((target("avx512f")))
+    static inline void load(f32 &x, const float16_t *p) {
+        x = (f32)_mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)p));
+    }
+    static EMB_INLINE float load1(const float16_t *p) {
+        return (float)*p;
+    }
+};
+
+// prefetch bytes of a row, last line separately as row need not be cache
+// line aligned
+EMB_INLINE void emb_prefetch(const void *row, int32_t bytes) {
+    const char *p = (const char *)row;
+    for (int32_t j = 0; j < bytes; j += 64) {
+        _mm_prefetch(p + j, _MM_HINT_T0);
+    }
+    _mm_prefetch(p + bytes - 1, _MM_HINT_T0);
+}
+
+// table row of bag row i, through remap if REMAP
+template <bool REMAP, typename idx_t>
+EMB_INLINE int64_t emb_row(const idx_t *rows, const int32_t *remap,
+                           int32_t i) {
+    return REMAP ? (int64_t)remap[rows[i]] : (int64_t)rows[i];
+}
+
+/* NV*VLEN + rem columns of the bag, NV vectors are accumulated in registers
+ * and rem(< VLEN) tail columns in scalars, each row is read once.
+ * with REMAP, remap entries are prefetched pf_dist rows ahead of the rows.
+ */
+template <int VLEN, int NV, bool MAX, bool WT, bool REMAP, typename in_t,
+          typename out_t, typename idx_t>
+EMB_INLINE void emb_bag_block(
+    const in_t *table, const idx_t *rows, const int32_t *remap,
+    int64_t row_stride, const float *wts, int32_t count, int32_t padding_idx,
+    int32_t rem, bool mean, int32_t pf_dist, out_t *dst) {
+    typedef emb_io_t<VLEN, in_t>  in_io;
+    typedef emb_io_t<VLEN, out_t> out_io;
+    typedef typename emb_vec_t<VLEN>::f32 vec;
+
+    const int32_t bytes = (NV*VLEN + rem)*sizeof(in_t);
+    vec   acc[NV > 0 ? NV : 1];
+    float tacc[VLEN];
+    int32_t valid = 0;
+
+    for (int32_t i = 0; i < pf_dist && i < count; ++i) {
+        if (REMAP && i + pf_dist < count && rows[i + pf_dist] != padding_idx) {
+            _mm_prefetch((const char *)(remap + rows[i + pf_dist]),
+                         _MM_HINT_T0);
+        }
+        if (!REMAP || rows[i] != padding_idx) {
+            emb_prefetch(table + emb_row<REMAP>(rows, remap, i)*row_stride,
+                         bytes);
+        }
+    }
+
+    for (int32_t i = 0; i < count; ++i) {
+        if (REMAP && i + 2*pf_dist < count && pf_dist
+                && rows[i + 2*pf_dist] != padding_idx) {
+            _mm_prefetch((const char *)(remap + rows[i + 2*pf_dist]),
+                         _MM_HINT_T0);
+        }
+        if (i + pf_dist < count && pf_dist
+                && (!REMAP || rows[i + pf_dist] != padding_idx)) {
+            emb_prefetch(table
+                         + emb_row<REMAP>(rows, remap, i + pf_dist)*row_stride,
+                         bytes);
+        }
+        if (rows[i] == padding_idx) {
+            continue;
+        }
+
+        const in_t  *row = table + emb_row<REMAP>(rows, remap, i)*row_stride;
+        const float  w   = WT ? wts[i] : 1.0f;
+        if (valid == 0) {
+            #pragma GCC unroll 8
+            for (int v = 0; v < NV; ++v) {
+                vec x;
+                in_io::load(x, row + v*VLEN);
+                acc[v] = WT ? x*w : x;
+            }
+            for (int32_t j = 0; j < rem; ++j) {
+                tacc[j] = w*in_io::load1(row + NV*VLEN + j);
+            }
+        }
+        else if (MAX) {
+            #pragma GCC unroll 8
+            for (int v = 0; v < NV; ++v) {
+                vec x;
+                in_io::load(x, row + v*VLEN);
+                x      = WT ? x*w : x;
+                acc[v] = acc[v] > x ? acc[v] : x;
+            }
+            for (int32_t j = 0; j < rem; ++j) {
+                float x = w*in_io::load1(row + NV*VLEN + j);
+                tacc[j] = tacc[j] > x ? tacc[j] : x;
+            }
+        }
+        else {
+            #pragma GCC unroll 8
+            for (int v = 0; v < NV; ++v) {
+                vec x;
+                in_io::load(x, row + v*VLEN);
+                acc[v] = WT ? acc[v] + x*w : acc[v] + x;
+            }
+            for (int32_t j = 0; j < rem; ++j) {
+                tacc[j] += w*in_io::load1(row + NV*VLEN + j);
+            }
+        }
+        valid++;
+    }
+
+    const float scale = valid == 0 ? 0.0f : (mean ? 1.0f/valid : 1.0f);
+    #pragma GCC unroll 8
+    for (int v = 0; v < NV; ++v) {
+        vec x = valid == 0 ? vec{} : acc[v]*scale;
+        out_io::store(dst + v*VLEN, x);
+    }
+    for (int32_t j = 0; j < rem; ++j) {
+        out_io::store1(dst + NV*VLEN + j, valid == 0 ? 0.0f : tacc[j]*scale);
+    }
+}
+
+/* whole bag, columns are walked in blocks of EMB_KERNEL_NV vectors and the
+ * last block takes remaining vectors and tail columns.
+ */
+template <int VLEN, bool MAX, bool WT, bool REMAP, typename in_t,
+          typename out_t, typename idx_t>
+EMB_INLINE void emb_bag_row(
+    const in_t *table, const idx_t *rows, const int32_t *remap,
+    int64_t row_stride, const float *wts, int32_t count, int32_t padding_idx,
+    int32_t dim, bool mean, int32_t pf_dist, out_t *dst) {
+    const int32_t blk = EMB_KERNEL_NV*VLEN;
+
+    int32_t c = 0;
+    for (; c + blk <= dim; c += blk) {
+        emb_bag_block<VLEN, EMB_KERNEL_NV, MAX, WT, REMAP>(table + c, rows,
+                remap, row_stride, wts, count, padding_idx, 0, mean, pf_dist,
+                dst + c);
+    }
+
+    const int32_t nv  = (dim - c)/VLEN;
+    const int32_t rem = (dim - c)%VLEN;
+    if (nv == 0 && rem == 0) {
+        return;
+    }
+
+#define EMB_BAG_TAIL(n) \
+    case n: \
+        emb_bag_block<VLEN, n, MAX, WT, REMAP>(table + c, rows, remap, \
+                row_stride, wts, count, padding_idx, rem, mean, pf_dist, \
+                dst + c); \
+        break;
+
+    switch (nv) {
+        EMB_BAG_TAIL(0)
+        EMB_BAG_TAIL(1)
+        EMB_BAG_TAIL(2)
+        EMB_BAG_TAIL(3)
+        EMB_BAG_TAIL(4)
+        EMB_BAG_TAIL(5)
+        EMB_BAG_TAIL(6)
+        EMB_BAG_TAIL(7)
+    }
+#undef EMB_BAG_TAIL
+}
+
+template <typename in_t, typename out_t, typename idx_t, bool MAX, bool WT>
+void emb_bag_avx2(const in_t *table, const idx_t *rows,
+                  int64_t row_stride, const float *wts, int32_t count,
+                  int32_t padding_idx, int32_t dim, bool mean,
+                  int32_t pf_dist, out_t *dst) {
+    emb_bag_row<8, MAX, WT, false>(table, rows, nullptr, row_stride, wts,
+                                   count, padding_idx, dim, mean, pf_dist,
+                                   dst);
+}
+
+template <typename in_t, typename out_t, typename idx_t, bool MAX, bool WT>
+__attribute__((target("avx512f"), flatten))
+void emb_bag_avx512(const in_t *table, const idx_t *rows,
+                    int64_t row_stride, const float *wts, int32_t count,
+                    int32_t padding_idx, int32_t dim, bool mean,
+                    int32_t pf_dist, out_t *dst) {
+    emb_bag_row<16, MAX, WT, false>(table, rows, nullptr, row_stride, wts,
+                                    count, padding_idx, dim, mean, pf_dist,
+                                    dst);
+}
+
+template <typename in_t, typename out_t, typename idx_t, bool MAX, bool WT>
+void emb_bag_remap_avx2(const in_t *table, const idx_t *rows,
+                        const int32_t *remap, int64_t row_stride,
+                        const float *wts, int32_t count, int32_t padding_idx,
+                        int32_t dim, bool mean, int32_t pf_dist, out_t *dst) {
+    emb_bag_row<8, MAX, WT, true>(table, rows, remap, row_stride, wts, count,
+                                  padding_idx, dim, mean, pf_dist, dst);
+}
+
+template <typename in_t, typename out_t, typename idx_t, bool MAX, bool WT>
+__attribute__((target("avx512f"), flatten))
+void emb_bag_remap_avx512(const in_t *table, const idx_t *rows,
+                          const int32_t *remap, int64_t row_stride,
+                          const float *wts, int32_t count,
+                          int32_t padding_idx, int32_t dim, bool mean,
+                          int32_t pf_dist, out_t *dst) {
+    emb_bag_row<16, MAX, WT, true>(table, rows, remap, row_stride, wts, count,
+                                   padding_idx, dim, mean, pf_dist, dst);
+}
+
+/* quantized row: BITS(8 or 4) bit values followed by scale and bias of
+ * scale_t, 4 bit values are packed two per byte with even column in low
+ * nibble.
+ */
+template <int VLEN, int BITS>
+struct emb_qio_t;
+
+template <int VLEN>
+struct emb_qio_t<VLEN, 8> {
+    typedef typename emb_vec_t<VLEN>::f32 f32;
+    typedef typename emb_vec_t<VLEN>::uu8 uu8;
+
+    // VLEN values of columns starting at byte p
+    static EMB_INLINE void load(f32 &x, const uint8_t *p) {
+        x = __builtin_convertvector(*(const uu8 *)p, f32);
+    }
+    static EMB_INLINE float load1(const uint8_t *row, int32_t col) {
+        return row[col];
+    }
+};
+
+// nibbles are spread to bytes in u16 lanes, low byte keeps even column
+template <int VLEN>
+struct emb_qio_t<VLEN, 4> {
+    typedef typename emb_vec_t<VLEN>::f32  f32;
+    typedef typename emb_vec_t<VLEN>::u8   u8;
+    typedef typename emb_vec_t<VLEN>::uu8h uu8h;
+    typedef typename emb_vec_t<VLEN>::u16h u16h;
+
+    static EMB_INLINE void load(f32 &x, const uint8_t *p) {
+        u16h w = __builtin_convertvector(*(const uu8h *)p, u16h);
+        w      = (w & 0xf) | ((w & 0xf0) << 4);
+        x      = __builtin_convertvector((u8)w, f32);
+    }
+    static EMB_INLINE float load1(const uint8_t *row, int32_t col) {
+        return (row[col >> 1] >> ((col & 1)*4)) & 0xf;
+    }
+};
+
+// scale and bias of a row, they need not be aligned
+template <typename scale_t>
+EMB_INLINE void emb_qparams(const uint8_t *p, float &scale, float &bias);
+
+template <>
+EMB_INLINE void emb_qparams<float>(const uint8_t *p, float &scale,
+                                   float &bias) {
+    memcpy(&scale, p, sizeof(float));
+    memcpy(&bias, p + sizeof(float), sizeof(float));
+}
+
+template <>
+EMB_INLINE void emb_qparams<float16_t>(const uint8_t *p, float &scale,
+                                       float &bias) {
+    uint16_t raw[2];
+    memcpy(raw, p, sizeof(raw));
+    scale = _cvtsh_ss(raw[0]);
+    bias  = _cvtsh_ss(raw[1]);
+}
+
+/* same as emb_bag_block for columns col ... col + NV*VLEN + rem of
+ * quantized rows, row values are scale*q + bias. For sum weighted bias of
+ * the rows is accumulated once in a scalar instead of per column.
+ */
+template <int VLEN, int NV, int BITS, typename scale_t, bool MAX, bool WT,
+          typename out_t, typename idx_t>
+EMB_INLINE void emb_qbag_block(
+    const uint8_t *table, const idx_t *rows, int64_t row_stride,
+    const float *wts, int32_t count, int32_t padding_idx, int32_t col,
+    int32_t rem, int32_t qbytes, bool mean, int32_t pf_dist, out_t *dst) {
+    typedef emb_qio_t<VLEN, BITS> in_io;
+    typedef emb_io_t<VLEN, out_t> out_io;
+    typedef typename emb_vec_t<VLEN>::f32 vec;
+
+    const int32_t cbyte = col*BITS/8;
+    const int32_t bytes = ((NV*VLEN + rem)*BITS + 7)/8;
+    vec   acc[NV > 0 ? NV : 1];
+    float tacc[VLEN];
+    float bsum  = 0.0f;
+    int32_t valid = 0;
+
+    for (int32_t i = 0; i < pf_dist && i < count; ++i) {
+        const uint8_t *row = table + rows[i]*row_stride;
+        emb_prefetch(row + cbyte, bytes);
+        _mm_prefetch((const char *)row + qbytes, _MM_HINT_T0);
+    }
+
+    for (int32_t i = 0; i < count; ++i) {
+        if (i + pf_dist < count && pf_dist) {
+            const uint8_t *row = table + rows[i + pf_dist]*row_stride;
+            emb_prefetch(row + cbyte, bytes);
+            _mm_prefetch((const char *)row + qbytes, _MM_HINT_T0);
+        }
+        if (rows[i] == padding_idx) {
+            continue;
+        }
+
+        const uint8_t *row = table + rows[i]*row_stride;
+        float scale, bias;
+        emb_qparams<scale_t>(row + qbytes, scale, bias);
+        if (WT) {
+            scale *= wts[i];
+            bias  *= wts[i];
+        }
+        const uint8_t *q = row + cbyte;
+
+        // first valid row initializes accumulators, max adds bias per
+        // column and keeps bsum 0
+        if (valid == 0) {
+            const float cbias = MAX ? bias : 0.0f;
+            const vec   vbias = vec{} + cbias;
+            #pragma GCC unroll 8
+            for (int v = 0; v < NV; ++v) {
+                vec x;
+                in_io::load(x, q + v*VLEN*BITS/8);
+                acc[v] = x*scale + vbias;
+            }
+            for (int32_t j = 0; j < rem; ++j) {
+                tacc[j] = in_io::load1(row, col + NV*VLEN + j)*scale + cbias;
+            }
+            bsum = MAX ? 0.0f : bias;
+        }
+        else if (MAX) {
+            const vec vbias = vec{} + bias;
+            #pragma GCC unroll 8
+            for (int v = 0; v < NV; ++v) {
+                vec x;
+                in_io::load(x, q + v*VLEN*BITS/8);
+                x      = x*scale + vbias;
+                acc[v] = acc[v] > x ? acc[v] : x;
+            }
+            for (int32_t j = 0; j < rem; ++j) {
+                float x = in_io::load1(row, col + NV*VLEN + j)*scale + bias;
+                tacc[j] = tacc[j] > x ? tacc[j] : x;
+            }
+        }
+        else {
+            #pragma GCC unroll 8
+            for (int v = 0; v < NV; ++v) {
+                vec x;
+                in_io::load(x, q + v*VLEN*BITS/8);
+                acc[v] += x*scale;
+            }
+            for (int32_t j = 0; j < rem; ++j) {
+                tacc[j] += in_io::load1(row, col + NV*VLEN + j)*scale;
+            }
+            bsum += bias;
+        }
+        valid++;
+    }
+
+    const float scale = valid == 0 ? 0.0f : (mean ? 1.0f/valid : 1.0f);
+    #pragma GCC unroll 8
+    for (int v = 0; v < NV; ++v) {
+        vec x = valid == 0 ? vec{} : (acc[v] + bsum)*scale;
+        out_io::store(dst + v*VLEN, x);
+    }
+    for (int32_t j = 0; j < rem; ++j) {
+        out_io::store1(dst + NV*VLEN + j,
+                       valid == 0 ? 0.0f : (tacc[j] + bsum)*scale);
+    }
+}
+
+/* whole quantized bag, blocks as in emb_bag_row. block columns are
+ * multiple of VLEN so 4 bit blocks start at byte boundary.
+ */
+template <int VLEN, int BITS, typename scale_t, bool MAX, bool WT,
+          typename out_t, typename idx_t>
+EMB_INLINE void emb_qbag_row(
+    const uint8_t *table, const idx_t *rows, int64_t row_stride,
+    const float *wts, int32_t count, int32_t padding_idx, int32_t dim,
+    bool mean, int32_t pf_dist, out_t *dst) {
+    const int32_t blk    = EMB_KERNEL_NV*VLEN;
+    const int32_t qbytes = (dim*BITS + 7)/8;
+
+    int32_t c = 0;
+    for (; c + blk <= dim; c += blk) {
+        emb_qbag_block<VLEN, EMB_KERNEL_NV, BITS, scale_t, MAX, WT>(table,
+                rows, row_stride, wts, count, padding_idx, c, 0, qbytes,
+                mean, pf_dist, dst + c);
+    }
+
+    const int32_t nv  = (dim - c)/VLEN;
+    const int32_t rem = (dim - c)%VLEN;
+    if (nv == 0 && rem == 0) {
+        return;
+    }
+
+#define EMB_QBAG_TAIL(n) \
+    case n: \
+        emb_qbag_block<VLEN, n, BITS, scale_t, MAX, WT>(table, rows, \
+                row_stride, wts, count, padding_idx, c, rem, qbytes, mean, \
+                pf_dist, dst + c); \
+        break;
+
+    switch (nv) {
+        EMB_QBAG_TAIL(0)
+        EMB_QBAG_TAIL(1)
+        EMB_QBAG_TAIL(2)
+        EMB_QBAG_TAIL(3)
+        EMB_QBAG_TAIL(4)
+        EMB_QBAG_TAIL(5)
+        EMB_QBAG_TAIL(6)
+        EMB_QBAG_TAIL(7)
+    }
+#undef EMB_QBAG_TAIL
+}
+
+template <int BITS, typename scale_t, typename out_t, typename idx_t, bool MAX,
+          bool WT>
+void emb_qbag_avx2(const uint8_t *table, const idx_t *rows,
+                   int64_t row_stride, const float *wts, int32_t count,
+                   int32_t padding_idx, int32_t dim, bool mean,
+                   int32_t pf_dist, out_t *dst) {
+    emb_qbag_row<8, BITS, scale_t, MAX, WT>(table, rows, row_stride, wts,
+                                            count, padding_idx, dim, mean,
+                                            pf_dist, dst);
+}
+
+template <int BITS, typename scale_t, typename out_t, typename idx_t, bool MAX,
+          bool WT>
+__attribute__((target("avx512f"), flatten))
+void emb_qbag_avx512(const uint8_t *table, const idx_t *rows,
+                     int64_t row_stride, const float *wts, int32_t count,
+                     int32_t padding_idx, int32_t dim, bool mean,
+                     int32_t pf_dist, out_t *dst) {
+    emb_qbag_row<16, BITS, scale_t, MAX, WT>(table, rows, row_stride, wts,
+                                             count, padding_idx, dim, mean,
+                                             pf_dist, dst);
+}
+
+template <int BITS, typename scale_t, typename out_t, typename idx_t>
+emb_qbag_kernel_t<out_t, idx_t> emb_qbag_select(bool is_max,
+                                                bool is_weights) {
+#define EMB_QBAG(isa, max, wt) \
+    emb_qbag_##isa<BITS, scale_t, out_t, idx_t, max, wt>
+
+    if (x64::mayiuse(x64::avx512_core)) {
+        if (is_max)
+            return is_weights ? EMB_QBAG(avx512, true, true)
+                              : EMB_QBAG(avx512, true, false);
+        return is_weights ? EMB_QBAG(avx512, false, true)
+                          : EMB_QBAG(avx512, false, false);
+    }
+
+    if (is_max)
+        return is_weights ? EMB_QBAG(avx2, true, true)
+                          : EMB_QBAG(avx2, true, false);
+    return is_weights ? EMB_QBAG(avx2, false, true)
+                      : EMB_QBAG(avx2, false, false);
+#undef EMB_QBAG
+}
+
+#undef EMB_INLINE
+
+} // namespace
+
+template <typename in_t, typename out_t, typename idx_t>
+emb_bag_kernel_t<in_t, out_t, idx_t> get_emb_bag_kernel(bool is_max,
+                                                        bool is_weights) {
+    if (x64::mayiuse(x64::avx512_core)) {
+        if (is_max)
+            return is_weights ? emb_bag_avx512<in_t, out_t, idx_t, true, true>
+                              : emb_bag_avx512<in_t, out_t, idx_t, true, false>;
+        return is_weights ? emb_bag_avx512<in_t, out_t, idx_t, false, true>
+                          : emb_bag_avx512<in_t, out_t, idx_t, false, false>;
+    }
+
+    if (is_max)
+        return is_weights ? emb_bag_avx2<in_t, out_t, idx_t, true, true>
+                          : emb_bag_avx2<in_t, out_t, idx_t, true, false>;
+    return is_weights ? emb_bag_avx2<in_t, out_t, idx_t, false, true>
+                      : emb_bag_avx2<in_t, out_t, idx_t, false, false>;
+}
+
+#define EMB_BAG_INST(in_t, out_t, idx_t) \
+    template emb_bag_kernel_t<in_t, out_t, idx_t> \
+    get_emb_bag_kernel<in_t, out_t, idx_t>(bool, bool);
+
+EMB_BAG_INST(float, float, int32_t)
+EMB_BAG_INST(float, bfloat16_t, int32_t)
+EMB_BAG_INST(bfloat16_t, float, int32_t)
+EMB_BAG_INST(bfloat16_t, bfloat16_t, int32_t)
+EMB_BAG_INST(float16_t, float, int32_t)
+EMB_BAG_INST(float16_t, bfloat16_t, int32_t)
+EMB_BAG_INST(float, float, int64_t)
+EMB_BAG_INST(float, bfloat16_t, int64_t)
+EMB_BAG_INST(bfloat16_t, float, int64_t)
+EMB_BAG_INST(bfloat16_t, bfloat16_t, int64_t)
+EMB_BAG_INST(float16_t, float, int64_t)
+EMB_BAG_INST(float16_t, bfloat16_t, int64_t)
+#undef EMB_BAG_INST
+
+template <typename in_t, typename out_t, typename idx_t>
+emb_bag_remap_kernel_t<in_t, out_t, idx_t> get_emb_bag_remap_kernel(
+    bool is_max, bool is_weights) {
+#define EMB_BAG_REMAP(isa, max, wt) \
+    emb_bag_remap_##isa<in_t, out_t, idx_t, max, wt>
+
+    if (x64::mayiuse(x64::avx512_core)) {
+        if (is_max)
+            return is_weights ? EMB_BAG_REMAP(avx512, true, true)
+                              : EMB_BAG_REMAP(avx512, true, false);
+        return is_weights ? EMB_BAG_REMAP(avx512, false, true)
+                          : EMB_BAG_REMAP(avx512, false, false);
+    }
+
+    if (is_max)
+        return is_weights ? EMB_BAG_REMAP(avx2, true, true)
+                          : EMB_BAG_REMAP(avx2, true, false);
+    return is_weights ? EMB_BAG_REMAP(avx2, false, true)
+                      : EMB_BAG_REMAP(avx2, false, false);
+#undef EMB_BAG_REMAP
+}
+
+template emb_bag_remap_kernel_t<float, float, int32_t>
+get_emb_bag_remap_kernel<float, float, int32_t>(bool, bool);
+template emb_bag_remap_kernel_t<float, float, int64_t>
+get_emb_bag_remap_kernel<float, float, int64_t>(bool, bool);
+
+template <typename out_t, typename idx_t>
+emb_qbag_kernel_t<out_t, idx_t> get_emb_qbag_kernel(int32_t bits,
+                                                    bool is_f16_scale,
+                                                    bool is_max,
+                                                    bool is_weights) {
+    if (bits == 4)
+        return is_f16_scale
+               ? emb_qbag_select<4, float16_t, out_t, idx_t>(is_max, is_weights)
+               : emb_qbag_select<4, float, out_t, idx_t>(is_max, is_weights);
+    return is_f16_scale
+           ? emb_qbag_select<8, float16_t, out_t, idx_t>(is_max, is_weights)
+           : emb_qbag_select<8, float, out_t, idx_t>(is_max, is_weights);
+}
+
+#define EMB_QBAG_INST(out_t, idx_t) \
+    template emb_qbag_kernel_t<out_t, idx_t> \
+    get_emb_qbag_kernel<out_t, idx_t>(int32_t, bool, bool, bool);
+
+EMB_QBAG_INST(float, int32_t)
+EMB_QBAG_INST(bfloat16_t, int32_t)
+EMB_QBAG_INST(float, int64_t)
+EMB_QBAG_INST(bfloat16_t, int64_t)
+#undef EMB_QBAG_INST
+
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
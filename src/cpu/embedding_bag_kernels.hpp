@@ -0,0 +1,93 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#ifndef CPU_EMBEDDING_BAG_KERNELS_HPP
+#define CPU_EMBEDDING_BAG_KERNELS_HPP
+
+#include <cstdint>
+
+#include "common/bfloat16.hpp"
+#include "common/float16.hpp"
+
+// number of vector accumulators held in registers per pass over the bag
+#define  EMB_KERNEL_NV              (8)
+// default distance(in bag rows) of software prefetch
+#define  EMB_PREFETCH_DIST          (8)
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+
+/* reduces one bag of embedding rows(f32, bf16 or f16) into dst(f32 or
+ * bf16), accumulation is always in f32.
+ * row i of the bag starts at table + rows[i]*row_stride, rows(idx_t s32 or
+ * s64) are either indices(row_stride = dim) or offsets premultiplied by
+ * dim(row_stride = 1), row address is computed in 64 bit.
+ * rows equal to padding_idx are skipped, a bag without rows gives zeros.
+ * dst is kept in EMB_KERNEL_NV vector registers and each row is streamed
+ * once per EMB_KERNEL_NV vectors of columns, rows pf_dist ahead are
+ * prefetched(pf_dist 0 disables prefetch).
+ */
+template <typename in_t, typename out_t, typename idx_t = int32_t>
+using emb_bag_kernel_t = void (*)(const in_t *table, const idx_t *rows,
+                                  int64_t row_stride, const float *wts,
+                                  int32_t count, int32_t padding_idx,
+                                  int32_t dim, bool mean, int32_t pf_dist,
+                                  out_t *dst);
+
+/* returns sum(or mean) kernel, max kernel if is_max. is_weights selects
+ * kernel scaling each row by wts[i].
+ * instantiated for in_t float, bfloat16_t, float16_t, out_t float,
+ * bfloat16_t and idx_t int32_t, int64_t.
+ */
+template <typename in_t, typename out_t, typename idx_t = int32_t>
+emb_bag_kernel_t<in_t, out_t, idx_t> get_emb_bag_kernel(bool is_max,
+                                                        bool is_weights);
+
+/* as emb_bag_kernel_t for tables with rows reordered(e.g. by access
+ * frequency), bag row i is row remap[rows[i]] of table. padding_idx is
+ * compared with rows[i] before remap. remap entries are prefetched ahead
+ * of the rows.
+ * instantiated for in_t, out_t float and idx_t int32_t, int64_t.
+ */
+template <typename in_t, typename out_t, typename idx_t = int32_t>
+using emb_bag_remap_kernel_t = void (*)(const in_t *table,
+                                        const idx_t *rows,
+                                        const int32_t *remap,
+                                        int64_t row_stride,
+                                        const float *wts, int32_t count,
+                                        int32_t padding_idx, int32_t dim,
+                                        bool mean, int32_t pf_dist,
+                                        out_t *dst);
+
+template <typename in_t, typename out_t, typename idx_t = int32_t>
+emb_bag_remap_kernel_t<in_t, out_t, idx_t> get_emb_bag_remap_kernel(
+    bool is_max, bool is_weights);
+
+/* quantized tables: row is dim values of bits(8 or 4) followed by scale
+ * and bias(f32, or f16 if is_f16_scale), value of column j is
+ * scale*q[j] + bias. 4 bit values are packed two per byte with even column
+ * in low nibble(PyTorch/FBGEMM fused rowwise layout). row i starts at byte
+ * rows[i]*row_stride of table, other arguments are as in emb_bag_kernel_t.
+ */
+template <typename out_t, typename idx_t = int32_t>
+using emb_qbag_kernel_t = void (*)(const uint8_t *table, const idx_t *rows,
+                                   int64_t row_stride, const float *wts,
+                                   int32_t count, int32_t padding_idx,
+                                   int32_t dim, bool mean, int32_t pf_dist,
+                                   out_t *dst);
+
+// instantiated for out_t float, bfloat16_t and idx_t int32_t, int64_t
+template <typename out_t, typename idx_t = int32_t>
+emb_qbag_kernel_t<out_t, idx_t> get_emb_qbag_kernel(int32_t bits,
+                                                    bool is_f16_scale,
+                                                    bool is_max,
+                                                    bool is_weights);
+
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+#endif
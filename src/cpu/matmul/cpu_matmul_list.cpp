@@ -29,6 +29,7 @@
 #if ZENDNN_X64
 #include "cpu/x64/matmul/brgemm_matmul.hpp"
 #include "cpu/matmul/zendnn_f32_matmul.hpp"
+#include "cpu/matmul/zendnn_bf16_matmul.hpp"
 using namespace zendnn::impl::cpu::x64::matmul;
 using namespace zendnn::impl::cpu::x64;
 #endif
@@ -47,6 +48,8 @@ using namespace zendnn::impl::cpu::matmul;
 const pd_create_f impl_list[] = {
         CPU_INSTANCE(zendnn_f32_matmul_t)
 		CPU_INSTANCE(gemm_f32_matmul_t)
+        CPU_INSTANCE_X64(zendnn_bf16_matmul_t<f32>)
+        CPU_INSTANCE_X64(zendnn_bf16_matmul_t<bf16>)
         CPU_INSTANCE(gemm_bf16_matmul_t<f32>)
         CPU_INSTANCE(gemm_bf16_matmul_t<bf16>)
         CPU_INSTANCE_X64(brgemm_matmul_t<avx512_core_bf16_amx_int8>)
@@ -0,0 +1,186 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include "common/c_types_map.hpp"
+#include "common/zendnn_thread.hpp"
+#include "common/type_helpers.hpp"
+#include "common/utils.hpp"
+
+#include "cpu/cpu_primitive.hpp"
+#include "cpu/platform.hpp"
+
+#include "cpu/matmul/zendnn_bf16_matmul.hpp"
+#include "cpu/matmul/matmul_utils.hpp"
+
+#include "zendnn_logging.hpp"
+#include "zendnn_private.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+namespace matmul {
+
+using namespace data_type;
+
+template <impl::data_type_t dst_type>
+status_t zendnn_bf16_matmul_t<dst_type>::pd_t::init(engine_t *engine) {
+    zendnnInfo(ZENDNN_CORELOG, "zendnn_bf16_matmul_t::pd_t::init()");
+    auto check_bias = [&]() -> bool {
+        return !with_bias()
+        || (weights_md(1)->data_type == f32 && is_bias_1xN());
+    };
+
+    bool ok = src_md()->data_type == src_type
+              && weights_md()->data_type == weights_type
+              && desc()->accum_data_type == acc_type
+              && dst_md()->data_type == dst_type
+              && platform::has_data_type_support(data_type::bf16) && check_bias()
+              && attr()->has_default_values(
+                  primitive_attr_t::skip_mask_t::oscale_runtime
+                  | primitive_attr_t::skip_mask_t::post_ops)
+              && set_default_formats()
+              && gemm_based::check_gemm_compatible_formats(*this);
+
+    if (!ok) {
+        return status::unimplemented;
+    }
+
+    // set state
+    params_.dst_is_acc_ = dst_type == data_type::f32;
+
+    return check_and_configure_attributes();
+}
+
+template <impl::data_type_t dst_type>
+status_t zendnn_bf16_matmul_t<dst_type>::pd_t::check_and_configure_attributes() {
+    zendnnInfo(ZENDNN_CORELOG,
+               "zendnn_bf16_matmul_t::pd_t::check_and_configure_attributes");
+    // output scales are applied by gemm as alpha
+    auto check_attr_oscale = [&]() -> bool {
+        return attr()->output_scales_.mask_ == 0;
+    };
+
+    auto check_attr_post_ops = [&]() -> bool {
+        using namespace primitive_kind;
+        const auto &p = attr()->post_ops_;
+        auto check_sum = [&](int idx) -> bool {
+            return p.contain(sum, idx);
+        };
+        auto check_eltwise = [&](int idx) -> bool {
+            return p.contain(eltwise, idx)
+            && utils::one_of(p.entry_[idx].eltwise.alg, alg_kind::eltwise_relu,
+                             alg_kind::eltwise_gelu, alg_kind::eltwise_gelu_erf)
+            && IMPLICATION(p.entry_[idx].eltwise.alg == alg_kind::eltwise_relu,
+                           p.entry_[idx].eltwise.alpha == 0.f);
+        };
+        switch (p.len()) {
+        case 0:
+            return true;
+        case 1:
+            return check_sum(0) || check_eltwise(0);
+        case 2:
+            return check_sum(0) && check_eltwise(1);
+        default:
+            return false;
+        }
+    };
+
+    if (!check_attr_oscale() || !check_attr_post_ops()) {
+        return status::unimplemented;
+    }
+
+    // set state
+    params_.gemm_applies_output_scales_ = true;
+    const auto &po = attr()->post_ops_;
+    if (po.len() > 0 && po.contain(primitive_kind::sum, 0)) {
+        params_.gemm_beta_ = po.entry_[0].sum.scale;
+    }
+
+    return status::success;
+}
+
+template <impl::data_type_t dst_type>
+status_t zendnn_bf16_matmul_t<dst_type>::execute_ref(
+    const exec_ctx_t &ctx) const {
+    auto src = CTX_IN_MEM(const src_data_t *, ZENDNN_ARG_SRC);
+    auto weights = CTX_IN_MEM(const weights_data_t *, ZENDNN_ARG_WEIGHTS);
+    auto bias = CTX_IN_MEM(const float *, ZENDNN_ARG_BIAS);
+    auto dst = CTX_OUT_MEM(dst_data_t *, ZENDNN_ARG_DST);
+
+    DEFINE_SCALES_BUFFER(scales);
+
+    const auto src_d = ctx.memory_mdw(ZENDNN_ARG_SRC, pd()->src_md());
+    const auto weights_d = ctx.memory_mdw(ZENDNN_ARG_WEIGHTS, pd()->weights_md());
+    const auto dst_d = ctx.memory_mdw(ZENDNN_ARG_DST, pd()->dst_md());
+
+    const gemm_based::params_t &params = pd()->params();
+
+    const auto &dst_bd = dst_d.blocking_desc();
+
+    const bool batched = pd()->batched();
+
+    const dim_t M = dst_d.dims()[dst_d.ndims() - 2];
+    const dim_t N = dst_d.dims()[dst_d.ndims() - 1];
+    const dim_t K = src_d.dims()[src_d.ndims() - 1];
+
+    const auto &src_strides = &src_d.blocking_desc().strides[dst_d.ndims() - 2];
+    const auto &weights_strides = &weights_d.blocking_desc().strides[dst_d.ndims() -
+                                                2];
+
+    const char *transA
+        = src_strides[1] == 1 &&
+          src_d.dims()[dst_d.ndims() - 2] > 1 ? "N" : "T";
+    const char *transB
+        = weights_strides[1] == 1 &&
+          weights_d.dims()[dst_d.ndims() - 2] > 1 ? "N" : "T";
+
+    const int lda = (int)src_strides[*transA == 'N' ? 0 : 1];
+    const int ldb = (int)weights_strides[*transB == 'N' ? 0 : 1];
+    const int ldc = (int)dst_bd.strides[dst_d.ndims() - 2];
+
+    const float alpha = params.get_gemm_alpha(scales);
+    const float beta = params.gemm_beta_;
+
+    const dim_t batch = batched ? src_d.dims()[dst_d.ndims() - 3] : 1;
+
+    const auto &post_ops = pd()->attr()->post_ops_;
+    int elementwise_index = post_ops.find(primitive_kind::eltwise);
+    bool has_eltwise_relu = elementwise_index>=0 ?
+                            post_ops.entry_[elementwise_index].eltwise.alg ==
+                            alg_kind::eltwise_relu : 0;
+    //gelu_type 1 refers to tanh based gelu and 2 refers to erf based gelu
+    int gelu_type = 0;
+    if (elementwise_index >= 0) {
+        const auto alg = post_ops.entry_[elementwise_index].eltwise.alg;
+        gelu_type = alg == alg_kind::eltwise_gelu ? 1 :
+                    alg == alg_kind::eltwise_gelu_erf ? 2 : 0;
+    }
+
+    zendnnInfo(ZENDNN_CORELOG, "zendnn_bf16_matmul_t::execute_ref");
+    zendnnInfo(ZENDNN_CORELOG, "M: ",M, " N: ",N, " K: ", K,
+               " transA: ", transA, " transB: ", transB,
+               " lda: ", lda, " ldb: ", ldb, " ldc: ", ldc,
+               " alpha: ", alpha, " beta: ", beta, " batch: ", batch,
+               " relu: ", has_eltwise_relu, " gelu: ", gelu_type,
+               " dst_bf16: ", dst_type == data_type::bf16);
+
+    zenMatMulBF16(strcmp(transA, "N"), strcmp(transB, "N"), batch, M, K, N,
+                  alpha, src, lda, weights, ldb, bias, has_eltwise_relu, gelu_type,
+                  beta, dst, ldc, dst_type == data_type::bf16);
+
+    return status::success;
+}
+
+template struct zendnn_bf16_matmul_t<data_type::f32>;
+template struct zendnn_bf16_matmul_t<data_type::bf16>;
+
+} // namespace matmul
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
@@ -0,0 +1,66 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#ifndef ZENDNN_BF16_MATMUL_HPP
+#define ZENDNN_BF16_MATMUL_HPP
+
+#include <assert.h>
+
+#include "common/bfloat16.hpp"
+#include "common/c_types_map.hpp"
+#include "common/primitive.hpp"
+#include "common/type_helpers.hpp"
+
+#include "cpu/matmul/cpu_matmul_pd.hpp"
+#include "cpu/matmul/gemm_based_common.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+namespace matmul {
+
+//bf16 ZenDNN MatMul: bf16 src/weights with f32 accumulation, f32 or bf16
+//dst with fused bias, sum and ReLU/GeLU
+template <impl::data_type_t dst_type>
+struct zendnn_bf16_matmul_t : public primitive_t {
+    struct pd_t : public cpu_matmul_pd_t {
+        using cpu_matmul_pd_t::cpu_matmul_pd_t;
+
+        DECLARE_COMMON_PD_T("zendnn_bf16", zendnn_bf16_matmul_t);
+
+        status_t init(engine_t *engine);
+        const gemm_based::params_t &params() const { return params_; }
+
+    private:
+        status_t check_and_configure_attributes();
+        gemm_based::params_t params_;
+    };
+
+    zendnn_bf16_matmul_t(const pd_t *apd) : primitive_t(apd) {}
+
+    static constexpr data_type_t src_type = data_type::bf16;
+    static constexpr data_type_t weights_type = data_type::bf16;
+    static constexpr data_type_t acc_type = data_type::f32;
+
+    typedef typename prec_traits<src_type>::type src_data_t;
+    typedef typename prec_traits<weights_type>::type weights_data_t;
+    typedef typename prec_traits<dst_type>::type dst_data_t;
+    typedef typename prec_traits<acc_type>::type acc_data_t;
+
+    virtual status_t execute(const exec_ctx_t &ctx) const override {
+        return execute_ref(ctx);
+    }
+
+private:
+    const pd_t *pd() const { return (const pd_t *)primitive_t::pd().get(); }
+    status_t execute_ref(const exec_ctx_t &ctx) const;
+};
+
+} // namespace matmul
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+#endif
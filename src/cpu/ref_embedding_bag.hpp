@@ -46,6 +46,11 @@ struct ref_embedding_bag_t : public primitive_t {
                 return status::unimplemented;
             }
 
+            if (desc()->input_desc.data_type != data_type
+                    || desc()->dst_desc.data_type != data_type) {
+                return status::unimplemented;
+            }
+
             return status::success;
         }
     };
@@ -58,23 +63,26 @@ struct ref_embedding_bag_t : public primitive_t {
     }
 
     using input_type   = typename prec_traits<data_type>::type;
-    using indices_type = int32_t;
-    using offsets_type = int32_t;
     using dst_type     = input_type;
 
     // exec() override from primitive_t
     status_t execute(const exec_ctx_t &ctx) const override {
-        return execute_ref(ctx);
+        if (pd()->desc()->indices_desc.data_type == impl::data_type::s64)
+            return execute_ref<int64_t>(ctx);
+        return execute_ref<int32_t>(ctx);
     }
 
   private:
     const pd_t *pd() const {
         return (const pd_t *)primitive_t::pd().get();
     }
+    // indices and offsets are s32 or s64
+    template <typename idx_type>
     status_t execute_ref(const exec_ctx_t &ctx) const;
 };
 
 template<data_type_t data_type>
+template<typename idx_type>
 status_t
 ref_embedding_bag_t<data_type>::execute_ref(const exec_ctx_t &ctx) const {
     status_t status = status::success;
@@ -86,8 +94,8 @@ ref_embedding_bag_t<data_type>::execute_ref(const exec_ctx_t &ctx) const {
 
     // get the tensors
     auto input   = CTX_IN_MEM(const input_type *, ZENDNN_ARG_SRC_0);
-    auto indices = CTX_IN_MEM(const indices_type *, ZENDNN_ARG_SRC_1);
-    auto offsets = CTX_IN_MEM(const offsets_type *, ZENDNN_ARG_SRC_2);
+    auto indices = CTX_IN_MEM(const idx_type *, ZENDNN_ARG_SRC_1);
+    auto offsets = CTX_IN_MEM(const idx_type *, ZENDNN_ARG_SRC_2);
     auto dst     = CTX_OUT_MEM(dst_type *, ZENDNN_ARG_DST);
 
     const input_type *weights = nullptr;
@@ -0,0 +1,92 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#include "common/c_types_map.hpp"
+#include "common/zendnn_thread.hpp"
+#include "common/type_helpers.hpp"
+#include "common/utils.hpp"
+#include "common/zendnn_private.hpp"
+
+#include "cpu/cpu_primitive.hpp"
+
+#include "cpu/x64/zendnn_bf16_convolution.hpp"
+#include "zendnn_logging.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+namespace x64 {
+
+using namespace zendnn::impl::status;
+using namespace zendnn::impl::utils;
+
+template <data_type_t dst_type>
+status_t zendnn_bf16_convolution_fwd_t<dst_type>::execute_forward(
+    const exec_ctx_t &ctx) const {
+    const auto &jcp = pd()->jcp_;
+    auto src = CTX_IN_MEM(const src_data_t *, ZENDNN_ARG_SRC);
+    auto weights = CTX_IN_MEM(const wei_data_t *, ZENDNN_ARG_WEIGHTS);
+    auto bias = CTX_IN_MEM(const float *, ZENDNN_ARG_BIAS);
+    auto dst = CTX_OUT_MEM(dst_data_t *, ZENDNN_ARG_DST);
+
+    zendnnInfo(ZENDNN_CORELOG,
+               "ZENDNN implementation path in zendnn_bf16_convolution_fwd_t::execute_forward [cpu/convolution]");
+    zendnnInfo(ZENDNN_CORELOG, "algo=", jcp.alg_kind, " mb=",jcp.mb, " ih=",jcp.ih,
+               " iw=",jcp.iw, " oh=",jcp.oh, " ow=",jcp.ow, " kh=",jcp.kh,
+               " kw=",jcp.kw, " stride_h=",jcp.stride_h,
+               " stride_w=",jcp.stride_w, " l_pad=",jcp.l_pad, " t_pad=",jcp.t_pad,
+               " ic=",jcp.ic, " oc=",jcp.oc, " [cpu/convolution]");
+
+    const bool relu = jcp.reluFused || jcp.with_eltwise;
+
+    int filter_offset = pd()->dst_md()->offset0;
+    int total_filters = pd()->dst_md()->format_desc.blocking.strides[3];
+    bool concat = true;
+
+    if (total_filters == jcp.oc) {
+        concat = false;
+    }
+
+    zendnnInfo(ZENDNN_CORELOG,
+               "zendnn_bf16_convolution_fwd_t::execute_forward zenConvolution2DBF16 [cpu/convolution]");
+    zenConvolution2DBF16(
+        src,
+        jcp.mb,
+        jcp.ic,
+        jcp.ih,
+        jcp.iw,
+        weights,
+        jcp.oc,
+        jcp.kh,
+        jcp.kw,
+        jcp.t_pad,
+        jcp.l_pad,
+        jcp.b_pad,
+        jcp.r_pad,
+        jcp.stride_h,
+        jcp.stride_w,
+        bias,
+        relu,
+        dst,
+        dst_type == data_type::bf16,
+        jcp.oh,
+        jcp.ow,
+        concat,
+        filter_offset,
+        total_filters
+    );
+
+    return status::success;
+}
+
+template struct zendnn_bf16_convolution_fwd_t<data_type::f32>;
+template struct zendnn_bf16_convolution_fwd_t<data_type::bf16>;
+
+} // namespace x64
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+// vim: et ts=4 sw=4 cindent cino+=l0,\:4,N-s
@@ -0,0 +1,116 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#ifndef ZENDNN_BF16_CONVOLUTION_HPP
+#define ZENDNN_BF16_CONVOLUTION_HPP
+
+#include "common/c_types_map.hpp"
+#include "common/zendnn_thread.hpp"
+#include "common/primitive.hpp"
+#include "common/utils.hpp"
+#include "common/zendnn_private.hpp"
+
+#include "cpu/cpu_convolution_pd.hpp"
+
+#include "cpu/x64/cpu_isa_traits.hpp"
+#include "cpu/x64/zendnn_conv_kernel_f32.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+namespace x64 {
+
+//BF16 ZenDNN convolution: bf16 src and weights, f32 accumulation with fused
+//f32 bias and ReLU, f32 or bf16 dst. Needs avx512_core, native bf16 dot
+//product is used on AVX512_BF16 capable cores.
+template <impl::data_type_t dst_type>
+struct zendnn_bf16_convolution_fwd_t : public primitive_t {
+    struct pd_t : public cpu_convolution_fwd_pd_t {
+        pd_t(const convolution_desc_t *adesc,
+             const primitive_attr_t *attr,
+             const typename pd_t::base_class *hint_fwd_pd)
+            : cpu_convolution_fwd_pd_t(adesc, attr, hint_fwd_pd)
+            , jcp_() {}
+
+        DECLARE_COMMON_PD_T("zendnn_bf16", zendnn_bf16_convolution_fwd_t);
+
+        status_t init(engine_t *engine) {
+            bool ok = true && is_fwd() && mayiuse(avx512_core)
+                      && (set_default_alg_kind(alg_kind::convolution_gemm)
+                          ||  set_default_alg_kind(alg_kind::convolution_direct))
+                      && expect_data_types(data_type::bf16, data_type::bf16,
+                                           data_type::undef, dst_type, data_type::f32)
+                      && IMPLICATION(with_bias(),
+                                     bias_md_.data_type == data_type::f32)
+                      && attr()->has_default_values(
+                          primitive_attr_t::skip_mask_t::post_ops, dst_type)
+                      && ndims() == 4 && !with_groups()
+                      && KDH() == 0 && KDW() == 0
+                      && post_ops_ok()
+                      && !has_zero_dim_memory() && set_default_formats();
+            if (!ok) return status::unimplemented;
+
+            status_t status = zendnn_conv_fwd_kernel_f32::init_conf(
+                                  jcp_, *desc(), src_md(), weights_md(), dst_md(), *attr());
+            if (status != status::success) return status;
+            //execute_forward applies bias and ReLU only, BatchNorm fusion is
+            //f32 only
+            if (jcp_.batchNormFused || jcp_.with_sum || jcp_.with_binary)
+                return status::unimplemented;
+
+            return status::success;
+        }
+
+        jit_conv_conf_t jcp_;
+
+      protected:
+        bool set_default_formats() {
+            using namespace format_tag;
+            auto src_tag = nhwc;
+            auto dst_tag = nhwc;
+            auto wei_tag = hwio;
+            return set_default_formats_common(src_tag, wei_tag, dst_tag);
+        }
+
+        //Supported post-op: relu with alpha 0 and scale 1. Sum, leaky relu
+        //and other eltwise or binary post-ops are rejected
+        bool post_ops_ok() const {
+            const auto &p = attr()->post_ops_;
+            switch (p.len()) {
+            case 0:
+                return true;
+            case 1:
+                return p.entry_[0].is_relu();
+            default:
+                return false;
+            }
+        }
+    };
+
+    zendnn_bf16_convolution_fwd_t(const pd_t *apd) : primitive_t(apd) {}
+
+    typedef typename prec_traits<data_type::bf16>::type src_data_t;
+    typedef typename prec_traits<data_type::bf16>::type wei_data_t;
+    typedef typename prec_traits<dst_type>::type dst_data_t;
+
+    status_t execute(const exec_ctx_t &ctx) const override {
+        return execute_forward(ctx);
+    }
+
+  private:
+    status_t execute_forward(const exec_ctx_t &ctx) const;
+    const pd_t *pd() const {
+        return (const pd_t *)primitive_t::pd().get();
+    }
+};
+
+} // namespace x64
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino+=l0,\:4,N-s
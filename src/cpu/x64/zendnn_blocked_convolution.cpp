@@ -0,0 +1,89 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#include "common/c_types_map.hpp"
+#include "common/zendnn_thread.hpp"
+#include "common/type_helpers.hpp"
+#include "common/utils.hpp"
+#include "common/zendnn_private.hpp"
+
+#include "cpu/cpu_primitive.hpp"
+
+#include "cpu/x64/zendnn_blocked_convolution.hpp"
+#include "zendnn_logging.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+namespace x64 {
+
+using namespace zendnn::impl::status;
+using namespace zendnn::impl::utils;
+
+status_t zendnn_blocked_convolution_fwd_t::execute_forward(
+    const exec_ctx_t &ctx) const {
+    const auto &jcp = pd()->jcp_;
+    auto src = CTX_IN_MEM(const data_t *, ZENDNN_ARG_SRC);
+    auto weights = CTX_IN_MEM(const data_t *, ZENDNN_ARG_WEIGHTS);
+    auto bias = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BIAS);
+    auto dst = CTX_OUT_MEM(data_t *, ZENDNN_ARG_DST);
+    auto batchNormScale = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BN_SCALE);
+    auto batchNormMean = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BN_MEAN);
+    auto batchNormOffset = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BN_OFFSET);
+
+    zendnnInfo(ZENDNN_CORELOG,
+               "ZENDNN implementation path in zendnn_blocked_convolution_fwd_t::execute_forward [cpu/convolution]");
+    zendnnInfo(ZENDNN_CORELOG, "algo=", jcp.alg_kind, " mb=",jcp.mb, " ih=",jcp.ih,
+               " iw=",jcp.iw, " oh=",jcp.oh, " ow=",jcp.ow, " kh=",jcp.kh,
+               " kw=",jcp.kw, " stride_h=",jcp.stride_h,
+               " stride_w=",jcp.stride_w, " l_pad=",jcp.l_pad, " t_pad=",jcp.t_pad,
+               " ic=",jcp.ic, " oc=",jcp.oc, " block=", pd()->block_,
+               " [cpu/convolution]");
+
+    //Channels are padded to block in nChw{8,16}c
+    const memory_desc_wrapper src_d(pd()->src_md());
+    const memory_desc_wrapper dst_d(pd()->dst_md());
+    const int padded_ic = src_d.padded_dims()[1];
+    const int padded_oc = dst_d.padded_dims()[1];
+    const bool relu = jcp.reluFused || jcp.with_eltwise;
+
+    zendnnEnv zenEnvObj = readEnv();
+    zenConvolution2DBlocked(
+        zenEnvObj,
+        src,
+        jcp.mb,
+        padded_ic,
+        jcp.ih,
+        jcp.iw,
+        weights,
+        padded_oc,
+        jcp.oc,
+        jcp.kh,
+        jcp.kw,
+        jcp.t_pad,
+        jcp.l_pad,
+        jcp.stride_h,
+        jcp.stride_w,
+        bias,
+        jcp.batchNormFused ? batchNormScale : NULL,
+        batchNormMean,
+        batchNormOffset,
+        relu,
+        jcp.with_sum,
+        dst,
+        jcp.oh,
+        jcp.ow,
+        pd()->block_
+    );
+
+    return status::success;
+}
+
+} // namespace x64
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+// vim: et ts=4 sw=4 cindent cino+=l0,\:4,N-s
@@ -0,0 +1,120 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#ifndef ZENDNN_BLOCKED_CONVOLUTION_HPP
+#define ZENDNN_BLOCKED_CONVOLUTION_HPP
+
+#include "common/c_types_map.hpp"
+#include "common/zendnn_thread.hpp"
+#include "common/memory_tracking.hpp"
+#include "common/primitive.hpp"
+#include "common/utils.hpp"
+#include "common/zendnn_private.hpp"
+
+#include "cpu/cpu_convolution_pd.hpp"
+
+#include "cpu/x64/zendnn_conv_kernel_f32.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+namespace x64 {
+
+//f32 ZenDNN convolution on BLOCKED Format: nChw{8,16}c src/dst and
+//OIhw{8,16}i{8,16}o weights, block is 16 on AVX-512 capable cores and 8
+//otherwise. bias, BatchNorm, sum and ReLU are fused. Enabled with
+//ZENDNN_BLOCKED_FORMAT=1.
+struct zendnn_blocked_convolution_fwd_t : public primitive_t {
+    struct pd_t : public cpu_convolution_fwd_pd_t {
+        pd_t(const convolution_desc_t *adesc,
+             const primitive_attr_t *attr,
+             const typename pd_t::base_class *hint_fwd_pd)
+            : cpu_convolution_fwd_pd_t(adesc, attr, hint_fwd_pd)
+            , jcp_(), block_(8) {}
+
+        DECLARE_COMMON_PD_T("zendnn_blocked", zendnn_blocked_convolution_fwd_t);
+
+        status_t init(engine_t *engine) {
+            zendnnEnv zenEnvObj = readEnv();
+            block_ = zenEnvObj.zenBlockSize;
+            bool ok = true && is_fwd() && zenEnvObj.zenBlockedFormat
+                      && (set_default_alg_kind(alg_kind::convolution_gemm)
+                          ||  set_default_alg_kind(alg_kind::convolution_direct))
+                      && expect_data_types(data_type::f32, data_type::f32,
+                                           data_type::f32, data_type::f32,
+                                           data_type::f32)
+                      && attr()->has_default_values(
+                          primitive_attr_t::skip_mask_t::post_ops,
+                          data_type::f32)
+                      && ndims() == 4 && !with_groups()
+                      && KDH() == 0 && KDW() == 0
+                      && post_ops_ok()
+                      && !has_zero_dim_memory() && set_default_formats();
+            if (!ok) return status::unimplemented;
+
+            return zendnn_conv_fwd_kernel_f32::init_conf(
+                       jcp_, *desc(), src_md(), weights_md(), dst_md(), *attr());
+        }
+
+        jit_conv_conf_t jcp_;
+        int block_;
+
+      protected:
+        bool set_default_formats() {
+            using namespace format_tag;
+            auto dat_tag = block_ == 16 ? nChw16c : nChw8c;
+            auto wei_tag = block_ == 16 ? OIhw16i16o : OIhw8i8o;
+            return set_default_formats_common(dat_tag, wei_tag, dat_tag)
+                   && memory_desc_matches_tag(src_md_, dat_tag)
+                   && memory_desc_matches_tag(dst_md_, dat_tag)
+                   && memory_desc_matches_tag(weights_md_, wei_tag);
+        }
+
+        //Supported post-ops: relu, sum, sum + relu
+        bool post_ops_ok() const {
+            const auto &p = attr()->post_ops_;
+            auto is_sum = [&](int idx) {
+                return p.entry_[idx].is_sum(false)
+                       && p.entry_[idx].sum.scale == 1.0f;
+            };
+            auto is_relu = [&](int idx) {
+                return p.entry_[idx].is_relu();
+            };
+            switch (p.len()) {
+            case 0:
+                return true;
+            case 1:
+                return is_relu(0) || is_sum(0);
+            case 2:
+                return is_sum(0) && is_relu(1);
+            default:
+                return false;
+            }
+        }
+    };
+
+    zendnn_blocked_convolution_fwd_t(const pd_t *apd) : primitive_t(apd) {}
+
+    typedef typename prec_traits<data_type::f32>::type data_t;
+
+    status_t execute(const exec_ctx_t &ctx) const override {
+        return execute_forward(ctx);
+    }
+
+  private:
+    status_t execute_forward(const exec_ctx_t &ctx) const;
+    const pd_t *pd() const {
+        return (const pd_t *)primitive_t::pd().get();
+    }
+};
+
+} // namespace x64
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino+=l0,\:4,N-s
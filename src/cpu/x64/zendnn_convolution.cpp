@@ -24,6 +24,7 @@
 #include "common/type_helpers.hpp"
 #include "common/utils.hpp"
 #include "common/zendnn_private.hpp"
+#include "common/zendnn_convolution_fft.hpp"
 
 #include "cpu/x64/zendnn_convolution.hpp"
 #include "zendnn_logging.hpp"
@@ -67,6 +68,7 @@ void zendnn_convolution_fwd_t::execute_forward(const exec_ctx_t &ctx) const {
                " f_pad=",jcp.f_pad, " ngroups=",jcp.ngroups, " ic=",jcp.ic, " oc=",jcp.oc,
                " [cpu/convolution]");
 
+    zendnnEnv zenEnvObj = readEnv();
     int filter_offset = pd()->dst_md()->offset0;
     int total_filters = pd()->dst_md()->format_desc.blocking.strides[3];
     bool concat = true;
@@ -75,9 +77,12 @@ void zendnn_convolution_fwd_t::execute_forward(const exec_ctx_t &ctx) const {
         concat = false;
     }
 
-    //TBD: To add support for gemm, ref, direct, winograd, fft
+    //TBD: To add support for gemm, ref, direct, winograd
     //we need to move else part to [ZENDNN ALGO] code
-    if (jcp.alg_kind == zendnn_convolution_ref) {
+    if (jcp.alg_kind == zendnn_convolution_fft) {
+        execute_forward_fft(ctx, concat, filter_offset, total_filters);
+    }
+    else if (jcp.alg_kind == zendnn_convolution_ref) {
         if ((jcp.reluFused == false) &&
                 (jcp.batchNormFused == true)) {
             //Only BatchNorm fused with conv
@@ -211,7 +216,82 @@ void zendnn_convolution_fwd_t::execute_forward(const exec_ctx_t &ctx) const {
             );
         }
     }
+    else if (jcp.ic <= CONV_DIRECT_LOW_IC) {
+        execute_forward_low_ic(ctx, concat, filter_offset, total_filters);
+    }
+    else if (jcp.batchNormFused == true && zenEnvObj.zenConvFoldBN) {
+        //BatchNorm is folded into weights and bias, conv runs as
+        //conv+bias(+ReLU) without a separate pass over the output
+        auto folded = fold_batchnorm(weights, bias, batchNormScale,
+                                     batchNormMean, batchNormOffset);
+        if (jcp.reluFused == true) {
+            zendnnInfo(ZENDNN_CORELOG,
+                       "zendnn_convolution_fwd_t::execute_forward zenConvolution2DwithBiasRelu(folded BatchNorm) [cpu/convolution]");
+            zenConvolution2DwithBiasRelu(
+                (float *)src,
+                jcp.mb,
+                jcp.ic,
+                jcp.ih,
+                jcp.iw,
+                folded->folded_weights.data(),
+                jcp.oc,
+                jcp.kh,
+                jcp.kw,
+                jcp.t_pad,
+                jcp.l_pad,
+                jcp.b_pad,
+                jcp.r_pad,
+                jcp.stride_h,
+                jcp.stride_w,
+                folded->folded_bias.data(),
+                (float *)dst,
+                jcp.oh,
+                jcp.ow,
+                concat,
+                filter_offset,
+                total_filters
+            );
+        }
+        else {
+            zendnnInfo(ZENDNN_CORELOG,
+                       "zendnn_convolution_fwd_t::execute_forward zenConvolution2DwithBias(folded BatchNorm) [cpu/convolution]");
+            zenConvolution2DwithBias(
+                (float *)src,
+                jcp.mb,
+                jcp.ic,
+                jcp.ih,
+                jcp.iw,
+                folded->folded_weights.data(),
+                jcp.oc,
+                jcp.kh,
+                jcp.kw,
+                jcp.t_pad,
+                jcp.l_pad,
+                jcp.b_pad,
+                jcp.r_pad,
+                jcp.stride_h,
+                jcp.stride_w,
+                folded->folded_bias.data(),
+                (float *)dst,
+                jcp.oh,
+                jcp.ow,
+                concat,
+                filter_offset,
+                total_filters
+            );
+        }
+    }
     else {
+        //Conv bias is applied ahead of BatchNorm, folded into its offset as
+        //offset + scale*bias
+        std::vector<float> bn_offset;
+        if (jcp.batchNormFused == true && bias != NULL) {
+            bn_offset.resize(jcp.oc);
+            for (int k = 0; k < jcp.oc; k++) {
+                bn_offset[k] = batchNormOffset[k] + batchNormScale[k]*bias[k];
+            }
+            batchNormOffset = bn_offset.data();
+        }
         if ((jcp.reluFused == false) &&
                 (jcp.batchNormFused == true)) {
             //Only BatchNorm fused with conv
@@ -458,6 +538,150 @@ void zendnn_convolution_fwd_t::execute_forward(const exec_ctx_t &ctx) const {
     }
 }
 
+std::shared_ptr<const zendnn_convolution_fwd_t::folded_bn_t>
+zendnn_convolution_fwd_t::fold_batchnorm(const data_t *weights,
+        const data_t *bias, const data_t *scale, const data_t *mean,
+        const data_t *offset) const {
+    const auto &jcp = kernel_->jcp;
+    const dim_t oc = jcp.oc;
+    const dim_t taps = (dim_t)jcp.kh * jcp.kw * jcp.ic;
+    const zendnn_weights_key_t key(weights, bias, scale, mean, offset);
+
+    std::lock_guard<std::mutex> lock(folded_bn_mutex_);
+    if (folded_bn_ && folded_bn_key_ == key)
+        return folded_bn_;
+
+    zendnnInfo(ZENDNN_CORELOG,
+               "zendnn_convolution_fwd_t::fold_batchnorm folding BatchNorm into weights [cpu/convolution]");
+    auto folded = std::make_shared<folded_bn_t>();
+
+    //w' = w*scale and b' = (b - mean)*scale + offset, weights are HWCN
+    folded->folded_weights.resize(taps * oc);
+    folded->folded_bias.resize(oc);
+    float *folded_weights = folded->folded_weights.data();
+    parallel_nd(taps, [&](dim_t t) {
+        #pragma omp simd
+        for (dim_t k = 0; k < oc; k++)
+            folded_weights[t * oc + k] = weights[t * oc + k] * scale[k];
+    });
+    for (dim_t k = 0; k < oc; k++)
+        folded->folded_bias[k]
+                = ((bias ? bias[k] : 0.f) - mean[k]) * scale[k] + offset[k];
+
+    folded_bn_ = folded;
+    folded_bn_key_ = key;
+    return folded;
+}
+
+void zendnn_convolution_fwd_t::execute_forward_fft(const exec_ctx_t &ctx,
+        bool concat, int filter_offset, int total_filters) const {
+    const auto &jcp = kernel_->jcp;
+    auto src = CTX_IN_MEM(const data_t *, ZENDNN_ARG_SRC);
+    auto weights = CTX_IN_MEM(const data_t *, ZENDNN_ARG_WEIGHTS);
+    auto bias = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BIAS);
+    auto dst = CTX_OUT_MEM(data_t *, ZENDNN_ARG_DST);
+    auto batchNormScale = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BN_SCALE);
+    auto batchNormMean = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BN_MEAN);
+    auto batchNormOffset = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BN_OFFSET);
+
+    zendnnEnv zenEnvObj = readEnv();
+    int fft_h = zenConvolution2DFFTSize(jcp.kh, jcp.oh);
+    int fft_w = zenConvolution2DFFTSize(jcp.kw, jcp.ow);
+
+    std::shared_ptr<std::vector<float>> filter_fft;
+    {
+        const zendnn_weights_key_t key(weights);
+        std::lock_guard<std::mutex> lock(fft_filter_mutex_);
+        if (!fft_filter_ || fft_filter_key_ != key) {
+            zendnnInfo(ZENDNN_CORELOG,
+                       "zendnn_convolution_fwd_t::execute_forward_fft transforming filter [cpu/convolution]");
+            fft_filter_ = std::make_shared<std::vector<float>>(
+                              zenConvolution2DFFTFilterSize(jcp.ic, jcp.oc, fft_h, fft_w));
+            zenConvolution2DFFTFilterTransform(zenEnvObj, weights, jcp.ic, jcp.oc,
+                                               jcp.kh, jcp.kw, fft_h, fft_w, fft_filter_->data());
+            fft_filter_key_ = key;
+        }
+        filter_fft = fft_filter_;
+    }
+
+    //BatchNorm is applied as scale and folded bias
+    const float *scale = NULL;
+    const float *post_bias = bias;
+    std::vector<float> bn_bias;
+    if (jcp.batchNormFused) {
+        bn_bias.resize(jcp.oc);
+        for (int k = 0; k < jcp.oc; k++) {
+            bn_bias[k] = batchNormOffset[k] + batchNormScale[k]*((bias ? bias[k] :
+                         0.0f) - batchNormMean[k]);
+        }
+        scale = batchNormScale;
+        post_bias = bn_bias.data();
+    }
+    bool relu = jcp.reluFused || jcp.with_eltwise;
+
+    zendnnInfo(ZENDNN_CORELOG,
+               "zendnn_convolution_fwd_t::execute_forward zenConvolution2DFFT [cpu/convolution]");
+    zenConvolution2DFFT(zenEnvObj, (float *)src, jcp.mb, jcp.ic, jcp.ih, jcp.iw,
+                        filter_fft->data(), jcp.oc, jcp.kh, jcp.kw, fft_h, fft_w,
+                        jcp.t_pad, jcp.l_pad, post_bias, (float *)dst, jcp.oh, jcp.ow,
+                        relu, jcp.with_sum, scale, concat, filter_offset, total_filters);
+}
+
+void zendnn_convolution_fwd_t::execute_forward_low_ic(const exec_ctx_t &ctx,
+        bool concat, int filter_offset, int total_filters) const {
+    const auto &jcp = kernel_->jcp;
+    auto src = CTX_IN_MEM(const data_t *, ZENDNN_ARG_SRC);
+    auto weights = CTX_IN_MEM(const data_t *, ZENDNN_ARG_WEIGHTS);
+    auto bias = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BIAS);
+    auto dst = CTX_OUT_MEM(data_t *, ZENDNN_ARG_DST);
+    auto batchNormScale = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BN_SCALE);
+    auto batchNormMean = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BN_MEAN);
+    auto batchNormOffset = CTX_IN_MEM(const data_t *, ZENDNN_ARG_BN_OFFSET);
+
+    zendnnEnv zenEnvObj = readEnv();
+    std::shared_ptr<std::vector<float>> filter_packed;
+    {
+        const zendnn_weights_key_t key(weights);
+        std::lock_guard<std::mutex> lock(low_ic_filter_mutex_);
+        if (!low_ic_filter_ || low_ic_filter_key_ != key) {
+            zendnnInfo(ZENDNN_CORELOG,
+                       "zendnn_convolution_fwd_t::execute_forward_low_ic packing filter [cpu/convolution]");
+            low_ic_filter_ = std::make_shared<std::vector<float>>(
+                                 zenConvolution2DDirectLowICFilterSize(jcp.ic, jcp.oc,
+                                         jcp.kh, jcp.kw));
+            zenConvolution2DDirectLowICFilterPack(weights, jcp.ic, jcp.oc, jcp.kh,
+                                                  jcp.kw, low_ic_filter_->data());
+            low_ic_filter_key_ = key;
+        }
+        filter_packed = low_ic_filter_;
+    }
+
+    //BatchNorm is applied as scale and folded bias
+    const float *scale = NULL;
+    const float *post_bias = bias;
+    std::vector<float> bn_bias;
+    if (jcp.batchNormFused) {
+        bn_bias.resize(jcp.oc);
+        for (int k = 0; k < jcp.oc; k++) {
+            bn_bias[k] = batchNormOffset[k] + batchNormScale[k]*((bias ? bias[k] :
+                         0.0f) - batchNormMean[k]);
+        }
+        scale = batchNormScale;
+        post_bias = bn_bias.data();
+    }
+    bool relu = jcp.reluFused || jcp.with_eltwise;
+
+    zendnnInfo(ZENDNN_CORELOG,
+               "zendnn_convolution_fwd_t::execute_forward zenConvolution2DDirectLowIC [cpu/convolution]");
+    zenConvolution2DDirectLowIC(zenEnvObj, src, jcp.mb, jcp.ic, jcp.ih, jcp.iw,
+                                weights, jcp.oc, jcp.kh, jcp.kw, jcp.t_pad,
+                                jcp.l_pad, jcp.b_pad, jcp.r_pad, jcp.stride_h,
+                                jcp.stride_w, post_bias, dst, jcp.oh, jcp.ow,
+                                relu, jcp.with_sum, scale, NULL, concat,
+                                filter_offset, total_filters,
+                                filter_packed->data());
+}
+
 } // namespace x64
 } // namespace cpu
 } // namespace impl
@@ -1,5 +1,5 @@
 ﻿/*******************************************************************************
-* Modifications Copyright (c) 2021 Advanced Micro Devices, Inc. All rights reserved.
+* Modifications Copyright (c) 2021-2022 Advanced Micro Devices, Inc. All rights reserved.
 * Notified per clause 4(b) of the license.
 *******************************************************************************/
 
@@ -22,6 +22,10 @@
 #ifndef ZENDNN_CONVOLUTION_HPP
 #define ZENDNN_CONVOLUTION_HPP
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "common/c_types_map.hpp"
 #include "common/zendnn_thread.hpp"
 #include "common/memory_tracking.hpp"
@@ -32,6 +36,7 @@
 #include "cpu/x64/cpu_reducer.hpp"
 
 #include "cpu/x64/zendnn_conv_kernel_f32.hpp"
+#include "cpu/x64/zendnn_weights_key.hpp"
 
 namespace zendnn {
 namespace impl {
@@ -51,7 +56,8 @@ struct zendnn_convolution_fwd_t : public primitive_t {
         status_t init(engine_t *engine) {
             bool ok = true && is_fwd()
                       && (set_default_alg_kind(alg_kind::convolution_gemm)
-                      ||  set_default_alg_kind(alg_kind::convolution_ref))
+                      ||  set_default_alg_kind(alg_kind::convolution_ref)
+                      ||  set_default_alg_kind(alg_kind::convolution_fft))
                       && expect_data_types(data_type::f32, data_type::f32,
                                            data_type::f32, data_type::f32,
                                            data_type::f32)
@@ -61,6 +67,12 @@ struct zendnn_convolution_fwd_t : public primitive_t {
                       && !has_zero_dim_memory() && set_default_formats();
             if (!ok) return status::unimplemented;
 
+            //FFT convolution supports only stride 1 2D convolution
+            if (desc()->alg_kind == alg_kind::convolution_fft
+                    && (ndims() != 4 || with_groups() || KSH() != 1
+                        || KSW() != 1 || KDH() != 0 || KDW() != 0))
+                return status::unimplemented;
+
             status_t status = zendnn_conv_fwd_kernel_f32::init_conf(
                     jcp_, *desc(), src_md(), weights_md(), dst_md(), *attr());
             if (status != status::success) return status;
@@ -101,9 +113,41 @@ struct zendnn_convolution_fwd_t : public primitive_t {
 
   private:
     void execute_forward(const exec_ctx_t &ctx) const;
+    void execute_forward_fft(const exec_ctx_t &ctx, bool concat,
+            int filter_offset, int total_filters) const;
+    void execute_forward_low_ic(const exec_ctx_t &ctx, bool concat,
+            int filter_offset, int total_filters) const;
+
+    //Weights and bias with BatchNorm folded in
+    struct folded_bn_t {
+        std::vector<float> folded_weights;
+        std::vector<float> folded_bias;
+    };
+    std::shared_ptr<const folded_bn_t> fold_batchnorm(const data_t *weights,
+            const data_t *bias, const data_t *scale, const data_t *mean,
+            const data_t *offset) const;
     const pd_t *pd() const { return (const pd_t *)primitive_t::pd().get(); }
 
     std::unique_ptr<zendnn_conv_fwd_kernel_f32> kernel_;
+
+    //Frequency domain filter of convolution_fft, transformed on first
+    //execution and again for another weights buffer or weights version
+    mutable std::mutex fft_filter_mutex_;
+    mutable std::shared_ptr<std::vector<float>> fft_filter_;
+    mutable zendnn_weights_key_t fft_filter_key_;
+
+    //BatchNorm folded weights and bias(ZENDNN_CONV_FOLD_BN), folded again
+    //for other weights, bias or BatchNorm parameter buffers or weights
+    //version
+    mutable std::mutex folded_bn_mutex_;
+    mutable std::shared_ptr<const folded_bn_t> folded_bn_;
+    mutable zendnn_weights_key_t folded_bn_key_;
+
+    //Filter packed for direct convolution of low input channel layers
+    //(ic <= CONV_DIRECT_LOW_IC), cached like the FFT filter
+    mutable std::mutex low_ic_filter_mutex_;
+    mutable std::shared_ptr<std::vector<float>> low_ic_filter_;
+    mutable zendnn_weights_key_t low_ic_filter_key_;
 };
 
 } // namespace x64
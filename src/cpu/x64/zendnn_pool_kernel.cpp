@@ -106,6 +106,7 @@ template <cpu_isa_t isa>
 void zendnn_pool_kernel<isa>::generate() {}
 
 template struct zendnn_pool_kernel<avx2>; // implements both <avx> and <avx2>
+template struct zendnn_pool_kernel<avx512_core>;
 
 } // namespace x64
 } // namespace cpu
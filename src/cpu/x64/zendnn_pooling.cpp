@@ -68,7 +68,12 @@ void zendnn_pooling_fwd_t<isa, d_type>::execute_forward(
     const auto &jpp = pd()->jpp_;
     zendnnInfo(ZENDNN_CORELOG, "ZENDNN implementation path in zendnn_pooling_fwd_t::execute_forward [cpu/pooling]");
 
-    max_pooling(
+    //src and dst are nChw8c(avx2) or nChw16c(avx512), jpp.c is padded to block
+    const int block = utils::one_of(isa, avx512_common, avx512_core) ? 16 : 8;
+    const auto alg = pd()->desc()->alg_kind;
+    zendnnEnv zenEnvObj = readEnv();
+    zenPoolingBlocked(
+        zenEnvObj,
         (float *)src,
         jpp.mb,
         jpp.c,
@@ -76,18 +81,21 @@ void zendnn_pooling_fwd_t<isa, d_type>::execute_forward(
         jpp.iw,
         jpp.kh,
         jpp.kw,
-        jpp.stride_w,
         jpp.stride_h,
-        jpp.l_pad,
-        jpp.l_pad,
-        jpp.l_pad,
+        jpp.stride_w,
+        jpp.t_pad,
         jpp.l_pad,
         (float *)dst,
-        0 // 1 for NCHW and 0 for NHWC
+        jpp.oh,
+        jpp.ow,
+        alg == alg_kind::pooling_max,
+        alg == alg_kind::pooling_avg_include_padding,
+        block
     );
 }
 
 template struct zendnn_pooling_fwd_t<avx2, data_type::f32>;
+template struct zendnn_pooling_fwd_t<avx512_core, data_type::f32>;
 
 } // namespace x64
 } // namespace cpu
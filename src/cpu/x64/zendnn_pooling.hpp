@@ -50,8 +50,12 @@ struct zendnn_pooling_fwd_t : public primitive_t {
         status_t init(engine_t *engine) {
             using namespace utils;
 
+            // zenPoolingBlocked is 2D and writes no workspace, 3D pooling
+            // and max pooling for training are left to other impls
             const bool ok = true && set_default_params() == status::success
-                      && is_fwd() && !has_zero_dim_memory()
+                      && is_fwd() && !has_zero_dim_memory() && ndims() == 4
+                      && IMPLICATION(desc()->alg_kind == alg_kind::pooling_max,
+                              desc()->prop_kind == prop_kind::forward_inference)
                       && everyone_is(
                           d_type, src_md()->data_type, dst_md()->data_type)
                       && attr()->has_default_values()
@@ -59,10 +63,6 @@ struct zendnn_pooling_fwd_t : public primitive_t {
                       && memory_desc_matches_tag(*dst_md(), desired_fmt_tag());
             if (!ok) return status::unimplemented;
 
-            const bool is_training = desc_.prop_kind == prop_kind::forward_training;
-            if (desc()->alg_kind == alg_kind::pooling_max && is_training)
-                init_default_ws();
-
             auto scratchpad = scratchpad_registry().registrar();
             return zendnn_pool_kernel<isa>::init_conf(
                     jpp_, scratchpad, this, zendnn_get_max_threads());
@@ -71,8 +71,7 @@ struct zendnn_pooling_fwd_t : public primitive_t {
         format_tag_t desired_fmt_tag() {
             using namespace format_tag;
             return utils::one_of(isa, avx512_common, avx512_core)
-                   ? (ndims() == 4 ? nChw16c : nCdhw16c)
-                   : (ndims() == 4 ? nChw8c : nCdhw8c);
+                   ? nChw16c : nChw8c;
         }
 
         jit_pool_conf_t jpp_;
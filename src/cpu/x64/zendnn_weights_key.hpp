@@ -0,0 +1,57 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#ifndef CPU_X64_ZENDNN_WEIGHTS_KEY_HPP
+#define CPU_X64_ZENDNN_WEIGHTS_KEY_HPP
+
+#include "zendnn_helper.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+namespace x64 {
+
+//Key of a cached weights transform, buffers it was computed from(weights
+//and up to four parameter buffers, unused ones are NULL) and
+//zenWeightsVersion() when it was computed. Transform is reused while
+//buffers and version are same, weights values are never compared.
+struct zendnn_weights_key_t {
+    zendnn_weights_key_t() : version_(0), valid_(false) {
+        for (int i = 0; i < max_bufs; i++)
+            bufs_[i] = nullptr;
+    }
+
+    //Version is read before the transform is computed, an update during
+    //it makes the key stale
+    zendnn_weights_key_t(const void *weights, const void *p0 = nullptr,
+            const void *p1 = nullptr, const void *p2 = nullptr,
+            const void *p3 = nullptr)
+        : bufs_ {weights, p0, p1, p2, p3}
+        , version_(zenWeightsVersion())
+        , valid_(true) {}
+
+    bool operator==(const zendnn_weights_key_t &rhs) const {
+        if (!valid_ || !rhs.valid_ || version_ != rhs.version_) return false;
+        for (int i = 0; i < max_bufs; i++)
+            if (bufs_[i] != rhs.bufs_[i]) return false;
+        return true;
+    }
+    bool operator!=(const zendnn_weights_key_t &rhs) const {
+        return !(*this == rhs);
+    }
+
+  private:
+    static constexpr int max_bufs = 5;
+    const void *bufs_[max_bufs];
+    unsigned long version_;
+    bool valid_;
+};
+
+} // namespace x64
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+#endif
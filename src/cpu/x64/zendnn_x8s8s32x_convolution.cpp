@@ -0,0 +1,145 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#include "common/c_types_map.hpp"
+#include "common/zendnn_thread.hpp"
+#include "common/type_helpers.hpp"
+#include "common/utils.hpp"
+#include "common/zendnn_private.hpp"
+
+#include "cpu/cpu_primitive.hpp"
+
+#include "cpu/x64/zendnn_x8s8s32x_convolution.hpp"
+#include "zendnn_logging.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+namespace x64 {
+
+using namespace zendnn::impl::status;
+using namespace zendnn::impl::memory_tracking::names;
+using namespace zendnn::impl::utils;
+
+template <data_type_t dst_type>
+status_t zendnn_x8s8s32x_convolution_fwd_t<dst_type>::execute_forward(
+    const exec_ctx_t &ctx) const {
+    const auto &jcp = pd()->jcp_;
+    auto src = CTX_IN_MEM(const uint8_t *, ZENDNN_ARG_SRC);
+    auto weights = CTX_IN_MEM(const int8_t *, ZENDNN_ARG_WEIGHTS);
+    auto bias = CTX_IN_MEM(const char *, ZENDNN_ARG_BIAS);
+    auto dst = CTX_OUT_MEM(dst_data_t *, ZENDNN_ARG_DST);
+    auto batchNormScale = CTX_IN_MEM(const float *, ZENDNN_ARG_BN_SCALE);
+    auto batchNormMean = CTX_IN_MEM(const float *, ZENDNN_ARG_BN_MEAN);
+    auto batchNormOffset = CTX_IN_MEM(const float *, ZENDNN_ARG_BN_OFFSET);
+
+    DEFINE_ZERO_POINT_VALUE(src_zero_point, ZENDNN_ARG_SRC);
+
+    zendnnInfo(ZENDNN_CORELOG,
+               "ZENDNN implementation path in zendnn_x8s8s32x_convolution_fwd_t::execute_forward [cpu/convolution]");
+    zendnnInfo(ZENDNN_CORELOG, "algo=", jcp.alg_kind, " mb=",jcp.mb, " ih=",jcp.ih,
+               " iw=",jcp.iw, " oh=",jcp.oh, " ow=",jcp.ow, " kh=",jcp.kh,
+               " kw=",jcp.kw, " stride_h=",jcp.stride_h,
+               " stride_w=",jcp.stride_w, " l_pad=",jcp.l_pad, " t_pad=",jcp.t_pad,
+               " ic=",jcp.ic, " oc=",jcp.oc, " [cpu/convolution]");
+
+    //Bias is applied on s32 accumulators before output scales
+    const float *bias_f32 = nullptr;
+    if (bias != nullptr) {
+        const memory_desc_wrapper bias_d(pd()->weights_md(1));
+        if (bias_d.data_type() == data_type::s32) {
+            auto scratchpad = ctx.get_scratchpad_grantor();
+            float *bias_cvt = scratchpad.template get<float>(key_conv_padded_bias);
+            const int32_t *bias_s32 = (const int32_t *)bias;
+            for (int oc = 0; oc < jcp.oc; oc++) {
+                bias_cvt[oc] = (float)bias_s32[oc];
+            }
+            bias_f32 = bias_cvt;
+        }
+        else {
+            bias_f32 = (const float *)bias;
+        }
+    }
+
+    const auto &oscales = pd()->attr()->output_scales_;
+    const auto &post_ops = pd()->attr()->post_ops_;
+    const int sum_idx = post_ops.find(primitive_kind::sum);
+    const float sum_scale = sum_idx != -1 ? post_ops.entry_[sum_idx].sum.scale :
+                            0.0f;
+    const bool relu = jcp.reluFused || jcp.with_eltwise;
+
+    int filter_offset = pd()->dst_md()->offset0;
+    int total_filters = pd()->dst_md()->format_desc.blocking.strides[3];
+    bool concat = true;
+
+    if (total_filters == jcp.oc) {
+        concat = false;
+    }
+
+    std::shared_ptr<std::vector<char>> packed_filter;
+    {
+        const zendnn_weights_key_t key(weights);
+        std::lock_guard<std::mutex> lock(packed_filter_mutex_);
+        if (!packed_filter_ || packed_filter_key_ != key) {
+            zendnnInfo(ZENDNN_CORELOG,
+                       "zendnn_x8s8s32x_convolution_fwd_t::execute_forward packing filter [cpu/convolution]");
+            packed_filter_ = std::make_shared<std::vector<char>>(
+                                 zenConvolution2DInt8FilterSize(jcp.ic, jcp.oc, jcp.kh, jcp.kw));
+            zenConvolution2DInt8FilterPack(weights, jcp.ic, jcp.oc, jcp.kh, jcp.kw,
+                                           packed_filter_->data());
+            packed_filter_key_ = key;
+        }
+        packed_filter = packed_filter_;
+    }
+
+    zendnnInfo(ZENDNN_CORELOG,
+               "zendnn_x8s8s32x_convolution_fwd_t::execute_forward zenConvolution2DInt8 [cpu/convolution]");
+    zenConvolution2DInt8(
+        src,
+        jcp.mb,
+        jcp.ic,
+        jcp.ih,
+        jcp.iw,
+        weights,
+        jcp.oc,
+        jcp.kh,
+        jcp.kw,
+        jcp.t_pad,
+        jcp.l_pad,
+        jcp.b_pad,
+        jcp.r_pad,
+        jcp.stride_h,
+        jcp.stride_w,
+        bias_f32,
+        oscales.scales_,
+        oscales.count_,
+        src_zero_point,
+        jcp.batchNormFused ? batchNormScale : NULL,
+        batchNormMean,
+        batchNormOffset,
+        relu,
+        sum_scale,
+        dst,
+        dst_type == data_type::s8,
+        jcp.oh,
+        jcp.ow,
+        concat,
+        filter_offset,
+        total_filters,
+        packed_filter->data()
+    );
+
+    return status::success;
+}
+
+template struct zendnn_x8s8s32x_convolution_fwd_t<data_type::u8>;
+template struct zendnn_x8s8s32x_convolution_fwd_t<data_type::s8>;
+
+} // namespace x64
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+// vim: et ts=4 sw=4 cindent cino+=l0,\:4,N-s
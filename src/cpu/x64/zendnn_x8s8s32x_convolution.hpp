@@ -0,0 +1,151 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+#ifndef ZENDNN_X8S8S32X_CONVOLUTION_HPP
+#define ZENDNN_X8S8S32X_CONVOLUTION_HPP
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "common/c_types_map.hpp"
+#include "common/zendnn_thread.hpp"
+#include "common/memory_tracking.hpp"
+#include "common/primitive.hpp"
+#include "common/utils.hpp"
+#include "common/zendnn_private.hpp"
+
+#include "cpu/cpu_convolution_pd.hpp"
+
+#include "cpu/x64/zendnn_conv_kernel_f32.hpp"
+#include "cpu/x64/zendnn_weights_key.hpp"
+
+namespace zendnn {
+namespace impl {
+namespace cpu {
+namespace x64 {
+
+//INT8 ZenDNN convolution: u8 src, s8 weights, s32 accumulation with fused
+//output scales, src zero-point, bias, BatchNorm, sum and ReLU requantized
+//to u8/s8 dst. Enabled with ZENDNN_INT8_SUPPORT=1.
+template <impl::data_type_t dst_type>
+struct zendnn_x8s8s32x_convolution_fwd_t : public primitive_t {
+    struct pd_t : public cpu_convolution_fwd_pd_t {
+        pd_t(const convolution_desc_t *adesc,
+             const primitive_attr_t *attr,
+             const typename pd_t::base_class *hint_fwd_pd)
+            : cpu_convolution_fwd_pd_t(adesc, attr, hint_fwd_pd)
+            , jcp_() {}
+
+        DECLARE_COMMON_PD_T("zendnn_int8", zendnn_x8s8s32x_convolution_fwd_t);
+
+        status_t init(engine_t *engine) {
+            using smask_t = primitive_attr_t::skip_mask_t;
+            zendnnEnv zenEnvObj = readEnv();
+            bool ok = true && is_fwd() && zenEnvObj.zenINT8format
+                      && (set_default_alg_kind(alg_kind::convolution_gemm)
+                          ||  set_default_alg_kind(alg_kind::convolution_direct))
+                      && expect_data_types(data_type::u8, data_type::s8,
+                                           data_type::undef, dst_type, data_type::s32)
+                      && IMPLICATION(with_bias(),
+                                     utils::one_of(bias_md_.data_type, data_type::f32,
+                                             data_type::s32))
+                      && attr()->has_default_values(smask_t::oscale
+                              | smask_t::zero_points_runtime
+                              | smask_t::post_ops, dst_type)
+                      && attr()->output_scales_.defined()
+                      && utils::one_of(attr()->output_scales_.mask_, 0, 1 << 1)
+                      && ndims() == 4 && !with_groups()
+                      && KDH() == 0 && KDW() == 0
+                      && zero_points_ok() && post_ops_ok()
+                      && !has_zero_dim_memory() && set_default_formats();
+            if (!ok) return status::unimplemented;
+
+            status_t status = zendnn_conv_fwd_kernel_f32::init_conf(
+                                  jcp_, *desc(), src_md(), weights_md(), dst_md(), *attr());
+            if (status != status::success) return status;
+
+            //f32 copy of s32 bias for requantization
+            auto scratchpad = scratchpad_registry().registrar();
+            if (with_bias())
+                scratchpad.template book<float>(
+                    memory_tracking::names::key_conv_padded_bias, jcp_.oc);
+
+            return status::success;
+        }
+
+        jit_conv_conf_t jcp_;
+
+      protected:
+        bool set_default_formats() {
+            using namespace format_tag;
+            auto src_tag = nhwc;
+            auto dst_tag = nhwc;
+            auto wei_tag = hwio;
+            return set_default_formats_common(src_tag, wei_tag, dst_tag);
+        }
+
+        //Only common src zero-point is supported
+        bool zero_points_ok() const {
+            int mask_src = 0;
+            attr()->zero_points_.get(ZENDNN_ARG_SRC, nullptr, &mask_src, nullptr);
+            return attr()->zero_points_.has_default_values(ZENDNN_ARG_WEIGHTS)
+                   && attr()->zero_points_.has_default_values(ZENDNN_ARG_DST)
+                   && mask_src == 0;
+        }
+
+        //Supported post-ops: relu, sum, sum + relu
+        bool post_ops_ok() const {
+            const auto &p = attr()->post_ops_;
+            auto is_sum = [&](int idx) {
+                return p.entry_[idx].is_sum(false)
+                       && utils::one_of(p.entry_[idx].sum.dt, data_type::undef,
+                                        dst_type);
+            };
+            auto is_relu = [&](int idx) {
+                return p.entry_[idx].is_relu();
+            };
+            switch (p.len()) {
+            case 0:
+                return true;
+            case 1:
+                return is_relu(0) || is_sum(0);
+            case 2:
+                return is_sum(0) && is_relu(1);
+            default:
+                return false;
+            }
+        }
+    };
+
+    zendnn_x8s8s32x_convolution_fwd_t(const pd_t *apd) : primitive_t(apd) {}
+
+    typedef typename prec_traits<dst_type>::type dst_data_t;
+
+    status_t execute(const exec_ctx_t &ctx) const override {
+        return execute_forward(ctx);
+    }
+
+  private:
+    status_t execute_forward(const exec_ctx_t &ctx) const;
+    const pd_t *pd() const {
+        return (const pd_t *)primitive_t::pd().get();
+    }
+
+    //Packed filter, packed on first execution and again for another
+    //weights buffer or weights version(zenWeightsUpdated)
+    mutable std::mutex packed_filter_mutex_;
+    mutable std::shared_ptr<std::vector<char>> packed_filter_;
+    mutable zendnn_weights_key_t packed_filter_key_;
+};
+
+} // namespace x64
+} // namespace cpu
+} // namespace impl
+} // namespace zendnn
+
+#endif
+
+// vim: et ts=4 sw=4 cindent cino+=l0,\:4,N-s
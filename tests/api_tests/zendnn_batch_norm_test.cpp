@@ -0,0 +1,160 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks inference BatchNorm(zenBatchNorm) against zenBatchNormRef.
+ * Covers data_format 0(NCHW), 1(NHWC) and 2(BLOCKED nChw{8,16}c, compared
+ * with NHWC reference), ReLU on and off, and NaN/infinity inputs which pass
+ * through unclamped without ReLU.
+ * AVX-512 and AVX2 kernels are both run, the test runs itself again with
+ * ISA limited to AVX2(ISA is fixed for a process on first use).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+#include "zendnn_private.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+
+static void rand_fill(vector<float> &v, float low, float high) {
+    for (auto &x : v) {
+        x = low + (high - low)*(rand()/(float)RAND_MAX);
+    }
+}
+
+static bool same(float out, float ref) {
+    if (isnan(ref)) {
+        return isnan(out);
+    }
+    return out == ref || fabs(out - ref) <= 1e-5f*(1.0f + fabs(ref));
+}
+
+//block 0 is plain data_format 0 or 1, otherwise data_format 2 with block
+static int test_batch_norm(int images, int height, int width, int channels,
+                           int data_format, bool relu) {
+    int block = data_format == 2 ? (int)readEnv().zenBlockSize : 1;
+    zendnnVerbose(ZENDNN_TESTLOG, "testing batch norm images=", images,
+                  " height=", height, " width=", width, " channels=", channels,
+                  " data_format=", data_format, " block=", block, " relu=",
+                  relu);
+
+    size_t spatial = (size_t)height*width;
+    vector<float> scale(channels), mean(channels), offset(channels);
+    rand_fill(scale, -2.0f, 2.0f);
+    rand_fill(mean, -1.0f, 1.0f);
+    rand_fill(offset, -1.0f, 1.0f);
+    vector<float> in((size_t)images*spatial*channels);
+    rand_fill(in, -3.0f, 3.0f);
+    //special values go through both kernels and tails
+    const float special[] = {NAN, INFINITY, -INFINITY, -FLT_MAX};
+    for (size_t i = 0; i < in.size(); i += 7) {
+        in[i] = special[(i/7)%4];
+    }
+
+    //reference in data_format 0 or NHWC for blocked
+    vector<float> ref = in;
+    zenBatchNormRef(images, height, width, channels, scale.data(), mean.data(),
+                    offset.data(), ref.data(), data_format == 0 ? 0 : 1, relu);
+
+    int blocks = (channels + block - 1)/block;
+    vector<float> out;
+    if (data_format == 2) {
+        //NHWC to nChw{block}c, padded channels are zero
+        out.assign((size_t)images*blocks*spatial*block, 0.0f);
+        for (int n = 0; n < images; n++)
+            for (size_t s = 0; s < spatial; s++)
+                for (int c = 0; c < channels; c++)
+                    out[(((size_t)n*blocks + c/block)*spatial + s)*block + c%block] =
+                        in[((size_t)n*spatial + s)*channels + c];
+    }
+    else {
+        out = in;
+    }
+    zenBatchNorm(images, height, width, channels, scale.data(), mean.data(),
+                 offset.data(), out.data(), data_format, relu);
+
+    for (int n = 0; n < images; n++)
+        for (size_t s = 0; s < spatial; s++)
+            for (int c = 0; c < blocks*block; c++) {
+                size_t i = data_format == 2 ?
+                           (((size_t)n*blocks + c/block)*spatial + s)*block + c%block :
+                           (data_format == 0 ? ((size_t)n*channels + c)*spatial + s :
+                            ((size_t)n*spatial + s)*channels + c);
+                if (c >= channels) {
+                    if (out[i] != 0.0f) {
+                        zendnnInfo(ZENDNN_TESTLOG, "batch norm padded channel ",
+                                   c, " is not zero: ", out[i]);
+                        return API_FAILURE;
+                    }
+                    continue;
+                }
+                size_t r = data_format == 0 ? i : ((size_t)n*spatial + s)*channels + c;
+                if (!same(out[i], ref[r])) {
+                    zendnnInfo(ZENDNN_TESTLOG, "batch norm mismatch at ", i,
+                               " out: ", out[i], " ref: ", ref[r]);
+                    return API_FAILURE;
+                }
+            }
+    return API_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    bool avx2 = argc > 1 && strcmp(argv[1], "avx2") == 0;
+    if (avx2) {
+        set_max_cpu_isa(cpu_isa::avx2);
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_batch_norm_test starts",
+               avx2 ? " with AVX2" : "");
+    srand(1111);
+
+    const int shapes[][4] = {
+        //images height width channels
+        {2, 7, 9, 37}, {1, 56, 56, 64}, {3, 5, 5, 3}, {1, 1, 1, 19},
+        {4, 33, 17, 130}
+    };
+    const char *block_sizes[] = {"8", "16"};
+
+    int status = API_SUCCESS;
+    for (const auto &p : shapes) {
+        for (int relu = 0; relu < 2; relu++) {
+            status |= test_batch_norm(p[0], p[1], p[2], p[3], 0, relu);
+            status |= test_batch_norm(p[0], p[1], p[2], p[3], 1, relu);
+            //ZENDNN_BLOCK_SIZE=16 is honoured only with AVX-512
+            for (const char *block_size : block_sizes) {
+                setenv("ZENDNN_BLOCK_SIZE", block_size, 1);
+                if ((int)readEnv().zenBlockSize == atoi(block_size)) {
+                    status |= test_batch_norm(p[0], p[1], p[2], p[3], 2, relu);
+                }
+            }
+            unsetenv("ZENDNN_BLOCK_SIZE");
+        }
+    }
+
+    //AVX2 kernels
+    if (!avx2) {
+        string cmd = string(argv[0]) + " avx2";
+        status |= system(cmd.c_str()) != 0;
+    }
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_batch_norm_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_batch_norm_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_batch_norm_test ends");
+    return status;
+}
@@ -0,0 +1,223 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks BF16 ZenDNN convolution primitive(zendnn_bf16) against f32
+ * reference convolution primitive(algorithm::convolution_ref) run on the
+ * same values.
+ * Covers padding, stride 2, 1x1 and non square input, batch > 1, bias and
+ * ReLU post-op, with f32 and bf16 dst. Post-ops other than ReLU(sum, GeLU,
+ * leaky ReLU) must not select zendnn_bf16.
+ * Inputs are multiples of 1/8 in [-1, 1], exact in bf16.
+ * I/p and o/p format is NHWC and filter format is HWIO.
+ * Test is skipped on cores without AVX-512, zendnn_bf16 is not selected
+ * there.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+using tag = memory::format_tag;
+using dt = memory::data_type;
+
+enum bf16_conv_post_op {
+    POST_NONE, POST_RELU, POST_SUM, POST_GELU, POST_LEAKY_RELU
+};
+
+struct bf16_conv_params {
+    int images, channels, height, width, no_of_filter, kernel, stride, pad;
+};
+
+//cpu_isa values are masks of ISA features
+static bool has_avx512_core() {
+    const int isa = (int)get_effective_cpu_isa();
+    const int core = (int)cpu_isa::avx512_core;
+    return (isa & core) == core;
+}
+
+static void rand_fill(vector<float> &v) {
+    for (auto &x : v) {
+        x = (rand()%17 - 8)/8.0f;
+    }
+}
+
+static convolution_forward::primitive_desc conv_pd(engine &eng,
+        algorithm alg, const bf16_conv_params &p, dt data_dt, dt dst_dt,
+        bf16_conv_post_op post) {
+    int out_height = (p.height + 2*p.pad - p.kernel)/p.stride + 1;
+    int out_width = (p.width + 2*p.pad - p.kernel)/p.stride + 1;
+    memory::desc src_md({p.images, p.channels, p.height, p.width}, data_dt,
+                        tag::nhwc);
+    memory::desc wei_md({p.no_of_filter, p.channels, p.kernel, p.kernel},
+                        data_dt, tag::hwio);
+    memory::desc bias_md({p.no_of_filter}, dt::f32, tag::x);
+    memory::desc dst_md({p.images, p.no_of_filter, out_height, out_width},
+                        dst_dt, tag::nhwc);
+
+    post_ops ops;
+    if (post == POST_RELU) {
+        ops.append_eltwise(1.0f, algorithm::eltwise_relu, 0.0f, 0.0f);
+    }
+    else if (post == POST_SUM) {
+        ops.append_sum(1.0f);
+    }
+    else if (post == POST_GELU) {
+        ops.append_eltwise(1.0f, algorithm::eltwise_gelu, 0.0f, 0.0f);
+    }
+    else if (post == POST_LEAKY_RELU) {
+        ops.append_eltwise(1.0f, algorithm::eltwise_relu, 0.1f, 0.0f);
+    }
+    primitive_attr attr;
+    attr.set_post_ops(ops);
+
+    auto conv_d = convolution_forward::desc(prop_kind::forward_inference, alg,
+                                            src_md, wei_md, bias_md, dst_md, {p.stride, p.stride},
+                                            {p.pad, p.pad}, {p.pad, p.pad});
+    return convolution_forward::primitive_desc(conv_d, attr, eng);
+}
+
+//Runs convolution, user data is f32 and is reordered to and from primitive
+//memories
+static void run_conv(engine &eng, stream &s,
+                     const convolution_forward::primitive_desc &pd,
+                     vector<float> &src, vector<float> &wei,
+                     vector<float> &bias, vector<float> &dst) {
+    memory user_src({pd.src_desc().dims(), dt::f32, tag::nhwc}, eng,
+                    src.data());
+    memory user_wei({pd.weights_desc().dims(), dt::f32, tag::hwio}, eng,
+                    wei.data());
+    memory user_dst({pd.dst_desc().dims(), dt::f32, tag::nhwc}, eng,
+                    dst.data());
+    memory bias_mem(pd.bias_desc(), eng, bias.data());
+
+    memory src_mem(pd.src_desc(), eng), wei_mem(pd.weights_desc(), eng),
+           dst_mem(pd.dst_desc(), eng);
+    reorder(user_src, src_mem).execute(s, user_src, src_mem);
+    reorder(user_wei, wei_mem).execute(s, user_wei, wei_mem);
+    convolution_forward(pd).execute(s, {
+        {ZENDNN_ARG_SRC, src_mem}, {ZENDNN_ARG_WEIGHTS, wei_mem},
+        {ZENDNN_ARG_BIAS, bias_mem}, {ZENDNN_ARG_DST, dst_mem}
+    });
+    reorder(dst_mem, user_dst).execute(s, dst_mem, user_dst);
+    s.wait();
+}
+
+static int test_bf16_conv(engine &eng, stream &s, const bf16_conv_params &p,
+                          bool relu, dt dst_dt) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing bf16 conv images=", p.images,
+                  " channels=", p.channels, " height=", p.height,
+                  " width=", p.width, " no_of_filter=", p.no_of_filter,
+                  " kernel=", p.kernel, " stride=", p.stride, " pad=", p.pad,
+                  " relu=", relu, " dst_bf16=", dst_dt == dt::bf16);
+
+    bf16_conv_post_op post = relu ? POST_RELU : POST_NONE;
+    auto bf16_pd = conv_pd(eng, algorithm::convolution_gemm, p, dt::bf16,
+                           dst_dt, post);
+    if (strncmp(bf16_pd.impl_info_str(), "zendnn_bf16", 11) != 0) {
+        zendnnInfo(ZENDNN_TESTLOG, "bf16 conv unexpected impl: ",
+                   bf16_pd.impl_info_str());
+        return API_FAILURE;
+    }
+    auto ref_pd = conv_pd(eng, algorithm::convolution_ref, p, dt::f32, dt::f32,
+                          post);
+
+    int out_height = (p.height + 2*p.pad - p.kernel)/p.stride + 1;
+    int out_width = (p.width + 2*p.pad - p.kernel)/p.stride + 1;
+    vector<float> src((size_t)p.images*p.height*p.width*p.channels);
+    vector<float> wei((size_t)p.kernel*p.kernel*p.channels*p.no_of_filter);
+    vector<float> bias(p.no_of_filter);
+    vector<float> out((size_t)p.images*out_height*out_width*p.no_of_filter);
+    vector<float> ref(out.size());
+    rand_fill(src);
+    rand_fill(wei);
+    rand_fill(bias);
+
+    run_conv(eng, s, bf16_pd, src, wei, bias, out);
+    run_conv(eng, s, ref_pd, src, wei, bias, ref);
+
+    //bf16 dst keeps 8 bits of mantissa
+    const float tol = dst_dt == dt::bf16 ? 1e-2f : 1e-4f;
+    for (size_t i = 0; i < out.size(); i++) {
+        if (fabs(out[i] - ref[i]) > tol*(1.0f + fabs(ref[i]))) {
+            zendnnInfo(ZENDNN_TESTLOG, "bf16 conv mismatch at ", i, " out: ",
+                       out[i], " ref: ", ref[i]);
+            return API_FAILURE;
+        }
+    }
+    return API_SUCCESS;
+}
+
+//zendnn_bf16 fuses only ReLU, other post-ops go to other implementations
+static int test_bf16_conv_post_op_fallback(engine &eng) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing bf16 conv unsupported post-ops");
+    const bf16_conv_params p = {1, 16, 7, 7, 16, 3, 1, 1};
+    const bf16_conv_post_op posts[] = {POST_SUM, POST_GELU, POST_LEAKY_RELU};
+    for (auto post : posts) {
+        try {
+            auto pd = conv_pd(eng, algorithm::convolution_gemm, p, dt::bf16,
+                              dt::f32, post);
+            if (strncmp(pd.impl_info_str(), "zendnn_bf16", 11) == 0) {
+                zendnnInfo(ZENDNN_TESTLOG, "bf16 conv post-op ", post,
+                           " selected zendnn_bf16");
+                return API_FAILURE;
+            }
+        }
+        catch (error &e) {
+            //no implementation supports this post-op
+        }
+    }
+    return API_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_bf16_conv_test starts");
+    srand(1111);
+
+    engine eng(engine::kind::cpu, 0);
+    stream s(eng);
+
+    int status = API_SUCCESS;
+    if (!has_avx512_core()) {
+        zendnnInfo(ZENDNN_TESTLOG,
+                   "zendnn_bf16_conv_test skipped, AVX-512 is not available");
+    }
+    else {
+        const bf16_conv_params params[] = {
+            //images channels height width filters kernel stride pad
+            {2,  3, 11, 11, 16, 3, 2, 1},
+            {1, 16,  7,  9, 24, 1, 1, 0},
+            {1,  8,  9,  9,  5, 3, 1, 1},
+            {3, 16,  6,  6, 40, 1, 2, 0},
+            {2, 32, 13, 10, 33, 5, 1, 2},
+        };
+        for (const auto &p : params) {
+            for (int relu = 0; relu < 2; relu++) {
+                status |= test_bf16_conv(eng, s, p, relu, dt::f32);
+                status |= test_bf16_conv(eng, s, p, relu, dt::bf16);
+            }
+        }
+        status |= test_bf16_conv_post_op_fallback(eng);
+    }
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_bf16_conv_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_bf16_conv_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_bf16_conv_test ends");
+    return status;
+}
@@ -0,0 +1,220 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks BF16 ZenDNN MatMul primitive(zendnn_bf16) against f32 MatMul
+ * primitive run on the same values.
+ * Covers 2D and batched 3D MatMul, transposed weights, bias, ReLU, GeLU(tanh
+ * and erf), sum with beta and sum followed by ReLU, with f32 and bf16 dst.
+ * Inputs are multiples of 1/8 in [-1, 1], exact in bf16, so only bf16 dst
+ * rounding and GeLU approximation differ from f32 result.
+ * Test is skipped on cores without AVX-512, zendnn_bf16 is not selected
+ * there.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+using dt = memory::data_type;
+
+enum bf16_post_op {
+    POST_NONE, POST_RELU, POST_GELU, POST_GELU_ERF, POST_SUM, POST_SUM_RELU
+};
+
+static const char *post_op_name[] = {
+    "none", "relu", "gelu", "gelu_erf", "sum", "sum_relu"
+};
+
+struct bf16_matmul_params {
+    int batch, M, K, N;
+    bool trans_weights, bias;
+    bf16_post_op post;
+};
+
+static void rand_fill(vector<float> &v) {
+    for (auto &x : v) {
+        x = (rand()%17 - 8)/8.0f;
+    }
+}
+
+//cpu_isa values are masks of ISA features
+static bool has_avx512_core() {
+    const int isa = (int)get_effective_cpu_isa();
+    const int core = (int)cpu_isa::avx512_core;
+    return (isa & core) == core;
+}
+
+static memory::dims plain_strides(const memory::dims &dims, bool trans) {
+    int nd = dims.size();
+    memory::dims strides(nd);
+    if (trans) {
+        strides[nd - 2] = 1;
+        strides[nd - 1] = dims[nd - 2];
+    }
+    else {
+        strides[nd - 2] = dims[nd - 1];
+        strides[nd - 1] = 1;
+    }
+    if (nd == 3) {
+        strides[0] = dims[1]*dims[2];
+    }
+    return strides;
+}
+
+//Runs MatMul with src/weights of type wei_dt and dst of type dst_dt, user
+//data is f32 and is reordered to and from primitive memories
+static int run_matmul(engine &eng, stream &s, const bf16_matmul_params &p,
+                      dt wei_dt, dt dst_dt, vector<float> &src,
+                      vector<float> &wei, vector<float> &bias,
+                      vector<float> &dst, const char *expected_impl) {
+    memory::dims src_dims = {p.M, p.K}, wei_dims = {p.K, p.N},
+                 dst_dims = {p.M, p.N}, bias_dims = {1, p.N};
+    if (p.batch > 1) {
+        src_dims.insert(src_dims.begin(), p.batch);
+        wei_dims.insert(wei_dims.begin(), p.batch);
+        dst_dims.insert(dst_dims.begin(), p.batch);
+        bias_dims.insert(bias_dims.begin(), 1);
+    }
+    memory::desc src_md(src_dims, wei_dt, plain_strides(src_dims, false));
+    memory::desc wei_md(wei_dims, wei_dt, plain_strides(wei_dims,
+                        p.trans_weights));
+    memory::desc dst_md(dst_dims, dst_dt, plain_strides(dst_dims, false));
+    memory::desc bias_md(bias_dims, dt::f32, plain_strides(bias_dims, false));
+
+    post_ops ops;
+    if (p.post == POST_SUM || p.post == POST_SUM_RELU) {
+        ops.append_sum(0.5f);
+    }
+    if (p.post == POST_RELU || p.post == POST_SUM_RELU) {
+        ops.append_eltwise(1.0f, algorithm::eltwise_relu, 0.0f, 0.0f);
+    }
+    else if (p.post == POST_GELU) {
+        ops.append_eltwise(1.0f, algorithm::eltwise_gelu, 0.0f, 0.0f);
+    }
+    else if (p.post == POST_GELU_ERF) {
+        ops.append_eltwise(1.0f, algorithm::eltwise_gelu_erf, 0.0f, 0.0f);
+    }
+    primitive_attr attr;
+    attr.set_post_ops(ops);
+
+    auto matmul_d = p.bias ? matmul::desc(src_md, wei_md, bias_md, dst_md) :
+                    matmul::desc(src_md, wei_md, dst_md);
+    auto matmul_pd = matmul::primitive_desc(matmul_d, attr, eng);
+    if (expected_impl && strncmp(matmul_pd.impl_info_str(), expected_impl,
+                                 strlen(expected_impl)) != 0) {
+        zendnnInfo(ZENDNN_TESTLOG, "bf16 matmul unexpected impl: ",
+                   matmul_pd.impl_info_str());
+        return API_FAILURE;
+    }
+
+    //f32 user memories, weights in the same layout as primitive weights
+    memory user_src({src_dims, dt::f32, plain_strides(src_dims, false)}, eng,
+                    src.data());
+    memory user_wei({wei_dims, dt::f32, plain_strides(wei_dims, p.trans_weights)},
+                    eng, wei.data());
+    memory user_dst({dst_dims, dt::f32, plain_strides(dst_dims, false)}, eng,
+                    dst.data());
+    memory user_bias(bias_md, eng, bias.data());
+
+    memory src_mem(src_md, eng), wei_mem(wei_md, eng), dst_mem(dst_md, eng);
+    reorder(user_src, src_mem).execute(s, user_src, src_mem);
+    reorder(user_wei, wei_mem).execute(s, user_wei, wei_mem);
+    //sum post-op accumulates to existing dst
+    reorder(user_dst, dst_mem).execute(s, user_dst, dst_mem);
+
+    matmul(matmul_pd).execute(s, {
+        {ZENDNN_ARG_SRC, src_mem}, {ZENDNN_ARG_WEIGHTS, wei_mem},
+        {ZENDNN_ARG_BIAS, user_bias}, {ZENDNN_ARG_DST, dst_mem}
+    });
+    reorder(dst_mem, user_dst).execute(s, dst_mem, user_dst);
+    s.wait();
+    return API_SUCCESS;
+}
+
+static int test_bf16_matmul(engine &eng, stream &s,
+                            const bf16_matmul_params &p, dt dst_dt) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing bf16 matmul batch=", p.batch,
+                  " M=", p.M, " K=", p.K, " N=", p.N, " trans_weights=",
+                  p.trans_weights, " bias=", p.bias, " post_op=",
+                  post_op_name[p.post], " dst_bf16=", dst_dt == dt::bf16);
+
+    vector<float> src((size_t)p.batch*p.M*p.K), wei((size_t)p.batch*p.K*p.N);
+    vector<float> bias(p.N), dst((size_t)p.batch*p.M*p.N);
+    rand_fill(src);
+    rand_fill(wei);
+    rand_fill(bias);
+    rand_fill(dst);
+    vector<float> ref(dst);
+
+    int status = run_matmul(eng, s, p, dt::bf16, dst_dt, src, wei, bias, dst,
+                            "zendnn_bf16");
+    status |= run_matmul(eng, s, p, dt::f32, dt::f32, src, wei, bias, ref,
+                         NULL);
+    if (status != API_SUCCESS) {
+        return status;
+    }
+
+    //bf16 dst keeps 8 bits of mantissa
+    const float tol = dst_dt == dt::bf16 ? 1e-2f : 1e-3f;
+    for (size_t i = 0; i < dst.size(); i++) {
+        if (fabs(dst[i] - ref[i]) > tol*(1.0f + fabs(ref[i]))) {
+            zendnnInfo(ZENDNN_TESTLOG, "bf16 matmul mismatch at ", i,
+                       " out: ", dst[i], " ref: ", ref[i]);
+            return API_FAILURE;
+        }
+    }
+    return API_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_bf16_matmul_test starts");
+    srand(1111);
+
+    engine eng(engine::kind::cpu, 0);
+    stream s(eng);
+
+    int status = API_SUCCESS;
+    if (!has_avx512_core()) {
+        zendnnInfo(ZENDNN_TESTLOG,
+                   "zendnn_bf16_matmul_test skipped, AVX-512 is not available");
+    }
+    else {
+        const bf16_matmul_params params[] = {
+            //batch M K N trans_weights bias post_op
+            {1, 37, 19, 50, false, true,  POST_NONE},
+            {1, 64, 32, 33, false, false, POST_RELU},
+            {1,  3, 16, 70, true,  true,  POST_GELU},
+            {1, 20, 48, 24, false, true,  POST_GELU_ERF},
+            {1, 16, 24, 40, false, false, POST_SUM},
+            {3,  2,  5, 100, true, true,  POST_NONE},
+            {4, 13, 32, 17, false, true,  POST_RELU},
+            {2,  9, 16, 21, false, true,  POST_SUM_RELU},
+        };
+        for (const auto &p : params) {
+            status |= test_bf16_matmul(eng, s, p, dt::f32);
+            status |= test_bf16_matmul(eng, s, p, dt::bf16);
+        }
+    }
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_bf16_matmul_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_bf16_matmul_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_bf16_matmul_test ends");
+    return status;
+}
@@ -0,0 +1,329 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks BLOCKED Format convolution(zendnn_blocked) and pooling primitives
+ * against the same primitives run on plain layout.
+ * Blocked run sets ZENDNN_BLOCKED_FORMAT=1 and ZENDNN_BLOCK_SIZE=8/16,
+ * src/dst are nChw{8,16}c and conv weights OIhw{8,16}i{8,16}o. Plain run
+ * uses nhwc src/dst and hwio weights for conv, nchw for pooling.
+ * 3D blocked pooling and max pooling for training must not select ZenDNN
+ * pooling(2D, no workspace).
+ * Block size 16 is tested only on AVX-512 capable cores.
+ * User data is nchw/oihw and is reordered to and from each layout.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+using tag = memory::format_tag;
+using dt = memory::data_type;
+
+//conv post-ops supported by blocked convolution
+enum conv_post_op {
+    POST_NONE, POST_RELU, POST_SUM, POST_SUM_RELU
+};
+
+static void rand_fill(vector<float> &v, float low, float high) {
+    for (auto &x : v) {
+        x = low + (high - low)*(rand()/(float)RAND_MAX);
+    }
+}
+
+//Reorders user data into a memory of desc md
+static memory reorder_to(engine &eng, stream &s, memory &user,
+                         const memory::desc &md) {
+    memory mem(md, eng);
+    reorder(user, mem).execute(s, user, mem);
+    s.wait();
+    return mem;
+}
+
+static int compare(const vector<float> &out, const vector<float> &ref,
+                   const char *name) {
+    for (size_t i = 0; i < out.size(); i++) {
+        if (fabs(out[i] - ref[i]) > 1e-4f*(1.0f + fabs(ref[i]))) {
+            zendnnInfo(ZENDNN_TESTLOG, name, " mismatch at ", i, " blocked: ",
+                       out[i], " plain: ", ref[i]);
+            return API_FAILURE;
+        }
+    }
+    return API_SUCCESS;
+}
+
+//Runs convolution with bias and post-ops, block 0 is plain layout
+static int run_conv(engine &eng, stream &s, int block, memory::dims src_dims,
+                    memory::dims wei_dims, memory::dims dst_dims, int stride,
+                    int pad, conv_post_op post, vector<float> &src,
+                    vector<float> &wei, vector<float> &bias,
+                    vector<float> &dst) {
+    setenv("ZENDNN_BLOCKED_FORMAT", block ? "1" : "0", 1);
+    if (block) {
+        setenv("ZENDNN_BLOCK_SIZE", block == 16 ? "16" : "8", 1);
+    }
+
+    memory user_src({src_dims, dt::f32, tag::nchw}, eng, src.data());
+    memory user_wei({wei_dims, dt::f32, tag::oihw}, eng, wei.data());
+    memory user_bias({{wei_dims[0]}, dt::f32, tag::x}, eng, bias.data());
+    memory user_dst({dst_dims, dt::f32, tag::nchw}, eng, dst.data());
+
+    tag dat_tag = block == 16 ? tag::nChw16c : (block ? tag::nChw8c :
+                  tag::nhwc);
+    tag wei_tag = block == 16 ? tag::OIhw16i16o : (block ? tag::OIhw8i8o :
+                  tag::hwio);
+    memory::desc src_md(src_dims, dt::f32, dat_tag);
+    memory::desc wei_md(wei_dims, dt::f32, wei_tag);
+    memory::desc dst_md(dst_dims, dt::f32, dat_tag);
+
+    post_ops ops;
+    if (post == POST_SUM || post == POST_SUM_RELU) {
+        ops.append_sum(1.0f);
+    }
+    if (post == POST_RELU || post == POST_SUM_RELU) {
+        ops.append_eltwise(1.0f, algorithm::eltwise_relu, 0.0f, 0.0f);
+    }
+    primitive_attr attr;
+    attr.set_post_ops(ops);
+
+    auto conv_d = convolution_forward::desc(prop_kind::forward_inference,
+                                            algorithm::convolution_gemm, src_md,
+                                            wei_md, user_bias.get_desc(),
+                                            dst_md, {stride, stride},
+                                            {pad, pad}, {pad, pad});
+    auto conv_pd = convolution_forward::primitive_desc(conv_d, attr, eng);
+    if (block && strncmp(conv_pd.impl_info_str(), "zendnn_blocked", 14) != 0) {
+        zendnnInfo(ZENDNN_TESTLOG, "blocked conv is not selected, impl: ",
+                   conv_pd.impl_info_str());
+        return API_FAILURE;
+    }
+
+    memory conv_src = reorder_to(eng, s, user_src, src_md);
+    memory conv_wei = reorder_to(eng, s, user_wei, wei_md);
+    //sum post-op accumulates into initial dst
+    memory conv_dst = reorder_to(eng, s, user_dst, dst_md);
+    convolution_forward(conv_pd).execute(s, {
+        {ZENDNN_ARG_SRC, conv_src}, {ZENDNN_ARG_WEIGHTS, conv_wei},
+        {ZENDNN_ARG_BIAS, user_bias}, {ZENDNN_ARG_DST, conv_dst}
+    });
+    s.wait();
+    reorder(conv_dst, user_dst).execute(s, conv_dst, user_dst);
+    s.wait();
+    return API_SUCCESS;
+}
+
+static int test_blocked_conv(engine &eng, stream &s, int block, int images,
+                             int channels, int height, int width,
+                             int no_of_filter, int kernel, int stride, int pad,
+                             conv_post_op post) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing blocked conv block=", block,
+                  " images=", images, " channels=", channels, " height=",
+                  height, " width=", width, " no_of_filter=", no_of_filter,
+                  " kernel=", kernel, " stride=", stride, " pad=", pad,
+                  " post=", (int)post);
+
+    int out_height = (height + 2*pad - kernel)/stride + 1;
+    int out_width = (width + 2*pad - kernel)/stride + 1;
+    memory::dims src_dims = {images, channels, height, width};
+    memory::dims wei_dims = {no_of_filter, channels, kernel, kernel};
+    memory::dims dst_dims = {images, no_of_filter, out_height, out_width};
+
+    vector<float> src((size_t)images*channels*height*width);
+    vector<float> wei((size_t)no_of_filter*channels*kernel*kernel);
+    vector<float> bias(no_of_filter);
+    vector<float> dst((size_t)images*no_of_filter*out_height*out_width);
+    rand_fill(src, -1.0f, 1.0f);
+    rand_fill(wei, -0.5f, 0.5f);
+    rand_fill(bias, -1.0f, 1.0f);
+    rand_fill(dst, -1.0f, 1.0f);
+    vector<float> ref = dst;
+
+    int status = run_conv(eng, s, 0, src_dims, wei_dims, dst_dims, stride, pad,
+                          post, src, wei, bias, ref);
+    status |= run_conv(eng, s, block, src_dims, wei_dims, dst_dims, stride,
+                       pad, post, src, wei, bias, dst);
+    if (status != API_SUCCESS) {
+        return status;
+    }
+    return compare(dst, ref, "blocked conv");
+}
+
+//Runs pooling, block 0 is plain layout
+static void run_pool(engine &eng, stream &s, int block, algorithm alg,
+                     memory::dims src_dims, memory::dims dst_dims, int kernel,
+                     int stride, int pad, vector<float> &src,
+                     vector<float> &dst, const char **impl) {
+    memory user_src({src_dims, dt::f32, tag::nchw}, eng, src.data());
+    memory user_dst({dst_dims, dt::f32, tag::nchw}, eng, dst.data());
+
+    tag dat_tag = block == 16 ? tag::nChw16c : (block ? tag::nChw8c :
+                  tag::nchw);
+    memory::desc src_md(src_dims, dt::f32, dat_tag);
+    memory::desc dst_md(dst_dims, dt::f32, dat_tag);
+
+    auto pool_d = pooling_forward::desc(prop_kind::forward_inference, alg,
+                                        src_md, dst_md, {stride, stride},
+                                        {kernel, kernel}, {pad, pad},
+                                        {pad, pad});
+    auto pool_pd = pooling_forward::primitive_desc(pool_d, eng);
+    *impl = pool_pd.impl_info_str();
+
+    memory pool_src = reorder_to(eng, s, user_src, src_md);
+    memory pool_dst(dst_md, eng);
+    pooling_forward(pool_pd).execute(s, {
+        {ZENDNN_ARG_SRC, pool_src}, {ZENDNN_ARG_DST, pool_dst}
+    });
+    s.wait();
+    reorder(pool_dst, user_dst).execute(s, pool_dst, user_dst);
+    s.wait();
+}
+
+static int test_blocked_pool(engine &eng, stream &s, int block, algorithm alg,
+                             int images, int channels, int height, int width,
+                             int kernel, int stride, int pad) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing blocked pool block=", block,
+                  " max=", alg == algorithm::pooling_max, " images=", images,
+                  " channels=", channels, " height=", height, " width=", width,
+                  " kernel=", kernel, " stride=", stride, " pad=", pad);
+
+    int out_height = (height + 2*pad - kernel)/stride + 1;
+    int out_width = (width + 2*pad - kernel)/stride + 1;
+    memory::dims src_dims = {images, channels, height, width};
+    memory::dims dst_dims = {images, channels, out_height, out_width};
+
+    vector<float> src((size_t)images*channels*height*width);
+    vector<float> dst((size_t)images*channels*out_height*out_width);
+    vector<float> ref(dst.size());
+    rand_fill(src, -1.0f, 1.0f);
+
+    const char *impl;
+    run_pool(eng, s, 0, alg, src_dims, dst_dims, kernel, stride, pad, src, ref,
+             &impl);
+    run_pool(eng, s, block, alg, src_dims, dst_dims, kernel, stride, pad, src,
+             dst, &impl);
+    //nChw16c is served by ZenDNN avx512_core pooling
+    if (block == 16 && strncmp(impl, "zendnn", 6) != 0) {
+        zendnnInfo(ZENDNN_TESTLOG, "blocked pooling is not selected, impl: ",
+                   impl);
+        return API_FAILURE;
+    }
+    return compare(dst, ref, "blocked pool");
+}
+
+//ZenDNN blocked pooling is 2D inference only, 3D blocked pooling and max
+//pooling for training(needs workspace) go to other impls, 3D output is
+//checked against plain layout
+static int test_blocked_pool_fallback(engine &eng, stream &s, int block) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing blocked pool fallback block=",
+                  block);
+    tag blk_2d = block == 16 ? tag::nChw16c : tag::nChw8c;
+    tag blk_3d = block == 16 ? tag::nCdhw16c : tag::nCdhw8c;
+
+    memory::desc train_md({2, 32, 8, 8}, dt::f32, blk_2d);
+    memory::desc train_dst_md({2, 32, 4, 4}, dt::f32, blk_2d);
+    auto train_d = pooling_forward::desc(prop_kind::forward_training,
+                                         algorithm::pooling_max, train_md,
+                                         train_dst_md, {2, 2}, {2, 2},
+                                         {0, 0}, {0, 0});
+    auto train_pd = pooling_forward::primitive_desc(train_d, eng);
+    if (strncmp(train_pd.impl_info_str(), "zendnn", 6) == 0) {
+        zendnnInfo(ZENDNN_TESTLOG, "ZenDNN pooling selected for training");
+        return API_FAILURE;
+    }
+
+    memory::dims src_dims = {1, 24, 6, 7, 9};
+    memory::dims dst_dims = {1, 24, 3, 3, 4};
+    vector<float> src((size_t)24*6*7*9), dst((size_t)24*3*3*4), ref(dst.size());
+    rand_fill(src, -1.0f, 1.0f);
+    vector<float> *outs[] = {&ref, &dst};
+    for (int blocked = 0; blocked < 2; blocked++) {
+        memory user_src({src_dims, dt::f32, tag::ncdhw}, eng, src.data());
+        memory user_dst({dst_dims, dt::f32, tag::ncdhw}, eng,
+                        outs[blocked]->data());
+        memory::desc src_md(src_dims, dt::f32, blocked ? blk_3d : tag::ncdhw);
+        memory::desc dst_md(dst_dims, dt::f32, blocked ? blk_3d : tag::ncdhw);
+        auto pool_d = pooling_forward::desc(prop_kind::forward_inference,
+                                            algorithm::pooling_max, src_md,
+                                            dst_md, {2, 2, 2}, {2, 2, 2},
+                                            {0, 0, 0}, {0, 0, 0});
+        auto pool_pd = pooling_forward::primitive_desc(pool_d, eng);
+        if (strncmp(pool_pd.impl_info_str(), "zendnn", 6) == 0) {
+            zendnnInfo(ZENDNN_TESTLOG, "ZenDNN pooling selected for 3D");
+            return API_FAILURE;
+        }
+        memory pool_src = reorder_to(eng, s, user_src, src_md);
+        memory pool_dst(dst_md, eng);
+        pooling_forward(pool_pd).execute(s, {
+            {ZENDNN_ARG_SRC, pool_src}, {ZENDNN_ARG_DST, pool_dst}
+        });
+        s.wait();
+        reorder(pool_dst, user_dst).execute(s, pool_dst, user_dst);
+        s.wait();
+    }
+    return compare(dst, ref, "blocked 3D pool");
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_blocked_conv_pool_test starts");
+    srand(1111);
+    engine eng(engine::kind::cpu, 0);
+    stream s(eng);
+
+    int status = API_SUCCESS;
+    const int blocks[] = {8, 16};
+    for (int block : blocks) {
+        if (block == 16) {
+            //ZENDNN_BLOCK_SIZE=16 is honoured only with AVX-512
+            setenv("ZENDNN_BLOCK_SIZE", "16", 1);
+            if (readEnv().zenBlockSize != 16) {
+                zendnnInfo(ZENDNN_TESTLOG,
+                           "block size 16 needs AVX-512, skipped");
+                continue;
+            }
+        }
+        //channels not multiple of block, padded channels of layout
+        status |= test_blocked_conv(eng, s, block, 2, 16, 14, 14, 32, 3, 1, 1,
+                                    POST_NONE);
+        status |= test_blocked_conv(eng, s, block, 1, 24, 15, 13, 40, 3, 2, 1,
+                                    POST_RELU);
+        status |= test_blocked_conv(eng, s, block, 2, 32, 9, 9, 16, 1, 1, 0,
+                                    POST_SUM);
+        status |= test_blocked_conv(eng, s, block, 1, 3, 17, 17, 24, 5, 2, 2,
+                                    POST_SUM_RELU);
+
+        status |= test_blocked_pool(eng, s, block, algorithm::pooling_max, 2,
+                                    32, 14, 14, 2, 2, 0);
+        status |= test_blocked_pool(eng, s, block, algorithm::pooling_max, 1,
+                                    24, 15, 13, 3, 2, 1);
+        status |= test_blocked_pool(eng, s, block,
+                                    algorithm::pooling_avg_exclude_padding, 2,
+                                    16, 13, 13, 3, 2, 1);
+        status |= test_blocked_pool(eng, s, block,
+                                    algorithm::pooling_avg_include_padding, 1,
+                                    40, 7, 7, 3, 1, 1);
+        status |= test_blocked_pool_fallback(eng, s, block);
+    }
+    unsetenv("ZENDNN_BLOCKED_FORMAT");
+    unsetenv("ZENDNN_BLOCK_SIZE");
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_blocked_conv_pool_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_blocked_conv_pool_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_blocked_conv_pool_test ends");
+    return status;
+}
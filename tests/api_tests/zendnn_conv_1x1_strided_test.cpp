@@ -0,0 +1,147 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks strided/padded 1x1 convolution(zenConvolution2DGemm1x1Strided),
+ * where GEMM reads strided input in place, against the generic gemm path:
+ * patch matrix built with im2rowNHWC and convolved as unstrided 1x1
+ * convolution.
+ * Covers batch 1(latency path) and batch > 1(throughput path), stride 2,
+ * different stride for height and width, padding, non square input, without
+ * bias, with bias and with bias + ReLU.
+ * I/p and o/p format is NHWC and filter format is HWCN.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+#include "zendnn_private.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+
+struct conv_1x1_params {
+    int images, channels, height, width, no_of_filter;
+    int stride_h, stride_w, pad;
+};
+
+enum conv_1x1_post_op {
+    POST_NONE, POST_BIAS, POST_BIAS_RELU
+};
+
+static void run_conv(conv_1x1_post_op op, const float *in, int images,
+                     int channels, int height, int width, const float *filter,
+                     int no_of_filter, int pad, int stride_h, int stride_w,
+                     const float *bias, float *out, int out_height,
+                     int out_width) {
+    switch (op) {
+    case POST_NONE:
+        zenConvolution2D(in, images, channels, height, width, filter,
+                         no_of_filter, 1, 1, pad, pad, pad, pad, stride_h, stride_w,
+                         out, out_height, out_width);
+        break;
+    case POST_BIAS:
+        zenConvolution2DwithBias(in, images, channels, height, width, filter,
+                                 no_of_filter, 1, 1, pad, pad, pad, pad, stride_h, stride_w,
+                                 bias, out, out_height, out_width);
+        break;
+    case POST_BIAS_RELU:
+        zenConvolution2DwithBiasRelu(in, images, channels, height, width,
+                                     filter, no_of_filter, 1, 1, pad, pad, pad, pad, stride_h,
+                                     stride_w, bias, out, out_height, out_width);
+        break;
+    }
+}
+
+static int test_conv_1x1_strided(const conv_1x1_params &p,
+                                 conv_1x1_post_op op) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing 1x1 strided conv images=",
+                  p.images, " channels=", p.channels, " height=", p.height,
+                  " width=", p.width, " no_of_filter=", p.no_of_filter,
+                  " stride_h=", p.stride_h, " stride_w=", p.stride_w,
+                  " pad=", p.pad, " post_op=", op);
+
+    int out_height = (p.height + 2*p.pad - 1)/p.stride_h + 1;
+    int out_width = (p.width + 2*p.pad - 1)/p.stride_w + 1;
+    vector<float> in((size_t)p.images*p.height*p.width*p.channels);
+    vector<float> filter((size_t)p.channels*p.no_of_filter);
+    vector<float> bias(p.no_of_filter);
+    for (auto &v : in) {
+        v = (rand()%9 - 4)/4.0f;
+    }
+    for (auto &v : filter) {
+        v = (rand()%9 - 4)/8.0f;
+    }
+    for (auto &v : bias) {
+        v = (rand()%9 - 4)/2.0f;
+    }
+
+    //Patch matrix of 1x1 filter is the strided/padded input, laid out as
+    //NHWC input of out_height x out_width
+    size_t in_pixels = (size_t)p.height*p.width*p.channels;
+    size_t out_pixels = (size_t)out_height*out_width;
+    vector<float> patch((size_t)p.images*out_pixels*p.channels);
+    for (int n = 0; n < p.images; n++) {
+        im2rowNHWC(in.data() + n*in_pixels, p.channels, p.height, p.width, 1, 1,
+                   p.pad, p.pad, p.pad, p.pad, p.stride_h, p.stride_w,
+                   patch.data() + n*out_pixels*p.channels);
+    }
+
+    size_t out_size = (size_t)p.images*out_pixels*p.no_of_filter;
+    vector<float> out(out_size), ref(out_size);
+    run_conv(op, in.data(), p.images, p.channels, p.height, p.width,
+             filter.data(), p.no_of_filter, p.pad, p.stride_h, p.stride_w,
+             bias.data(), out.data(), out_height, out_width);
+    run_conv(op, patch.data(), p.images, p.channels, out_height, out_width,
+             filter.data(), p.no_of_filter, 0, 1, 1, bias.data(), ref.data(),
+             out_height, out_width);
+
+    for (size_t i = 0; i < out_size; i++) {
+        if (fabs(out[i] - ref[i]) > 1e-4f*(1.0f + fabs(ref[i]))) {
+            zendnnInfo(ZENDNN_TESTLOG, "1x1 strided conv mismatch at ", i,
+                       " out: ", out[i], " ref: ", ref[i]);
+            return API_FAILURE;
+        }
+    }
+    return API_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_1x1_strided_test starts");
+    srand(1111);
+
+    const conv_1x1_params params[] = {
+        //images channels height width filters stride_h stride_w pad
+        {1, 32, 14, 20,  64, 2, 2, 0},
+        {1, 16, 13, 17,  20, 2, 2, 1},
+        {2, 24, 15,  9,  40, 2, 2, 0},
+        {3, 16, 11, 13,  24, 2, 1, 0},
+        {2, 64, 28, 14, 128, 2, 2, 0},
+        {2,  8,  9, 12,  16, 1, 2, 1},
+    };
+
+    int status = API_SUCCESS;
+    for (const auto &p : params) {
+        for (int op = POST_NONE; op <= POST_BIAS_RELU; op++) {
+            status |= test_conv_1x1_strided(p, (conv_1x1_post_op)op);
+        }
+    }
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_1x1_strided_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_1x1_strided_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_1x1_strided_test ends");
+    return status;
+}
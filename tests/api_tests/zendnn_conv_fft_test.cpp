@@ -0,0 +1,163 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks FFT convolution primitive(algorithm::convolution_fft) against
+ * reference convolution primitive(algorithm::convolution_ref).
+ * Covers kernels 3, 5, 7 and 11, padding, batch > 1, non square kernel,
+ * bias and ReLU post-op. Cached filter transform is checked by executing
+ * one primitive with two weights buffers and with weights updated in place.
+ * I/p and o/p format is NHWC and filter format is HWIO.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+using tag = memory::format_tag;
+using dt = memory::data_type;
+
+static void rand_fill(vector<float> &v) {
+    for (auto &x : v) {
+        x = (rand()%17 - 8)/8.0f;
+    }
+}
+
+static convolution_forward::primitive_desc conv_pd(engine &eng,
+        algorithm alg, memory::dims src_dims, memory::dims wei_dims,
+        memory::dims dst_dims, int pad_h, int pad_w, bool relu) {
+    memory::desc src_md(src_dims, dt::f32, tag::nhwc);
+    memory::desc wei_md(wei_dims, dt::f32, tag::hwio);
+    memory::desc bias_md({wei_dims[0]}, dt::f32, tag::x);
+    memory::desc dst_md(dst_dims, dt::f32, tag::nhwc);
+
+    post_ops ops;
+    if (relu) {
+        ops.append_eltwise(1.0f, algorithm::eltwise_relu, 0.0f, 0.0f);
+    }
+    primitive_attr attr;
+    attr.set_post_ops(ops);
+
+    auto conv_d = convolution_forward::desc(prop_kind::forward_inference, alg,
+                                            src_md, wei_md, bias_md, dst_md,
+                                            {1, 1}, {pad_h, pad_w},
+                                            {pad_h, pad_w});
+    return convolution_forward::primitive_desc(conv_d, attr, eng);
+}
+
+static void run_conv(engine &eng, stream &s, convolution_forward &conv,
+                     const convolution_forward::primitive_desc &pd,
+                     vector<float> &src, vector<float> &wei,
+                     vector<float> &bias, vector<float> &dst) {
+    memory src_mem(pd.src_desc(), eng, src.data());
+    memory wei_mem(pd.weights_desc(), eng, wei.data());
+    memory bias_mem(pd.bias_desc(), eng, bias.data());
+    memory dst_mem(pd.dst_desc(), eng, dst.data());
+    conv.execute(s, {
+        {ZENDNN_ARG_SRC, src_mem}, {ZENDNN_ARG_WEIGHTS, wei_mem},
+        {ZENDNN_ARG_BIAS, bias_mem}, {ZENDNN_ARG_DST, dst_mem}
+    });
+    s.wait();
+}
+
+static int compare(const vector<float> &out, const vector<float> &ref,
+                   const char *name) {
+    //FFT rounding error grows with kernel size and channels
+    for (size_t i = 0; i < out.size(); i++) {
+        if (fabs(out[i] - ref[i]) > 1e-3f*(1.0f + fabs(ref[i]))) {
+            zendnnInfo(ZENDNN_TESTLOG, name, " mismatch at ", i, " fft: ",
+                       out[i], " ref: ", ref[i]);
+            return API_FAILURE;
+        }
+    }
+    return API_SUCCESS;
+}
+
+static int test_conv_fft(engine &eng, stream &s, int images, int channels,
+                         int height, int width, int no_of_filter,
+                         int kernel_h, int kernel_w, int pad_h, int pad_w,
+                         bool relu) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing fft conv images=", images,
+                  " channels=", channels, " height=", height, " width=", width,
+                  " no_of_filter=", no_of_filter, " kernel=", kernel_h, "x",
+                  kernel_w, " pad=", pad_h, ",", pad_w, " relu=", relu);
+
+    int out_height = height + 2*pad_h - kernel_h + 1;
+    int out_width = width + 2*pad_w - kernel_w + 1;
+    memory::dims src_dims = {images, channels, height, width};
+    memory::dims wei_dims = {no_of_filter, channels, kernel_h, kernel_w};
+    memory::dims dst_dims = {images, no_of_filter, out_height, out_width};
+
+    vector<float> src((size_t)images*height*width*channels);
+    vector<float> wei1((size_t)kernel_h*kernel_w*channels*no_of_filter);
+    vector<float> wei2(wei1.size());
+    vector<float> bias(no_of_filter);
+    rand_fill(src);
+    rand_fill(wei1);
+    rand_fill(wei2);
+    rand_fill(bias);
+    size_t out_size = (size_t)images*out_height*out_width*no_of_filter;
+    vector<float> out(out_size), ref(out_size);
+
+    auto fft_pd = conv_pd(eng, algorithm::convolution_fft, src_dims, wei_dims,
+                          dst_dims, pad_h, pad_w, relu);
+    auto ref_pd = conv_pd(eng, algorithm::convolution_ref, src_dims, wei_dims,
+                          dst_dims, pad_h, pad_w, relu);
+    convolution_forward fft_conv(fft_pd);
+    convolution_forward ref_conv(ref_pd);
+
+    int status = API_SUCCESS;
+    //first weights, second weights buffer and first buffer updated in place,
+    //same primitive(cached filter transform) for all
+    vector<float> *weights[] = {&wei1, &wei2, &wei1};
+    for (int step = 0; step < 3; step++) {
+        if (step == 2) {
+            for (auto &x : wei1) {
+                x = -x*0.5f;
+            }
+            zenWeightsUpdated();
+        }
+        run_conv(eng, s, fft_conv, fft_pd, src, *weights[step], bias, out);
+        run_conv(eng, s, ref_conv, ref_pd, src, *weights[step], bias, ref);
+        status |= compare(out, ref, step == 0 ? "fft conv" :
+                          (step == 1 ? "fft conv second weights" :
+                           "fft conv weights updated in place"));
+    }
+    return status;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_fft_test starts");
+    srand(1111);
+    engine eng(engine::kind::cpu, 0);
+    stream s(eng);
+
+    int status = API_SUCCESS;
+    status |= test_conv_fft(eng, s, 2, 16, 20, 20, 24, 3, 3, 1, 1, true);
+    status |= test_conv_fft(eng, s, 1, 8, 27, 31, 16, 5, 5, 2, 2, false);
+    status |= test_conv_fft(eng, s, 3, 12, 23, 19, 20, 7, 7, 3, 3, true);
+    status |= test_conv_fft(eng, s, 2, 4, 40, 33, 8, 11, 11, 5, 5, false);
+    //valid(no padding) convolution and 1xK kernel
+    status |= test_conv_fft(eng, s, 2, 6, 30, 30, 10, 11, 11, 0, 0, true);
+    status |= test_conv_fft(eng, s, 2, 8, 1, 64, 12, 1, 7, 0, 3, true);
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_fft_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_fft_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_fft_test ends");
+    return status;
+}
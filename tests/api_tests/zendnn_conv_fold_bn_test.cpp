@@ -0,0 +1,188 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks convolution primitive with fused BatchNorm(+ReLU) when BatchNorm is
+ * folded into weights and bias(ZENDNN_CONV_FOLD_BN=1) against the unfolded
+ * primitive(ZENDNN_CONV_FOLD_BN=0) and a reference loop
+ *   out = scale*(conv + bias - mean) + offset, then relu
+ * Covers convolution with and without bias. Folded parameters are cached by
+ * the primitive, weights and BatchNorm parameters are updated in place
+ * between executions(followed by zenWeightsUpdated) to check that the
+ * cache is refreshed.
+ * I/p and o/p format is NHWC and filter format is HWIO.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+using tag = memory::format_tag;
+using dt = memory::data_type;
+
+static void rand_fill(vector<float> &v, float low, float high) {
+    for (auto &x : v) {
+        x = low + (high - low)*(rand()/(float)RAND_MAX);
+    }
+}
+
+static int compare(const vector<float> &out, const vector<float> &ref,
+                   const char *name) {
+    for (size_t i = 0; i < out.size(); i++) {
+        if (fabs(out[i] - ref[i]) > 1e-4f*(1.0f + fabs(ref[i]))) {
+            zendnnInfo(ZENDNN_TESTLOG, name, " mismatch at ", i, " out: ",
+                       out[i], " ref: ", ref[i]);
+            return API_FAILURE;
+        }
+    }
+    return API_SUCCESS;
+}
+
+static int test_conv_fold_bn(engine &eng, stream &s, int images, int channels,
+                             int height, int width, int no_of_filter,
+                             int kernel, int stride, int pad, bool with_bias,
+                             bool relu) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing conv fold bn images=", images,
+                  " channels=", channels, " height=", height, " width=", width,
+                  " no_of_filter=", no_of_filter, " kernel=", kernel,
+                  " stride=", stride, " pad=", pad, " bias=", with_bias,
+                  " relu=", relu);
+
+    int out_height = (height + 2*pad - kernel)/stride + 1;
+    int out_width = (width + 2*pad - kernel)/stride + 1;
+    int F = no_of_filter;
+    memory::dims src_dims = {images, channels, height, width};
+    memory::dims wei_dims = {F, channels, kernel, kernel};
+    memory::dims dst_dims = {images, F, out_height, out_width};
+
+    vector<float> src((size_t)images*height*width*channels);
+    vector<float> wei((size_t)kernel*kernel*channels*F);
+    vector<float> bias(F), scale(F), mean(F), offset(F);
+    rand_fill(src, -1.0f, 1.0f);
+    rand_fill(wei, -0.5f, 0.5f);
+    rand_fill(bias, -1.0f, 1.0f);
+    rand_fill(scale, 0.5f, 2.0f);
+    rand_fill(mean, -0.5f, 0.5f);
+    rand_fill(offset, -1.0f, 1.0f);
+    size_t out_size = (size_t)images*out_height*out_width*F;
+
+    memory::desc src_md(src_dims, dt::f32, tag::nhwc);
+    memory::desc wei_md(wei_dims, dt::f32, tag::hwio);
+    memory::desc vec_md({F}, dt::f32, tag::x);
+    memory::desc dst_md(dst_dims, dt::f32, tag::nhwc);
+    auto conv_d = convolution_forward::desc(prop_kind::forward_inference,
+                                            algorithm::convolution_gemm, src_md,
+                                            wei_md, with_bias ? vec_md : memory::desc(),
+                                            dst_md, {stride, stride}, {pad, pad},
+                                            {pad, pad}, relu, true, vec_md,
+                                            vec_md, vec_md);
+    auto conv_pd = convolution_forward::primitive_desc(conv_d, eng);
+    convolution_forward conv(conv_pd);
+
+    memory src_mem(src_md, eng, src.data());
+    memory wei_mem(wei_md, eng, wei.data());
+    memory bias_mem(vec_md, eng, bias.data());
+    memory scale_mem(vec_md, eng, scale.data());
+    memory mean_mem(vec_md, eng, mean.data());
+    memory offset_mem(vec_md, eng, offset.data());
+
+    int status = API_SUCCESS;
+    //second step updates weights and BatchNorm parameters in place
+    for (int step = 0; step < 2; step++) {
+        if (step == 1) {
+            for (auto &x : wei) {
+                x = -x;
+            }
+            for (int k = 0; k < F; k++) {
+                scale[k] *= 0.5f;
+                mean[k] += 0.25f;
+                bias[k] -= 0.5f;
+            }
+            zenWeightsUpdated();
+        }
+
+        vector<float> ref(out_size);
+        for (int n = 0; n < images; n++)
+            for (int oh = 0; oh < out_height; oh++)
+                for (int ow = 0; ow < out_width; ow++)
+                    for (int k = 0; k < F; k++) {
+                        float acc = with_bias ? bias[k] : 0.0f;
+                        for (int i = 0; i < kernel; i++)
+                            for (int j = 0; j < kernel; j++) {
+                                int ih = oh*stride - pad + i;
+                                int iw = ow*stride - pad + j;
+                                if (ih < 0 || ih >= height || iw < 0 || iw >= width) {
+                                    continue;
+                                }
+                                for (int c = 0; c < channels; c++)
+                                    acc += src[(((size_t)n*height + ih)*width + iw)*channels + c]
+                                           *wei[((size_t)(i*kernel + j)*channels + c)*F + k];
+                            }
+                        float v = scale[k]*(acc - mean[k]) + offset[k];
+                        ref[(((size_t)n*out_height + oh)*out_width + ow)*F + k] =
+                            (relu && v < 0.0f) ? 0.0f : v;
+                    }
+
+        vector<float> out[2];
+        for (int fold = 0; fold < 2; fold++) {
+            //knob is read on every execution
+            setenv("ZENDNN_CONV_FOLD_BN", fold ? "1" : "0", 1);
+            out[fold].assign(out_size, 77.0f);
+            memory dst_mem(dst_md, eng, out[fold].data());
+            std::unordered_map<int, memory> args = {
+                {ZENDNN_ARG_SRC, src_mem}, {ZENDNN_ARG_WEIGHTS, wei_mem},
+                {ZENDNN_ARG_DST, dst_mem}, {ZENDNN_ARG_BN_SCALE, scale_mem},
+                {ZENDNN_ARG_BN_MEAN, mean_mem}, {ZENDNN_ARG_BN_OFFSET, offset_mem}
+            };
+            if (with_bias) {
+                args.insert({ZENDNN_ARG_BIAS, bias_mem});
+            }
+            conv.execute(s, args);
+            s.wait();
+        }
+        status |= compare(out[0], ref, "unfolded bn conv");
+        status |= compare(out[1], ref, "folded bn conv");
+        status |= compare(out[1], out[0], "folded vs unfolded bn conv");
+    }
+    unsetenv("ZENDNN_CONV_FOLD_BN");
+    return status;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_fold_bn_test starts");
+    srand(1111);
+    engine eng(engine::kind::cpu, 0);
+    stream s(eng);
+
+    int status = API_SUCCESS;
+    for (int with_bias = 0; with_bias < 2; with_bias++) {
+        for (int relu = 0; relu < 2; relu++) {
+            status |= test_conv_fold_bn(eng, s, 2, 16, 14, 14, 32, 3, 1, 1,
+                                        with_bias, relu);
+            status |= test_conv_fold_bn(eng, s, 1, 24, 15, 13, 40, 3, 2, 1,
+                                        with_bias, relu);
+            status |= test_conv_fold_bn(eng, s, 2, 32, 7, 7, 64, 1, 1, 0,
+                                        with_bias, relu);
+        }
+    }
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_fold_bn_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_fold_bn_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_fold_bn_test ends");
+    return status;
+}
@@ -0,0 +1,263 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks INT8 convolution(zenConvolution2DInt8) against a reference
+ * u8 x s8 -> s32 convolution requantized to u8/s8 dst.
+ * Covers src zero-point with padding, per tensor and per channel scales,
+ * bias, BatchNorm, sum and ReLU post-ops, saturation of dst and filter
+ * packed once with zenConvolution2DInt8FilterPack. INT8 convolution
+ * primitive(ZENDNN_INT8_SUPPORT=1) is checked with its cached packed filter
+ * when weights are updated in place(followed by zenWeightsUpdated).
+ * I/p and o/p format is NHWC and filter format is HWCN.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+using tag = memory::format_tag;
+using dt = memory::data_type;
+
+struct int8_conv_params {
+    int   images, channels, height, width, no_of_filter;
+    int   kernel, stride, pad, src_zero_point;
+    float scale;            //output scale, large values saturate dst
+    bool  per_channel, bias, batch_norm, sum, relu, out_signed, prepacked;
+};
+
+static int test_conv_int8(const int8_conv_params &p) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing int8 conv images=", p.images,
+                  " channels=", p.channels, " height=", p.height,
+                  " width=", p.width, " no_of_filter=", p.no_of_filter,
+                  " kernel=", p.kernel, " stride=", p.stride, " pad=", p.pad,
+                  " src_zero_point=", p.src_zero_point, " scale=", p.scale,
+                  " out_signed=", p.out_signed, " prepacked=", p.prepacked);
+
+    int out_height = (p.height + 2*p.pad - p.kernel)/p.stride + 1;
+    int out_width = (p.width + 2*p.pad - p.kernel)/p.stride + 1;
+    int F = p.no_of_filter;
+
+    vector<uint8_t> in((size_t)p.images*p.height*p.width*p.channels);
+    vector<int8_t> filter((size_t)p.kernel*p.kernel*p.channels*F);
+    for (auto &v : in) {
+        v = rand()%256;
+    }
+    for (auto &v : filter) {
+        v = rand()%256 - 128;
+    }
+    vector<float> bias(F), scale(F), bn_scale(F), bn_mean(F), bn_offset(F);
+    for (int o = 0; o < F; o++) {
+        bias[o] = rand()%2000 - 1000;
+        scale[o] = p.scale*(rand()%100 + 1)/100.0f;
+        bn_scale[o] = 0.5f + rand()%100/100.0f;
+        bn_mean[o] = rand()%10 - 5;
+        bn_offset[o] = rand()%20 - 10;
+    }
+
+    size_t out_size = (size_t)p.images*out_height*out_width*F;
+    vector<uint8_t> out(out_size), ref(out_size);
+    for (size_t i = 0; i < out_size; i++) {
+        out[i] = ref[i] = rand()%256;
+    }
+
+    float sum_scale = p.sum ? 0.7f : 0.0f;
+    float lower = p.out_signed ? -128.0f : 0.0f;
+    float upper = p.out_signed ? 127.0f : 255.0f;
+    for (int n = 0; n < p.images; n++)
+        for (int oh = 0; oh < out_height; oh++)
+            for (int ow = 0; ow < out_width; ow++)
+                for (int o = 0; o < F; o++) {
+                    long acc = 0;
+                    for (int i = 0; i < p.kernel; i++)
+                        for (int j = 0; j < p.kernel; j++) {
+                            int ih = oh*p.stride - p.pad + i;
+                            int iw = ow*p.stride - p.pad + j;
+                            bool pad = ih < 0 || ih >= p.height || iw < 0
+                                       || iw >= p.width;
+                            for (int c = 0; c < p.channels; c++) {
+                                int a = pad ? p.src_zero_point :
+                                        in[(((size_t)n*p.height + ih)*p.width + iw)
+                                           *p.channels + c];
+                                acc += (long)(a - p.src_zero_point)*
+                                       filter[((size_t)(i*p.kernel + j)*p.channels + c)*F + o];
+                            }
+                        }
+                    float v = (p.per_channel ? scale[o] : scale[0])*
+                              (acc + (p.bias ? bias[o] : 0.0f));
+                    if (p.batch_norm) {
+                        v = bn_scale[o]*(v - bn_mean[o]) + bn_offset[o];
+                    }
+                    size_t idx = (((size_t)n*out_height + oh)*out_width + ow)*F + o;
+                    if (p.sum) {
+                        v += sum_scale*(p.out_signed ? (float)(int8_t)ref[idx] :
+                                        (float)ref[idx]);
+                    }
+                    if (p.relu && v < 0.0f) {
+                        v = 0.0f;
+                    }
+                    v = nearbyintf(fmin(fmax(v, lower), upper));
+                    ref[idx] = p.out_signed ? (uint8_t)(int8_t)v : (uint8_t)v;
+                }
+
+    vector<char> packed;
+    if (p.prepacked) {
+        packed.resize(zenConvolution2DInt8FilterSize(p.channels, F, p.kernel,
+                      p.kernel));
+        zenConvolution2DInt8FilterPack(filter.data(), p.channels, F, p.kernel,
+                                       p.kernel, packed.data());
+    }
+    zenConvolution2DInt8(in.data(), p.images, p.channels, p.height, p.width,
+                         p.prepacked ? NULL : filter.data(), F, p.kernel,
+                         p.kernel, p.pad, p.pad, p.pad, p.pad, p.stride,
+                         p.stride, p.bias ? bias.data() : NULL, scale.data(),
+                         p.per_channel ? F : 1, p.src_zero_point,
+                         p.batch_norm ? bn_scale.data() : NULL, bn_mean.data(),
+                         bn_offset.data(), p.relu, sum_scale, out.data(),
+                         p.out_signed, out_height, out_width, false, 0, 0,
+                         p.prepacked ? packed.data() : NULL);
+
+    //requantization may round differently by one when float result lies at
+    //half way point
+    int saturated = 0;
+    for (size_t i = 0; i < out_size; i++) {
+        int o = p.out_signed ? (int8_t)out[i] : out[i];
+        int r = p.out_signed ? (int8_t)ref[i] : ref[i];
+        if (abs(o - r) > 1) {
+            zendnnInfo(ZENDNN_TESTLOG, "int8 conv mismatch at ", i, " out: ",
+                       o, " ref: ", r);
+            return API_FAILURE;
+        }
+        saturated += r == (int)lower || r == (int)upper;
+    }
+    zendnnVerbose(ZENDNN_TESTLOG, "int8 conv saturated outputs: ", saturated,
+                  " of ", out_size);
+    return API_SUCCESS;
+}
+
+//u8 src, s8 weights and u8 dst convolution primitive, same primitive is
+//executed before and after weights are updated in place
+static int test_conv_int8_primitive(engine &eng, stream &s) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing int8 conv primitive weights update");
+    const int N = 1, C = 16, H = 9, W = 9, F = 24, K = 3, pad = 1;
+    const float scale = 1e-3f;
+
+    vector<uint8_t> in((size_t)N*H*W*C);
+    vector<int8_t> filter((size_t)K*K*C*F);
+    for (auto &v : in) {
+        v = rand()%256;
+    }
+    for (auto &v : filter) {
+        v = rand()%201 - 100;
+    }
+    size_t out_size = (size_t)N*H*W*F;
+    vector<uint8_t> out(out_size);
+
+    memory::desc src_md({N, C, H, W}, dt::u8, tag::nhwc);
+    memory::desc wei_md({F, C, K, K}, dt::s8, tag::hwio);
+    memory::desc dst_md({N, F, H, W}, dt::u8, tag::nhwc);
+    primitive_attr attr;
+    attr.set_output_scales(0, {scale});
+    auto conv_d = convolution_forward::desc(prop_kind::forward_inference,
+                                            algorithm::convolution_gemm, src_md, wei_md, dst_md,
+                                            {1, 1}, {pad, pad}, {pad, pad});
+    auto conv_pd = convolution_forward::primitive_desc(conv_d, attr, eng);
+    if (strncmp(conv_pd.impl_info_str(), "zendnn_int8", 11) != 0) {
+        zendnnInfo(ZENDNN_TESTLOG, "int8 conv primitive unexpected impl: ",
+                   conv_pd.impl_info_str());
+        return API_FAILURE;
+    }
+    convolution_forward conv(conv_pd);
+    memory src_mem(conv_pd.src_desc(), eng, in.data());
+    memory wei_mem(conv_pd.weights_desc(), eng, filter.data());
+    memory dst_mem(conv_pd.dst_desc(), eng, out.data());
+
+    for (int step = 0; step < 2; step++) {
+        if (step == 1) {
+            for (auto &v : filter) {
+                v = -v;
+            }
+            zenWeightsUpdated();
+        }
+        conv.execute(s, {
+            {ZENDNN_ARG_SRC, src_mem}, {ZENDNN_ARG_WEIGHTS, wei_mem},
+            {ZENDNN_ARG_DST, dst_mem}
+        });
+        s.wait();
+
+        for (int h = 0; h < H; h++)
+            for (int w = 0; w < W; w++)
+                for (int o = 0; o < F; o++) {
+                    long acc = 0;
+                    for (int i = 0; i < K; i++)
+                        for (int j = 0; j < K; j++) {
+                            int ih = h - pad + i;
+                            int iw = w - pad + j;
+                            if (ih < 0 || ih >= H || iw < 0 || iw >= W) {
+                                continue;
+                            }
+                            for (int c = 0; c < C; c++)
+                                acc += (long)in[((size_t)ih*W + iw)*C + c]*
+                                       filter[((size_t)(i*K + j)*C + c)*F + o];
+                        }
+                    float v = nearbyintf(fmin(fmax(scale*acc, 0.0f), 255.0f));
+                    size_t idx = ((size_t)h*W + w)*F + o;
+                    if (abs((int)out[idx] - (int)v) > 1) {
+                        zendnnInfo(ZENDNN_TESTLOG, "int8 conv primitive step ",
+                                   step, " mismatch at ", idx, " out: ",
+                                   (int)out[idx], " ref: ", v);
+                        return API_FAILURE;
+                    }
+                }
+    }
+    return API_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_int8_test starts");
+    srand(1111);
+
+    const int8_conv_params params[] = {
+        //images channels height width filters kernel stride pad zero_point
+        //scale per_channel bias bn sum relu signed prepacked
+        {1,  3, 17, 17, 16, 3, 1, 1,   0, 1e-3f, true,  true,  false, false, true,  false, false},
+        {2, 32, 14, 14, 70, 3, 2, 1, 128, 1e-5f, false, true,  false, true,  false, true,  false},
+        {1, 64,  7,  7, 64, 1, 1, 0,   5, 1e-5f, true,  true,  true,  true,  true,  false, true},
+        {3,  5,  9, 11,  9, 5, 2, 2,  17, 1e-4f, true,  false, true,  false, false, true,  true},
+        //large scales, most of dst saturates at both ends
+        {1, 16, 10, 10, 24, 3, 1, 1,  64, 1e-1f, true,  true,  false, false, false, true,  false},
+        {1, 16, 10, 10, 24, 3, 1, 1,  64, 1e-1f, false, true,  false, true,  false, false, true},
+    };
+
+    int status = API_SUCCESS;
+    for (const auto &p : params) {
+        status |= test_conv_int8(p);
+    }
+
+    setenv("ZENDNN_INT8_SUPPORT", "1", 1);
+    engine eng(engine::kind::cpu, 0);
+    stream s(eng);
+    status |= test_conv_int8_primitive(eng, s);
+    unsetenv("ZENDNN_INT8_SUPPORT");
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_int8_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_int8_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_int8_test ends");
+    return status;
+}
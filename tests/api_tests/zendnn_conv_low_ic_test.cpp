@@ -0,0 +1,189 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks direct convolution of low input channel layers(channels <=
+ * CONV_DIRECT_LOW_IC, zenConvolution2DDirectLowIC) against reference
+ * convolution.
+ * Covers padding, stride 2, odd widths, filters not multiple of filter block,
+ * bias, sum, ReLU and BatchNorm post-ops and filter packed once with
+ * zenConvolution2DDirectLowICFilterPack.
+ * I/p and o/p format is NHWC and filter format is HWCN.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+#include "zendnn_private.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+
+//post-ops of low input channel convolution
+enum low_ic_post_op {
+    POST_BIAS, POST_BIAS_RELU, POST_BIAS_SUM, POST_BIAS_SUM_RELU, POST_BN_RELU,
+    POST_PREPACKED
+};
+
+struct low_ic_conv_params {
+    int images, channels, height, width, no_of_filter, kernel;
+    int pad_t, pad_l, pad_b, pad_r, stride;
+};
+
+static void rand_fill(vector<float> &v) {
+    for (auto &x : v) {
+        x = (rand()%11 - 5)/4.0f;
+    }
+}
+
+static int test_conv_low_ic(const low_ic_conv_params &p, low_ic_post_op post) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing low ic conv images=", p.images,
+                  " channels=", p.channels, " height=", p.height, " width=",
+                  p.width, " no_of_filter=", p.no_of_filter, " kernel=",
+                  p.kernel, " pad=", p.pad_t, ",", p.pad_l, ",", p.pad_b, ",",
+                  p.pad_r, " stride=", p.stride, " post=", (int)post);
+
+    int out_height = (p.height + p.pad_t + p.pad_b - p.kernel)/p.stride + 1;
+    int out_width = (p.width + p.pad_l + p.pad_r - p.kernel)/p.stride + 1;
+    int F = p.no_of_filter;
+    size_t out_size = (size_t)p.images*out_height*out_width*F;
+
+    vector<float> in((size_t)p.images*p.height*p.width*p.channels);
+    vector<float> filter((size_t)p.kernel*p.kernel*p.channels*F);
+    vector<float> bias(F), scale(F), mean(F), offset(F), residual(out_size);
+    rand_fill(in);
+    rand_fill(filter);
+    rand_fill(bias);
+    rand_fill(scale);
+    rand_fill(mean);
+    rand_fill(offset);
+    rand_fill(residual);
+
+    vector<float> ref(out_size);
+    zenConvolution2DRef(in.data(), p.images, p.channels, p.height, p.width,
+                        filter.data(), F, p.kernel, p.kernel, p.pad_t, p.pad_l,
+                        p.pad_b, p.pad_r, p.stride, p.stride, ref.data(),
+                        out_height, out_width);
+    bool sum = post == POST_BIAS_SUM || post == POST_BIAS_SUM_RELU;
+    bool relu = post == POST_BIAS_RELU || post == POST_BIAS_SUM_RELU ||
+                post == POST_BN_RELU;
+    for (size_t i = 0; i < out_size; i++) {
+        int k = i%F;
+        float v = post == POST_BN_RELU ? (ref[i] - mean[k])*scale[k] + offset[k] :
+                  ref[i] + bias[k];
+        v += sum ? residual[i] : 0.0f;
+        ref[i] = (relu && v < 0.0f) ? 0.0f : v;
+    }
+
+    vector<float> out = sum ? residual : vector<float>(out_size, 77.0f);
+    switch (post) {
+    case POST_BIAS:
+        zenConvolution2DwithBias(in.data(), p.images, p.channels, p.height,
+                                 p.width, filter.data(), F, p.kernel, p.kernel,
+                                 p.pad_t, p.pad_l, p.pad_b, p.pad_r, p.stride,
+                                 p.stride, bias.data(), out.data(), out_height,
+                                 out_width);
+        break;
+    case POST_BIAS_RELU:
+        zenConvolution2DwithBiasRelu(in.data(), p.images, p.channels, p.height,
+                                     p.width, filter.data(), F, p.kernel,
+                                     p.kernel, p.pad_t, p.pad_l, p.pad_b,
+                                     p.pad_r, p.stride, p.stride, bias.data(),
+                                     out.data(), out_height, out_width);
+        break;
+    case POST_BIAS_SUM:
+        zenConvolution2DwithBiasSum(in.data(), p.images, p.channels, p.height,
+                                    p.width, filter.data(), F, p.kernel,
+                                    p.kernel, p.pad_t, p.pad_l, p.pad_b,
+                                    p.pad_r, p.stride, p.stride, bias.data(),
+                                    out.data(), out_height, out_width);
+        break;
+    case POST_BIAS_SUM_RELU:
+        zenConvolution2DwithBiasSumRelu(in.data(), p.images, p.channels,
+                                        p.height, p.width, filter.data(), F,
+                                        p.kernel, p.kernel, p.pad_t, p.pad_l,
+                                        p.pad_b, p.pad_r, p.stride, p.stride,
+                                        bias.data(), out.data(), out_height,
+                                        out_width);
+        break;
+    case POST_BN_RELU:
+        zenConvolution2DwithBatchNormRelu(in.data(), p.images, p.channels,
+                                          p.height, p.width, filter.data(), F,
+                                          p.kernel, p.kernel, p.pad_t, p.pad_l,
+                                          p.pad_b, p.pad_r, p.stride, p.stride,
+                                          scale.data(), mean.data(),
+                                          offset.data(), out.data(), out_height,
+                                          out_width);
+        break;
+    case POST_PREPACKED: {
+        //packed buffer is offset by one float, it needs no alignment
+        vector<float> packed(zenConvolution2DDirectLowICFilterSize(p.channels, F,
+                             p.kernel, p.kernel) + 1);
+        zenConvolution2DDirectLowICFilterPack(filter.data(), p.channels, F,
+                                              p.kernel, p.kernel,
+                                              packed.data() + 1);
+        zenConvolution2DDirectLowIC(readEnv(), in.data(), p.images, p.channels,
+                                    p.height, p.width, NULL, F, p.kernel,
+                                    p.kernel, p.pad_t, p.pad_l, p.pad_b,
+                                    p.pad_r, p.stride, p.stride, bias.data(),
+                                    out.data(), out_height, out_width, false,
+                                    false, NULL, NULL, false, 0, 0,
+                                    packed.data() + 1);
+        break;
+    }
+    }
+
+    for (size_t i = 0; i < out_size; i++) {
+        if (fabs(out[i] - ref[i]) > 1e-4f*(1.0f + fabs(ref[i]))) {
+            zendnnInfo(ZENDNN_TESTLOG, "low ic conv mismatch at ", i, " out: ",
+                       out[i], " ref: ", ref[i]);
+            return API_FAILURE;
+        }
+    }
+    return API_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_low_ic_test starts");
+    srand(1111);
+
+    const low_ic_conv_params params[] = {
+        //images channels height width filters kernel pad_t pad_l pad_b pad_r
+        //stride
+        {1, 3, 30, 30, 64, 7, 3, 3, 3, 3, 2},
+        {2, 4, 13, 11, 21, 3, 1, 1, 1, 1, 1},
+        {3, 1, 17, 23, 16, 3, 0, 1, 1, 0, 2},
+        {1, 3, 15, 9, 35, 5, 2, 2, 2, 2, 2},
+        {2, 2, 8, 7, 8, 3, 1, 1, 1, 1, 1},
+        {1, 4, 19, 31, 48, 1, 0, 0, 0, 0, 2},
+    };
+    const low_ic_post_op posts[] = {
+        POST_BIAS, POST_BIAS_RELU, POST_BIAS_SUM, POST_BIAS_SUM_RELU,
+        POST_BN_RELU, POST_PREPACKED
+    };
+
+    int status = API_SUCCESS;
+    for (const auto &p : params) {
+        for (low_ic_post_op post : posts) {
+            status |= test_conv_low_ic(p, post);
+        }
+    }
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_low_ic_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_low_ic_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_low_ic_test ends");
+    return status;
+}
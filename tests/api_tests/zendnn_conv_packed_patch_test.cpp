@@ -0,0 +1,159 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks im2row + gemm convolution with patch matrix written in gemm packed
+ * layout(ZENDNN_CONV_PACKED_PATCH=1) against the same convolution on the
+ * existing gemm path(ZENDNN_CONV_PACKED_PATCH=0).
+ * Covers padding(also uneven), stride 2, non square input, channel counts
+ * that are not a multiple of 8, filter counts that are not a multiple of 16,
+ * patch rows and columns spanning several packed blocks, bias, ReLU, sum
+ * and concatenated output.
+ * I/p and o/p format is NHWC and filter format is HWCN.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+#include "zendnn_private.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+
+struct packed_conv_params {
+    int images, channels, height, width, no_of_filter, kernel_h, kernel_w;
+    int pad_t, pad_l, pad_b, pad_r, stride_h, stride_w;
+};
+
+enum packed_conv_post_op {
+    POST_BIAS,
+    POST_BIAS_RELU,
+    POST_BIAS_SUM_RELU,
+    POST_BIAS_CONCAT,
+};
+
+static void run_conv(const packed_conv_params &p, packed_conv_post_op op,
+                     bool packed, const vector<float> &in,
+                     const vector<float> &filter, const vector<float> &bias,
+                     int out_height, int out_width, vector<float> &out) {
+    setenv("ZENDNN_CONV_PACKED_PATCH", packed ? "1" : "0", 1);
+    switch (op) {
+    case POST_BIAS:
+        zenConvolution2DwithBias(in.data(), p.images, p.channels, p.height,
+                                 p.width, filter.data(), p.no_of_filter, p.kernel_h, p.kernel_w,
+                                 p.pad_t, p.pad_l, p.pad_b, p.pad_r, p.stride_h, p.stride_w,
+                                 bias.data(), out.data(), out_height, out_width);
+        break;
+    case POST_BIAS_RELU:
+        zenConvolution2DwithBiasRelu(in.data(), p.images, p.channels, p.height,
+                                     p.width, filter.data(), p.no_of_filter, p.kernel_h, p.kernel_w,
+                                     p.pad_t, p.pad_l, p.pad_b, p.pad_r, p.stride_h, p.stride_w,
+                                     bias.data(), out.data(), out_height, out_width);
+        break;
+    case POST_BIAS_SUM_RELU:
+        zenConvolution2DwithBiasSumRelu(in.data(), p.images, p.channels,
+                                        p.height, p.width, filter.data(), p.no_of_filter, p.kernel_h,
+                                        p.kernel_w, p.pad_t, p.pad_l, p.pad_b, p.pad_r, p.stride_h,
+                                        p.stride_w, bias.data(), out.data(), out_height, out_width);
+        break;
+    case POST_BIAS_CONCAT:
+        //filters are written at offset 5 of 2*no_of_filter + 5 wide rows
+        zenConvolution2DwithBias(in.data(), p.images, p.channels, p.height,
+                                 p.width, filter.data(), p.no_of_filter, p.kernel_h, p.kernel_w,
+                                 p.pad_t, p.pad_l, p.pad_b, p.pad_r, p.stride_h, p.stride_w,
+                                 bias.data(), out.data(), out_height, out_width, true, 5,
+                                 2*p.no_of_filter + 5);
+        break;
+    }
+}
+
+static int test_conv_packed_patch(const packed_conv_params &p,
+                                  packed_conv_post_op op) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing packed patch conv images=",
+                  p.images, " channels=", p.channels, " height=", p.height,
+                  " width=", p.width, " no_of_filter=", p.no_of_filter,
+                  " kernel_h=", p.kernel_h, " kernel_w=", p.kernel_w,
+                  " pad_t=", p.pad_t, " pad_l=", p.pad_l, " pad_b=", p.pad_b,
+                  " pad_r=", p.pad_r, " stride_h=", p.stride_h,
+                  " stride_w=", p.stride_w, " post_op=", op);
+
+    int out_height = (p.height + p.pad_t + p.pad_b - p.kernel_h)/p.stride_h + 1;
+    int out_width = (p.width + p.pad_l + p.pad_r - p.kernel_w)/p.stride_w + 1;
+    vector<float> in((size_t)p.images*p.height*p.width*p.channels);
+    vector<float> filter((size_t)p.kernel_h*p.kernel_w*p.channels*p.no_of_filter);
+    vector<float> bias(p.no_of_filter);
+    for (auto &v : in) {
+        v = (rand()%9 - 4)/4.0f;
+    }
+    for (auto &v : filter) {
+        v = (rand()%9 - 4)/8.0f;
+    }
+    for (auto &v : bias) {
+        v = (rand()%9 - 4)/2.0f;
+    }
+
+    int ldc = op == POST_BIAS_CONCAT ? 2*p.no_of_filter + 5 : p.no_of_filter;
+    size_t out_size = (size_t)p.images*out_height*out_width*ldc;
+    //sum accumulates to existing output, both paths start from same values
+    vector<float> out(out_size), ref(out_size);
+    for (size_t i = 0; i < out_size; i++) {
+        out[i] = ref[i] = (rand()%9 - 4)/2.0f;
+    }
+
+    run_conv(p, op, false, in, filter, bias, out_height, out_width, ref);
+    run_conv(p, op, true, in, filter, bias, out_height, out_width, out);
+
+    for (size_t i = 0; i < out_size; i++) {
+        if (fabs(out[i] - ref[i]) > 1e-4f*(1.0f + fabs(ref[i]))) {
+            zendnnInfo(ZENDNN_TESTLOG, "packed patch conv mismatch at ", i,
+                       " out: ", out[i], " ref: ", ref[i]);
+            return API_FAILURE;
+        }
+    }
+    return API_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_packed_patch_test starts");
+    srand(1111);
+    setenv("ZENDNN_CONV_PIPELINE", "0", 1);
+
+    //batch > 1 so convolution takes throughput path, odd sizes keep it off
+    //winograd
+    const packed_conv_params params[] = {
+        //images channels height width filters kernel_h kernel_w
+        //pad_t pad_l pad_b pad_r stride_h stride_w
+        {2, 16, 15, 23, 32, 3, 3, 1, 1, 1, 1, 2, 2},
+        {3, 13, 17, 11, 21, 3, 3, 1, 1, 1, 1, 1, 1},
+        {2, 64, 13, 13, 40, 3, 3, 1, 1, 1, 1, 1, 1},
+        {2, 37, 21, 9, 19, 5, 3, 2, 0, 1, 1, 2, 2},
+        {2, 8, 9, 27, 16, 7, 7, 3, 3, 3, 3, 2, 1},
+    };
+
+    int status = API_SUCCESS;
+    for (const auto &p : params) {
+        for (int op = POST_BIAS; op <= POST_BIAS_CONCAT; op++) {
+            status |= test_conv_packed_patch(p, (packed_conv_post_op)op);
+        }
+    }
+    unsetenv("ZENDNN_CONV_PACKED_PATCH");
+    unsetenv("ZENDNN_CONV_PIPELINE");
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_packed_patch_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_packed_patch_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_packed_patch_test ends");
+    return status;
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks pipelined im2row + gemm convolution(ZENDNN_CONV_PIPELINE=1)
+ * against reference convolution.
+ * Pipelined path pairs producer and consumer threads, it is run with the
+ * requested team and from inside a parallel region where it gets a team of
+ * one thread. Run also with OMP_THREAD_LIMIT below OMP_NUM_THREADS to cover
+ * a partial team, e.g.
+ *   OMP_THREAD_LIMIT=3 zendnn_conv_pipeline_test
+ * I/p and o/p format is NHWC and filter format is HWCN.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <omp.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+#include "zendnn_private.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+
+static int test_conv_pipeline(int images, int channels, int height,
+                              int width, int no_of_filter, int kernel,
+                              int pad, int stride, bool nested) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing pipelined conv images=", images,
+                  " channels=", channels, " height=", height, " width=", width,
+                  " no_of_filter=", no_of_filter, " kernel=", kernel,
+                  " pad=", pad, " stride=", stride, " nested=", nested);
+
+    int out_height = (height + 2*pad - kernel)/stride + 1;
+    int out_width = (width + 2*pad - kernel)/stride + 1;
+    vector<float> in((size_t)images*height*width*channels);
+    vector<float> filter((size_t)kernel*kernel*channels*no_of_filter);
+    vector<float> bias(no_of_filter);
+    for (auto &v : in) {
+        v = (rand()%9 - 4)/4.0f;
+    }
+    for (auto &v : filter) {
+        v = (rand()%9 - 4)/8.0f;
+    }
+    for (auto &v : bias) {
+        v = (rand()%9 - 4)/2.0f;
+    }
+
+    size_t out_size = (size_t)images*out_height*out_width*no_of_filter;
+    vector<float> ref(out_size);
+    zenConvolution2DRef(in.data(), images, channels, height, width,
+                        filter.data(), no_of_filter, kernel, kernel, pad, pad,
+                        pad, pad, stride, stride, ref.data(), out_height,
+                        out_width);
+    for (size_t i = 0; i < out_size; i++) {
+        ref[i] += bias[i%no_of_filter];
+    }
+
+    //Nested call, each thread of outer team runs its own convolution with
+    //inner team of one thread
+    int outer = nested ? 2 : 1;
+    vector<vector<float>> out(outer, vector<float>(out_size));
+    #pragma omp parallel for num_threads(outer)
+    for (int t = 0; t < outer; t++) {
+        zenConvolution2DwithBias(in.data(), images, channels, height, width,
+                                 filter.data(), no_of_filter, kernel, kernel,
+                                 pad, pad, pad, pad, stride, stride,
+                                 bias.data(), out[t].data(), out_height,
+                                 out_width);
+    }
+
+    for (int t = 0; t < outer; t++) {
+        for (size_t i = 0; i < out_size; i++) {
+            if (fabs(out[t][i] - ref[i]) > 1e-4f*(1.0f + fabs(ref[i]))) {
+                zendnnInfo(ZENDNN_TESTLOG, "pipelined conv mismatch at ", i,
+                           " out: ", out[t][i], " ref: ", ref[i]);
+                return API_FAILURE;
+            }
+        }
+    }
+    return API_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_pipeline_test starts");
+    srand(1111);
+    //knobs are read by every convolution call
+    setenv("ZENDNN_CONV_PIPELINE", "1", 1);
+    setenv("OMP_NUM_THREADS", "4", 0);
+
+    //batch > 1, single image goes to latency path
+    int status = API_SUCCESS;
+    for (int nested = 0; nested < 2; nested++) {
+        status |= test_conv_pipeline(2, 16, 27, 27, 32, 3, 1, 1, nested);
+        status |= test_conv_pipeline(3, 8, 15, 17, 24, 3, 1, 2, nested);
+        status |= test_conv_pipeline(2, 32, 14, 14, 64, 5, 2, 1, nested);
+    }
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_pipeline_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_pipeline_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_conv_pipeline_test ends");
+    return status;
+}
@@ -0,0 +1,198 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Microbenchmark for embedding bag scheduling with power law bag lengths.
+ * Bag lengths follow Zipf distribution, so a few bags hold most of the
+ * indices. Times embedding_bag primitive with bags kept whole
+ * (ZENDNN_EMB_SPLIT_MIN very large, work is still balanced by indices)
+ * against long bags split across threads and checks outputs are same.
+ *
+ * Usage: zendnn_embedding_bag_bench [iterations] [split_min]
+ * split_min is ZENDNN_EMB_SPLIT_MIN of split run(default 256), threads are
+ * taken from OMP_NUM_THREADS.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "zendnn.hpp"
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace zendnn;
+
+struct emb_bench_shape {
+    const char *name;
+    int   rows, dim, bags, max_len;
+    float zipf_s;
+};
+
+//Table and batch shapes from DLRM style models, zipf_s is Zipf exponent of
+//bag length(1 ... max_len)
+static const emb_bench_shape shapes[] = {
+    {"uniform_len",  1000000,  64, 2048,    1, 0.0f},
+    {"zipf_1.05",    1000000,  64, 2048, 4096, 1.05f},
+    {"zipf_1.2",     1000000, 128, 2048, 8192, 1.2f},
+    {"zipf_1.5_d16", 4000000,  16, 4096, 8192, 1.5f},
+    {"zipf_2.0",     1000000,  64,  512, 65536, 2.0f},
+};
+
+//Zipf distributed bag lengths, P(len = k) ~ 1/k^s
+static std::vector<int> zipf_lengths(const emb_bench_shape &s,
+                                     std::mt19937 &gen) {
+    std::vector<double> cdf(s.max_len);
+    double sum = 0.0;
+    for (int k = 1; k <= s.max_len; k++) {
+        sum += 1.0 / pow((double)k, s.zipf_s);
+        cdf[k - 1] = sum;
+    }
+    std::uniform_real_distribution<double> uni(0.0, sum);
+    std::vector<int> len(s.bags);
+    for (int b = 0; b < s.bags; b++) {
+        len[b] = (int)(std::lower_bound(cdf.begin(), cdf.end(), uni(gen))
+                       - cdf.begin()) + 1;
+    }
+    return len;
+}
+
+static embedding_bag create_primitive(engine eng, const memory &table,
+                                      const memory &indices,
+                                      const memory &offsets,
+                                      const memory &dst,
+                                      const std::string &split_min) {
+    //knob is read when primitive descriptor is created
+    setenv("ZENDNN_EMB_SPLIT_MIN", split_min.c_str(), 1);
+    auto emdb_d = embedding_bag::desc(prop_kind::forward_inference,
+                                      algorithm::embedding_bag_sum,
+                                      readEnv().omp_num_threads,
+                                      table.get_desc(), indices.get_desc(),
+                                      offsets.get_desc(), dst.get_desc());
+    auto emdb_pd = embedding_bag::primitive_desc(emdb_d, eng);
+    return embedding_bag(emdb_pd);
+}
+
+template <typename F>
+static double time_msec(F func, int iterations) {
+    //Warm up run, also touches destination pages
+    func();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count()
+           / iterations;
+}
+
+static int bench_shape(engine eng, stream s, const emb_bench_shape &sh,
+                       int iterations, const std::string &split_min) {
+    std::mt19937 gen(7);
+    std::vector<int> len = zipf_lengths(sh, gen);
+
+    int num_indices = 0, longest = 0;
+    for (int b = 0; b < sh.bags; b++) {
+        num_indices += len[b];
+        longest = len[b] > longest ? len[b] : longest;
+    }
+
+    auto table   = memory({{sh.rows, sh.dim}, memory::data_type::f32,
+        memory::format_tag::ab}, eng);
+    auto indices = memory({{num_indices}, memory::data_type::s32,
+        memory::format_tag::a}, eng);
+    auto offsets = memory({{sh.bags}, memory::data_type::s32,
+        memory::format_tag::a}, eng);
+    auto whole   = memory({{sh.bags, sh.dim}, memory::data_type::f32,
+        memory::format_tag::ab}, eng);
+    auto split   = memory({{sh.bags, sh.dim}, memory::data_type::f32,
+        memory::format_tag::ab}, eng);
+
+    float *table_hndl = (float *)table.get_data_handle();
+    for (size_t i = 0; i < (size_t)sh.rows * sh.dim; i++) {
+        table_hndl[i] = (float)(i % 127) / 64.0f - 1.0f;
+    }
+    int32_t *indices_hndl = (int32_t *)indices.get_data_handle();
+    std::uniform_int_distribution<int32_t> row(0, sh.rows - 1);
+    for (int i = 0; i < num_indices; i++) {
+        indices_hndl[i] = row(gen);
+    }
+    int32_t *offsets_hndl = (int32_t *)offsets.get_data_handle();
+    for (int b = 0, first = 0; b < sh.bags; first += len[b], b++) {
+        offsets_hndl[b] = first;
+    }
+
+    auto whole_prim = create_primitive(eng, table, indices, offsets, whole,
+                                       std::to_string(num_indices));
+    auto split_prim = create_primitive(eng, table, indices, offsets, split,
+                                       split_min);
+
+    double whole_ms = time_msec([&]() {
+        whole_prim.execute(s, {{ZENDNN_ARG_SRC_0, table},
+            {ZENDNN_ARG_SRC_1, indices}, {ZENDNN_ARG_SRC_2, offsets},
+            {ZENDNN_ARG_DST, whole}});
+        s.wait();
+    }, iterations);
+    double split_ms = time_msec([&]() {
+        split_prim.execute(s, {{ZENDNN_ARG_SRC_0, table},
+            {ZENDNN_ARG_SRC_1, indices}, {ZENDNN_ARG_SRC_2, offsets},
+            {ZENDNN_ARG_DST, split}});
+        s.wait();
+    }, iterations);
+
+    //split bags are added in different order, allow rounding difference
+    int status = API_SUCCESS;
+    const float *whole_hndl = (float *)whole.get_data_handle();
+    const float *split_hndl = (float *)split.get_data_handle();
+    for (size_t i = 0; i < (size_t)sh.bags * sh.dim; i++) {
+        if (fabs(whole_hndl[i] - split_hndl[i])
+                > 1e-4f * (1.0f + fabs(whole_hndl[i]))) {
+            status = API_FAILURE;
+            break;
+        }
+    }
+
+    double gbytes = (double)num_indices * sh.dim * sizeof(float) / 1e6;
+    printf("%-13s dim%-4d bags %-5d indices %-8d longest %-6d | whole %8.3f ms"
+           " %7.2f GB/s | split %8.3f ms %7.2f GB/s x%5.2f | %s\n",
+           sh.name, sh.dim, sh.bags, num_indices, longest, whole_ms,
+           gbytes / whole_ms, split_ms, gbytes / split_ms,
+           whole_ms / split_ms, status == API_SUCCESS ? "OK" : "MISMATCH");
+    return status;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_embedding_bag_bench starts");
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    iterations = iterations < 1 ? 1 : iterations;
+    std::string split_min = argc > 2 ? argv[2] : "256";
+
+    //whole and split primitives differ only in ZENDNN_EMB_SPLIT_MIN, which
+    //primitive cache does not key on, without cache each gets its own
+    //primitive descriptor
+    set_primitive_cache_capacity(0);
+
+    engine eng(engine::kind::cpu, 0);
+    stream s(eng);
+
+    int status = API_SUCCESS;
+    for (const auto &sh : shapes) {
+        if (bench_shape(eng, s, sh, iterations, split_min) != API_SUCCESS) {
+            status = API_FAILURE;
+        }
+    }
+
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_embedding_bag_bench ends");
+    return status;
+}
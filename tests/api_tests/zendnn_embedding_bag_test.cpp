@@ -27,14 +27,17 @@
 #include <cmath>
 #include <fstream>
 #include <numeric>
+#include <algorithm>
 #include <string>
 #include <math.h>
 #include <cstdlib>
 #include <unistd.h>
+#include <limits.h>
 #include <string.h>
 
 #include "test_utils.hpp"
 #include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
 
 #define   API_SUCCESS          (0)
 #define   API_FAILURE          (1)
@@ -99,6 +102,189 @@ memory create_embedding_table(engine eng, emb_params &params) {
     return table;
 }
 
+/* create bf16 copy of embedding table, values are small integers so
+   they are exact in bf16 */
+memory create_embedding_table_bf16(engine eng, emb_params &params) {
+
+    int32_t  &num_embedding = params.num_embedding;
+    int32_t  &dim_embedding = params.dim_embedding;
+
+    auto table = memory({{num_embedding, dim_embedding},
+        memory::data_type::bf16,
+        memory::format_tag::ab}, eng);
+
+    uint16_t *hndl = (uint16_t *)table.get_data_handle();
+
+    for(auto i = 0; i < num_embedding*dim_embedding; ++i) {
+        float    val = float(i+1);
+        uint32_t bits;
+        memcpy(&bits, &val, sizeof(bits));
+        hndl[i] = bits >> 16;
+    }
+
+    return table;
+}
+
+/* f32 to f16 for zero and normal values exact in f16 */
+uint16_t f32_to_f16(float val) {
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+    if((bits & 0x7fffffff) == 0)
+        return sign;
+    int32_t exp = int32_t((bits >> 23) & 0xff) - 127 + 15;
+    return uint16_t(sign | (exp << 10) | ((bits >> 13) & 0x3ff));
+}
+
+/* create f16 copy of embedding table, values are small integers so they
+   are exact in f16 */
+memory create_embedding_table_f16(engine eng, emb_params &params) {
+
+    int32_t  &num_embedding = params.num_embedding;
+    int32_t  &dim_embedding = params.dim_embedding;
+
+    auto table = memory({{num_embedding, dim_embedding},
+        memory::data_type::f16,
+        memory::format_tag::ab}, eng);
+
+    uint16_t *hndl = (uint16_t *)table.get_data_handle();
+
+    for(auto i = 0; i < num_embedding*dim_embedding; ++i) {
+        hndl[i] = f32_to_f16(float(i+1));
+    }
+
+    return table;
+}
+
+/* f32 to bf16 with round to nearest even, NaN stays NaN */
+uint16_t f32_to_bf16(float val) {
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    if(isnan(val))
+        return uint16_t((bits >> 16) | 0x40);
+    bits += 0x7fff + ((bits >> 16) & 1);
+    return uint16_t(bits >> 16);
+}
+
+/* create row-wise quantized table, row r holds dim_embedding values of
+   bits(8 or 4, two per byte with even column in low nibble) followed by
+   scale and bias of scale_dt(f32 or f16). dequantized f32 table is
+   returned in deq */
+memory create_embedding_table_quant(engine eng, emb_params &params,
+                                    int32_t bits, memory::data_type scale_dt,
+                                    std::vector<float> &deq) {
+
+    int32_t  &num_embedding = params.num_embedding;
+    int32_t  &dim_embedding = params.dim_embedding;
+    int32_t   qcols         = bits == 8 ? dim_embedding
+                                        : (dim_embedding + 1)/2;
+    int32_t   scale_size    = scale_dt == memory::data_type::f16
+                              ? sizeof(uint16_t) : sizeof(float);
+    int32_t   row_bytes     = qcols + 2*scale_size;
+
+    auto table = memory({{num_embedding, qcols},
+        memory::data_type::u8,
+        {row_bytes, 1}}, eng);
+
+    uint8_t *hndl = (uint8_t *)table.get_data_handle();
+    memset(hndl, 0, num_embedding*row_bytes);
+    deq.resize(num_embedding*dim_embedding);
+
+    for(auto r = 0; r < num_embedding; ++r) {
+        uint8_t *row   = hndl + r*row_bytes;
+        float    scale = 0.5f*(r+1);
+        float    bias  = float(r) - 3.0f;
+        for(auto j = 0; j < dim_embedding; ++j) {
+            uint8_t q = uint8_t((r*7 + j) % (1 << bits));
+            if(bits == 8)
+                row[j] = q;
+            else
+                row[j/2] |= uint8_t(q << (4*(j%2)));
+            deq[r*dim_embedding + j] = scale*q + bias;
+        }
+        if(scale_dt == memory::data_type::f16) {
+            uint16_t sb[2] = {f32_to_f16(scale), f32_to_f16(bias)};
+            memcpy(row + qcols, sb, sizeof(sb));
+        }
+        else {
+            memcpy(row + qcols, &scale, sizeof(float));
+            memcpy(row + qcols + sizeof(float), &bias, sizeof(float));
+        }
+    }
+
+    return table;
+}
+
+/* reference bags over f32 table, mean divides by rows which are not
+   padding index, bag of padding rows only is zero */
+std::vector<float> ref_bags(const std::vector<float> &table,
+                            emb_params &params, algorithm alg,
+                            bool is_weights, int32_t padding_idx) {
+
+    int32_t dim = params.dim_embedding;
+    std::vector<float> out(params.num_bags*dim, 0.0f);
+
+    for(auto b = 0; b < params.num_bags; ++b) {
+        int32_t first = params.offsets[b];
+        int32_t last  = b + 1 < params.num_bags ? params.offsets[b+1]
+                                                : params.num_indices;
+        int32_t count = 0;
+        for(auto i = first; i < last; ++i) {
+            int32_t idx = params.indices[i];
+            if(idx == padding_idx)
+                continue;
+            float wt = is_weights ? params.weights[i] : 1.0f;
+            for(auto j = 0; j < dim; ++j) {
+                float val = wt*table[idx*dim + j];
+                float &o  = out[b*dim + j];
+                if(alg == algorithm::embedding_bag_max)
+                    o = count ? std::max(o, val) : val;
+                else
+                    o += val;
+            }
+            ++count;
+        }
+        if(alg == algorithm::embedding_bag_mean && count)
+            for(auto j = 0; j < dim; ++j)
+                out[b*dim + j] /= count;
+    }
+
+    return out;
+}
+
+/* dense reference gradient of embedding bag backward, mode 0 is sum
+   (weights may be NULL) and 1 is mean over non padding rows. touched rows
+   are rows of non padding indices */
+std::vector<float> ref_grad(int rows, int dim, const int *indices,
+                            int indices_size, const int *offsets, int bags,
+                            const float *weights, int mode, int padding_idx,
+                            const std::vector<float> &diff_dst,
+                            std::vector<bool> &touched) {
+
+    std::vector<float> grad(rows*dim, 0.0f);
+    touched.assign(rows, false);
+
+    for(auto b = 0; b < bags; ++b) {
+        int first = offsets[b];
+        int last  = b + 1 < bags ? offsets[b+1] : indices_size;
+        int valid = 0;
+        for(auto i = first; i < last; ++i)
+            valid += indices[i] != padding_idx;
+        for(auto i = first; i < last; ++i) {
+            int row = indices[i];
+            if(row == padding_idx)
+                continue;
+            float scale = weights ? weights[i]
+                          : (mode == 1 ? 1.0f/valid : 1.0f);
+            for(auto j = 0; j < dim; ++j)
+                grad[row*dim + j] += scale*diff_dst[b*dim + j];
+            touched[row] = true;
+        }
+    }
+
+    return grad;
+}
+
 /* create indices */
 memory create_indices(engine eng, emb_params &params) {
 
@@ -199,7 +385,9 @@ std::vector<float> sum_bags(memory &dst)
 void exec_embedding_bag(engine eng, stream s, memory table,
                         memory indices, memory offsets, memory weights,
                         memory bags, algorithm alg, uint32_t num_threads,
-                        bool is_weights, int32_t padding_idx) {
+                        bool is_weights, int32_t padding_idx,
+                        int32_t quant_bits = 0,
+                        memory::data_type scale_dt = memory::data_type::undef) {
 
     auto table_md   = memory::desc(table.get_desc());
     auto indices_md = memory::desc(indices.get_desc());
@@ -209,7 +397,19 @@ void exec_embedding_bag(engine eng, stream s, memory table,
 
     auto emdb_d = embedding_bag::desc();
 
-    if(!is_weights) {
+    if(quant_bits) {
+        emdb_d = embedding_bag::desc(prop_kind::forward_inference,
+                                     alg,
+                                     num_threads,
+                                     table_md,
+                                     indices_md,
+                                     offsets_md,
+                                     is_weights ? weights_md : memory::desc(),
+                                     bags_md,
+                                     padding_idx,
+                                     quant_bits,
+                                     scale_dt);
+    } else if(!is_weights) {
         if(padding_idx < 0)
             emdb_d = embedding_bag::desc(prop_kind::forward_inference,
                                          alg,
@@ -268,6 +468,93 @@ void exec_embedding_bag(engine eng, stream s, memory table,
     }
 }
 
+/* bags split across threads(ZENDNN_EMB_SPLIT_MIN=1) against same bags kept
+   whole, with sum, weighted sum, mean and max. second bag has a run of
+   padding index longer than a thread range, so a middle piece of it is all
+   padding */
+int test_split_bags(engine eng, stream s) {
+
+    int status = API_SUCCESS;
+
+    emb_params    params;
+    const int32_t lens[]      = {6, 60, 4, 1};
+    const int32_t num_bags    = 4;
+    const int32_t num_indices = 71;
+    const int32_t padding_idx = params.padding_idx;
+    const int32_t dim         = params.dim_embedding;
+    const uint32_t num_threads = 8;
+
+    memory table   = create_embedding_table(eng, params);
+    auto   indices = memory({{num_indices}, memory::data_type::s32,
+        memory::format_tag::a}, eng);
+    auto   offsets = memory({{num_bags}, memory::data_type::s32,
+        memory::format_tag::a}, eng);
+    auto   weights = memory({{num_indices}, memory::data_type::f32,
+        memory::format_tag::a}, eng);
+
+    int32_t *indices_hndl = (int32_t *)indices.get_data_handle();
+    int32_t *offsets_hndl = (int32_t *)offsets.get_data_handle();
+    float   *weights_hndl = (float *)weights.get_data_handle();
+    for(auto b = 0, first = 0; b < num_bags; first += lens[b], ++b) {
+        offsets_hndl[b] = first;
+    }
+    for(auto i = 0; i < num_indices; ++i) {
+        int32_t idx = (i*3) % params.num_embedding;
+        indices_hndl[i] = idx == padding_idx ? idx + 1 : idx;
+        weights_hndl[i] = 0.5f + i % 4;
+    }
+    for(auto i = lens[0] + 15; i < lens[0] + 45; ++i) {
+        indices_hndl[i] = padding_idx;
+    }
+
+    /* thread count and split min are read when primitive descriptor is
+       created, primitive cache does not key on them */
+    int         cache_capacity = get_primitive_cache_capacity();
+    const char *omp_env        = getenv("OMP_NUM_THREADS");
+    std::string omp_threads    = omp_env ? omp_env : "";
+    set_primitive_cache_capacity(0);
+    setenv("OMP_NUM_THREADS", std::to_string(num_threads).c_str(), 1);
+
+    const algorithm algs[]   = {algorithm::embedding_bag_sum,
+                                algorithm::embedding_bag_sum,
+                                algorithm::embedding_bag_mean,
+                                algorithm::embedding_bag_max};
+    const bool      is_wts[] = {true, false, false, false};
+    const char     *names[]  = {"weighted sum", "sum", "mean", "max"};
+    for(int a = 0; a < 4; ++a) {
+        memory bags[2];
+        for(int split = 0; split < 2; ++split) {
+            setenv("ZENDNN_EMB_SPLIT_MIN", split ? "1" : "1000000", 1);
+            bags[split] = memory({{num_bags, dim}, memory::data_type::f32,
+                memory::format_tag::ab}, eng);
+            exec_embedding_bag(eng, s, table, indices, offsets, weights,
+                               bags[split], algs[a], num_threads, is_wts[a],
+                               padding_idx);
+        }
+
+        float *whole = (float *)bags[0].get_data_handle();
+        float *split = (float *)bags[1].get_data_handle();
+        for(auto i = 0; i < num_bags*dim; ++i) {
+            if(fabs(split[i] - whole[i]) > 1e-5f*(1.0f + fabs(whole[i]))) {
+                zendnnError(ZENDNN_TESTLOG, "split bags ", names[a],
+                            " bag ", i/dim, " Expected:", whole[i],
+                            " Actual:", split[i]);
+                status = API_FAILURE;
+                break;
+            }
+        }
+    }
+
+    unsetenv("ZENDNN_EMB_SPLIT_MIN");
+    if(omp_env)
+        setenv("OMP_NUM_THREADS", omp_threads.c_str(), 1);
+    else
+        unsetenv("OMP_NUM_THREADS");
+    set_primitive_cache_capacity(cache_capacity);
+
+    return status;
+}
+
 int main(int argc, char **argv) {
 
     int status = API_SUCCESS;
@@ -363,6 +650,713 @@ int main(int argc, char **argv) {
         }
     }
 
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing bf16 table sum with weights and pading index");
+        memory table_bf16 = create_embedding_table_bf16(eng, params);
+        exec_embedding_bag(eng, s, table_bf16, indices,
+                           offsets, weights, bags,
+                           algorithm::embedding_bag_sum, params.num_threads,
+                           true, params.padding_idx);
+
+        auto sum = sum_bags(bags);
+        for(int i = 0; i < params.num_bags; ++i) {
+            if(!cmp(sum[i],expected_output_sum_wt_pd[i])) {
+                zendnnError(ZENDNN_TESTLOG, "Expected:",
+                            expected_output_sum_wt_pd[i],
+                            " Actual:", sum[i]);
+                status = API_FAILURE;
+            }
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing f16 table with sum, mean and max");
+        memory table_f16 = create_embedding_table_f16(eng, params);
+        const algorithm algs[]     = {algorithm::embedding_bag_sum,
+                                      algorithm::embedding_bag_mean,
+                                      algorithm::embedding_bag_max};
+        const bool      is_wts[]   = {true, false, false};
+        const int32_t   pad_idx[]  = {params.padding_idx, -1,
+                                      params.padding_idx};
+        const float    *expected[] = {expected_output_sum_wt_pd,
+                                      expected_output_mean_nwt_npd,
+                                      expected_output_max_nwt_pd};
+        for(int a = 0; a < 3; ++a) {
+            exec_embedding_bag(eng, s, table_f16, indices,
+                               offsets, weights, bags, algs[a],
+                               params.num_threads, is_wts[a], pad_idx[a]);
+
+            auto sum = sum_bags(bags);
+            for(int i = 0; i < params.num_bags; ++i) {
+                if(!cmp(sum[i],expected[a][i])) {
+                    zendnnError(ZENDNN_TESTLOG, "f16 table Expected:",
+                                expected[a][i], " Actual:", sum[i]);
+                    status = API_FAILURE;
+                }
+            }
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing bf16 output rounding and NaN");
+        /* each bag is one row, so output is the row itself. Row 0 has
+           256 + j, odd values are ties between two bf16 values and round
+           to even, row 1 has fractions and a NaN in column 3 */
+        emb_params bf16_params;
+        const int  dim = bf16_params.dim_embedding;
+        bf16_params.num_embedding = 2;
+        bf16_params.num_indices   = 2;
+        bf16_params.num_bags      = 2;
+        bf16_params.indices[0]    = 0;
+        bf16_params.indices[1]    = 1;
+        bf16_params.offsets[0]    = 0;
+        bf16_params.offsets[1]    = 1;
+
+        memory bf16_table   = create_embedding_table(eng, bf16_params);
+        float *table_hndl   = (float *)bf16_table.get_data_handle();
+        for(int j = 0; j < dim; ++j) {
+            table_hndl[j]       = float(256 + j);
+            table_hndl[dim + j] = -1.0f/float(j + 3);
+        }
+        table_hndl[dim + 3] = NAN;
+
+        memory bf16_indices = create_indices(eng, bf16_params);
+        memory bf16_offsets = create_offsets(eng, bf16_params);
+        memory bf16_weights = create_weights(eng, bf16_params);
+        auto   bf16_bags    = memory({{bf16_params.num_bags, dim},
+            memory::data_type::bf16,
+            memory::format_tag::ab}, eng);
+
+        exec_embedding_bag(eng, s, bf16_table, bf16_indices,
+                           bf16_offsets, bf16_weights, bf16_bags,
+                           algorithm::embedding_bag_sum,
+                           bf16_params.num_threads, false, -1);
+
+        uint16_t *out = (uint16_t *)bf16_bags.get_data_handle();
+        for(int i = 0; i < bf16_params.num_bags*dim; ++i) {
+            uint16_t expected = f32_to_bf16(table_hndl[i]);
+            bool     nan_ok   = isnan(table_hndl[i])
+                                && (out[i] & 0x7f80) == 0x7f80
+                                && (out[i] & 0x7f) != 0;
+            if(out[i] != expected && !nan_ok) {
+                zendnnError(ZENDNN_TESTLOG, "bf16 output of ",
+                            table_hndl[i], " Expected:", expected,
+                            " Actual:", out[i]);
+                status = API_FAILURE;
+            }
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing s64 indices sum with weights and pading index");
+        auto indices_s64 = memory({{params.num_indices},
+            memory::data_type::s64,
+            memory::format_tag::a}, eng);
+        auto offsets_s64 = memory({{params.num_bags},
+            memory::data_type::s64,
+            memory::format_tag::a}, eng);
+
+        int64_t *idx_hndl = (int64_t *)indices_s64.get_data_handle();
+        int64_t *off_hndl = (int64_t *)offsets_s64.get_data_handle();
+        for(auto i = 0; i < params.num_indices; ++i) {
+            idx_hndl[i] = params.indices[i];
+        }
+        for(auto i = 0; i < params.num_bags; ++i) {
+            off_hndl[i] = params.offsets[i];
+        }
+
+        exec_embedding_bag(eng, s, table, indices_s64,
+                           offsets_s64, weights, bags,
+                           algorithm::embedding_bag_sum, params.num_threads,
+                           true, params.padding_idx);
+
+        auto sum = sum_bags(bags);
+        for(int i = 0; i < params.num_bags; ++i) {
+            if(!cmp(sum[i],expected_output_sum_wt_pd[i])) {
+                zendnnError(ZENDNN_TESTLOG, "Expected:",
+                            expected_output_sum_wt_pd[i],
+                            " Actual:", sum[i]);
+                status = API_FAILURE;
+            }
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing quantized tables with sum, mean and max");
+        /* 8 and 4 bit values with f32 and f16 scale and bias, odd dim
+           leaves high nibble of last byte of 4 bit row unused. second bag
+           has only padding rows and is zero, third bag starts with
+           padding row */
+        const algorithm algs[]    = {algorithm::embedding_bag_sum,
+                                     algorithm::embedding_bag_mean,
+                                     algorithm::embedding_bag_max};
+        const bool      is_wts[]  = {true, false, false};
+        const int32_t   bits[]    = {8, 4};
+        const int32_t   dims[]    = {20, 19};
+        const memory::data_type scale_dts[] = {memory::data_type::f32,
+                                               memory::data_type::f16};
+        for(auto nbits : bits)
+        for(auto dim : dims)
+        for(auto scale_dt : scale_dts) {
+            emb_params q_params;
+            q_params.dim_embedding = dim;
+            for(auto i = 3; i < 7; ++i)
+                q_params.indices[i] = q_params.padding_idx;
+            std::vector<float> deq;
+            memory q_table = create_embedding_table_quant(eng, q_params,
+                             nbits, scale_dt, deq);
+            memory q_indices = create_indices(eng, q_params);
+            memory q_bags  = create_output(eng, q_params);
+            for(int a = 0; a < 3; ++a) {
+                exec_embedding_bag(eng, s, q_table, q_indices, offsets,
+                                   weights, q_bags, algs[a],
+                                   q_params.num_threads, is_wts[a],
+                                   q_params.padding_idx, nbits, scale_dt);
+
+                std::vector<float> ref = ref_bags(deq, q_params, algs[a],
+                                                  is_wts[a],
+                                                  q_params.padding_idx);
+                float *out = (float *)q_bags.get_data_handle();
+                for(size_t i = 0; i < ref.size(); ++i) {
+                    if(fabs(out[i] - ref[i]) > 1e-5f*(1.0f + fabs(ref[i]))) {
+                        zendnnError(ZENDNN_TESTLOG, nbits,
+                                    " bit quantized table dim ", dim,
+                                    " alg ", a, " Expected:", ref[i],
+                                    " Actual:", out[i]);
+                        status = API_FAILURE;
+                        break;
+                    }
+                }
+            }
+        }
+
+        /* bits and scale data type are not guessed from shapes, u8 table
+           without them and row stride not matching scale data type are
+           rejected */
+        emb_params q_params;
+        std::vector<float> deq;
+        memory q_table = create_embedding_table_quant(eng, q_params, 8,
+                         memory::data_type::f32, deq);
+        bool rejected[2] = {false, false};
+        try {
+            exec_embedding_bag(eng, s, q_table, indices, offsets, weights,
+                               bags, algorithm::embedding_bag_sum,
+                               q_params.num_threads, false, -1);
+        }
+        catch(zendnn::error &e) {
+            rejected[0] = true;
+        }
+        try {
+            exec_embedding_bag(eng, s, q_table, indices, offsets, weights,
+                               bags, algorithm::embedding_bag_sum,
+                               q_params.num_threads, false, -1, 8,
+                               memory::data_type::f16);
+        }
+        catch(zendnn::error &e) {
+            rejected[1] = true;
+        }
+        if(!rejected[0] || !rejected[1]) {
+            zendnnError(ZENDNN_TESTLOG,
+                        "quantized table with wrong format is accepted");
+            status = API_FAILURE;
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing bags split across threads with sum, mean and max");
+        status |= test_split_bags(eng, s);
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing grouped embedding bag with sum, mean and max");
+        /* same table looked up with the three modes tested above, outputs
+           are concatenated along columns. s64 indices and offsets give
+           same output */
+        const int      table_count = 3;
+        const int      ldo         = table_count*params.dim_embedding;
+        const float   *tables[]    = {(float *)table.get_data_handle(),
+                                      (float *)table.get_data_handle(),
+                                      (float *)table.get_data_handle()};
+        const int      dims[]      = {params.dim_embedding,
+                                      params.dim_embedding,
+                                      params.dim_embedding};
+        const int     *idx[]       = {params.indices, params.indices,
+                                      params.indices};
+        const int      idx_size[]  = {params.num_indices, params.num_indices,
+                                      params.num_indices};
+        const int     *offs[]      = {params.offsets, params.offsets,
+                                      params.offsets};
+        const float   *wts[]       = {params.weights, NULL, NULL};
+        const int      modes[]     = {0, 1, 2};
+        const int      pad_idx[]   = {params.padding_idx, -1,
+                                      params.padding_idx};
+        const float   *expected[]  = {expected_output_sum_wt_pd,
+                                      expected_output_mean_nwt_npd,
+                                      expected_output_max_nwt_pd};
+
+        std::vector<float> grp_out(params.num_bags*ldo);
+        zenGroupEmbeddingBag(table_count, tables, dims, idx, idx_size, offs,
+                             wts, modes, pad_idx, params.num_bags,
+                             grp_out.data(), ldo);
+
+        std::vector<int64_t> idx64(params.indices,
+                                   params.indices + params.num_indices);
+        std::vector<int64_t> offs64(params.offsets,
+                                    params.offsets + params.num_bags);
+        const int64_t *idx_s64[]  = {idx64.data(), idx64.data(),
+                                     idx64.data()};
+        const int64_t *offs_s64[] = {offs64.data(), offs64.data(),
+                                     offs64.data()};
+        std::vector<float> grp_out_s64(params.num_bags*ldo);
+        zenGroupEmbeddingBagInt64(table_count, tables, dims, idx_s64,
+                                  idx_size, offs_s64, wts, modes, pad_idx,
+                                  params.num_bags, grp_out_s64.data(), ldo);
+        if(grp_out_s64 != grp_out) {
+            zendnnError(ZENDNN_TESTLOG,
+                        "Grouped embedding bag with s64 indices differs");
+            status = API_FAILURE;
+        }
+
+        for(int t = 0; t < table_count; ++t) {
+            for(int i = 0; i < params.num_bags; ++i) {
+                float bag_sum = 0.0;
+                for(int j = 0; j < params.dim_embedding; ++j) {
+                    bag_sum += grp_out[i*ldo + t*params.dim_embedding + j];
+                }
+                if(!cmp(bag_sum, expected[t][i])) {
+                    zendnnError(ZENDNN_TESTLOG, "Grouped table ", t,
+                                " Expected:", expected[t][i],
+                                " Actual:", bag_sum);
+                    status = API_FAILURE;
+                }
+            }
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing embedding bag backward with SGD update");
+        /* weighted sum with padding, diff_dst of bag b is b+1 in every
+           column, so gradient of a row is sum of weight*(bag+1) over its
+           non padding indices */
+        const int      unique_rows     = 9;
+        const int      expected_rows[] = {0, 2, 3, 4, 5, 6, 7, 8, 9};
+        const float    expected_grad[] = {1, 12, 27, 10, 3, 14, 36, 33, 30};
+        const float    lr              = 0.5f;
+        const int      dim             = params.dim_embedding;
+
+        std::vector<float> diff_dst(params.num_bags*dim);
+        for(int i = 0; i < params.num_bags*dim; ++i) {
+            diff_dst[i] = float(i/dim + 1);
+        }
+
+        std::vector<int>   grad_rows(params.num_indices);
+        std::vector<float> grad(params.num_indices*dim);
+        int unique = zenEmbeddingBagBackward(params.num_embedding, dim,
+                                             params.indices,
+                                             params.num_indices,
+                                             params.offsets, params.num_bags,
+                                             params.weights, 0,
+                                             params.padding_idx,
+                                             diff_dst.data(), dim,
+                                             grad_rows.data(), grad.data());
+
+        const float *hndl = (float *)table.get_data_handle();
+        std::vector<float> updated(hndl,
+                                   hndl + params.num_embedding*dim);
+        int updated_rows = zenEmbeddingBagUpdate(updated.data(),
+                           params.num_embedding, dim, params.indices,
+                           params.num_indices, params.offsets,
+                           params.num_bags, params.weights, 0,
+                           params.padding_idx, diff_dst.data(), dim,
+                           0, lr, 0.0f, NULL);
+
+        if(unique != unique_rows || updated_rows != unique_rows) {
+            zendnnError(ZENDNN_TESTLOG, "Backward Expected rows:",
+                        unique_rows, " Actual:", unique, " ", updated_rows);
+            status = API_FAILURE;
+        }
+        else {
+            for(int u = 0; u < unique_rows; ++u) {
+                int row = expected_rows[u];
+                for(int j = 0; j < dim; ++j) {
+                    if(grad_rows[u] != row
+                            || !cmp(grad[u*dim + j], expected_grad[u])
+                            || !cmp(updated[row*dim + j],
+                                    hndl[row*dim + j]
+                                    - lr*expected_grad[u])) {
+                        zendnnError(ZENDNN_TESTLOG, "Backward row ", row,
+                                    " Expected grad:", expected_grad[u],
+                                    " Actual:", grad[u*dim + j]);
+                        status = API_FAILURE;
+                        break;
+                    }
+                }
+            }
+            /* padding row is not updated */
+            int pad = params.padding_idx;
+            if(!cmp(updated[pad*dim], hndl[pad*dim])) {
+                zendnnError(ZENDNN_TESTLOG, "Backward padding row updated");
+                status = API_FAILURE;
+            }
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing embedding bag backward with Adagrad and row-wise Adagrad update");
+        /* two steps from state of ones, diff_dst varies along columns so
+           row-wise state(mean of squared gradient) differs from Adagrad */
+        const float lr  = 0.5f;
+        const float eps = 1e-6f;
+        const int   dim = params.dim_embedding;
+        const int   num = params.num_embedding;
+
+        std::vector<float> diff_dst(params.num_bags*dim);
+        for(int i = 0; i < params.num_bags*dim; ++i) {
+            diff_dst[i] = 0.25f*(i/dim + 1)*(1 + (i%dim)%3);
+        }
+        std::vector<bool>  touched;
+        std::vector<float> grad = ref_grad(num, dim, params.indices,
+                                           params.num_indices,
+                                           params.offsets, params.num_bags,
+                                           params.weights, 0,
+                                           params.padding_idx, diff_dst,
+                                           touched);
+
+        const float *hndl = (float *)table.get_data_handle();
+        for(int optimizer = 1; optimizer <= 2; ++optimizer) {
+            const char *name = optimizer == 1 ? "Adagrad" : "row-wise Adagrad";
+            std::vector<float> updated(hndl, hndl + num*dim);
+            std::vector<float> ref_table = updated;
+            std::vector<float> state(optimizer == 1 ? num*dim : num, 1.0f);
+            std::vector<float> ref_state = state;
+
+            for(int step = 0; step < 2; ++step) {
+                int updated_rows = zenEmbeddingBagUpdate(updated.data(),
+                                   num, dim, params.indices,
+                                   params.num_indices, params.offsets,
+                                   params.num_bags, params.weights, 0,
+                                   params.padding_idx, diff_dst.data(), dim,
+                                   optimizer, lr, eps, state.data());
+                if(updated_rows != 9) {
+                    zendnnError(ZENDNN_TESTLOG, name, " Expected rows:", 9,
+                                " Actual:", updated_rows);
+                    status = API_FAILURE;
+                }
+
+                for(int r = 0; r < num; ++r) {
+                    if(!touched[r])
+                        continue;
+                    const float *g = &grad[r*dim];
+                    float       *t = &ref_table[r*dim];
+                    if(optimizer == 1) {
+                        for(int j = 0; j < dim; ++j) {
+                            ref_state[r*dim + j] += g[j]*g[j];
+                            t[j] -= lr*g[j]/(sqrtf(ref_state[r*dim + j])
+                                             + eps);
+                        }
+                    }
+                    else {
+                        float sq = 0.0f;
+                        for(int j = 0; j < dim; ++j)
+                            sq += g[j]*g[j];
+                        ref_state[r] += sq/dim;
+                        for(int j = 0; j < dim; ++j)
+                            t[j] -= lr*g[j]/(sqrtf(ref_state[r]) + eps);
+                    }
+                }
+            }
+
+            for(size_t i = 0; i < updated.size(); ++i) {
+                if(fabs(updated[i] - ref_table[i])
+                        > 1e-5f*(1.0f + fabs(ref_table[i]))) {
+                    zendnnError(ZENDNN_TESTLOG, name, " table ", i,
+                                " Expected:", ref_table[i],
+                                " Actual:", updated[i]);
+                    status = API_FAILURE;
+                    break;
+                }
+            }
+            for(size_t i = 0; i < state.size(); ++i) {
+                if(fabs(state[i] - ref_state[i])
+                        > 1e-5f*(1.0f + fabs(ref_state[i]))) {
+                    zendnnError(ZENDNN_TESTLOG, name, " state ", i,
+                                " Expected:", ref_state[i],
+                                " Actual:", state[i]);
+                    status = API_FAILURE;
+                    break;
+                }
+            }
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing embedding bag backward with mean and padding");
+        /* second bag is padding only and gets no gradient, mean of other
+           bags is over their non padding rows */
+        const int   indices_mean[] = {0, 1, 5, 1, 1, 4, 2, 6, 1, 3};
+        const int   offsets_mean[] = {0, 3, 5};
+        const int   num_mean       = 10;
+        const int   bags_mean      = 3;
+        const int   dim            = params.dim_embedding;
+        const int   num            = params.num_embedding;
+
+        std::vector<float> diff_dst(bags_mean*dim);
+        for(int i = 0; i < bags_mean*dim; ++i) {
+            diff_dst[i] = float(i/dim + 1) + 0.125f*(i%dim);
+        }
+        std::vector<bool>  touched;
+        std::vector<float> ref = ref_grad(num, dim, indices_mean, num_mean,
+                                          offsets_mean, bags_mean, NULL, 1,
+                                          params.padding_idx, diff_dst,
+                                          touched);
+
+        std::vector<int>   grad_rows(num_mean);
+        std::vector<float> grad(num_mean*dim);
+        int unique = zenEmbeddingBagBackward(num, dim, indices_mean,
+                                             num_mean, offsets_mean,
+                                             bags_mean, NULL, 1,
+                                             params.padding_idx,
+                                             diff_dst.data(), dim,
+                                             grad_rows.data(), grad.data());
+
+        /* touched rows in ascending order are the unique rows */
+        int u = 0;
+        for(int r = 0; r < num; ++r) {
+            if(!touched[r])
+                continue;
+            if(u >= unique || grad_rows[u] != r) {
+                zendnnError(ZENDNN_TESTLOG, "Backward mean Expected row:", r,
+                            " Actual:", u < unique ? grad_rows[u] : -1);
+                status = API_FAILURE;
+                break;
+            }
+            for(int j = 0; j < dim; ++j) {
+                if(fabs(grad[u*dim + j] - ref[r*dim + j])
+                        > 1e-5f*(1.0f + fabs(ref[r*dim + j]))) {
+                    zendnnError(ZENDNN_TESTLOG, "Backward mean row ", r,
+                                " Expected grad:", ref[r*dim + j],
+                                " Actual:", grad[u*dim + j]);
+                    status = API_FAILURE;
+                    break;
+                }
+            }
+            ++u;
+        }
+        if(u != unique) {
+            zendnnError(ZENDNN_TESTLOG, "Backward mean Expected rows:", u,
+                        " Actual:", unique);
+            status = API_FAILURE;
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing embedding bag backward error returns");
+        /* out of range index, weights with mean and Adagrad without state
+           return -1 and leave table unchanged */
+        const int    dim           = params.dim_embedding;
+        const int    num           = params.num_embedding;
+        const int    bad_indices[] = {0, 1, 5, 1, 4, 2, 6, 1, 3, 9, 8, 10};
+        const float *hndl          = (float *)table.get_data_handle();
+        std::vector<float> diff_dst(params.num_bags*dim, 1.0f);
+        std::vector<float> updated(hndl, hndl + num*dim);
+        std::vector<float> state(num*dim, 0.0f);
+        std::vector<int>   grad_rows(params.num_indices);
+        std::vector<float> grad(params.num_indices*dim);
+
+        int ret[4];
+        ret[0] = zenEmbeddingBagBackward(num, dim, bad_indices,
+                                         params.num_indices, params.offsets,
+                                         params.num_bags, params.weights, 0,
+                                         params.padding_idx, diff_dst.data(),
+                                         dim, grad_rows.data(), grad.data());
+        ret[1] = zenEmbeddingBagUpdate(updated.data(), num, dim, bad_indices,
+                                       params.num_indices, params.offsets,
+                                       params.num_bags, params.weights, 0,
+                                       params.padding_idx, diff_dst.data(),
+                                       dim, 0, 0.5f, 0.0f, NULL);
+        ret[2] = zenEmbeddingBagUpdate(updated.data(), num, dim,
+                                       params.indices, params.num_indices,
+                                       params.offsets, params.num_bags,
+                                       params.weights, 1,
+                                       params.padding_idx, diff_dst.data(),
+                                       dim, 1, 0.5f, 1e-6f, state.data());
+        ret[3] = zenEmbeddingBagUpdate(updated.data(), num, dim,
+                                       params.indices, params.num_indices,
+                                       params.offsets, params.num_bags,
+                                       params.weights, 0,
+                                       params.padding_idx, diff_dst.data(),
+                                       dim, 1, 0.5f, 1e-6f, NULL);
+        for(int k = 0; k < 4; ++k) {
+            if(ret[k] != -1) {
+                zendnnError(ZENDNN_TESTLOG, "Backward error case ", k,
+                            " Expected:", -1, " Actual:", ret[k]);
+                status = API_FAILURE;
+            }
+        }
+        if(!std::equal(updated.begin(), updated.end(), hndl)) {
+            zendnnError(ZENDNN_TESTLOG, "Backward table updated on error");
+            status = API_FAILURE;
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing embedding bag over frequency reordered table");
+        /* rows are reordered by access counts of the batch and looked up
+           with original indices, output is same as weighted sum above.
+           s64 indices and offsets give same counts and output */
+        const int dim = params.dim_embedding;
+        std::vector<unsigned int> counts(params.num_embedding, 0);
+        std::vector<float>        reordered(params.num_embedding*dim);
+        std::vector<int>          remap(params.num_embedding);
+        std::vector<float>        remap_out(params.num_bags*dim);
+
+        zenEmbeddingRowCount(params.num_embedding, params.indices,
+                             params.num_indices, params.padding_idx,
+                             counts.data());
+        int hot_rows = zenEmbeddingRowReorder(
+                           (float *)table.get_data_handle(),
+                           params.num_embedding, dim, counts.data(),
+                           reordered.data(), remap.data());
+        zenEmbeddingBagRemap(reordered.data(), dim, remap.data(),
+                             params.indices, params.num_indices,
+                             params.offsets, params.num_bags,
+                             params.weights, 0, params.padding_idx,
+                             remap_out.data(), dim);
+
+        std::vector<int64_t>      idx64(params.indices,
+                                        params.indices + params.num_indices);
+        std::vector<int64_t>      offs64(params.offsets,
+                                         params.offsets + params.num_bags);
+        std::vector<unsigned int> counts_s64(params.num_embedding, 0);
+        std::vector<float>        remap_out_s64(params.num_bags*dim);
+        zenEmbeddingRowCountInt64(params.num_embedding, idx64.data(),
+                                  params.num_indices, params.padding_idx,
+                                  counts_s64.data());
+        zenEmbeddingBagRemapInt64(reordered.data(), dim, remap.data(),
+                                  idx64.data(), params.num_indices,
+                                  offs64.data(), params.num_bags,
+                                  params.weights, 0, params.padding_idx,
+                                  remap_out_s64.data(), dim);
+        if(counts_s64 != counts || remap_out_s64 != remap_out) {
+            zendnnError(ZENDNN_TESTLOG,
+                        "Reordered table with s64 indices differs");
+            status = API_FAILURE;
+        }
+
+        /* all rows except padding row are looked up */
+        if(hot_rows != params.num_embedding - 1) {
+            zendnnError(ZENDNN_TESTLOG, "Reorder Expected hot rows:",
+                        params.num_embedding - 1, " Actual:", hot_rows);
+            status = API_FAILURE;
+        }
+        for(int i = 0; i < params.num_bags; ++i) {
+            float bag_sum = 0.0;
+            for(int j = 0; j < dim; ++j) {
+                bag_sum += remap_out[i*dim + j];
+            }
+            if(!cmp(bag_sum, expected_output_sum_wt_pd[i])) {
+                zendnnError(ZENDNN_TESTLOG, "Reordered table Expected:",
+                            expected_output_sum_wt_pd[i],
+                            " Actual:", bag_sum);
+                status = API_FAILURE;
+            }
+        }
+    }
+
+    {
+        zendnnVerbose(ZENDNN_TESTLOG,
+                      "testing sum with weights over file backed table");
+        /* table is written after a header of odd size, so mapped table
+           does not start at a page boundary */
+        const int   dim         = params.dim_embedding;
+        const int   header      = 100;
+        char        path[]      = "/tmp/zendnn_emb_tableXXXXXX";
+        const float *mapped     = NULL;
+        int         fd          = mkstemp(path);
+        if(fd >= 0) {
+            std::vector<char> pad_bytes(header, 0);
+            size_t bytes = params.num_embedding*dim*sizeof(float);
+            if(write(fd, pad_bytes.data(), header) == header
+                    && write(fd, table.get_data_handle(), bytes)
+                    == (ssize_t)bytes) {
+                mapped = zenEmbeddingTableMap(path, header,
+                                              params.num_embedding, dim);
+            }
+            close(fd);
+        }
+
+        if(mapped == NULL) {
+            zendnnError(ZENDNN_TESTLOG, "File backed table is not mapped");
+            status = API_FAILURE;
+        }
+        else {
+            /* s64 indices request same page ranges */
+            std::vector<int64_t> idx64(params.indices,
+                                       params.indices + params.num_indices);
+            int ranges = zenEmbeddingTablePrefetch(mapped, dim,
+                                                   params.indices,
+                                                   params.num_indices,
+                                                   params.padding_idx);
+            int ranges_s64 = zenEmbeddingTablePrefetchInt64(mapped, dim,
+                             idx64.data(), params.num_indices,
+                             params.padding_idx);
+            if(ranges <= 0 || ranges_s64 != ranges) {
+                zendnnError(ZENDNN_TESTLOG, "File backed prefetch ranges:",
+                            ranges, " with s64 indices:", ranges_s64);
+                status = API_FAILURE;
+            }
+            memory mapped_table(table.get_desc(), eng, (void *)mapped);
+            exec_embedding_bag(eng, s, mapped_table, indices,
+                               offsets, weights, bags,
+                               algorithm::embedding_bag_sum,
+                               params.num_threads, true, params.padding_idx);
+
+            auto sum = sum_bags(bags);
+            for(int i = 0; i < params.num_bags; ++i) {
+                if(!cmp(sum[i],expected_output_sum_wt_pd[i])) {
+                    zendnnError(ZENDNN_TESTLOG, "File backed Expected:",
+                                expected_output_sum_wt_pd[i],
+                                " Actual:", sum[i]);
+                    status = API_FAILURE;
+                }
+            }
+            zenEmbeddingTableUnmap(mapped, params.num_embedding, dim);
+        }
+
+        /* offset not float aligned, table size or its end overflowing and
+           table beyond end of file are rejected */
+        const unsigned long bad_offsets[] = {header + 1, header,
+                                             ULONG_MAX - 3, header + 4};
+        const unsigned long bad_rows[]    = {(unsigned long)params.num_embedding,
+                                             ULONG_MAX/8,
+                                             (unsigned long)params.num_embedding,
+                                             (unsigned long)params.num_embedding};
+        for(int k = 0; k < 4; ++k) {
+            const float *bad = zenEmbeddingTableMap(path, bad_offsets[k],
+                                                    bad_rows[k], dim);
+            if(bad != NULL) {
+                zendnnError(ZENDNN_TESTLOG, "File backed table case ", k,
+                            " is mapped at offset ", bad_offsets[k],
+                            " rows ", bad_rows[k]);
+                zenEmbeddingTableUnmap(bad, bad_rows[k], dim);
+                status = API_FAILURE;
+            }
+        }
+        unlink(path);
+    }
+
     if (status == API_SUCCESS)
       zendnnInfo(ZENDNN_TESTLOG,
                  "ZenDNN API test for embedding_bag successful.");
@@ -0,0 +1,137 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Microbenchmark for im2row (patch matrix formation) in NHWC format.
+ * Times im2rowNHWC and im2rowNHWC_par against a generic per pixel im2row
+ * loop for stem 7x7, 3x3 and 1x1 layer shapes and checks patch matrices
+ * are same.
+ *
+ * Usage: zendnn_im2row_bench [iterations]
+ * Threads for im2rowNHWC_par are taken from OMP_NUM_THREADS.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "zendnn.hpp"
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_private.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+struct im2row_shape {
+    const char *name;
+    int C, H, W, KH, KW, pad, stride;
+};
+
+//Layer shapes from resnet50, mobilenet and googlenet
+static const im2row_shape shapes[] = {
+    {"stem_7x7_s2",   3, 224, 224, 7, 7, 3, 2},
+    {"stem_3x3_s2",   3, 224, 224, 3, 3, 1, 2},
+    {"conv_3x3_c24", 24, 112, 112, 3, 3, 1, 1},
+    {"conv_3x3_c64", 64,  56,  56, 3, 3, 1, 1},
+    {"conv_3x3_s2", 128,  56,  56, 3, 3, 1, 2},
+    {"conv_3x3_c256", 256, 14, 14, 3, 3, 1, 1},
+    {"conv_5x5_c48", 48,  28,  28, 5, 5, 2, 1},
+    {"conv_1x1_s2", 256,  56,  56, 1, 1, 0, 2},
+};
+
+//Generic per pixel im2row, used as baseline and for validation
+static void im2row_generic(const float *input_data, const int depth,
+                           const int height, const int width, const int filter_h, const int filter_w,
+                           const int pad, const int stride, float *col_data) {
+    int height_col = (height + 2 * pad - filter_h) / stride + 1;
+    int width_col = (width + 2 * pad - filter_w) / stride + 1;
+    for (int h = 0; h < height_col; ++h) {
+        int h_pad = -pad + h * stride;
+        for (int w = 0; w < width_col; ++w) {
+            int w_pad = -pad + w * stride;
+            for (int ih = h_pad; ih < h_pad + filter_h; ++ih) {
+                for (int iw = w_pad; iw < w_pad + filter_w; ++iw) {
+                    if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
+                        memcpy(col_data, input_data + ((size_t)ih * width + iw) * depth,
+                               sizeof(float) * depth);
+                    }
+                    else {
+                        memset(col_data, 0, sizeof(float) * depth);
+                    }
+                    col_data += depth;
+                }
+            }
+        }
+    }
+}
+
+template <typename F>
+static double time_msec(F func, int iterations) {
+    //Warm up run, also touches destination pages
+    func();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count()
+           / iterations;
+}
+
+static int bench_shape(const im2row_shape &s, int iterations) {
+    int out_h = (s.H + 2 * s.pad - s.KH) / s.stride + 1;
+    int out_w = (s.W + 2 * s.pad - s.KW) / s.stride + 1;
+    size_t patch_size = (size_t)out_h * out_w * s.KH * s.KW * s.C;
+    std::vector<float> input((size_t)s.H * s.W * s.C);
+    std::vector<float> ref(patch_size), zen(patch_size), zen_par(patch_size);
+    for (size_t i = 0; i < input.size(); i++) {
+        input[i] = (float)(i % 509) - 254.0f;
+    }
+
+    double generic = time_msec([&]() {
+        im2row_generic(input.data(), s.C, s.H, s.W, s.KH, s.KW, s.pad, s.stride,
+                       ref.data());
+    }, iterations);
+    double serial = time_msec([&]() {
+        im2rowNHWC(input.data(), s.C, s.H, s.W, s.KH, s.KW, s.pad, s.pad, s.pad,
+                   s.pad, s.stride, s.stride, zen.data());
+    }, iterations);
+    double parallel = time_msec([&]() {
+        im2rowNHWC_par(input.data(), s.C, s.H, s.W, s.KH, s.KW, s.pad, s.pad,
+                       s.pad, s.pad, s.stride, s.stride, zen_par.data());
+    }, iterations);
+
+    int status = API_SUCCESS;
+    if (memcmp(ref.data(), zen.data(), patch_size * sizeof(float))
+            || memcmp(ref.data(), zen_par.data(), patch_size * sizeof(float))) {
+        status = API_FAILURE;
+    }
+
+    double gbytes = patch_size * sizeof(float) / 1e6;
+    printf("%-14s C%-4d %4dx%-4d k%dx%d s%d | generic %8.3f ms | im2rowNHWC %8.3f ms"
+           " %7.2f GB/s x%5.2f | im2rowNHWC_par %8.3f ms %7.2f GB/s | %s\n",
+           s.name, s.C, s.H, s.W, s.KH, s.KW, s.stride, generic, serial,
+           gbytes / serial, generic / serial, parallel, gbytes / parallel,
+           status == API_SUCCESS ? "OK" : "MISMATCH");
+    return status;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_im2row_bench starts");
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    iterations = iterations < 1 ? 1 : iterations;
+
+    int status = API_SUCCESS;
+    for (const auto &s : shapes) {
+        if (bench_shape(s, iterations) != API_SUCCESS) {
+            status = API_FAILURE;
+        }
+    }
+
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_im2row_bench ends");
+    return status;
+}
@@ -0,0 +1,174 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Checks fused inverted residual block(zenInvertedResidualBlock) against the
+ * unfused sequence of layers
+ *  1. 1x1 expand conv + BN + ReLU6 (zenConvolution2DwithBatchNormRelu, clip)
+ *  2. kxk depthwise conv + BN + ReLU6 (reference loop)
+ *  3. 1x1 project conv + BN (zenConvolution2DwithBatchNorm)
+ *  4. optional residual add
+ * I/p and o/p format is NHWC, filters are HWCN(depthwise filter is HWC).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_helper.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace std;
+using namespace zendnn;
+
+static vector<float> rand_vec(size_t size, float low, float high) {
+    vector<float> v(size);
+    for (size_t i = 0; i < size; i++) {
+        v[i] = low + (high - low)*(rand()/(float)RAND_MAX);
+    }
+    return v;
+}
+
+//Depthwise conv with BN and ReLU6, reference for middle stage
+static void depthwise_bn_relu6(const float *in, int images, int height,
+                               int width, int channels, const float *filter,
+                               int kernel, int pad, int stride,
+                               const float *scale, const float *mean,
+                               const float *offset, float *out, int out_height,
+                               int out_width) {
+    for (int n = 0; n < images; n++)
+        for (int oh = 0; oh < out_height; oh++)
+            for (int ow = 0; ow < out_width; ow++)
+                for (int c = 0; c < channels; c++) {
+                    float acc = 0.0f;
+                    for (int i = 0; i < kernel; i++)
+                        for (int j = 0; j < kernel; j++) {
+                            int ih = oh*stride - pad + i;
+                            int iw = ow*stride - pad + j;
+                            if (ih < 0 || ih >= height || iw < 0 || iw >= width) {
+                                continue;
+                            }
+                            acc += in[(((size_t)n*height + ih)*width + iw)*channels + c]
+                                   *filter[(i*kernel + j)*channels + c];
+                        }
+                    acc = (acc - mean[c])*scale[c] + offset[c];
+                    acc = acc < 0.0f ? 0.0f : (acc > 6.0f ? 6.0f : acc);
+                    out[(((size_t)n*out_height + oh)*out_width + ow)*channels + c] = acc;
+                }
+}
+
+static int test_block(int images, int channels, int height, int width,
+                      int expanded, int kernel, int stride, int no_of_filter,
+                      bool expand, bool residual) {
+    zendnnVerbose(ZENDNN_TESTLOG, "testing inverted residual block images=",
+                  images, " channels=", channels, " height=", height,
+                  " width=", width, " expanded=", expanded, " kernel=", kernel,
+                  " stride=", stride, " no_of_filter=", no_of_filter,
+                  " expand=", expand, " residual=", residual);
+
+    int pad = kernel/2;
+    int out_height = (height + 2*pad - kernel)/stride + 1;
+    int out_width = (width + 2*pad - kernel)/stride + 1;
+    size_t in_pixels = (size_t)images*height*width;
+    size_t out_pixels = (size_t)images*out_height*out_width;
+
+    vector<float> in = rand_vec(in_pixels*channels, -0.5f, 0.5f);
+    vector<float> expand_filter = rand_vec((size_t)channels*expanded, -0.5f, 0.5f);
+    vector<float> dw_filter = rand_vec((size_t)kernel*kernel*expanded, -0.5f,
+                                       0.5f);
+    vector<float> project_filter = rand_vec((size_t)expanded*no_of_filter,
+                                            -0.5f, 0.5f);
+    vector<float> expand_scale = rand_vec(expanded, 0.5f, 2.0f);
+    vector<float> expand_mean = rand_vec(expanded, -0.5f, 0.5f);
+    vector<float> expand_offset = rand_vec(expanded, 0.0f, 3.0f);
+    vector<float> dw_scale = rand_vec(expanded, 0.5f, 2.0f);
+    vector<float> dw_mean = rand_vec(expanded, -0.5f, 0.5f);
+    vector<float> dw_offset = rand_vec(expanded, 0.0f, 3.0f);
+    vector<float> project_scale = rand_vec(no_of_filter, 0.5f, 2.0f);
+    vector<float> project_mean = rand_vec(no_of_filter, -0.5f, 0.5f);
+    vector<float> project_offset = rand_vec(no_of_filter, -0.5f, 0.5f);
+
+    //unfused sequence
+    vector<float> expanded_out(in_pixels*expanded);
+    if (expand) {
+        zenConvolution2DwithBatchNormRelu(in.data(), images, channels, height,
+                                          width, expand_filter.data(), expanded,
+                                          1, 1, 0, 0, 0, 0, 1, 1,
+                                          expand_scale.data(), expand_mean.data(),
+                                          expand_offset.data(), expanded_out.data(),
+                                          height, width);
+        zenClipOp(readEnv(), expanded_out.data(), 6.0f, expanded_out.size());
+    }
+    else {
+        expanded_out = in;
+    }
+    vector<float> dw_out(out_pixels*expanded);
+    depthwise_bn_relu6(expanded_out.data(), images, height, width, expanded,
+                       dw_filter.data(), kernel, pad, stride, dw_scale.data(),
+                       dw_mean.data(), dw_offset.data(), dw_out.data(),
+                       out_height, out_width);
+    vector<float> ref(out_pixels*no_of_filter);
+    zenConvolution2DwithBatchNorm(dw_out.data(), images, expanded, out_height,
+                                  out_width, project_filter.data(), no_of_filter,
+                                  1, 1, 0, 0, 0, 0, 1, 1, project_scale.data(),
+                                  project_mean.data(), project_offset.data(),
+                                  ref.data(), out_height, out_width);
+    if (residual) {
+        for (size_t i = 0; i < ref.size(); i++) {
+            ref[i] += in[i];
+        }
+    }
+
+    //fused block
+    vector<float> out(ref.size(), 77.0f);
+    zenInvertedResidualBlock(in.data(), images, channels, height, width,
+                             expand ? expand_filter.data() : NULL, expanded,
+                             expand_scale.data(), expand_mean.data(),
+                             expand_offset.data(), dw_filter.data(), kernel,
+                             kernel, pad, pad, pad, pad, stride, stride,
+                             dw_scale.data(), dw_mean.data(), dw_offset.data(),
+                             project_filter.data(), no_of_filter,
+                             project_scale.data(), project_mean.data(),
+                             project_offset.data(), residual, out.data(),
+                             out_height, out_width);
+
+    for (size_t i = 0; i < out.size(); i++) {
+        if (fabs(out[i] - ref[i]) > 1e-4f*(1.0f + fabs(ref[i]))) {
+            zendnnInfo(ZENDNN_TESTLOG, "inverted residual block mismatch at ",
+                       i, " fused: ", out[i], " unfused: ", ref[i]);
+            return API_FAILURE;
+        }
+    }
+    return API_SUCCESS;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_inverted_residual_test starts");
+    srand(1111);
+
+    int status = API_SUCCESS;
+    //stride 1 block with residual
+    status |= test_block(1, 16, 56, 56, 96, 3, 1, 16, true, true);
+    //stride 2 block, batch 2
+    status |= test_block(2, 24, 28, 28, 144, 3, 2, 32, true, false);
+    //expansion factor 1, no expand conv
+    status |= test_block(1, 32, 30, 30, 32, 3, 1, 16, false, false);
+    //5x5 depthwise, odd sizes
+    status |= test_block(3, 8, 15, 13, 48, 5, 2, 8, true, false);
+    status |= test_block(1, 40, 7, 7, 240, 5, 1, 40, true, true);
+
+    if (status == API_SUCCESS) {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_inverted_residual_test passed");
+    }
+    else {
+        zendnnInfo(ZENDNN_TESTLOG, "zendnn_inverted_residual_test failed");
+    }
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_inverted_residual_test ends");
+    return status;
+}
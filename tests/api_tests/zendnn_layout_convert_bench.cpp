@@ -0,0 +1,126 @@
+/*******************************************************************************
+* Copyright (c) 2022 Advanced Micro Devices, Inc. All rights reserved.
+*
+*******************************************************************************/
+
+/* Microbenchmark for NCHW <-> NHWC layout conversion.
+ * Compares NCHW2NHWC/NHWC2NCHW helpers against zendnn reorder primitive
+ * (jit_uni_reorder) for same conversions and checks both give same result.
+ *
+ * Usage: zendnn_layout_convert_bench [iterations]
+ * Threads are taken from OMP_NUM_THREADS/ZEN_NUM_THREADS.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "zendnn.hpp"
+#include "test_utils.hpp"
+#include "zendnn_logging.hpp"
+#include "zendnn_private.hpp"
+
+#define   API_SUCCESS          (0)
+#define   API_FAILURE          (1)
+
+using namespace zendnn;
+using tag = memory::format_tag;
+using dt = memory::data_type;
+
+struct layout_shape {
+    int N, C, H, W;
+};
+
+//Typical CNN activation shapes, odd sizes exercise tile edges
+static const layout_shape shapes[] = {
+    {1, 3, 224, 224},
+    {1, 64, 112, 112},
+    {8, 64, 56, 56},
+    {8, 256, 56, 56},
+    {16, 512, 28, 28},
+    {16, 2048, 7, 7},
+    {4, 35, 17, 19},
+};
+
+template <typename F>
+static double time_msec(F func, int iterations) {
+    //Warm up run, also touches destination pages
+    func();
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count()
+           / iterations;
+}
+
+static int bench_shape(const layout_shape &s, int iterations, engine &eng,
+                       stream &engine_stream) {
+    size_t size = (size_t)s.N * s.C * s.H * s.W;
+    std::vector<float> src(size), zen_dst(size), reorder_dst(size);
+    for (size_t i = 0; i < size; i++) {
+        src[i] = (float)(i % 1021) - 510.0f;
+    }
+
+    memory::dims dims = {s.N, s.C, s.H, s.W};
+    memory nchw_mem({dims, dt::f32, tag::nchw}, eng, src.data());
+    memory nhwc_mem({dims, dt::f32, tag::nhwc}, eng, reorder_dst.data());
+    reorder to_nhwc(nchw_mem, nhwc_mem);
+
+    double zen_fwd = time_msec([&]() {
+        NCHW2NHWC(src.data(), s.N, s.C, s.H, s.W, zen_dst.data());
+    }, iterations);
+    double reorder_fwd = time_msec([&]() {
+        to_nhwc.execute(engine_stream, nchw_mem, nhwc_mem);
+        engine_stream.wait();
+    }, iterations);
+    int status = memcmp(zen_dst.data(), reorder_dst.data(),
+                        size * sizeof(float)) ? API_FAILURE : API_SUCCESS;
+
+    //Back to NCHW from NHWC produced above, src is overwritten
+    std::vector<float> zen_back(size);
+    memory back_mem({dims, dt::f32, tag::nchw}, eng, src.data());
+    reorder to_nchw(nhwc_mem, back_mem);
+    double zen_bwd = time_msec([&]() {
+        NHWC2NCHW(zen_dst.data(), s.N, s.C, s.H, s.W, zen_back.data());
+    }, iterations);
+    double reorder_bwd = time_msec([&]() {
+        to_nchw.execute(engine_stream, nhwc_mem, back_mem);
+        engine_stream.wait();
+    }, iterations);
+    if (memcmp(zen_back.data(), src.data(), size * sizeof(float))) {
+        status = API_FAILURE;
+    }
+
+    double gbytes = 2.0 * size * sizeof(float) / 1e6;
+    printf("%4d %5d %4d %4d | NCHW2NHWC %9.3f ms %7.2f GB/s | reorder %9.3f ms"
+           " %7.2f GB/s | NHWC2NCHW %9.3f ms %7.2f GB/s | reorder %9.3f ms"
+           " %7.2f GB/s | %s\n", s.N, s.C, s.H, s.W,
+           zen_fwd, gbytes / zen_fwd, reorder_fwd, gbytes / reorder_fwd,
+           zen_bwd, gbytes / zen_bwd, reorder_bwd, gbytes / reorder_bwd,
+           status == API_SUCCESS ? "OK" : "MISMATCH");
+    return status;
+}
+
+int main(int argc, char **argv) {
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_layout_convert_bench starts");
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    iterations = iterations < 1 ? 1 : iterations;
+
+    engine eng(engine::kind::cpu, 0);
+    stream engine_stream(eng);
+
+    int status = API_SUCCESS;
+    printf("   N     C    H    W\n");
+    for (const auto &s : shapes) {
+        if (bench_shape(s, iterations, eng, engine_stream) != API_SUCCESS) {
+            status = API_FAILURE;
+        }
+    }
+
+    zendnnInfo(ZENDNN_TESTLOG, "zendnn_layout_convert_bench ends");
+    return status;
+}